@@ -0,0 +1,175 @@
+﻿// BinaryReply.cs — 클라이언트 회신용 바이너리 판정 응답 ('CNRP' v1)
+// -------------------------------------------------------------------------------------------------
+// 요청 헤더(CNHD v2 이상)의 replyFormat 이 1 이면 JSON 대신 이 형식으로 회신한다.
+// 레이아웃은 클라이언트 ReplyParser.h 의 BinaryReply 와 같다 (다중 바이트 필드 Big-Endian).
+// 사유/시각 문자열은 클라이언트가 JSON 응답과 같은 모양으로 다시 조립하므로
+// 여기서는 결과 enum, 검출(라벨 ID / 신뢰도 / 박스), 서버 측 시간만 싣는다.
+// TOP/SIDE 결과가 enum 에 없는 문자열이면 Build 가 null → 호출 쪽이 JSON 으로 회신 (사유 문자열이 같게).
+// -------------------------------------------------------------------------------------------------
+
+using System;                                       // DateTime
+using System.Collections.Generic;                   // List<T>
+using Newtonsoft.Json.Linq;                         // JObject/JArray
+
+namespace MFCServer1
+{
+    public static class BinaryReply
+    {
+        public const byte ReplyFormatBinary = 1;                                      // 요청 헤더 값
+        private const uint Magic = 0x434E5250;                                        // 'CNRP'
+        private const byte Version = 1;                                               // 형식 버전
+        private const int HeaderSize = 32;                                            // 고정부
+        private const int DetectionSize = 12;                                         // 검출 1개
+        public const int MaxDetectionsPerView = 16;                                   // 클라 용량 (DetectionList) 과 동일
+
+        public enum Verdict : byte { Normal = 0, Defect = 1, Error = 2 }
+        private enum ViewVerdict : byte { Normal = 0, Abnormal = 1, None = 2, Error = 3 }
+        public enum ReasonCode : byte { Combined = 0, BadImage = 1, NoAiReply = 2, NoCan = 3, AiParseFailed = 4, NoTop = 5, BadRole = 6 }
+
+        // 라벨 ID = datasets/can_defect/data.yaml 클래스 순서 (표시 이름 / 클래스 이름 둘 다 인식)
+        private static readonly string[] LabelNames = { "상단찌그러짐", "뚜껑없음", "측면찌그러짐", "스크래치", "정상(상단)", "정상(측면)" };
+        private static readonly string[] ClassNames = { "top_dent", "top_no_tap", "side_dent", "side_foreign", "top_normal", "side_normal" };
+        private const byte UnknownLabel = 0xFF;
+
+        // ===== TOP 저장 응답 =====
+        public static byte[] TopAck(long serverUs)
+        {
+            byte[] buf = new byte[HeaderSize];                                        // 검출 없음
+            WriteHeader(buf, 1, Verdict.Normal, ViewVerdict.None, ViewVerdict.None,
+                ReasonCode.Combined, serverUs, 0, 0, 0, 0);                            // kind = 1
+            return buf;
+        }
+
+        // ===== 판정 응답 =====
+        // finalResult/defectReason 은 JSON 회신과 같은 값, parsed 는 AI 응답 (없으면 null)
+        // TOP/SIDE 결과를 enum 으로 못 나타내면 null (JSON 으로 회신)
+        public static byte[] Build(string finalResult, string defectReason, JObject parsed,
+                                   long serverUs, long aiUs, DateTime? time)
+        {
+            ViewVerdict? topResult = ViewVerdictOf(parsed?.Value<string>("top_result"));
+            ViewVerdict? sideResult = ViewVerdictOf(parsed?.Value<string>("side_result"));
+            if (topResult == null || sideResult == null) return null;                 // 모르는 결과 문자열
+
+            JArray detTop = CapDetections(parsed?["det_top"] as JArray);              // TOP 검출 (상위 16)
+            JArray detSide = CapDetections(parsed?["det_side"] as JArray);            // SIDE 검출
+            int topCount = detTop?.Count ?? 0;
+            int sideCount = detSide?.Count ?? 0;
+
+            byte[] buf = new byte[HeaderSize + (topCount + sideCount) * DetectionSize];
+            long unixMs = time.HasValue ? new DateTimeOffset(time.Value).ToUnixTimeMilliseconds() : 0;
+
+            WriteHeader(buf, 0, VerdictOf(finalResult), topResult.Value, sideResult.Value,
+                ReasonCodeOf(defectReason), serverUs, aiUs, unixMs, topCount, sideCount);
+
+            int off = HeaderSize;                                                     // 검출 시작
+            for (int i = 0; i < topCount; i++, off += DetectionSize) WriteDetection(buf, off, detTop[i]);
+            for (int i = 0; i < sideCount; i++, off += DetectionSize) WriteDetection(buf, off, detSide[i]);
+            return buf;
+        }
+
+        private static void WriteHeader(byte[] b, byte kind, Verdict result, ViewVerdict top, ViewVerdict side,
+                                        ReasonCode reason, long serverUs, long aiUs, long unixMs,
+                                        int topCount, int sideCount)
+        {
+            PutU32(b, 0, Magic);                                                      // 매직
+            b[4] = Version;                                                           // 버전
+            b[5] = kind;                                                              // 0 판정 / 1 TOP 저장
+            PutU16(b, 6, b.Length);                                                   // 전체 크기
+            b[8] = (byte)result;
+            b[9] = (byte)top;
+            b[10] = (byte)side;
+            b[11] = (byte)reason;
+            PutU32(b, 12, (uint)Math.Min(Math.Max(serverUs, 0), uint.MaxValue));      // 서버 처리
+            PutU32(b, 16, (uint)Math.Min(Math.Max(aiUs, 0), uint.MaxValue));          // AI 왕복
+            PutU32(b, 20, (uint)((ulong)unixMs >> 32));                               // 시각 (상위)
+            PutU32(b, 24, (uint)unixMs);                                              // 시각 (하위)
+            b[28] = (byte)topCount;
+            b[29] = (byte)sideCount;
+        }
+
+        // [label, score, (x, y, w, h)] → 12바이트
+        private static void WriteDetection(byte[] b, int off, JToken item)
+        {
+            string label = item?[0]?.ToString() ?? "";                                // 라벨
+            double score = 0;
+            try { score = item?[1]?.Value<double>() ?? 0; } catch { }                 // 신뢰도
+            b[off] = LabelId(label);
+            PutU16(b, off + 2, (int)Math.Round(Math.Min(Math.Max(score, 0), 6.5535) * 10000));
+            for (int k = 0; k < 4; k++)                                               // 박스 (있으면)
+            {
+                int v = 0;
+                try { v = item?[2 + k]?.Value<int>() ?? 0; } catch { }
+                PutU16(b, off + 4 + k * 2, Math.Min(Math.Max(v, 0), 0xFFFF));
+            }
+        }
+
+        private static byte LabelId(string label)
+        {
+            for (int i = 0; i < LabelNames.Length; i++)
+                if (label == LabelNames[i] || label == ClassNames[i]) return (byte)i;
+            return UnknownLabel;                                                      // 모르는 라벨
+        }
+
+        private static Verdict VerdictOf(string finalResult)
+        {
+            if (finalResult == "정상") return Verdict.Normal;
+            if (finalResult == "불량") return Verdict.Defect;
+            return Verdict.Error;
+        }
+
+        // ===== 검출 개수 제한 (JSON / 바이너리 회신 공용) =====
+        // 신뢰도 높은 순 MaxDetectionsPerView 개. 클라는 그 이상 버리고, 긴 JSON 은 응답만 키운다.
+        public static JArray CapDetections(JArray arr)
+        {
+            if (arr == null || arr.Count <= MaxDetectionsPerView) return arr;       // 그대로
+            var items = new List<JToken>(arr);
+            items.Sort((a, b) => ScoreOf(b).CompareTo(ScoreOf(a)));                   // 신뢰도 내림차순
+            return new JArray(items.GetRange(0, MaxDetectionsPerView));
+        }
+
+        private static double ScoreOf(JToken det)
+        {
+            return (det is JArray a && a.Count > 1 && (a[1].Type == JTokenType.Float || a[1].Type == JTokenType.Integer))
+                ? a[1].Value<double>() : 0.0;                                          // [label, score, ...]
+        }
+
+        // 클라는 JSON 사유와 같게 조립: 정상 / 비정상(라벨) / 에러 / 빈 문자열. 그 밖의 문자열은 null.
+        private static ViewVerdict? ViewVerdictOf(string res)
+        {
+            if (string.IsNullOrEmpty(res)) return ViewVerdict.None;                   // 없음
+            if (res == "정상") return ViewVerdict.Normal;
+            if (res == "비정상") return ViewVerdict.Abnormal;
+            if (res == "에러") return ViewVerdict.Error;
+            return null;                                                              // 표현 불가
+        }
+
+        // 고정 사유 문자열 → 코드 (나머지는 TOP/SIDE 결과로 클라가 조립)
+        private static ReasonCode ReasonCodeOf(string reason)
+        {
+            switch (reason)
+            {
+                case "bad image": return ReasonCode.BadImage;
+                case "AI응답없음": return ReasonCode.NoAiReply;
+                case "캔인식실패": return ReasonCode.NoCan;
+                case "AI응답파싱실패": return ReasonCode.AiParseFailed;
+                case "TOP없음": return ReasonCode.NoTop;
+                case "역할오류": return ReasonCode.BadRole;
+                default: return ReasonCode.Combined;
+            }
+        }
+
+        private static void PutU16(byte[] b, int off, int v)
+        {
+            b[off] = (byte)(v >> 8);
+            b[off + 1] = (byte)v;
+        }
+
+        private static void PutU32(byte[] b, int off, uint v)
+        {
+            b[off] = (byte)(v >> 24);
+            b[off + 1] = (byte)(v >> 16);
+            b[off + 2] = (byte)(v >> 8);
+            b[off + 3] = (byte)v;
+        }
+    }
+}
@@ -0,0 +1,186 @@
+﻿// ImageCodecs.cs — 클라이언트 전송 코덱(QOI / Raw BGR) 정규화
+// -------------------------------------------------------------------------------------------------
+// 클라이언트(ImageEncoder.h)는 링크 상황에 따라 PNG / QOI / Raw BGR / JPEG 중 하나로 보낸다.
+// Python(cv2.imdecode)과 UI(Image.FromStream)는 QOI/Raw 를 못 읽으므로
+// 수신 직후 BMP(무압축, 디코딩 비용 거의 없음)로 바꿔서 이후 흐름은 그대로 둔다.
+// PNG/JPEG 는 손대지 않고 확장자만 실제 포맷에 맞춘다.
+// -------------------------------------------------------------------------------------------------
+
+using System;                                       // 기본 타입
+using System.IO;                                    // InvalidDataException
+
+namespace MFCServer1
+{
+    public static class ImageCodecs
+    {
+        private const int MaxDimension = 16384;                                       // 이상치 방어 (클라와 동일)
+
+        // ===== 수신 바이트 → (Python/UI 가 읽을 수 있는 바이트, 확장자) =====
+        public static byte[] Normalize(byte[] data, out string ext)
+        {
+            if (HasMagic(data, "qoif"))                                               // QOI
+            {
+                int w, h;
+                byte[] bgr = DecodeQoi(data, out w, out h);                           // 디코딩
+                ext = ".bmp";                                                         // BMP 로 저장
+                return EncodeBmp(bgr, w, h);                                          // 변환
+            }
+            if (HasMagic(data, "BGR8"))                                               // Raw BGR
+            {
+                int w, h;
+                byte[] bgr = DecodeRawBgr(data, out w, out h);                        // 헤더 제거
+                ext = ".bmp";                                                         // BMP 로 저장
+                return EncodeBmp(bgr, w, h);                                          // 변환
+            }
+
+            ext = DetectExtension(data);                                              // PNG/JPEG 그대로
+            return data;                                                              // 원본
+        }
+
+        // ===== 매직으로 확장자 판별 =====
+        public static string DetectExtension(byte[] data)
+        {
+            if (data.Length >= 8 && data[0] == 0x89 && data[1] == 0x50 && data[2] == 0x4E && data[3] == 0x47)
+                return ".png";                                                        // \x89PNG
+            if (data.Length >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+                return ".jpg";                                                        // SOI
+            if (data.Length >= 2 && data[0] == (byte)'B' && data[1] == (byte)'M')
+                return ".bmp";                                                        // BM
+            return ".jpg";                                                            // 알 수 없음 → 기존 동작
+        }
+
+        private static bool HasMagic(byte[] b, string magic)
+        {
+            if (b.Length < magic.Length) return false;                                // 짧음
+            for (int i = 0; i < magic.Length; i++)
+                if (b[i] != (byte)magic[i]) return false;                             // 불일치
+            return true;                                                              // 일치
+        }
+
+        private static int BeI32(byte[] b, int off)
+        {
+            return (b[off] << 24) | (b[off + 1] << 16) | (b[off + 2] << 8) | b[off + 3]; // BE
+        }
+
+        private static void CheckSize(int w, int h)
+        {
+            if (w <= 0 || h <= 0 || w > MaxDimension || h > MaxDimension)
+                throw new InvalidDataException($"bad image size {w}x{h}");             // 손상
+        }
+
+        // ===== Raw: ['BGR8'][w BE][h BE][w*h*3] =====
+        private static byte[] DecodeRawBgr(byte[] data, out int w, out int h)
+        {
+            if (data.Length < 12) throw new InvalidDataException("raw header");      // 짧음
+            w = BeI32(data, 4);                                                       // 폭
+            h = BeI32(data, 8);                                                       // 높이
+            CheckSize(w, h);                                                          // 검사
+
+            int bytes = w * h * 3;                                                    // 본문 크기
+            if (data.Length - 12 < bytes) throw new InvalidDataException("raw body"); // 잘림
+
+            byte[] bgr = new byte[bytes];                                             // 버퍼
+            Buffer.BlockCopy(data, 12, bgr, 0, bytes);                                // 복사
+            return bgr;                                                               // 반환
+        }
+
+        // ===== QOI (https://qoiformat.org) → BGR =====
+        private static byte[] DecodeQoi(byte[] data, out int w, out int h)
+        {
+            if (data.Length < 14 + 8) throw new InvalidDataException("qoi header");  // 짧음
+            w = BeI32(data, 4);                                                       // 폭
+            h = BeI32(data, 8);                                                       // 높이
+            CheckSize(w, h);                                                          // 검사
+
+            byte[] bgr = new byte[w * h * 3];                                         // 출력
+            byte[] index = new byte[64 * 4];                                          // RGBA 해시 테이블
+            byte r = 0, g = 0, b = 0, a = 255;                                        // 이전 픽셀
+            int run = 0;                                                              // 반복 수
+            int p = 14;                                                               // 읽기 위치
+            int end = data.Length - 8;                                                // 패딩 제외
+
+            for (int o = 0; o < bgr.Length; o += 3)
+            {
+                if (run > 0)
+                {
+                    run--;                                                            // 이전 픽셀 반복
+                }
+                else
+                {
+                    if (p >= end) throw new InvalidDataException("qoi truncated");   // 잘림
+                    int b1 = data[p++];                                               // 태그
+
+                    if (b1 == 0xFE)                                                   // RGB
+                    {
+                        if (end - p < 3) throw new InvalidDataException("qoi rgb");
+                        r = data[p]; g = data[p + 1]; b = data[p + 2]; p += 3;
+                    }
+                    else if (b1 == 0xFF)                                              // RGBA
+                    {
+                        if (end - p < 4) throw new InvalidDataException("qoi rgba");
+                        r = data[p]; g = data[p + 1]; b = data[p + 2]; a = data[p + 3]; p += 4;
+                    }
+                    else if ((b1 & 0xC0) == 0x00)                                     // INDEX
+                    {
+                        int i = b1 * 4;
+                        r = index[i]; g = index[i + 1]; b = index[i + 2]; a = index[i + 3];
+                    }
+                    else if ((b1 & 0xC0) == 0x40)                                     // DIFF
+                    {
+                        r = (byte)(r + ((b1 >> 4) & 3) - 2);
+                        g = (byte)(g + ((b1 >> 2) & 3) - 2);
+                        b = (byte)(b + (b1 & 3) - 2);
+                    }
+                    else if ((b1 & 0xC0) == 0x80)                                     // LUMA
+                    {
+                        if (p >= end) throw new InvalidDataException("qoi luma");
+                        int b2 = data[p++];
+                        int vg = (b1 & 0x3F) - 32;
+                        r = (byte)(r + vg - 8 + ((b2 >> 4) & 0x0F));
+                        g = (byte)(g + vg);
+                        b = (byte)(b + vg - 8 + (b2 & 0x0F));
+                    }
+                    else                                                              // RUN
+                    {
+                        run = b1 & 0x3F;
+                    }
+
+                    int hsh = ((r * 3 + g * 5 + b * 7 + a * 11) & 63) * 4;            // 해시
+                    index[hsh] = r; index[hsh + 1] = g; index[hsh + 2] = b; index[hsh + 3] = a;
+                }
+
+                bgr[o] = b; bgr[o + 1] = g; bgr[o + 2] = r;                           // BGR 순서
+            }
+            return bgr;                                                               // 반환
+        }
+
+        // ===== BGR → 24비트 BMP (bottom-up, 행 4바이트 정렬) =====
+        private static byte[] EncodeBmp(byte[] bgr, int w, int h)
+        {
+            int rowBytes = w * 3;                                                     // 실제 행
+            int stride = (rowBytes + 3) & ~3;                                         // 정렬 행
+            int imageSize = stride * h;                                               // 픽셀 영역
+            byte[] bmp = new byte[54 + imageSize];                                    // 헤더 54바이트
+
+            bmp[0] = (byte)'B'; bmp[1] = (byte)'M';                                   // 시그니처
+            PutLeI32(bmp, 2, bmp.Length);                                             // 파일 크기
+            PutLeI32(bmp, 10, 54);                                                    // 픽셀 오프셋
+            PutLeI32(bmp, 14, 40);                                                    // BITMAPINFOHEADER
+            PutLeI32(bmp, 18, w);                                                     // 폭
+            PutLeI32(bmp, 22, h);                                                     // 높이 (양수 = bottom-up)
+            bmp[26] = 1;                                                              // planes
+            bmp[28] = 24;                                                             // bpp
+            PutLeI32(bmp, 34, imageSize);                                             // 이미지 크기
+
+            for (int y = 0; y < h; y++)
+                Buffer.BlockCopy(bgr, y * rowBytes, bmp, 54 + (h - 1 - y) * stride, rowBytes); // 뒤집어 복사
+
+            return bmp;                                                               // 반환
+        }
+
+        private static void PutLeI32(byte[] b, int off, int v)
+        {
+            b[off] = (byte)v; b[off + 1] = (byte)(v >> 8); b[off + 2] = (byte)(v >> 16); b[off + 3] = (byte)(v >> 24); // LE
+        }
+    }
+}
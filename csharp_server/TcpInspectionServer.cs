@@ -14,6 +14,7 @@ using System.Text;                                  // Encoding
 using System.Threading;                             // CancellationTokenSource
 using System.Threading.Tasks;                       // Task/async
 using System.Collections.Generic;                   // List<T>
+using System.Diagnostics;                           // Stopwatch
 using Newtonsoft.Json.Linq;                         // JObject/JArray
 using MFCServer1;                                   // DatabaseService, ServerMonitor 네임스페이스
 
@@ -31,8 +32,32 @@ namespace MFCServer1                                 // 네임스페이스 통
         private CancellationTokenSource _cts;       // 취소 토큰
 
         // ===== 듀얼 페어 상태 (TOP 먼저, 그 다음 SIDE) =====
-        private static string _pendingTopPath = null;   // 직전 TOP 경로
-        private static byte[] _pendingTopBytes = null;  // 직전 TOP 바이트
+        // 헤더 v3: (제품번호, 단위 번호) 키로 짝 → 여러 라인/연결이 섞여도 엇갈리지 않음
+        // 헤더 없음/v2 이하: 기존처럼 도착 순서 (직전 TOP 하나)
+        // 키 TOP 은 받은 순서로 줄 세워 가장 오래된 것부터 버림 (SIDE 가 안 온 TOP 이 이미지째 쌓이지 않게)
+        private class PendingTop
+        {
+            public string Path;                                                      // TOP 경로
+            public byte[] Bytes;                                                     // TOP 바이트
+            public DateTime ReceivedAt;                                              // 받은 시각 (만료)
+            public LinkedListNode<string> Order;                                     // _pendingOrder 위치
+        }
+        private static readonly object _pairLock = new object();                      // 세션은 Task.Run 으로 동시
+        private static readonly Dictionary<string, PendingTop> _pendingByKey = new Dictionary<string, PendingTop>();
+        private static readonly LinkedList<string> _pendingOrder = new LinkedList<string>(); // 오래된 키가 앞
+        private const int MaxPendingTops = 64;                                        // 라인 수 x 클라 대기열 동시 전송(4) 보다 넉넉히
+        private static readonly TimeSpan PendingTopTtl = TimeSpan.FromSeconds(30);    // 클라 재전송 간격(최대 10초) + 여유
+        private static string _pendingTopPath = null;   // 직전 TOP 경로 (도착 순서)
+        private static byte[] _pendingTopBytes = null;  // 직전 TOP 바이트 (도착 순서)
+
+        // ===== 클라이언트 상태 확인 ('CNHC') =====
+        // 클라이언트 서버 풀이 주기적으로 보냄 → 파이썬 0x01 헬스체크 결과 + 부하를 JSON 한 줄로 회신
+        private const uint HealthCheckMagic = 0x434E4843;                             // 'CNHC'
+        private const int PythonHealthTimeoutMs = 300;                                // 파이썬 확인 기한
+        private const int PythonHealthCacheMs = 1000;                                 // 여러 클라이언트가 물어도 1초에 한 번
+        private static int _activeSessions = 0;                                       // 처리 중 세션 (Interlocked)
+        private static readonly SemaphoreSlim _pythonHealthLock = new SemaphoreSlim(1, 1);
+        private static DateTime _pythonCheckedAt = DateTime.MinValue;                 // 마지막 파이썬 확인
 
         // ===== 생성자 =====
         public TcpInspectionServer(int listenPort, string pythonHost, int pythonPort)
@@ -89,6 +114,7 @@ namespace MFCServer1                                 // 네임스페이스 통
         {
             using (client)                                                    // using 보장
             {
+                Interlocked.Increment(ref _activeSessions);                   // 부하 (상태 확인 회신용)
                 try
                 {
                     using (NetworkStream ns = client.GetStream())             // 스트림
@@ -98,6 +124,25 @@ namespace MFCServer1                                 // 네임스페이스 통
                         int gotLen = await ReadExactAsync(ns, lenBuf, 0, 4);  // 정확 수신
                         if (gotLen < 4) return;                               // 끊김
 
+                        // (1-0) 상태 확인('CNHC') → JSON 한 줄 회신 후 종료
+                        if (BeU32(lenBuf, 0) == HealthCheckMagic)
+                        {
+                            await WriteUtf8Async(ns, await BuildHealthReplyAsync()); // 회신
+                            return;
+                        }
+
+                        // (1-1) 선택 요청 헤더('CNHD') → 크롭 기하 정보 읽고 실제 길이 재수신
+                        RequestHeaderInfo header = null;                      // 헤더 (없으면 null)
+                        if (IsRequestHeaderMagic(lenBuf))                     // 매직이면 헤더
+                        {
+                            header = await ReadRequestHeaderAsync(ns);        // 나머지 헤더 수신
+                            if (header == null) return;                       // 손상/끊김
+                            Console.WriteLine("[HDR] " + header);             // 로그
+
+                            gotLen = await ReadExactAsync(ns, lenBuf, 0, 4);  // 실제 길이
+                            if (gotLen < 4) return;                           // 끊김
+                        }
+
                         // Big-Endian → int
                         int imgSize = (lenBuf[0] << 24) | (lenBuf[1] << 16) | (lenBuf[2] << 8) | lenBuf[3]; // 길이
                         if (imgSize <= 0 || imgSize > 100_000_000) return;    // 이상치 방어
@@ -106,43 +151,121 @@ namespace MFCServer1                                 // 네임스페이스 통
                         byte[] imgBytes = new byte[imgSize];                  // 버퍼
                         int got = await ReadExactAsync(ns, imgBytes, 0, imgSize); // 수신
                         if (got < imgSize) return;                             // 끊김
+                        Stopwatch serverTime = Stopwatch.StartNew();           // 수신 완료 → 회신
+                        bool binaryReply = header != null &&
+                            header.ReplyFormat == BinaryReply.ReplyFormatBinary; // 바이너리 회신 요청
+
+                        // (2-1) 전송 코덱 정규화: QOI/Raw → BMP, PNG/JPEG 는 그대로 (확장자만 판별)
+                        string imgExt;                                         // 저장 확장자
+                        try
+                        {
+                            imgBytes = ImageCodecs.Normalize(imgBytes, out imgExt); // 변환
+                        }
+                        catch (InvalidDataException ex)
+                        {
+                            Console.WriteLine("[RECV] 이미지 디코딩 실패: " + ex.Message); // 로그
+                            if (binaryReply)
+                                await WriteBytesAsync(ns, BinaryReply.Build("에러", "bad image", null,
+                                    ElapsedUs(serverTime), 0, null));                   // 바이너리 회신
+                            else
+                                await WriteUtf8Async(ns, "{\"result\":\"에러\",\"reason\":\"bad image\"}"); // 회신
+                            return;                                            // 폐기
+                        }
 
                         // (3) 파일 저장
                         string dateDir = DateTime.Now.ToString("yyyyMMdd");   // 날짜 폴더
                         string saveDir = Path.Combine(@"C:\captures", dateDir); // 저장 루트
                         Directory.CreateDirectory(saveDir);                   // 폴더 보장
 
-                        bool firstShot = (_pendingTopPath == null);           // TOP 여부
+                        // 역할: v3 헤더가 있으면 헤더 값, 없으면 도착 순서로 추측
+                        bool byHeader = header != null && header.HasRole;     // 헤더 역할 사용
+                        bool firstShot;                                        // TOP 여부
+                        if (byHeader)
+                        {
+                            if (header.Role != RequestHeaderInfo.RoleTop && header.Role != RequestHeaderInfo.RoleSide)
+                            {
+                                Console.WriteLine("[RECV] 지원하지 않는 역할: " + header.Role); // 로그
+                                await WriteErrorAsync(ns, binaryReply, "역할오류", serverTime); // 회신
+                                return;                                        // 폐기
+                            }
+                            firstShot = header.Role == RequestHeaderInfo.RoleTop; // 헤더 역할
+                        }
+                        else
+                        {
+                            lock (_pairLock) firstShot = (_pendingTopPath == null); // 도착 순서
+                        }
                         string role = firstShot ? "TOP" : "SIDE";             // 접두사
                         string ts = DateTime.Now.ToString("yyyyMMdd_HHmmss_fff"); // 타임스탬프
-                        string outPath = Path.Combine(saveDir, $"{role}_{ts}.jpg"); // 경로
+                        string idPart = byHeader && header.ProductId.Length > 0 ? header.ProductId + "_" : ""; // 제품번호
+                        string outPath = Path.Combine(saveDir, $"{role}_{idPart}{ts}{imgExt}"); // 경로
                         File.WriteAllBytes(outPath, imgBytes);                // 저장
 
                         Console.WriteLine($"[RECV] {role} saved: {outPath}"); // 로그
 
-                        // (4) 페어링: 첫 장이면 TOP 기억 후 종료
+                        // (4) 페어링: TOP 이면 기억 후 종료
                         if (firstShot)
                         {
-                            _pendingTopPath = outPath;                        // 경로 보관
-                            _pendingTopBytes = imgBytes;                      // 바이트 보관
-                            await WriteUtf8Async(ns, "{\"ok\":true,\"msg\":\"TOP saved\"}"); // 회신
+                            lock (_pairLock)
+                            {
+                                if (byHeader)
+                                {
+                                    RememberTop(header.PairKey, outPath, imgBytes); // 키로 보관
+                                }
+                                else
+                                {
+                                    _pendingTopPath = outPath;                // 경로 보관
+                                    _pendingTopBytes = imgBytes;              // 바이트 보관
+                                }
+                            }
+                            if (binaryReply)
+                                await WriteBytesAsync(ns, BinaryReply.TopAck(ElapsedUs(serverTime))); // 바이너리 회신
+                            else
+                                await WriteUtf8Async(ns, "{\"ok\":true,\"msg\":\"TOP saved\"}"); // 회신
                             return;                                           // 종료(SIDE 대기)
                         }
 
-                        // 여기 도착 = 방금 받은 건 SIDE
+                        // 여기 도착 = 방금 받은 건 SIDE → 짝 TOP 꺼내기
                         string sidePath = outPath;                             // SIDE 경로
+                        string topPath;                                        // TOP 경로
+                        byte[] topBytes;                                       // TOP 바이트
+                        lock (_pairLock)
+                        {
+                            if (byHeader)
+                            {
+                                PendingTop top = TakeTop(header.PairKey);      // 같은 키 TOP (소비)
+                                topPath = top?.Path;                           // 없으면 null
+                                topBytes = top?.Bytes;
+                            }
+                            else
+                            {
+                                topPath = _pendingTopPath;                     // 직전 TOP
+                                topBytes = _pendingTopBytes;
+                                _pendingTopPath = null;                        // 페어 초기화
+                                _pendingTopBytes = null;
+                            }
+                        }
+                        if (topPath == null)
+                        {
+                            Console.WriteLine("[RECV] 짝 TOP 없음: " + (byHeader ? header.PairKey : "")); // 로그
+                            await WriteErrorAsync(ns, binaryReply, "TOP없음", serverTime); // 회신
+                            return;                                            // 폐기
+                        }
 
                         // (5) 파이썬 듀얼 분석 호출
                         string aiJson = "";                                    // 응답 JSON
+                        Stopwatch aiTime = Stopwatch.StartNew();               // AI 왕복
                         try
                         {
-                            aiJson = await CallPythonDualAsync(_pendingTopBytes, imgBytes); // 호출
+                            bool sideEnhanced = header != null &&
+                                (header.Flags & RequestHeaderInfo.FlagSideEnhanced) != 0; // 클라이언트 측면 전처리
+                            aiJson = await CallPythonDualAsync(topBytes, imgBytes, sideEnhanced); // 호출
                         }
                         catch (Exception ex)
                         {
                             Console.WriteLine("[AI] call FAIL: " + ex.Message); // 로그
                             aiJson = "";                                        // 빈 응답
                         }
+                        aiTime.Stop();                                         // 측정 끝
 
                         // (6) AI 응답 해석 → 최종 결과/사유
                         string finalResult = "에러";                            // 기본값
@@ -195,7 +318,7 @@ namespace MFCServer1                                 // 네임스페이스 통
                                 DateTime.Now,                                        // 시간
                                 finalResult,                                         // 결과
                                 defectReason,                                        // 요약
-                                _pendingTopPath,                                     // TOP
+                                topPath,                                             // TOP
                                 sidePath                                             // SIDE
                             );
                             Console.WriteLine("[DB] inspection id=" + newId);         // 로그
@@ -232,39 +355,132 @@ namespace MFCServer1                                 // 네임스페이스 통
                             DateTime.Now,                                            // 시간
                             finalResult,                                             // 결과
                             defectReason,                                            // 사유
-                            _pendingTopPath,                                         // TOP
+                            topPath,                                                 // TOP
                             sidePath                                                 // SIDE
                         );
 
-                        // (10) 클라이언트 회신(JSON 요약)
-                        string reply =
-                            "{\"result\":\"" + finalResult +
-                            "\",\"reason\":\"" + defectReason.Replace("\"", "'") +
-                            "\",\"timestamp\":\"" + DateTime.Now.ToString("yyyy-MM-dd HH:mm:ss") +
-                            "\"}";
-                        await WriteUtf8Async(ns, reply);                              // 전송
-
-                        // (11) 페어 초기화
-                        _pendingTopPath = null;                                      // 리셋
-                        _pendingTopBytes = null;                                     // 리셋
+                        // (10) 클라이언트 회신 (요청 헤더가 원하면 바이너리, 아니면 JSON 요약)
+                        //      결과 문자열을 바이너리로 못 나타내면 JSON (클라는 둘 다 받음)
+                        byte[] binary = binaryReply
+                            ? BinaryReply.Build(finalResult, defectReason, parsed,
+                                ElapsedUs(serverTime), ElapsedUs(aiTime), DateTime.Now) : null;
+                        if (binary != null)
+                        {
+                            await WriteBytesAsync(ns, binary);                        // 전송
+                        }
+                        else
+                        {
+                            string reply =
+                                "{\"result\":\"" + finalResult +
+                                "\",\"reason\":\"" + defectReason.Replace("\"", "'") +
+                                "\",\"timestamp\":\"" + DateTime.Now.ToString("yyyy-MM-dd HH:mm:ss") +
+                                "\"" + DetectionsJson(parsed) + "}";
+                            await WriteUtf8Async(ns, reply);                          // 전송
+                        }
                     }
                 }
                 catch (Exception ex)
                 {
                     Console.WriteLine("[SESSION-ERR] " + ex.Message);                 // 세션 예외
                 }
+                finally
+                {
+                    Interlocked.Decrement(ref _activeSessions);                       // 부하
+                }
             }
         }
 
-        // ===== 파이썬 듀얼 호출 (모드 0x02 / 길이는 Little-Endian) =====
-        private async Task<string> CallPythonDualAsync(byte[] topBytes, byte[] sideBytes)
+        // ===== 키 TOP 보관/소비 (_pairLock 안에서만 호출) =====
+        private static void RememberTop(string key, string path, byte[] bytes)
+        {
+            DateTime now = DateTime.UtcNow;                                          // 기준 시각
+            TakeTop(key);                                                            // 같은 키 재전송 → 새 것으로
+            while (_pendingOrder.First != null &&
+                   (_pendingOrder.Count >= MaxPendingTops ||
+                    now - _pendingByKey[_pendingOrder.First.Value].ReceivedAt > PendingTopTtl))
+            {
+                Console.WriteLine("[RECV] SIDE 안 온 TOP 버림: " + _pendingOrder.First.Value); // 로그
+                TakeTop(_pendingOrder.First.Value);                                  // 가장 오래된 것
+            }
+            var top = new PendingTop { Path = path, Bytes = bytes, ReceivedAt = now };
+            top.Order = _pendingOrder.AddLast(key);                                  // 맨 뒤 = 최신
+            _pendingByKey[key] = top;
+        }
+
+        private static PendingTop TakeTop(string key)
+        {
+            PendingTop top;
+            if (!_pendingByKey.TryGetValue(key, out top)) return null;               // 없음
+            _pendingByKey.Remove(key);                                               // 소비
+            _pendingOrder.Remove(top.Order);                                         // 순서에서도
+            return top;
+        }
+
+        // ===== 상태 확인 회신: {"ok":true,"ai":true,"active":N,"pending":M} =====
+        private async Task<string> BuildHealthReplyAsync()
+        {
+            bool ai = await CheckPythonHealthAsync();                                // 파이썬 (캐시)
+            int active = Math.Max(Volatile.Read(ref _activeSessions) - 1, 0);         // 이 확인 제외
+            int pending;
+            lock (_pairLock) pending = _pendingByKey.Count + (_pendingTopBytes != null ? 1 : 0); // SIDE 대기 TOP
+            return "{\"ok\":true,\"ai\":" + (ai ? "true" : "false") +
+                   ",\"active\":" + active + ",\"pending\":" + pending + "}";
+        }
+
+        // ===== 파이썬 헬스체크 (모드 0x01 → "OK") =====
+        // 결과는 ServerMonitor.PythonAlive 에도 반영 (UI). 1초 안에 다시 물으면 직전 결과.
+        private async Task<bool> CheckPythonHealthAsync()
+        {
+            await _pythonHealthLock.WaitAsync();                                     // 동시 확인 1개
+            try
+            {
+                if ((DateTime.UtcNow - _pythonCheckedAt).TotalMilliseconds < PythonHealthCacheMs)
+                    return ServerMonitor.PythonAlive;                                // 캐시
+
+                bool ok = false;
+                try
+                {
+                    using (var cli = new TcpClient())                                // 클라
+                    {
+                        Task<bool> work = Task.Run(async () =>
+                        {
+                            await cli.ConnectAsync(_pythonHost, _pythonPort);        // 연결
+                            NetworkStream ns = cli.GetStream();                      // 스트림
+                            await ns.WriteAsync(new byte[] { 0x01 }, 0, 1);          // 모드
+                            byte[] buf = new byte[2];
+                            return await ReadExactAsync(ns, buf, 0, 2) == 2 && buf[0] == (byte)'O' && buf[1] == (byte)'K';
+                        });
+                        if (await Task.WhenAny(work, Task.Delay(PythonHealthTimeoutMs)) == work)
+                            ok = await work;                                         // 예외 전파
+                        // 기한 초과면 false (using 이 소켓을 닫아 남은 작업도 끝남)
+                    }
+                    ServerMonitor.PythonLastErrorMessage = ok ? "" : "health check failed";
+                }
+                catch (Exception ex)
+                {
+                    ok = false;
+                    ServerMonitor.PythonLastErrorMessage = ex.Message;               // 연결 실패 등
+                }
+
+                ServerMonitor.PythonAlive = ok;                                      // UI
+                _pythonCheckedAt = DateTime.UtcNow;
+                return ok;
+            }
+            finally
+            {
+                _pythonHealthLock.Release();
+            }
+        }
+
+        // ===== 파이썬 듀얼 호출 (모드 0x02, SIDE 전처리 완료 시 0x04 / 길이는 Little-Endian) =====
+        private async Task<string> CallPythonDualAsync(byte[] topBytes, byte[] sideBytes, bool sideEnhanced)
         {
             using (var cli = new TcpClient())                                        // 클라
             {
                 await cli.ConnectAsync(_pythonHost, _pythonPort);                    // 연결
                 using (NetworkStream ns = cli.GetStream())                           // 스트림
                 {
-                    await ns.WriteAsync(new byte[] { 0x02 }, 0, 1);                  // 모드
+                    await ns.WriteAsync(new byte[] { (byte)(sideEnhanced ? 0x04 : 0x02) }, 0, 1); // 모드
 
                     byte[] lenTop = BitConverter.GetBytes(topBytes.Length);          // TOP 길이
                     if (!BitConverter.IsLittleEndian) Array.Reverse(lenTop);         // LE 보정
@@ -318,6 +534,20 @@ namespace MFCServer1                                 // 네임스페이스 통
             return "TOP: " + topExpr + " · SIDE: " + sideExpr;                        // 조합
         }
 
+        // ===== 검출 목록 전달 (클라 오버레이용) =====
+        // AI 응답의 det_top/det_side ([label, score, x, y, w, h] 배열)를 신뢰도 상위 16개까지 붙인다 (클라 용량). 없으면 빈 문자열.
+        private static string DetectionsJson(JObject jobj)
+        {
+            if (jobj == null) return "";                                              // AI 응답 없음
+            var sb = new StringBuilder();
+            foreach (string key in new[] { "det_top", "det_side" })
+            {
+                if (jobj[key] is JArray arr)                                          // 배열만 (신뢰도 상위 16개)
+                    sb.Append(",\"").Append(key).Append("\":").Append(BinaryReply.CapDetections(arr).ToString(Newtonsoft.Json.Formatting.None));
+            }
+            return sb.ToString();
+        }
+
         // ===== JSON → inspection_result 행 변환 (4열 전용) =====
         private static List<DatabaseService.InspectionResultRow> BuildResultRowsFromParsed(JObject jobj, int newId)
         {
@@ -370,6 +600,125 @@ namespace MFCServer1                                 // 네임스페이스 통
             return rows;                                                              // 반환
         }
 
+        // ===== 요청 헤더 (클라이언트 RequestHeader.h 와 동일, Big-Endian) =====
+        private const uint RequestHeaderMagic = 0x434E4844;                           // 'CNHD'
+        private const int RequestHeaderMinSize = 28;                                  // v1 크기
+        private const int RequestHeaderV2Size = 32;                                   // v2 (replyFormat)
+        private const int RequestHeaderV3Size = 80;                                   // v3 (역할/단위 번호/시각/제품번호)
+        private const int RequestHeaderMaxSize = 1024;                                // 이상치 방어
+
+        private class RequestHeaderInfo
+        {
+            public const int FlagSideEnhanced = 0x02;                                 // 측면 전처리 적용됨
+            public const int RoleTop = 0;                                             // CameraRole (클라 Station.h)
+            public const int RoleSide = 1;                                            // front = 서버 SIDE
+            private static readonly string[] PixelNames =
+                { "?", "Mono8", "BayerRG8", "BayerGR8", "BayerGB8", "BayerBG8", "RGB8", "BGR8" }; // 0 = 모름, 1 + RawFormat
+            private static readonly string[] CodecNames = { "png", "qoi", "raw", "jpeg" }; // ImageCodec
+
+            public int Version;                                                       // 버전
+            public int Flags;                                                         // 0x01 = 레터박스, 0x02 = 측면 전처리
+            public int RoiX, RoiY, RoiW, RoiH;                                        // 센서 좌표 크롭
+            public int ScaledW, ScaledH;                                              // 리사이즈 크기
+            public int PadX, PadY;                                                    // 패딩
+            public int OutW, OutH;                                                    // 모델 입력 크기
+            public int ReplyFormat;                                                   // v2: 0 = JSON, 1 = 바이너리
+
+            // v3 메타데이터 (v2 이하면 HasRole = false)
+            public bool HasRole;                                                      // 역할 있음
+            public int Role;                                                          // 0 top, 1 front(SIDE), 2 bottom, 3 side2
+            public int PixelFormat;                                                   // 카메라 원본 형식
+            public int Codec;                                                         // 본문 코덱
+            public ulong Sequence;                                                    // 검사 단위 번호
+            public long CaptureUs;                                                    // 노출 시각 (Unix µs, 0 = 모름)
+            public ulong CameraTicks;                                                 // 카메라 타임스탬프 원값
+            public uint FrameCounter;                                                 // 0xFFFFFFFF = 없음
+            public string ProductId = "";                                             // 제품번호
+
+            public string PairKey => ProductId + "#" + Sequence;                      // TOP/SIDE 짝 키
+
+            public override string ToString()
+            {
+                string s = $"v{Version} flags=0x{Flags:X2} roi=({RoiX},{RoiY},{RoiW},{RoiH}) " +
+                       $"scaled={ScaledW}x{ScaledH} pad=({PadX},{PadY}) out={OutW}x{OutH} reply={ReplyFormat}"; // 로그용
+                if (!HasRole) return s;                                               // v2 이하
+                string pixel = PixelFormat < PixelNames.Length ? PixelNames[PixelFormat] : "?";
+                string codec = Codec < CodecNames.Length ? CodecNames[Codec] : "?";
+                string capture = CaptureUs > 0
+                    ? DateTimeOffset.FromUnixTimeMilliseconds(CaptureUs / 1000).LocalDateTime.ToString("HH:mm:ss.fff") : "-";
+                return s + $" role={Role} id={ProductId} seq={Sequence} capture={capture} " +
+                       $"frame={(FrameCounter == 0xFFFFFFFF ? "-" : FrameCounter.ToString())} pixel={pixel} codec={codec}";
+            }
+        }
+
+        private static bool IsRequestHeaderMagic(byte[] b)
+        {
+            uint v = ((uint)b[0] << 24) | ((uint)b[1] << 16) | ((uint)b[2] << 8) | b[3]; // BE
+            return v == RequestHeaderMagic;                                          // 비교
+        }
+
+        private static int BeU16(byte[] b, int off)
+        {
+            return (b[off] << 8) | b[off + 1];                                        // BE u16
+        }
+
+        private static uint BeU32(byte[] b, int off)
+        {
+            return ((uint)b[off] << 24) | ((uint)b[off + 1] << 16) | ((uint)b[off + 2] << 8) | b[off + 3]; // BE u32
+        }
+
+        private static ulong BeU64(byte[] b, int off)
+        {
+            return ((ulong)BeU32(b, off) << 32) | BeU32(b, off + 4);                  // BE u64
+        }
+
+        // 매직 뒤 나머지 헤더 수신 (버전이 올라가 길어져도 headerSize 만큼 건너뜀)
+        private static async Task<RequestHeaderInfo> ReadRequestHeaderAsync(NetworkStream ns)
+        {
+            byte[] fixedPart = new byte[4];                                           // ver/flags/size
+            if (await ReadExactAsync(ns, fixedPart, 0, 4) < 4) return null;           // 끊김
+
+            int headerSize = BeU16(fixedPart, 2);                                     // 전체 크기
+            if (headerSize < RequestHeaderMinSize || headerSize > RequestHeaderMaxSize) return null; // 방어
+
+            byte[] full = new byte[headerSize];                                       // 매직 포함 버퍼
+            Array.Copy(fixedPart, 0, full, 4, 4);                                     // 앞부분 복사
+            int rest = headerSize - 8;                                                // 남은 바이트
+            if (await ReadExactAsync(ns, full, 8, rest) < rest) return null;          // 끊김
+
+            var info = new RequestHeaderInfo
+            {
+                Version = full[4],                                                    // 버전
+                Flags = full[5],                                                      // 플래그
+                RoiX = BeU16(full, 8),
+                RoiY = BeU16(full, 10),
+                RoiW = BeU16(full, 12),
+                RoiH = BeU16(full, 14),
+                ScaledW = BeU16(full, 16),
+                ScaledH = BeU16(full, 18),
+                PadX = BeU16(full, 20),
+                PadY = BeU16(full, 22),
+                OutW = BeU16(full, 24),
+                OutH = BeU16(full, 26),
+                ReplyFormat = (full[4] >= 2 && headerSize >= RequestHeaderV2Size) ? full[28] : 0
+            };
+
+            // v3: 역할/단위 번호/시각/제품번호 (역할 0xFF = 없음 → 도착 순서)
+            if (full[4] >= 3 && headerSize >= RequestHeaderV3Size)
+            {
+                info.HasRole = full[29] != 0xFF;                                      // 역할 있음
+                info.Role = full[29];
+                info.PixelFormat = full[30];
+                info.Codec = full[31];
+                info.Sequence = BeU64(full, 32);
+                info.CaptureUs = (long)BeU64(full, 40);
+                info.CameraTicks = BeU64(full, 48);
+                info.FrameCounter = BeU32(full, 56);
+                info.ProductId = Encoding.ASCII.GetString(full, 60, 16).TrimEnd('\0'); // NUL 채움
+            }
+            return info;
+        }
+
         // ===== 정확히 N바이트 읽기 유틸 =====
         private static async Task<int> ReadExactAsync(NetworkStream ns, byte[] buf, int off, int len)
         {
@@ -383,6 +732,26 @@ namespace MFCServer1                                 // 네임스페이스 통
             return total;                                                             // 총 읽은 길이
         }
 
+        // ===== 에러 판정 회신 (짝 없음/역할 오류, 요청 형식에 맞춰) =====
+        private static async Task WriteErrorAsync(NetworkStream ns, bool binaryReply, string reason, Stopwatch serverTime)
+        {
+            if (binaryReply)
+                await WriteBytesAsync(ns, BinaryReply.Build("에러", reason, null, ElapsedUs(serverTime), 0, null)); // 바이너리
+            else
+                await WriteUtf8Async(ns, "{\"result\":\"에러\",\"reason\":\"" + reason + "\"}"); // JSON
+        }
+
+        // ===== 바이너리 쓰기 유틸 =====
+        private static async Task WriteBytesAsync(NetworkStream ns, byte[] data)
+        {
+            await ns.WriteAsync(data, 0, data.Length);                                // 전송
+        }
+
+        private static long ElapsedUs(Stopwatch sw)
+        {
+            return sw.ElapsedTicks * 1_000_000L / Stopwatch.Frequency;                // 마이크로초
+        }
+
         // ===== UTF-8 텍스트 쓰기 유틸 =====
         private static async Task WriteUtf8Async(NetworkStream ns, string s)
         {
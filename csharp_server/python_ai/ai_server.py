@@ -92,6 +92,11 @@ def infer_image(img_bgr, camera_type=None):
         "model_version": f"yolo8-{YOLO_WEIGHTS}",
     }
 
+def det_list(res):
+    """클라이언트 회신용 검출 목록: [label, score, x, y, w, h] (박스는 전송 이미지 좌표)"""
+    return [[b["label"], b["score"], b["x"], b["y"], b["w"], b["h"]] for b in res["bboxes"]]
+
+
 # ======================================
 # TCP 유틸
 # ======================================
@@ -130,15 +135,16 @@ def handle_client(conn: socket.socket, addr):
 
         # --------------------------------
         # 0x02 : Dual 분석 (TOP + SIDE/FRONT)
+        #   (0x04 = 같은 형식, SIDE 는 클라이언트 전처리 완료 — 이 버전은 측면 전처리가 없어 동일 처리)
         # 프로토콜:
-        #   [0x02]
+        #   [0x02 | 0x04]
         #   [4바이트 TOP length  (little-endian)]
         #   [TOP bytes]
         #   [4바이트 SIDE length (little-endian)]
         #   [SIDE bytes]
         # 응답: UTF-8 JSON 문자열 한 번 쏘고 종료
         # --------------------------------
-        if mode == 0x02:
+        if mode in (0x02, 0x04):
             print("[AI] Dual request...")
 
             # TOP
@@ -181,8 +187,8 @@ def handle_client(conn: socket.socket, addr):
                 "result":     "정상" if (res_top["result"] == "normal" and res_side["result"] == "normal") else "비정상",
                 "top_result": "정상" if res_top["result"]  == "normal" else "비정상",
                 "side_result":"정상" if res_side["result"] == "normal" else "비정상",
-                "det_top":  [[c["name"], c["score"]] for c in res_top["classes"]],
-                "det_side": [[c["name"], c["score"]] for c in res_side["classes"]],
+                "det_top":  det_list(res_top),
+                "det_side": det_list(res_side),
             }
 
             payload = json.dumps(final, ensure_ascii=False).encode("utf-8")
@@ -237,7 +243,7 @@ def handle_client(conn: socket.socket, addr):
             final = {
                 "result": "정상" if res["result"] == "normal" else "비정상",
                 ("det_top" if cam_label == "top" else "det_side"):
-                    [[c["name"], c["score"]] for c in res["classes"]]
+                    det_list(res)
             }
 
             payload = json.dumps(final, ensure_ascii=False).encode("utf-8")
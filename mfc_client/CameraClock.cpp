@@ -0,0 +1,90 @@
+﻿#include "CameraClock.h"
+#include "LatencyStats.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+void CCameraClock::AddSample(uint64_t hostBeforeNs, uint64_t cameraTicks, uint64_t hostAfterNs)
+{
+    if (hostAfterNs < hostBeforeNs)
+        return;
+    const uint64_t rtt = hostAfterNs - hostBeforeNs;
+    if (rtt < m_bestRtt) {
+        // 래치는 왕복 사이 어딘가 → 가운데로 가정
+        m_bestRtt = rtt;
+        m_bestHostNs = hostBeforeNs + rtt / 2;
+        m_bestTicks = cameraTicks;
+    }
+}
+
+bool CCameraClock::Commit()
+{
+    if (m_bestRtt == UINT64_MAX)
+        return false;
+
+    const double cameraNs = static_cast<double>(m_bestTicks) * m_nsPerTick;
+    const double offset = static_cast<double>(m_bestHostNs) - cameraNs;
+
+    if (m_calibrated && cameraNs > m_calCameraNs) {
+        // 보정 사이 오프셋 변화 = 두 시계 속도 차. 재부팅/리셋(틱 역행)이나 터무니없는 값은 버림
+        const double drift = (offset - m_offsetNs) / (cameraNs - m_calCameraNs);
+        if (std::fabs(drift) < 500e-6)
+            m_drift = drift;
+    }
+    else
+        m_drift = 0.0;
+
+    m_offsetNs = offset;
+    m_calCameraNs = cameraNs;
+    m_calHostNs = m_bestHostNs;
+    m_uncertaintyNs = m_bestRtt / 2;
+    m_calibrated = true;
+    m_bestRtt = UINT64_MAX;
+    return true;
+}
+
+uint64_t CCameraClock::ToHostNs(uint64_t cameraTicks) const
+{
+    if (!m_calibrated || cameraTicks == 0)
+        return 0;
+    const double cameraNs = static_cast<double>(cameraTicks) * m_nsPerTick;
+    const double host = cameraNs + m_offsetNs + m_drift * (cameraNs - m_calCameraNs);
+    return host > 0.0 ? static_cast<uint64_t>(host) : 0;
+}
+
+int64_t SteadyToUnixUs(uint64_t steadyNs)
+{
+    const int64_t nowUs = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t ageNs = static_cast<int64_t>(NowNs() - steadyNs);
+    return nowUs - ageNs / 1000;
+}
+
+std::string FormatFrameStamp(const FrameStamp& stamp, const CCameraClock* clock)
+{
+    std::string out;
+    char buf[64];
+    auto add = [&out](const char* text) {
+        if (!out.empty()) out += ", ";
+        out += text;
+    };
+    if (stamp.frameCounter >= 0) {
+        std::snprintf(buf, sizeof(buf), "frame %lld", static_cast<long long>(stamp.frameCounter));
+        add(buf);
+    }
+    if (stamp.triggerCounter >= 0) {
+        if (stamp.triggerIgnored >= 0)
+            std::snprintf(buf, sizeof(buf), "trigger %lld (ignored %lld)",
+                static_cast<long long>(stamp.triggerCounter), static_cast<long long>(stamp.triggerIgnored));
+        else
+            std::snprintf(buf, sizeof(buf), "trigger %lld", static_cast<long long>(stamp.triggerCounter));
+        add(buf);
+    }
+    if (clock && clock->Calibrated()) {
+        std::snprintf(buf, sizeof(buf), "clock \xC2\xB1%.2f ms, drift %.1f ppm",
+            clock->UncertaintyNs() / 1e6, clock->DriftPpm());
+        add(buf);
+    }
+    return out;
+}
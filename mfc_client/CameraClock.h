@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <string>
+
+// ===== 프레임 스탬프 (청크 데이터 / 그랩 결과에서) =====
+// 카메라 타임스탬프는 카메라 자체 시계(틱) → CCameraClock 으로 호스트 시계(NowNs)로 옮긴다.
+// 계수기는 카메라가 없으면 -1 (청크 미지원/비활성).
+struct FrameStamp
+{
+    uint64_t cameraTicks = 0;       // 노출 시작 시각 (카메라 틱, 0 = 없음)
+    uint64_t hostNs = 0;            // 같은 시각을 호스트 단조 시계로 (0 = 시계 미보정)
+    uint64_t arrivalNs = 0;         // 그랩 결과를 받은 호스트 시각
+    int64_t  frameCounter = -1;     // 카메라 프레임 번호 (ChunkFramecounter / ChunkFrameID)
+    int64_t  triggerCounter = -1;   // 받은 프레임 트리거 수 (ChunkTriggerinputcounter / ChunkCounterValue)
+    int64_t  triggerIgnored = -1;   // 무시된 트리거 수 (노출 중 들어온 트리거 = PLC 쪽 누락)
+
+    bool HasHostTime() const { return hostNs != 0; }
+};
+
+// ===== 카메라 시계 → 호스트 시계 =====
+// 보정 1회 = 래치 명령을 몇 번 보내고 (호스트 전, 카메라 값, 호스트 후) 중 왕복이 가장 짧은 표본으로 오프셋.
+// 두 번째 보정부터는 오프셋 변화량으로 시계 속도 차(ppm)도 추정해 보정 사이를 보간한다.
+// 오차 ≈ 가장 짧은 왕복의 절반 (GigE 수백 µs, USB 수십 µs).
+class CCameraClock
+{
+public:
+    void SetTickFrequency(double hz) { m_nsPerTick = hz > 0.0 ? 1e9 / hz : 1.0; }   // 기본 1 GHz (1 틱 = 1 ns)
+
+    // 보정 묶음: Begin → AddSample × N → Commit
+    void Begin() { m_bestRtt = UINT64_MAX; }
+    void AddSample(uint64_t hostBeforeNs, uint64_t cameraTicks, uint64_t hostAfterNs);
+    bool Commit();                  // 표본이 없으면 false (이전 보정 유지)
+
+    bool     Calibrated() const { return m_calibrated; }
+    uint64_t ToHostNs(uint64_t cameraTicks) const;   // 미보정이면 0
+    uint64_t LastCalibrationNs() const { return m_calHostNs; }
+    uint64_t UncertaintyNs() const { return m_uncertaintyNs; }
+    double   DriftPpm() const { return m_drift * 1e6; }
+
+private:
+    double   m_nsPerTick = 1.0;
+    bool     m_calibrated = false;
+    double   m_offsetNs = 0.0;      // host = camera(ns) + offset + drift × (camera(ns) − calCamera)
+    double   m_drift = 0.0;         // 호스트/카메라 속도 차 (무차원)
+    double   m_calCameraNs = 0.0;
+    uint64_t m_calHostNs = 0;
+    uint64_t m_uncertaintyNs = 0;
+
+    // 진행 중인 묶음의 최선 표본
+    uint64_t m_bestRtt = UINT64_MAX;
+    uint64_t m_bestHostNs = 0;
+    uint64_t m_bestTicks = 0;
+};
+
+// 호스트 단조 시각(NowNs) → 벽시계 (Unix µs / ms). 지금 두 시계를 함께 읽어 차이만큼 되돌린다.
+int64_t SteadyToUnixUs(uint64_t steadyNs);
+inline int64_t SteadyToUnixMs(uint64_t steadyNs) { return SteadyToUnixUs(steadyNs) / 1000; }
+
+// "frame 1234, trigger 1250 (ignored 2), clock ±0.2 ms" — 청크가 없으면 해당 항목 생략
+std::string FormatFrameStamp(const FrameStamp& stamp, const CCameraClock* clock = nullptr);
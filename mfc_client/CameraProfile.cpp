@@ -0,0 +1,97 @@
+﻿#include "CameraProfile.h"
+
+#include <algorithm>
+#include <cstdio>
+
+bool CameraProfile::IsEmpty() const
+{
+    return exposureUs <= 0.0 && gainDb < 0.0 && binning <= 0 && sensorRoi.IsEmpty() &&
+           pixelFormat.empty() && packetSize <= 0 && interPacketDelay < 0 && frameRate <= 0.0;
+}
+
+int64_t FitToRange(int64_t value, const IntRange& range)
+{
+    if (range.max < range.min)
+        return range.min;
+    int64_t v = (std::min)((std::max)(value, range.min), range.max);
+    if (range.inc > 1)
+        v = range.min + (v - range.min) / range.inc * range.inc;
+    return v;
+}
+
+RoiRect BinnedRoi(const RoiRect& sensor, int binning)
+{
+    const int b = binning > 1 ? binning : 1;
+    RoiRect r;
+    r.x = sensor.x / b;
+    r.y = sensor.y / b;
+    r.width = sensor.width / b;
+    r.height = sensor.height / b;
+    return r;
+}
+
+// ===================== 센서 창 =====================
+namespace
+{
+    int RoundUp(int v, int inc) { return inc > 1 ? (v + inc - 1) / inc * inc : v; }
+    int RoundDown(int v, int inc) { return inc > 1 ? v / inc * inc : v; }
+}
+
+RoiRect AlignSensorWindow(const RoiRect& sensor, int binning, const SensorLimits& limits)
+{
+    RoiRect full;
+    full.width = RoundDown(limits.maxW, limits.incW);
+    full.height = RoundDown(limits.maxH, limits.incH);
+    if (sensor.IsEmpty())
+        return full;
+
+    const int b = binning > 1 ? binning : 1;
+    auto axis = [](int lo, int hi, int maxLen, int incLen, int incOff, int fullLen, int& off, int& len) {
+        lo = (std::max)(0, (std::min)(lo, maxLen - 1));
+        hi = (std::min)(maxLen, (std::max)(hi, lo + 1));
+        off = RoundDown(lo, incOff);
+        len = (std::min)(RoundUp(hi - off, incLen), fullLen);
+        if (off + len > maxLen)                 // 오른쪽/아래 끝을 넘으면 안쪽으로 밀기
+            off = RoundDown(maxLen - len, incOff);
+    };
+    RoiRect w;
+    axis(sensor.x / b, (sensor.x + sensor.width + b - 1) / b, limits.maxW, limits.incW, limits.incX, full.width, w.x, w.width);
+    axis(sensor.y / b, (sensor.y + sensor.height + b - 1) / b, limits.maxH, limits.incH, limits.incY, full.height, w.y, w.height);
+    return w;
+}
+
+RoiRect RoiInWindow(const RoiRect& sensor, int binning, const RoiRect& window)
+{
+    if (sensor.IsEmpty())
+        return RoiRect();
+    const RoiRect binned = BinnedRoi(sensor, binning);
+    RoiRect r;
+    r.x = (std::max)(0, binned.x - window.x);
+    r.y = (std::max)(0, binned.y - window.y);
+    r.width = (std::min)(binned.x + binned.width, window.x + window.width) - window.x - r.x;
+    r.height = (std::min)(binned.y + binned.height, window.y + window.height) - window.y - r.y;
+    return r;
+}
+
+std::string ChoosePixelFormat(const std::vector<std::string>& available)
+{
+    static const char* const kPreferred[] = {
+        "BayerRG8", "BayerGR8", "BayerGB8", "BayerBG8", "BGR8", "BGR8Packed", "RGB8", "RGB8Packed", "Mono8",
+    };
+    for (const char* name : kPreferred)
+        if (std::find(available.begin(), available.end(), name) != available.end())
+            return name;
+    return std::string();
+}
+
+std::string FormatProfileReport(const char* role, const CameraProfileReport& report, double measuredFps)
+{
+    char crop[48] = "";
+    if (report.inspectionBytes > 0)
+        std::snprintf(crop, sizeof(crop), " (inspection %.2f MB)", report.inspectionBytes / 1e6);
+    char buf[224];
+    std::snprintf(buf, sizeof(buf), "%-6s %dx%d %s, %.2f MB/frame%s, camera %.1f fps, measured %.1f fps",
+        role, report.width, report.height, report.pixelFormat.c_str(),
+        report.payloadBytes / 1e6, crop, report.cameraFps, measuredFps);
+    return buf;
+}
@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "Preprocess.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===== 카메라 파라미터 프로파일 (열 때 한 번에 적용) =====
+// 값마다 "유지" 값이 있어 지정한 것만 바꾼다 (나머지는 카메라 사용자 세트 그대로).
+// 적용 순서: 비닝 → 센서 ROI → 픽셀 형식 → 패킷 크기/패킷 간격 → 노출/게인 → 프레임 속도 상한
+// (비닝이 ROI 범위를, ROI/형식이 최대 프레임 속도를 바꾸므로).
+struct CameraProfile
+{
+    double      exposureUs = 0.0;       // 노출 (µs), 0 = 유지
+    double      gainDb = -1.0;          // 게인 (dB), < 0 = 유지
+    int         binning = 0;            // 가로/세로 비닝 (1/2/4), 0 = 유지
+    RoiRect     sensorRoi;              // 센서 ROI (비닝 전 센서 픽셀), 비어 있으면 유지
+    std::string pixelFormat;            // PFNC 이름 ("BayerRG8" ...), "auto" = 변환 비용 최소, "" = 유지
+    int         packetSize = 0;         // GigE GevSCPSPacketSize (바이트, 점보 프레임이면 8192 등), 0 = 유지
+    int         interPacketDelay = -1;  // GigE GevSCPD (틱), < 0 = 유지
+    double      frameRate = 0.0;        // AcquisitionFrameRate 상한 (fps), 0 = 유지
+
+    bool IsEmpty() const;
+};
+
+// ===== 적용 결과 (카메라별) =====
+struct CameraProfileReport
+{
+    int         width = 0;              // 적용 후 영상 크기 (비닝 반영)
+    int         height = 0;
+    std::string pixelFormat;
+    int64_t     payloadBytes = 0;       // 프레임당 전송 바이트 (PayloadSize, 미리보기 창)
+    int64_t     inspectionBytes = 0;    // 검사 창(센서 크롭)의 프레임당 바이트, 0 = 창 전환 없음
+    double      cameraFps = 0.0;        // 카메라가 계산한 최대 프레임 속도 (ResultingFrameRate)
+    std::vector<std::string> warnings;  // 지원 안 함/범위 밖으로 조정한 항목
+};
+
+// 정수 파라미터 범위 (GenApi IInteger: min/max/inc)
+struct IntRange
+{
+    int64_t min = 0;
+    int64_t max = 0;
+    int64_t inc = 1;
+};
+
+// 범위 안으로 자르고 min 기준 inc 배수로 내림
+int64_t FitToRange(int64_t value, const IntRange& range);
+
+// 센서 ROI → 비닝 후 좌표 (Width/Height/OffsetX/OffsetY 는 비닝된 픽셀 단위)
+RoiRect BinnedRoi(const RoiRect& sensor, int binning);
+
+// ===== 센서 창 (카메라 OffsetX/OffsetY/Width/Height, 비닝 후 픽셀) =====
+struct SensorLimits
+{
+    int maxW = 0, maxH = 0;     // WidthMax / HeightMax (비닝 반영)
+    int incW = 1, incH = 1;     // Width / Height 증분
+    int incX = 1, incY = 1;     // OffsetX / OffsetY 증분
+};
+
+// 센서 ROI(비닝 전 센서 픽셀)를 모두 덮는 가장 작은 창. 증분에 맞춰 바깥쪽으로 넓히고 센서 안으로 밀어 넣음.
+// sensor 가 비어 있으면 센서 전체.
+RoiRect AlignSensorWindow(const RoiRect& sensor, int binning, const SensorLimits& limits);
+
+// 센서 ROI → 창 안의 프레임 좌표 (전처리 크롭에 그대로). sensor 가 비어 있으면 창 전체(= 빈 ROI).
+RoiRect RoiInWindow(const RoiRect& sensor, int binning, const RoiRect& window);
+
+// 카메라가 지원하는 형식 중 변환 비용이 가장 적은 것 (없으면 "").
+// 컬러: 베이어 8비트(선로 1바이트/픽셀, 타일 디모자이크) → BGR8 (변환 없음, 3바이트) → RGB8.
+// 흑백 카메라: Mono8. 그 외(10/12비트, YUV 등)는 Pylon 변환기 경로라 고르지 않는다.
+std::string ChoosePixelFormat(const std::vector<std::string>& available);
+
+// "top 1224x1024 BayerRG8, 1.25 MB/frame (inspection 0.40 MB), camera 41.3 fps, measured 40.8 fps"
+std::string FormatProfileReport(const char* role, const CameraProfileReport& report, double measuredFps);
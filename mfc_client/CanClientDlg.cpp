@@ -4,17 +4,16 @@
 #include "CanClientDlg.h"
 #include "afxdialogex.h"
 
+#include <algorithm>
+#include <deque>
 #include <fstream>
+#include <mutex>
+#include <string_view>
 #include <winsock2.h>
-#include <ws2tcpip.h>
 #pragma comment(lib, "ws2_32.lib")
 
-// ===== JSON 라이브러리 =====
-#include <nlohmann/json.hpp>
-using json = nlohmann::json;
-
-// UTF-8 std::string -> UTF-16 CString
-static CString Utf8ToCStr(const std::string& s)
+// UTF-8 -> UTF-16 CString
+static CString Utf8ToCStr(std::string_view s)
 {
     if (s.empty()) return CString();
     int wlen = MultiByteToWideChar(CP_UTF8, 0, s.data(), (int)s.size(), nullptr, 0);
@@ -32,11 +31,37 @@ static CString Utf8ToCStr(const std::string& s)
 
 using namespace Pylon;
 
+// Pylon 그랩 결과 → 직접 변환하는 원본 프레임 (그 외 형식은 false → Pylon 변환기)
+static bool RawFrameFromGrab(const CGrabResultPtr& grab, RawFrame& raw)
+{
+    switch (grab->GetPixelType()) {
+    case PixelType_Mono8:       raw.format = RawFormat::Mono8;    break;
+    case PixelType_BayerRG8:    raw.format = RawFormat::BayerRG8; break;
+    case PixelType_BayerGR8:    raw.format = RawFormat::BayerGR8; break;
+    case PixelType_BayerGB8:    raw.format = RawFormat::BayerGB8; break;
+    case PixelType_BayerBG8:    raw.format = RawFormat::BayerBG8; break;
+    case PixelType_RGB8packed:  raw.format = RawFormat::RGB8;     break;
+    case PixelType_BGR8packed:  raw.format = RawFormat::BGR8;     break;
+    default: return false;
+    }
+    raw.data = static_cast<const uint8_t*>(grab->GetBuffer());
+    raw.width = static_cast<int>(grab->GetWidth());
+    raw.height = static_cast<int>(grab->GetHeight());
+    raw.stride = raw.width * RawBytesPerPixel(raw.format) + static_cast<int>(grab->GetPaddingX());
+    return raw.IsValid();
+}
+
 // ===================== 메시지 맵 =====================
 BEGIN_MESSAGE_MAP(CCanClientDlg, CDialogEx)
     ON_BN_CLICKED(IDC_BTN_START, &CCanClientDlg::OnBnClickedBtnStart)
+    ON_BN_CLICKED(IDC_CHK_AUTO, &CCanClientDlg::OnBnClickedChkAuto)
     ON_WM_DESTROY()
     ON_WM_TIMER()
+    ON_MESSAGE(WM_OVERLAY_READY, &CCanClientDlg::OnOverlayReady)
+    ON_MESSAGE(WM_STATION_SLOT, &CCanClientDlg::OnStationSlot)
+    ON_MESSAGE(WM_STATION_READY, &CCanClientDlg::OnStationReady)
+    ON_MESSAGE(WM_SPOOL_DELIVERED, &CCanClientDlg::OnSpoolDelivered)
+    ON_MESSAGE(WM_INSPECTION_DONE, &CCanClientDlg::OnInspectionDone)
 END_MESSAGE_MAP()
 
 // ===================== 생성자 =====================
@@ -72,6 +97,31 @@ BOOL CCanClientDlg::OnInitDialog()
         m_history.clear();               // 메모리 내 히스토리 초기화
         if (m_historyList.GetSafeHwnd()) // 리스트뷰도 비움
             m_historyList.DeleteAllItems();
+
+        // 제품번호/단위 번호는 지난 실행에서 이어감
+        LoadCounters();
+    }
+
+    // ===== 설정 파일 로드 (없으면 기본값) =====
+    {
+        std::string err;
+        if (LoadClientConfig("C:\\CanClient\\config.json", m_config, &err))
+            OutputDebugString(L"[INFO] 설정 파일 로드 완료\n");
+        else
+            OutputDebugStringA(("[INFO] 기본 설정 사용: " + err + "\n").c_str());
+        m_presence.SetConfig(m_config.presence);
+        m_pipeline.SetLogger([](const std::string& msg) { OutputDebugStringA(msg.c_str()); });
+        m_pipeline.SetCancel(&m_sendCancel);
+        m_pipeline.Configure(m_config);
+    }
+
+    // ===== 결과 오버레이 창 =====
+    if (m_config.overlay.enabled && m_config.overlay.previewWindow) {
+        m_previewDlg.CreateModeless(this);
+        const HWND hwnd = GetSafeHwnd();
+        m_compositor.SetReadyCallback([hwnd](int slot) {
+            ::PostMessage(hwnd, WM_OVERLAY_READY, static_cast<WPARAM>(slot), 0);
+        });
     }
 
     // ===== WSA 초기화 =====
@@ -81,45 +131,123 @@ BOOL CCanClientDlg::OnInitDialog()
         OutputDebugString(L"[INFO] WSA 초기화 완료\n");
     }
 
+    // ===== 검사 서버 풀 (server.endpoints, 없으면 server 1대) =====
+    m_endpoints.Configure(m_config.server, m_config.pool);
+    if (m_wsaInitialized)
+        m_endpoints.StartProbes();
+    m_pipeline.SetEndpointPool(&m_endpoints);
+
+    // ===== 오프라인 전송 대기열 (지난 실행에서 못 보낸 것부터 이어서) =====
+    OpenSpool();
+
     // ===== 히스토리 리스트 초기화 =====
     InitHistoryList();
 
     // ===== 초기 UI 상태 =====
     ClearCurrentResult();
 
-    try {
-        PylonInitialize();
-        CTlFactory& factory = CTlFactory::GetInstance();
-        DeviceInfoList_t devices;
-
-        if (factory.EnumerateDevices(devices) < 2) {
-            AfxMessageBox(L"Basler 카메라 2대를 모두 연결해야 합니다.");
-            return TRUE;
-        }
+    // ===== 단계별 지연 표 (1초마다 갱신) =====
+    m_monoFont.CreatePointFont(90, _T("Consolas"));
+    GetDlgItem(IDC_EDIT_LATENCY)->SetFont(&m_monoFont);
+    UpdateLatencyView();
+    SetTimer(2, 1000, nullptr);
 
-        m_camTop.Attach(factory.CreateDevice(devices[0]));
-        m_camFront.Attach(factory.CreateDevice(devices[1]));
+    // ===== 카메라: 다이얼로그를 먼저 띄우고 백그라운드에서 장치별 병렬로 연결 =====
+    StartCameras();
 
-        m_camTop.Open();
-        m_camFront.Open();
+    return TRUE;
+}
 
-        // 미리보기용: 최신 프레임만 유지
-        m_camTop.StartGrabbing(GrabStrategy_LatestImageOnly);
-        m_camFront.StartGrabbing(GrabStrategy_LatestImageOnly);
+// ===================== 카메라 기동 (백그라운드) =====================
+// GigE 카메라는 열거/열기만 수 초 → UI 스레드에서 순서대로 하면 그동안 창이 안 뜬다.
+// 기동 스레드: PylonInitialize → 열거/배정 → 슬롯별 병렬 Open → StartGrabbing, 진행은 메시지로.
+void CCanClientDlg::StartCameras()
+{
+    SetDlgItemText(IDC_STATIC_STATUS, _T("카메라 연결 중..."));
+    m_slotsOpened = 0;
 
-        // 변환기 기본 설정: 미리보기/저장 공용 BGR8
-        m_converter.OutputPixelFormat = PixelType_BGR8packed;
-        m_converter.OutputBitAlignment = OutputBitAlignment_MsbAligned;
+    const HWND hwnd = GetSafeHwnd();
+    const StationConfig station = m_config.station;
+    m_startupThread = std::thread([this, hwnd, station] {
+        const uint64_t start = NowNs();
+        PylonInitialize();
+        m_pylonInitialized = true;
+        m_startup.initNs = NowNs() - start;
+
+        const bool ok = m_station.Open(station, &m_startup,
+            [hwnd](size_t slot, bool opened) {
+                ::PostMessage(hwnd, WM_STATION_SLOT, static_cast<WPARAM>(slot), opened ? 1 : 0);
+            },
+            &m_startupError);
+        m_startup.totalNs = NowNs() - start;
+        ::PostMessage(hwnd, WM_STATION_READY, ok ? 1 : 0, 0);
+    });
+}
 
-        // 미리보기 타이머
-        m_timerId = SetTimer(1, 33, nullptr); // ~30fps
+LRESULT CCanClientDlg::OnStationSlot(WPARAM wParam, LPARAM lParam)
+{
+    const size_t slot = static_cast<size_t>(wParam);
+    const auto& cams = m_config.station.cameras;
+    const char* role = slot < cams.size() ? CameraRoleName(cams[slot].role) : "?";
+
+    CString status;
+    if (lParam) {
+        ++m_slotsOpened;
+        status.Format(_T("카메라 연결 중... (%d/%d, %s)"), static_cast<int>(m_slotsOpened),
+            static_cast<int>(cams.size()), (LPCTSTR)Utf8ToCStr(role));
     }
-    catch (const GenericException& e) {
-        CString msg(e.GetDescription());
+    else
+        status.Format(_T("카메라 연결 실패: %s"), (LPCTSTR)Utf8ToCStr(role));
+    SetDlgItemText(IDC_STATIC_STATUS, status);
+    return 0;
+}
+
+LRESULT CCanClientDlg::OnStationReady(WPARAM wParam, LPARAM)
+{
+    if (m_startupThread.joinable())
+        m_startupThread.join();
+
+    const std::string timing = "[STARTUP] " + std::string(CT2A(GetCurrentTimestamp(), CP_UTF8)) + " " +
+        FormatStationStartup(m_config.station, m_startup) + "\n";
+    OutputDebugStringA(timing.c_str());
+    std::ofstream log("C:\\CanClient\\latency.log", std::ios::app);
+    log << timing;
+
+    if (!wParam) {
+        SetDlgItemText(IDC_STATIC_STATUS, _T("카메라 연결 실패"));
+        CString msg;
+        msg.Format(L"Basler 카메라 %d대를 모두 연결해야 합니다.\n%s",
+            static_cast<int>(m_config.station.cameras.size()), (LPCTSTR)Utf8ToCStr(m_startupError));
         AfxMessageBox(msg);
+        return 0;
     }
 
-    return TRUE;
+    m_shots.assign(m_station.Count(), ImageBuffer());
+    for (size_t slot = 0; slot < m_station.Count(); ++slot)
+    {
+        // 프로파일 적용 결과 + 범위 밖으로 조정/미지원 항목
+        const char* role = CameraRoleName(m_station.Role(slot));
+        std::string line = "[CAMERA] " + FormatProfileReport(role, m_station.Report(slot), 0.0) +
+            " (serial " + m_station.Serial(slot) + ")\n";
+        for (const std::string& w : m_station.Report(slot).warnings)
+            line += "[CAMERA] " + std::string(role) + " profile: " + w + "\n";
+        OutputDebugStringA(line.c_str());
+        log << line;
+    }
+
+    // 변환기 기본 설정: 미리보기/저장 공용 BGR8
+    m_converter.OutputPixelFormat = PixelType_BGR8packed;
+    m_converter.OutputBitAlignment = OutputBitAlignment_MsbAligned;
+
+    m_camerasReady = true;
+    SetDlgItemText(IDC_STATIC_STATUS, _T("카메라 대기 중..."));
+
+    // 미리보기 타이머
+    m_timerId = SetTimer(1, 33, nullptr); // ~30fps
+
+    if (m_config.autoStart)
+        SetAutoMode(true);
+    return 0;
 }
 
 // ===================== 히스토리 리스트 초기화 =====================
@@ -148,42 +276,142 @@ void CCanClientDlg::OnTimer(UINT_PTR nIDEvent)
 {
     if (nIDEvent == 1)
     {
-        try {
-            CGrabResultPtr grabTop, grabFront;
+        bool trigger = false;
+        // 검사 직후에는 오버레이를 잠시 유지 (캔 감지는 계속)
+        const bool live = GetTickCount64() >= m_overlayUntil;
 
-            if (m_camTop.IsGrabbing() &&
-                m_camTop.RetrieveResult(50, grabTop, TimeoutHandling_Return) &&
-                grabTop->GrabSucceeded())
+        try {
+            // 미리보기 컨트롤은 top/front 두 개 (그 외 역할은 검사 때만 그랩 결과 사용)
+            std::vector<CGrabResultPtr> grabs;
+            m_station.GrabUnit(50, grabs);
+            const int slotTop = m_station.SlotOf(CameraRole::Top);
+            const int slotFront = m_station.SlotOf(CameraRole::Front);
+            CGrabResultPtr grabTop = slotTop >= 0 ? grabs[slotTop] : CGrabResultPtr();
+            CGrabResultPtr grabFront = slotFront >= 0 ? grabs[slotFront] : CGrabResultPtr();
+
+            CWnd* ctrlTop = GetDlgItem(IDC_CAM_TOP);
+            if (grabTop.IsValid() && PreviewGrab(grabTop, ctrlTop, m_previewTop))
             {
-                // BGR8 변환 (미리보기)
-                m_converter.Convert(m_pylonImage, grabTop);
-                const uint8_t* buf = reinterpret_cast<const uint8_t*>(m_pylonImage.GetBuffer());
-                int w = static_cast<int>(grabTop->GetWidth());
-                int h = static_cast<int>(grabTop->GetHeight());
-                DrawImageBufferToCtrl(buf, w, h, GetDlgItem(IDC_CAM_TOP));
+                if (live)
+                    DrawImageBufferToCtrl(m_previewTop.pixels.data(), m_previewTop.width, m_previewTop.height, ctrlTop);
+
+                // 연속 검사: 캔이 화면 중앙에 도착하면 트리거 (미리보기 해상도로 판정)
+                if (m_autoMode && !m_inspecting) {
+                    UpdatePresenceScale(static_cast<int>(grabTop->GetWidth()), m_previewTop.width);
+                    trigger = m_presence.Update(m_previewTop.View());
+                }
             }
 
-            if (m_camFront.IsGrabbing() &&
-                m_camFront.RetrieveResult(50, grabFront, TimeoutHandling_Return) &&
-                grabFront->GrabSucceeded())
+            CWnd* ctrlFront = GetDlgItem(IDC_CAM_FRONT);
+            if (grabFront.IsValid() && PreviewGrab(grabFront, ctrlFront, m_previewFront))
             {
-                // BGR8 변환 (미리보기)
-                m_converter.Convert(m_pylonImage, grabFront);
-                const uint8_t* buf = reinterpret_cast<const uint8_t*>(m_pylonImage.GetBuffer());
-                int w = static_cast<int>(grabFront->GetWidth());
-                int h = static_cast<int>(grabFront->GetHeight());
-                DrawImageBufferToCtrl(buf, w, h, GetDlgItem(IDC_CAM_FRONT));
+                if (live)
+                    DrawImageBufferToCtrl(m_previewFront.pixels.data(), m_previewFront.width, m_previewFront.height, ctrlFront);
             }
         }
-        catch (...) {
-            OutputDebugString(L"[Basler] RetrieveResult error\n");
+        catch (const GenericException& e) {
+            // 그랩 실패/예외는 GrabUnit 계수기에 (여기는 미리보기 변환 쪽)
+            OutputDebugStringA(("[Basler] 미리보기 오류: " + std::string(e.GetDescription()) + "\n").c_str());
         }
+
+        if (trigger) {
+            OutputDebugString(L"[AUTO] 캔 감지 → 자동 촬영\n");
+            RunInspection(true);
+        }
+    }
+    else if (nIDEvent == 2)
+    {
+        // 카메라 시계 재보정 (주기가 안 됐으면 바로 반환, 검사 중에는 미룸)
+        if (m_camerasReady && !m_inspecting)
+            m_station.CalibrateClocks();
+        UpdateLatencyView();
     }
     CDialogEx::OnTimer(nIDEvent);
 }
 
+// ===================== 미리보기 1장: 원본 → 컨트롤 크기 BGR8 =====================
+// 아는 형식은 변환 + 면적 평균 축소를 타일 단위로 한 번에 (센서 해상도 BGR8 을 만들지 않음),
+// 그 외 형식은 Pylon 변환기 → 축소 2단계.
+bool CCanClientDlg::PreviewGrab(const CGrabResultPtr& grab, CWnd* pWnd, ImageBuffer& preview)
+{
+    if (!pWnd) return false;
+    CRect rc; pWnd->GetClientRect(&rc);
+
+    RawFrame raw;
+    if (RawFrameFromGrab(grab, raw))
+        return ConvertPreview(raw, rc.Width(), rc.Height(), preview, &m_tilePool);
+
+    m_converter.Convert(m_pylonImage, grab);
+    DownscaleToFit(ImageView(static_cast<const uint8_t*>(m_pylonImage.GetBuffer()),
+        static_cast<int>(m_pylonImage.GetWidth()), static_cast<int>(m_pylonImage.GetHeight())),
+        rc.Width(), rc.Height(), preview);
+    return preview.width > 0;
+}
+
+// 캔 감지 간격(sampleStep)은 센서 픽셀 기준 → 미리보기 픽셀로 환산 (너비가 바뀔 때만 다시 설정)
+void CCanClientDlg::UpdatePresenceScale(int sensorW, int previewW)
+{
+    if (previewW == m_presencePreviewW || sensorW <= 0) return;
+    m_presencePreviewW = previewW;
+
+    PresenceConfig cfg = m_config.presence;
+    const int step = static_cast<int>(cfg.sampleStep * static_cast<double>(previewW) / sensorW + 0.5);
+    cfg.sampleStep = step > 1 ? step : 1;
+    m_presence.SetConfig(cfg);
+}
+
+// ===================== 검출 박스 / 라벨 (센서 좌표 → 표시 영역) =====================
+static void DrawDetections(CDC& dc, const ViewDetections& detections, float minScore,
+    int originX, int originY, double scaleX, double scaleY)
+{
+    const COLORREF kDefect = RGB(255, 48, 48);
+    const COLORREF kNormal = RGB(48, 220, 48);
+
+    CPen penDefect(PS_SOLID, 2, kDefect);
+    CPen penNormal(PS_SOLID, 2, kNormal);
+    CPen* oldPen = dc.SelectObject(&penNormal);
+    CGdiObject* oldBrush = dc.SelectStockObject(NULL_BRUSH);
+    const int oldBkMode = dc.SetBkMode(TRANSPARENT);
+    const COLORREF oldColor = dc.GetTextColor();
+
+    for (const SensorDetection& d : detections) {
+        if (!d.HasBox() || d.Score() < minScore) continue;
+
+        const bool defect = DefectLabels::IsDefect(d.labelId);
+        dc.SelectObject(defect ? &penDefect : &penNormal);
+        dc.SetTextColor(defect ? kDefect : kNormal);
+
+        const CRect box(
+            originX + static_cast<int>(d.x * scaleX), originY + static_cast<int>(d.y * scaleY),
+            originX + static_cast<int>((d.x + d.w) * scaleX), originY + static_cast<int>((d.y + d.h) * scaleY));
+        dc.Rectangle(box);
+
+        // 라벨은 박스 위 (위쪽 여유가 없으면 박스 안)
+        CString text;
+        text.Format(_T("%s %.2f"), (LPCTSTR)Utf8ToCStr(DefectLabels::Name(d.labelId)), d.Score());
+        const int textH = dc.GetTextExtent(text).cy;
+        const int textY = box.top - textH >= originY ? box.top - textH : box.top + 2;
+        dc.TextOut(box.left + 2, textY, text);
+    }
+
+    dc.SetTextColor(oldColor);
+    dc.SetBkMode(oldBkMode);
+    dc.SelectObject(oldBrush);
+    dc.SelectObject(oldPen);
+}
+
+// ===================== 결과 창 합성 완료 =====================
+LRESULT CCanClientDlg::OnOverlayReady(WPARAM wParam, LPARAM)
+{
+    const int slot = static_cast<int>(wParam);
+    if (m_previewDlg.GetSafeHwnd() && m_compositor.TakeLatest(slot, m_overlaySpare))
+        m_previewDlg.Present(slot, m_overlaySpare);
+    return 0;
+}
+
 // ===================== BGR8 버퍼 출력 (종횡비 유지 + HALFTONE) =====================
-void CCanClientDlg::DrawImageBufferToCtrl(const uint8_t* data, int width, int height, CWnd* pWnd)
+void CCanClientDlg::DrawImageBufferToCtrl(const uint8_t* data, int width, int height, CWnd* pWnd,
+    const ViewDetections* detections)
 {
     if (!pWnd || !data || width <= 0 || height <= 0) return;
 
@@ -231,11 +459,110 @@ void CCanClientDlg::DrawImageBufferToCtrl(const uint8_t* data, int width, int he
         data, &bmi, DIB_RGB_COLORS, SRCCOPY);
 
     SetStretchBltMode(dc.GetSafeHdc(), oldMode);
+
+    if (detections && detections->count > 0)
+        DrawDetections(dc, *detections, m_config.overlay.minScore, drawX, drawY,
+            static_cast<double>(drawW) / width, static_cast<double>(drawH) / height);
+}
+
+// ===================== 검사 프레임 + 검출 오버레이 =====================
+void CCanClientDlg::ShowDetectionOverlay(const InspectionResult& result, bool top, bool front)
+{
+    if (!m_config.overlay.enabled)
+        return;
+
+    const ImageBuffer* shotTop = top ? ShotOf(CameraRole::Top) : nullptr;
+    const ImageBuffer* shotFront = front ? ShotOf(CameraRole::Front) : nullptr;
+    if (shotTop && shotTop->width > 0)
+        DrawImageBufferToCtrl(shotTop->pixels.data(), shotTop->width, shotTop->height,
+            GetDlgItem(IDC_CAM_TOP), &result.detTop);
+    if (shotFront && shotFront->width > 0)
+        DrawImageBufferToCtrl(shotFront->pixels.data(), shotFront->width, shotFront->height,
+            GetDlgItem(IDC_CAM_FRONT), &result.detFront);
+
+    // 결과 창: 센서 해상도 프레임을 복사하지 않고 빌려 줌 (다음 변환 전 WaitIdle)
+    if (m_previewDlg.GetSafeHwnd()) {
+        const ImageBuffer* shots[CPreviewDlg::kSlots] = { shotTop, shotFront };
+        const ViewDetections* dets[CPreviewDlg::kSlots] = { &result.detTop, &result.detFront };
+        for (int slot = 0; slot < CPreviewDlg::kSlots; ++slot) {
+            const ImageBuffer* shot = shots[slot];
+            if (!shot || shot->width == 0) continue;
+            const CSize size = m_previewDlg.TargetSize(slot);
+            m_compositor.Submit(slot, shot->View(), *dets[slot], size.cx, size.cy, m_config.overlay.minScore);
+        }
+        if (result.defectType == _T("불량"))
+            m_previewDlg.Reveal();
+    }
+
+    const int holdMs = m_config.overlay.holdMs;
+    m_overlayUntil = GetTickCount64() + static_cast<ULONGLONG>(holdMs > 0 ? holdMs : 0);
+}
+
+const ImageBuffer* CCanClientDlg::ShotOf(CameraRole role) const
+{
+    const int slot = m_station.SlotOf(role);
+    return slot >= 0 && static_cast<size_t>(slot) < m_shots.size() ? &m_shots[slot] : nullptr;
+}
+
+// 검사 단위 촬영 시각 = 가장 먼저 노출한 뷰 (한 트리거로 동시 노출이면 뷰끼리 µs 차이)
+void CCanClientDlg::StampResult(InspectionResult& result, const InspectionUnit& unit)
+{
+    const FrameStamp* stamp = nullptr;
+    for (const ViewRequest& v : unit.views)
+        if (v.stamp.HasHostTime() && (!stamp || v.stamp.hostNs < stamp->hostNs))
+            stamp = &v.stamp;
+    if (!stamp && !unit.views.empty())
+        stamp = &unit.views.front().stamp;
+    if (!stamp)
+        return;
+
+    result.frameCounter = stamp->frameCounter;
+    result.triggerCounter = stamp->triggerCounter;
+
+    // 시계 미보정이면 그랩 결과를 받은 시각 (노출 + 전송만큼 늦음)
+    const uint64_t at = stamp->HasHostTime() ? stamp->hostNs : stamp->arrivalNs;
+    if (at == 0)
+        return;
+    const int64_t ms = SteadyToUnixMs(at);
+    const CTime t(static_cast<time_t>(ms / 1000));
+    result.captureTime.Format(_T("%s.%03d"), t.Format(_T("%Y-%m-%d %H:%M:%S")).GetString(), static_cast<int>(ms % 1000));
+
+    const uint64_t now = NowNs();
+    if (stamp->HasHostTime() && now > stamp->hostNs) {
+        result.endToEndMs = (now - stamp->hostNs) / 1e6;
+        m_latency.Record(Stage::EndToEnd, now - stamp->hostNs);
+    }
 }
 
 // ===================== 촬영 및 전송 =====================
 void CCanClientDlg::OnBnClickedBtnStart()
 {
+    RunInspection(false);
+}
+
+// ===================== 연속 검사 모드 토글 =====================
+void CCanClientDlg::OnBnClickedChkAuto()
+{
+    SetAutoMode(IsDlgButtonChecked(IDC_CHK_AUTO) == BST_CHECKED);
+}
+
+void CCanClientDlg::SetAutoMode(bool enable)
+{
+    m_autoMode = enable;
+    m_presence.Reset(); // 현재 화면을 새 배경으로 학습
+
+    CheckDlgButton(IDC_CHK_AUTO, enable ? BST_CHECKED : BST_UNCHECKED);
+    SetDlgItemText(IDC_STATIC_STATUS, enable ? _T("연속 검사 중 (캔 대기)") : _T("카메라 대기 중..."));
+    OutputDebugString(enable ? L"[AUTO] 연속 검사 시작\n" : L"[AUTO] 연속 검사 종료\n");
+}
+
+// ===================== 촬영(스테이션 전체) → 저장 → 전송 → 결과 =====================
+void CCanClientDlg::RunInspection(bool autoTriggered)
+{
+    if (m_inspecting || !m_camerasReady) return;
+    m_inspecting = true;
+    const uint64_t startNs = NowNs();   // Total: 결과 처리까지 (FinishInspection)
+
     // 타이머 일시 중지 (카메라 충돌 방지)
     if (m_timerId) {
         KillTimer(m_timerId);
@@ -243,244 +570,377 @@ void CCanClientDlg::OnBnClickedBtnStart()
 
     GetDlgItem(IDC_BTN_START)->EnableWindow(FALSE);
 
+    std::unique_ptr<InspectionDone> job;
     try {
         CString folder = L"C:\\CanClient\\captures";
         CreateDirectory(folder, NULL);
 
-        if (!m_camTop.IsOpen())   m_camTop.Open();
-        if (!m_camFront.IsOpen()) m_camFront.Open();
-
-        if (!m_camTop.IsGrabbing())
-            m_camTop.StartGrabbing(GrabStrategy_LatestImageOnly);
-        if (!m_camFront.IsGrabbing())
-            m_camFront.StartGrabbing(GrabStrategy_LatestImageOnly);
-
-        Sleep(120); // 카메라 안정화
-
-        CGrabResultPtr grabTop, grabFront;
-        std::string topResponse, frontResponse;
-
-        // ===== 1) TOP 캡처 & 저장(PNG, 무손실) & 전송 =====
-        if (m_camTop.RetrieveResult(800, grabTop, TimeoutHandling_Return) &&
-            grabTop->GrabSucceeded())
+        m_station.EnsureGrabbing();
+        // 검사 모드: sensor_crop 카메라는 검사 창, 그랩 전략이 다르면 재시작 (전환 전 프레임은 GrabUnit 이 버림)
+        m_station.SetMode(CStationCameras::Mode::Inspection);
+
+        // 수동 촬영만 안정화 대기 (자동 트리거는 캔이 이미 중앙에 있음)
+        if (!autoTriggered)
+            Sleep(120);
+
+        // ===== 0) 스테이션 전체를 한 번에 그랩 (캔 1개 = 검사 단위 1개) =====
+        std::vector<CGrabResultPtr> grabs;
+        std::vector<FrameStamp> stamps;
+        const uint64_t t = NowNs();
+        m_station.GrabUnit(static_cast<unsigned>(m_config.station.grabTimeoutMs), grabs, &stamps);
+        m_latency.Record(Stage::Grab, NowNs() - t);
+
+        const std::string stamp = std::to_string(time(NULL));
+
+        // ===== 1) 뷰별 BGR8 변환 =====
+        InspectionUnit unit;
+        unit.sequence = ++m_unitSequence;
+        // 제품번호는 촬영 때 정해 요청 헤더에 싣고 결과에도 같은 값
+        const CString productId = GenerateProductId();
+        const std::string productIdA(CT2A(productId, CP_UTF8));
+        SaveCounters();   // 전송 전에 기록 → 이 단위가 대기열에 남은 채 종료돼도 다음 실행과 안 겹침
+        std::vector<uint64_t> convertNs;   // unit.views 와 같은 순서
+        for (size_t slot = 0; slot < grabs.size(); ++slot)
         {
-            CPylonImage imgTop;
-            m_converter.Convert(imgTop, grabTop); // BGR8
-
-            std::string topPath = "C:\\CanClient\\captures\\capture_" +
-                std::to_string(time(NULL)) + "_top.png";
-
-            // 버전 호환을 위해 옵션 없이 저장 (무손실 PNG)
-            CImagePersistence::Save(ImageFileFormat_Png, topPath.c_str(), imgTop);
-
-            OutputDebugString(L"[INFO] TOP 이미지 저장 완료(PNG)\n");
-            SendImageToServer(topPath, topResponse);
-            OutputDebugStringA(("[TOP 응답] " + topResponse + "\n").c_str());
+            const CameraRole role = m_station.Role(slot);
+            if (!grabs[slot].IsValid()) {
+                OutputDebugStringA(("[WARNING] 그랩 실패: " + std::string(CameraRoleName(role)) + "\n").c_str());
+                continue;
+            }
+            ViewRequest req;
+            req.role = role;
+            req.roi = m_station.FrameRoi(slot);   // 센서 창 안 좌표
+            req.send = IsServerRole(role);   // 서버 프로토콜은 TOP → SIDE 두 장
+            req.stamp = stamps[slot];
+            req.sequence = unit.sequence;
+            req.productId = productIdA;
+            const std::string counters = FormatFrameStamp(req.stamp, &m_station.Clock(slot));
+            if (!counters.empty())
+                OutputDebugStringA(("[STAMP] " + std::string(CameraRoleName(role)) + " " + counters + "\n").c_str());
+            req.archiveBase = "C:\\CanClient\\captures\\capture_" + stamp + "_" + CameraRoleName(role);
+            convertNs.push_back(ConvertView(grabs[slot], m_shots[slot], req));
+            unit.views.push_back(req);
         }
 
-        Sleep(200); // 서버 처리 대기
+        const int iTop = unit.IndexOf(CameraRole::Top);
+        const int iFront = unit.IndexOf(CameraRole::Front);
+        bool topOk = iTop >= 0;
+        bool frontOk = iFront >= 0;
 
-        // ===== 2) FRONT 캡처 & 저장(PNG, 무손실) & 전송 =====
-        if (m_camFront.RetrieveResult(800, grabFront, TimeoutHandling_Return) &&
-            grabFront->GrabSucceeded())
+        // ===== 로컬 1차 선별: 두 뷰 모두 확실한 정상이면 서버 생략 =====
+        ScreenVerdict screen;
+        if (topOk && frontOk && m_pipeline.ScreenPair(unit.views[iTop], unit.views[iFront], screen))
         {
-            CPylonImage imgFront;
-            m_converter.Convert(imgFront, grabFront); // BGR8
-
-            std::string frontPath = "C:\\CanClient\\captures\\capture_" +
-                std::to_string(time(NULL)) + "_front.png";
-
-            CImagePersistence::Save(ImageFileFormat_Png, frontPath.c_str(), imgFront);
-
-            OutputDebugString(L"[INFO] FRONT 이미지 저장 완료(PNG)\n");
-            SendImageToServer(frontPath, frontResponse);
-            OutputDebugStringA(("[FRONT 응답] " + frontResponse + "\n").c_str());
-
-            // ===== 3) 검사 결과 처리 =====
             InspectionResult result;
-            result.productId = GenerateProductId();
+            result.productId = productId;
             result.timestamp = GetCurrentTimestamp();
-
-            if (ParseJsonResponse(frontResponse, result)) {
-                UpdateCurrentResult(result);
-                AddToHistory(result);
-                OutputDebugString(L"[SUCCESS] 검사 완료 및 결과 표시\n");
-            }
-            else {
-                // JSON 파싱 실패 → 원본 문자열 그대로 표시
-                OutputDebugStringA(("[WARNING] JSON 파싱 실패, 원본: " + frontResponse + "\n").c_str());
-                result.defectType = _T("에러");
-                result.defectDetail = Utf8ToCStr(frontResponse);
-                UpdateCurrentResult(result);
-                AddToHistory(result);
-            }
+            result.defectType = _T("정상");
+            result.defectDetail.Format(_T("로컬 판정 (TOP %.1f%%, FRONT %.1f%%)"), screen.top * 100.0f, screen.front * 100.0f);
+            StampResult(result, unit);
+
+            CStageTimer uiTimer(m_latency, Stage::UiUpdate);
+            UpdateCurrentResult(result);
+            ShowDetectionOverlay(result, true, true);
+            AddToHistory(result);
+            OutputDebugString(L"[SUCCESS] 로컬 선별 정상 (서버 생략)\n");
+            topOk = frontOk = false;
         }
+
+        // ===== 2) 인코딩 & 전송은 전송 스레드에서 (서버 응답을 기다리는 동안 창은 계속 움직임) =====
+        job = std::make_unique<InspectionDone>();
+        job->startNs = startNs;
+        job->productId = productId;
+        job->unit = std::move(unit);
+        job->convertNs = std::move(convertNs);
+        job->iTop = iTop;
+        job->iFront = iFront;
+        job->topOk = topOk;
+        job->frontOk = frontOk;
     }
     catch (const GenericException& e) {
         CString msg(e.GetDescription());
-        AfxMessageBox(msg);
         OutputDebugString(L"[ERROR] 카메라 에러\n");
+        // 연속 검사 중에는 모달 창으로 라인을 멈추지 않음
+        if (!autoTriggered)
+            AfxMessageBox(msg);
+    }
+
+    // 미리보기 모드로 복귀 (카메라는 여기서 끝, 전송 중에도 미리보기)
+    try {
+        m_station.SetMode(CStationCameras::Mode::Preview);
+    }
+    catch (const GenericException& e) {
+        OutputDebugStringA(("[ERROR] 미리보기 모드 복귀 실패: " + std::string(e.GetDescription()) + "\n").c_str());
     }
 
     // 타이머 재시작
     m_timerId = SetTimer(1, 33, nullptr);
-    GetDlgItem(IDC_BTN_START)->EnableWindow(TRUE);
+
+    // 촬영 버튼/자동 트리거는 결과가 올 때까지 막아 둠 (m_shots 를 전송 스레드가 읽는 중)
+    if (job)
+        StartSend(std::move(job));
+    else
+        FinishInspection(startNs);
 }
 
-// ===================== TCP 전송 및 응답 수신 =====================
-bool CCanClientDlg::SendImageToServer(const std::string& imgPath, std::string& response)
+// ===================== 전송 스레드 =====================
+// 연결/응답 기한이 최대 십수 초라 UI 스레드에서 기다리면 그동안 창이 멈춘다.
+// 검사 1건씩 (m_inspecting 동안 다음 촬영 없음), 끝나면 WM_INSPECTION_DONE 으로 결과를 넘김.
+void CCanClientDlg::StartSend(std::unique_ptr<InspectionDone> job)
 {
-    OutputDebugString(L"[DEBUG] SendImageToServer 시작\n");
-
-    // ===== 파일 읽기 =====
-    std::ifstream file(imgPath, std::ios::binary | std::ios::ate);
-    if (!file) {
-        OutputDebugString(L"[ERROR] 이미지 파일 열기 실패\n");
-        return false;
-    }
-
-    std::streamsize size = file.tellg();
-    file.seekg(0, std::ios::beg);
-    std::vector<char> buffer(static_cast<size_t>(size));
+    if (m_sendThread.joinable())
+        m_sendThread.join();   // 앞 검사는 결과 메시지를 보낸 뒤라 바로 끝남
+
+    const HWND hwnd = GetSafeHwnd();
+    m_sendThread = std::thread([this, hwnd, d = job.release()] {
+        SendUnit(*d);
+        if (!::PostMessage(hwnd, WM_INSPECTION_DONE, 0, reinterpret_cast<LPARAM>(d)))
+            delete d;
+    });
+}
 
-    if (!file.read(buffer.data(), size)) {
-        OutputDebugString(L"[ERROR] 파일 읽기 실패\n");
-        return false;
-    }
+// 전송 스레드: 검사 코어만 사용 (UI/카메라 멤버는 건드리지 않음)
+void CCanClientDlg::SendUnit(InspectionDone& d)
+{
+    std::vector<ViewRequest>& views = d.unit.views;
 
-    // ===== 소켓 생성 =====
-    SOCKET sock = socket(AF_INET, SOCK_STREAM, 0);
-    if (sock == INVALID_SOCKET) {
-        OutputDebugString(L"[ERROR] 소켓 생성 실패\n");
-        return false;
+    // ===== TOP 인코딩 & 전송 =====
+    if (d.topOk)
+    {
+        SendView(views[d.iTop], d.convertNs[d.iTop], d.geomTop, d.topResponse);
+        OutputDebugStringA(("[TOP 응답] " + d.topResponse + "\n").c_str());
     }
 
-    // ===== 서버 연결 =====
-    sockaddr_in serverAddr = {};
-    serverAddr.sin_family = AF_INET;
-    //serverAddr.sin_port = htons(9000);
-    //inet_pton(AF_INET, "127.0.0.1", &serverAddr.sin_addr);
-
-    serverAddr.sin_port = htons(9000);
-    inet_pton(AF_INET, "10.10.21.121", &serverAddr.sin_addr);
-
-    if (connect(sock, (sockaddr*)&serverAddr, sizeof(serverAddr)) == SOCKET_ERROR) {
-        int err = WSAGetLastError();
-        CString errMsg;
-        errMsg.Format(L"[ERROR] 서버 연결 실패 (WSA: %d)\n", err);
-        OutputDebugString(errMsg);
-        closesocket(sock);
-        return false;
+    // ===== FRONT 인코딩 & 전송 =====
+    // TOP 응답을 받은 뒤에 보내므로 서버 쪽 TOP→SIDE 순서가 보장됨
+    if (d.frontOk)
+    {
+        SendView(views[d.iFront], d.convertNs[d.iFront], d.geomFront, d.frontResponse, &d.queued);
+        OutputDebugStringA(("[FRONT 응답] " + d.frontResponse + "\n").c_str());
     }
-    OutputDebugString(L"[DEBUG] 서버 연결 성공\n");
 
-    // ===== 크기 전송 (Big Endian) =====
-    int fileSize = static_cast<int>(size);
-    int netSize = htonl(fileSize);
-
-    if (send(sock, (char*)&netSize, sizeof(netSize), 0) != sizeof(netSize)) {
-        OutputDebugString(L"[ERROR] 길이 전송 실패\n");
-        closesocket(sock);
-        return false;
+    // ===== 서버가 받지 않는 역할 (bottom/side2): 인코딩 + 보관만 =====
+    for (size_t i = 0; i < views.size(); ++i)
+    {
+        if (views[i].send) continue;
+        LetterboxGeometry geom;
+        std::string unused;
+        SendView(views[i], d.convertNs[i], geom, unused);
     }
+}
 
-    // ===== 데이터 전송 (sendall) =====
-    int totalSent = 0;
-    while (totalSent < fileSize) {
-        int chunk = min(64 * 1024, fileSize - totalSent); // 64KB 청크
-        int sent = send(sock, buffer.data() + totalSent, chunk, 0);
-        if (sent <= 0) {
-            OutputDebugString(L"[ERROR] 데이터 전송 실패\n");
-            closesocket(sock);
-            return false;
+// ===================== 검사 결과 처리 (UI 스레드) =====================
+LRESULT CCanClientDlg::OnInspectionDone(WPARAM, LPARAM lParam)
+{
+    std::unique_ptr<InspectionDone> d(reinterpret_cast<InspectionDone*>(lParam));
+    if (d->frontOk)
+    {
+        InspectionResult result;
+        result.productId = d->productId;
+        result.timestamp = GetCurrentTimestamp();
+
+        const bool parsed = !d->queued && ParseJsonResponse(d->frontResponse, d->topOk ? &d->geomTop : nullptr, d->geomFront, result);
+        StampResult(result, d->unit);
+        CStageTimer uiTimer(m_latency, Stage::UiUpdate);
+
+        if (d->queued) {
+            // 서버 없음 → 디스크 대기열. 판정은 재전송 후 이력에 (OnSpoolDelivered)
+            result.defectType = _T("대기");
+            result.defectDetail.Format(_T("서버 연결 안 됨, 대기열 %d건"), static_cast<int>(m_spool.Depth()));
+            UpdateCurrentResult(result);
+            OutputDebugString(L"[INFO] 오프라인 대기열에 저장\n");
+        }
+        else if (parsed) {
+            UpdateCurrentResult(result);
+            ShowDetectionOverlay(result, d->topOk, d->frontOk);
+            AddToHistory(result);
+            OutputDebugString(L"[SUCCESS] 검사 완료 및 결과 표시\n");
+        }
+        else {
+            // JSON 파싱 실패 → 원본 문자열 그대로 표시
+            OutputDebugStringA(("[WARNING] JSON 파싱 실패, 원본: " + d->frontResponse + "\n").c_str());
+            result.defectType = _T("에러");
+            result.defectDetail = BinaryReply::ExpectedSize(reinterpret_cast<const uint8_t*>(d->frontResponse.data()), d->frontResponse.size())
+                ? CString(_T("바이너리 응답 손상")) : Utf8ToCStr(d->frontResponse);
+            UpdateCurrentResult(result);
+            AddToHistory(result);
         }
-        totalSent += sent;
     }
-    OutputDebugString(L"[INFO] 이미지 전송 완료\n");
 
-    // ===== 응답 수신 =====
-    char recvBuf[4096] = { 0 };
-    int recvLen = recv(sock, recvBuf, sizeof(recvBuf) - 1, 0);
-
-    if (recvLen > 0) {
-        recvBuf[recvLen] = '\0';
-        response = std::string(recvBuf);
-        OutputDebugStringA(("[응답 수신] " + response + "\n").c_str());
-    }
-    else {
-        OutputDebugString(L"[WARNING] 응답 없음\n");
-        response.clear();
-    }
+    FinishInspection(d->startNs);
+    return 0;
+}
 
-    closesocket(sock);
-    return true;
+void CCanClientDlg::FinishInspection(uint64_t startNs)
+{
+    m_latency.Record(Stage::Total, NowNs() - startNs);
+    GetDlgItem(IDC_BTN_START)->EnableWindow(TRUE);
+    m_inspecting = false;
 }
 
-// ===================== JSON 파싱 (간단 버전) =====================
-bool CCanClientDlg::ParseJsonResponse(const std::string& jsonStr, InspectionResult& result)
+// ===================== 뷰 1장: BGR8 변환 (소요 ns 반환) =====================
+uint64_t CCanClientDlg::ConvertView(const CGrabResultPtr& grab, ImageBuffer& shot, ViewRequest& req)
 {
-    if (jsonStr.empty()) {
-        OutputDebugString(L"[ERROR] JSON 문자열이 비어있음\n");
-        return false;
+    const uint64_t start = NowNs();
+
+    // 변환 결과는 검사 후 오버레이 배경으로도 쓰므로 멤버 버퍼에 (매번 재사용)
+    // 합성기가 아직 이전 프레임을 읽는 중이면 끝날 때까지 대기 (보통 이미 끝나 있음)
+    m_compositor.WaitIdle();
+
+    // 아는 형식은 타일 파이프라인 (스레드 풀), 그 외는 Pylon 변환기가 같은 버퍼에 바로 씀
+    RawFrame raw;
+    const bool known = RawFrameFromGrab(grab, raw);
+    req.rawFormat = known ? static_cast<int>(raw.format) : -1;
+    if (!known || !ConvertToBgr(raw, shot, &m_tilePool)) {
+        shot.Allocate(static_cast<int>(grab->GetWidth()), static_cast<int>(grab->GetHeight()));
+        m_converter.Convert(shot.pixels.data(), shot.pixels.size(), grab); // BGR8
     }
 
-    try {
-        auto j = json::parse(jsonStr);
-
-        // result 필드 (필수)
-        if (j.contains("result")) {
-            std::string resultStr = j["result"].get<std::string>();
-            result.defectType = Utf8ToCStr(resultStr);
-
-            CStringA log;
-            log.Format("[JSON] result = %s\n", resultStr.c_str());
-            OutputDebugStringA(log);
-        }
-        else {
-            OutputDebugString(L"[ERROR] JSON에 'result' 필드 없음\n");
-            return false;
-        }
+    req.frame = shot.View();
+    return NowNs() - start;
+}
 
-        // reason 필드 (선택)
-        if (j.contains("reason")) {
-            std::string reasonStr = j["reason"].get<std::string>();
-            result.defectDetail = Utf8ToCStr(reasonStr);
+// ===================== 뷰 1장: 검사 코어 (크롭/레터박스 → 인코딩 → 전송) =====================
+bool CCanClientDlg::SendView(ViewRequest& req, uint64_t convertNs, LetterboxGeometry& geom, std::string& response,
+    bool* queued)
+{
+    // 선별 시간은 Convert 단계에서 빼고 변환 소요만 이어 붙임
+    req.convertStartNs = NowNs() - convertNs;
+
+    ViewOutcome out;
+    const bool ok = m_pipeline.ProcessView(req, out);
+    geom = out.geometry;
+    response = out.response;
+    if (queued)
+        *queued = out.queued;
+    return ok;
+}
 
-            CStringA log;
-            log.Format("[JSON] reason = %s\n", reasonStr.c_str());
-            OutputDebugStringA(log);
-        }
-        else {
-            result.defectDetail = _T("");
-        }
+// ===================== 오프라인 전송 대기열 =====================
+void CCanClientDlg::OpenSpool()
+{
+    const SpoolConfig& sc = m_config.spool;
+    if (!sc.enabled || !m_wsaInitialized)
+        return;
 
-        // timestamp 필드 (선택)
-        if (j.contains("timestamp")) {
-            std::string timestampStr = j["timestamp"].get<std::string>();
-            // 서버 timestamp 사용하려면:
-            // result.timestamp = CString(timestampStr.c_str());
-        }
+    std::string err;
+    if (!m_spool.Open(sc.path, static_cast<uint64_t>(sc.capacityMb) << 20, &err)) {
+        OutputDebugStringA(("[ERROR] 오프라인 대기열 열기 실패: " + err + "\n").c_str());
+        return;
+    }
+    const size_t backlog = m_spool.Depth();
+    if (backlog)
+        OutputDebugStringA(("[INFO] 오프라인 대기열 " + std::to_string(backlog) + "건 남음, 재전송 시작\n").c_str());
+
+    // 작업자 스레드 → UI 스레드. 판정은 SIDE 응답에만 있으므로 그것만 넘김.
+    // det_top 좌표용으로 TOP 헤더의 레터박스를 단위 키로 잠깐 들고 있음 (TOP 은 같은 단위 SIDE 보다 먼저 전달됨).
+    // 재시작 전에 TOP 이 나간 단위는 모르므로 TOP 검출을 비움 (지금 화면 기준으로 잘못 옮기지 않음).
+    struct TopGeoms
+    {
+        static constexpr size_t kMax = 64;     // 동시 전송 단위 수보다 넉넉히
+        std::mutex mutex;
+        std::deque<std::pair<RequestHeader::UnitId, LetterboxGeometry>> items;
+    };
+    auto topGeoms = std::make_shared<TopGeoms>();
+
+    const HWND hwnd = GetSafeHwnd();
+    m_spool.SetEndpointPool(&m_endpoints);
+    m_spool.StartDrain(m_config.server, sc.concurrency, sc.retryMs,
+        [hwnd, topGeoms](const RequestHeader::Fields& meta, const std::string& response) {
+            if (!meta.hasRole)
+                return;
+            const RequestHeader::UnitId unit = RequestHeader::UnitOf(meta);
+            if (meta.role == CameraRole::Top) {
+                if (response.empty())
+                    return;
+                std::lock_guard<std::mutex> lock(topGeoms->mutex);
+                if (topGeoms->items.size() >= TopGeoms::kMax)
+                    topGeoms->items.pop_front();
+                topGeoms->items.emplace_back(unit, meta.geometry);
+                return;
+            }
+            if (meta.role != CameraRole::Front)
+                return;
+            auto* d = new SpoolDelivery;
+            d->geomFront = meta.geometry;
+            {
+                std::lock_guard<std::mutex> lock(topGeoms->mutex);
+                auto& items = topGeoms->items;
+                auto it = std::find_if(items.begin(), items.end(), [&](const auto& e) { return e.first == unit; });
+                if (it != items.end()) {
+                    d->geomTop = it->second;
+                    d->topGeomKnown = true;
+                    items.erase(it);
+                }
+            }
+            d->productId = meta.productId.data();
+            d->captureUs = meta.captureUs;
+            if (meta.frameCounter != RequestHeader::kNoFrameCounter)
+                d->frameCounter = meta.frameCounter;
+            d->response = response;
+            if (!::PostMessage(hwnd, WM_SPOOL_DELIVERED, 0, reinterpret_cast<LPARAM>(d)))
+                delete d;
+        });
+    m_pipeline.SetSpool(&m_spool);
+}
 
-        return true;
+// 대기열에서 늦게 보낸 캔의 판정 → 이력 (현재 결과 칸은 지금 검사 중인 캔 몫이라 건드리지 않음)
+LRESULT CCanClientDlg::OnSpoolDelivered(WPARAM, LPARAM lParam)
+{
+    std::unique_ptr<SpoolDelivery> d(reinterpret_cast<SpoolDelivery*>(lParam));
+
+    InspectionResult result;
+    result.productId = Utf8ToCStr(d->productId);
+    result.timestamp = GetCurrentTimestamp();
+    result.frameCounter = d->frameCounter;
+    if (d->captureUs > 0) {
+        const int64_t ms = d->captureUs / 1000;
+        const CTime t(static_cast<time_t>(ms / 1000));
+        result.captureTime.Format(_T("%s.%03d"), t.Format(_T("%Y-%m-%d %H:%M:%S")).GetString(), static_cast<int>(ms % 1000));
     }
-    catch (json::parse_error& e) {
-        CStringA errMsg;
-        errMsg.Format("[ERROR] JSON 파싱 실패: %s\n", e.what());
-        OutputDebugStringA(errMsg);
-        return false;
+    if (d->response.empty()) {
+        // 대기열이 버린 SIDE: TOP 을 받은 서버를 몰라 다른 서버로 보내지 않음
+        result.defectType = _T("에러");
+        result.defectDetail = _T("TOP 받은 서버 알 수 없음 (대기열에서 버림)");
     }
-    catch (json::type_error& e) {
-        CStringA errMsg;
-        errMsg.Format("[ERROR] JSON 타입 에러: %s\n", e.what());
-        OutputDebugStringA(errMsg);
-        return false;
+    else {
+        if (!ParseJsonResponse(d->response, d->topGeomKnown ? &d->geomTop : nullptr, d->geomFront, result)) {
+            result.defectType = _T("에러");
+            result.defectDetail = Utf8ToCStr(d->response);
+        }
+        result.defectDetail += _T(" (대기열 재전송)");
     }
-    catch (std::exception& e) {
-        CStringA errMsg;
-        errMsg.Format("[ERROR] JSON 예외: %s\n", e.what());
-        OutputDebugStringA(errMsg);
+    AddToHistory(result);
+    return 0;
+}
+
+// ===================== 응답 파싱 (검사 코어) =====================
+bool CCanClientDlg::ParseJsonResponse(const std::string& jsonStr, const LetterboxGeometry* geomTop,
+    const LetterboxGeometry& geomFront, InspectionResult& result)
+{
+    InspectionReply reply;
+    if (!m_pipeline.ParseReply(jsonStr, reply))
         return false;
-    }
+
+    result.defectType = Utf8ToCStr(reply.result.View());
+    result.defectDetail = Utf8ToCStr(reply.reason.View());
+    if (geomTop)
+        MapDetectionsToSensor(reply.top, *geomTop, result.detTop);
+    else
+        result.detTop.Clear();
+    MapDetectionsToSensor(reply.side, geomFront, result.detFront);
+    // 서버 timestamp 사용하려면:
+    // result.timestamp = Utf8ToCStr(reply.timestamp.View());
+
+    CStringA dbg;
+    if (reply.binary)
+        dbg.Format("[REPLY] result = %s, reason = %s, server %.1f ms (AI %.1f ms)\n",
+            reply.result.c_str(), reply.reason.c_str(), reply.serverUs / 1e3, reply.aiUs / 1e3);
+    else
+        dbg.Format("[JSON] result = %s, reason = %s, det %u/%u\n", reply.result.c_str(), reply.reason.c_str(),
+            static_cast<unsigned>(reply.top.count), static_cast<unsigned>(reply.side.count));
+    OutputDebugStringA(dbg);
+    return true;
 }
 
 // ===================== UI 업데이트 =====================
@@ -497,6 +957,43 @@ void CCanClientDlg::UpdateCurrentResult(const InspectionResult& result)
     }
 }
 
+// ===================== 단계별 지연 표 =====================
+void CCanClientDlg::UpdateLatencyView()
+{
+    // 에디트 컨트롤은 CRLF 줄바꿈
+    std::string report = m_latency.Report();
+    if (m_camerasReady)
+        report += "\n" + m_station.StatusReport();   // 카메라별 크기/형식/프레임당 바이트/fps
+    report += m_endpoints.Report();                  // 서버별 상태/진행 중/처리 시간
+    if (m_spool.IsOpen())
+        report += FormatSpoolStatus(m_spool.GetStatus(), SteadyToUnixMs(NowNs()));
+    std::string text;
+    text.reserve(report.size() + 16);
+    for (char c : report) {
+        if (c == '\n') text += '\r';
+        text += c;
+    }
+    SetDlgItemText(IDC_EDIT_LATENCY, Utf8ToCStr(text));
+
+    // ===== 주기 로그 (구간 통계) =====
+    const int interval = m_config.latency.logIntervalSec;
+    if (interval <= 0 || ++m_latencyLogElapsed < interval)
+        return;
+    m_latencyLogElapsed = 0;
+
+    std::string block = "[LATENCY] " + std::string(CT2A(GetCurrentTimestamp(), CP_UTF8)) +
+        " (최근 " + std::to_string(interval) + "초)\n" + m_latency.IntervalReport();
+    if (m_camerasReady)
+        block += m_station.StatusReport();   // 누적 그랩 계수 (건너뜀/불완전/실패/재전송)
+    block += m_endpoints.Report();           // 서버별 보낸/실패 누적, 마지막 오류
+    if (m_spool.IsOpen())
+        block += FormatSpoolStatus(m_spool.GetStatus(), SteadyToUnixMs(NowNs()));
+    OutputDebugStringA(block.c_str());
+
+    std::ofstream log("C:\\CanClient\\latency.log", std::ios::app);
+    log << block << "\n";
+}
+
 // ===================== 현재 결과 초기화 =====================
 void CCanClientDlg::ClearCurrentResult()
 {
@@ -567,6 +1064,33 @@ CString CCanClientDlg::GenerateProductId()
     return productId;
 }
 
+// ===================== 번호 저장/로드 =====================
+// counter.txt: "다음 제품번호 마지막 단위 번호" 한 줄. 없거나 깨졌으면 기본값 그대로.
+void CCanClientDlg::LoadCounters()
+{
+    std::ifstream in("C:\\CanClient\\counter.txt");
+    int product = 0;
+    unsigned long long sequence = 0;
+    if (in >> product >> sequence) {
+        m_productCounter = (std::max)(m_productCounter, product);
+        m_unitSequence = (std::max)(m_unitSequence, static_cast<uint64_t>(sequence));
+    }
+}
+
+void CCanClientDlg::SaveCounters()
+{
+    // 임시 파일에 쓰고 교체 (쓰는 도중 꺼져도 이전 값은 남음)
+    const char* path = "C:\\CanClient\\counter.txt";
+    const char* temp = "C:\\CanClient\\counter.tmp";
+    {
+        std::ofstream out(temp, std::ios::trunc);
+        out << m_productCounter << ' ' << m_unitSequence << '\n';
+        if (!out.flush())
+            return;
+    }
+    MoveFileExA(temp, path, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+}
+
 CString CCanClientDlg::GetCurrentTimestamp()
 {
     CTime now = CTime::GetCurrentTime();
@@ -587,11 +1111,16 @@ void CCanClientDlg::SaveHistoryToFile()
 
     for (const auto& rec : m_history) {
         CString line;
-        line.Format(_T("%s|%s|%s|%s\n"),
+        // 5~8번째: 촬영 시각 | 프레임 번호 | 트리거 수 | 노출→결과 ms (없으면 - / -1)
+        line.Format(_T("%s|%s|%s|%s|%s|%lld|%lld|%.1f\n"),
             rec.productId.GetString(),
             rec.defectType.GetString(),
             (rec.defectDetail.IsEmpty() ? _T("-") : rec.defectDetail.GetString()),
-            rec.timestamp.GetString());
+            rec.timestamp.GetString(),
+            (rec.captureTime.IsEmpty() ? _T("-") : rec.captureTime.GetString()),
+            static_cast<long long>(rec.frameCounter),
+            static_cast<long long>(rec.triggerCounter),
+            rec.endToEndMs);
         file.WriteString(line);
     }
     file.Close();
@@ -643,6 +1172,16 @@ void CCanClientDlg::LoadHistoryFromFile()
         if (rec.defectDetail == _T("-"))
             rec.defectDetail.Empty();
 
+        // 이전 형식(4필드)도 그대로 읽음
+        if (tokens.size() >= 8) {
+            rec.captureTime = tokens[4].Trim();
+            if (rec.captureTime == _T("-"))
+                rec.captureTime.Empty();
+            rec.frameCounter = _ttoi64(tokens[5].Trim());
+            rec.triggerCounter = _ttoi64(tokens[6].Trim());
+            rec.endToEndMs = _tstof(tokens[7].Trim());
+        }
+
         if (!rec.productId.IsEmpty())
         {
             m_history.push_back(rec);
@@ -660,26 +1199,49 @@ void CCanClientDlg::LoadHistoryFromFile()
         }
     }
 
-    m_productCounter = maxId + 1;
+    m_productCounter = (std::max)(m_productCounter, maxId + 1);   // counter.txt 값보다 뒤로 가지 않게
     file.Close();
 }
 
 // ===================== 종료 =====================
 void CCanClientDlg::OnDestroy()
 {
+    // 전송 스레드: 보내는 중이면 끊고 기다림 (그 캔은 대기열에도 남지 않음), 못 받은 결과 메시지는 버림
+    m_sendCancel = true;
+    if (m_sendThread.joinable())
+        m_sendThread.join();
+    MSG msg;
+    while (::PeekMessage(&msg, GetSafeHwnd(), WM_INSPECTION_DONE, WM_INSPECTION_DONE, PM_REMOVE))
+        delete reinterpret_cast<InspectionDone*>(msg.lParam);
+
+    // 대기열 작업자가 창에 메시지를 보내지 않게 먼저 멈춤 (남은 건 파일에, 다음 실행 때 이어서)
+    m_pipeline.SetSpool(nullptr);
+    m_spool.Close();
+    m_pipeline.SetEndpointPool(nullptr);
+    m_endpoints.StopProbes();
+
+    // 합성 중인 프레임(m_shots)을 놓기 전에 작업자를 멈춤
+    m_compositor.SetReadyCallback(nullptr);
+    m_compositor.WaitIdle();
+    if (m_previewDlg.GetSafeHwnd())
+        m_previewDlg.DestroyWindow();
+
     CDialogEx::OnDestroy();
 
     if (m_timerId) {
         KillTimer(m_timerId);
         m_timerId = 0;
     }
+    KillTimer(2);
+
+    // 기동 중에 닫히면 열기가 끝날 때까지 기다린 뒤 정리
+    if (m_startupThread.joinable())
+        m_startupThread.join();
 
     try {
-        if (m_camTop.IsGrabbing())   m_camTop.StopGrabbing();
-        if (m_camTop.IsOpen())       m_camTop.Close();
-        if (m_camFront.IsGrabbing()) m_camFront.StopGrabbing();
-        if (m_camFront.IsOpen())     m_camFront.Close();
-        PylonTerminate();
+        m_station.Close();
+        if (m_pylonInitialized)
+            PylonTerminate();
     }
     catch (...) {}
 
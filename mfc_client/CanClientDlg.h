@@ -1,17 +1,82 @@
 ﻿#pragma once
 #include <pylon/PylonIncludes.h>
+#include <array>
+#include <atomic>
+#include <memory>
 #include <vector>
 #include <string>
+#include <thread>
+
+#include "ClientConfig.h"
+#include "FrameConvert.h"
+#include "InspectionCore.h"
+#include "LatencyStats.h"
+#include "OverlayCompositor.h"
+#include "PresenceDetector.h"
+#include "Preprocess.h"
+#include "PreviewDlg.h"
+#include "RequestHeader.h"
+#include "StationCameras.h"
+#include "ThreadPool.h"
 
 using namespace Pylon;
 
+// 합성기 완료 알림 (wParam = 슬롯)
+constexpr UINT WM_OVERLAY_READY = WM_APP + 1;
+// 카메라 기동 진행 (wParam = 슬롯, lParam = 1 열림 / 0 실패), 완료 (wParam = 1 성공 / 0 실패)
+constexpr UINT WM_STATION_SLOT = WM_APP + 2;
+constexpr UINT WM_STATION_READY = WM_APP + 3;
+// 오프라인 대기열에서 늦게 보낸 요청의 응답 (lParam = SpoolDelivery*, 받는 쪽이 delete)
+constexpr UINT WM_SPOOL_DELIVERED = WM_APP + 4;
+// 전송 스레드가 검사 1건을 끝냄 (lParam = InspectionDone*, 받는 쪽이 delete)
+constexpr UINT WM_INSPECTION_DONE = WM_APP + 5;
+
+struct SpoolDelivery
+{
+    std::string productId;          // 요청 헤더 v3 (촬영 때 정한 제품번호)
+    int64_t     captureUs = 0;
+    int64_t     frameCounter = -1;
+    std::string response;
+
+    // 검출 좌표 변환: 전송 당시 레터박스 (지금 화면의 캔과 다를 수 있음)
+    LetterboxGeometry geomFront;    // SIDE 요청 헤더
+    LetterboxGeometry geomTop;      // 같은 단위 TOP 요청 헤더 (이번 실행에서 보냈을 때만)
+    bool              topGeomKnown = false;
+};
+
 // ===== 검사 결과 구조체 =====
 struct InspectionResult
 {
     CString productId;      // 제품번호
     CString defectType;     // 판정결과 ("정상" / "불량" / "에러")
     CString defectDetail;   // 불량종류
-    CString timestamp;      // 시간
+    CString timestamp;      // 시간 (응답 수신)
+
+    // 촬영 시각 (카메라 청크 타임스탬프 → 호스트 시계), PLC 이벤트 대조용
+    CString captureTime;            // "YYYY-MM-DD HH:MM:SS.mmm", 비어 있으면 없음
+    int64_t frameCounter = -1;      // 카메라 프레임 번호 (-1 = 없음)
+    int64_t triggerCounter = -1;    // 카메라가 받은 트리거 수
+    double  endToEndMs = -1.0;      // 노출 → 결과 표시 (ms, < 0 = 시계 미보정)
+
+    // AI 검출 (센서 좌표, 미리보기 오버레이용)
+    ViewDetections detTop;
+    ViewDetections detFront;
+};
+
+// ===== 전송 스레드에 넘기는 검사 1건 (촬영/변환은 UI 스레드에서 끝난 상태) =====
+struct InspectionDone
+{
+    uint64_t              startNs = 0;      // RunInspection 시작 (Total 단계)
+    CString               productId;
+    InspectionUnit        unit;             // 뷰 프레임은 m_shots 를 가리킴 (결과 처리까지 다음 촬영 없음)
+    std::vector<uint64_t> convertNs;        // unit.views 와 같은 순서
+    int                   iTop = -1, iFront = -1;
+    bool                  topOk = false, frontOk = false;   // 서버로 보낼 뷰 (로컬 선별 정상이면 둘 다 false)
+
+    // 전송 스레드가 채움
+    std::string           topResponse, frontResponse;
+    bool                  queued = false;   // FRONT 가 오프라인 대기열로
+    LetterboxGeometry     geomTop, geomFront;
 };
 
 class CCanClientDlg : public CDialogEx
@@ -28,21 +93,61 @@ protected:
     virtual BOOL OnInitDialog();
     afx_msg void OnDestroy();
     afx_msg void OnBnClickedBtnStart();
+    afx_msg void OnBnClickedChkAuto();
     afx_msg void OnTimer(UINT_PTR nIDEvent);
+    afx_msg LRESULT OnOverlayReady(WPARAM wParam, LPARAM lParam);
+    afx_msg LRESULT OnStationSlot(WPARAM wParam, LPARAM lParam);
+    afx_msg LRESULT OnStationReady(WPARAM wParam, LPARAM lParam);
+    afx_msg LRESULT OnSpoolDelivered(WPARAM wParam, LPARAM lParam);
+    afx_msg LRESULT OnInspectionDone(WPARAM wParam, LPARAM lParam);
     DECLARE_MESSAGE_MAP()
 
 private:
     HICON m_hIcon;
 
-    // ===== 카메라 =====
-    CInstantCamera        m_camTop;
-    CInstantCamera        m_camFront;
-    CImageFormatConverter m_converter;   // BGR8 변환용
-    CPylonImage           m_pylonImage;  // 미리보기 공유 버퍼
+    // ===== 카메라 (검사 스테이션 N대, 시리얼 → 역할) =====
+    CStationCameras       m_station;
+    std::thread           m_startupThread;    // PylonInitialize + 병렬 열기 (다이얼로그는 먼저 표시)
+    StationStartup        m_startup;          // 단계별 기동 시간 (기동 스레드가 채우고 READY 후 읽음)
+    std::string           m_startupError;
+    bool                  m_pylonInitialized = false;
+    bool                  m_camerasReady = false;   // READY 전에는 m_station 을 건드리지 않음
+    size_t                m_slotsOpened = 0;
+    CImageFormatConverter m_converter;   // BGR8 변환용 (FrameConvert 가 모르는 픽셀 형식만)
+    CPylonImage           m_pylonImage;  // 미리보기 공유 버퍼 (Pylon 변환기 경로)
+    CThreadPool           m_tilePool;    // 변환/미리보기 타일 작업자
+    ImageBuffer           m_previewTop;  // 라이브 미리보기 (컨트롤 크기, 변환 + 축소 한 번에)
+    ImageBuffer           m_previewFront;
+    std::vector<ImageBuffer> m_shots;    // 슬롯별 마지막 검사 프레임 (BGR8, 전송 + 오버레이 공용, 열 때 크기 고정)
+    ULONGLONG             m_overlayUntil = 0;   // 이 시각까지 라이브 미리보기 대신 오버레이 유지
     UINT_PTR              m_timerId = 0;
 
+    // ===== 연속 검사 (캔 감지 자동 트리거) =====
+    ClientConfig      m_config;
+    CPresenceDetector m_presence;
+    int               m_presencePreviewW = 0;   // 감지 간격을 환산한 미리보기 너비
+    bool              m_autoMode = false;
+    bool              m_inspecting = false;
+
+    // ===== 결과 오버레이 창 (top/front 의 m_shots 를 빌려 작업자 스레드에서 합성) =====
+    COverlayCompositor m_compositor;
+    CPreviewDlg        m_previewDlg;
+    ImageBuffer        m_overlaySpare;   // Present 와 맞바꾸는 재사용 버퍼
+
     // ===== 네트워크 =====
     bool m_wsaInitialized = false;
+    CEndpointPool  m_endpoints;          // 검사 서버 풀 (상태 확인 + 최소 부하 분배), 대기열보다 먼저 선언 (나중에 소멸)
+    COutboundQueue m_spool;              // 서버에 못 보낸 요청 (디스크), 작업자가 서버 복구 후 재전송
+    std::thread       m_sendThread;      // 검사 1건의 인코딩/전송 (RunInspection → WM_INSPECTION_DONE)
+    std::atomic<bool> m_sendCancel{ false };   // 닫을 때 보내는 중인 요청을 바로 끝냄
+
+    // ===== 단계별 지연 계측 =====
+    CLatencyStats m_latency;
+    CFont         m_monoFont;            // 지연 표 (고정폭)
+    int           m_latencyLogElapsed = 0;
+
+    // ===== 검사 코어 (전처리 → 인코딩 → 전송, 헤드리스 도구와 공용) =====
+    CInspectionPipeline m_pipeline{ m_latency };
 
     // ===== UI 컨트롤 =====
     CListCtrl m_historyList;
@@ -50,12 +155,35 @@ private:
     // ===== 데이터 =====
     std::vector<InspectionResult> m_history;
     int m_productCounter = 1012; // CK1012부터 시작
+    uint64_t m_unitSequence = 0; // 검사 단위 번호 (스테이션 그랩 1회 = 1)
+    // 두 번호는 counter.txt 로 실행 간 이어짐 (히스토리는 시작 때 비우므로 거기서 못 구함).
+    // 재시작 후 대기열에서 다시 보내는 지난 단위와 새 단위의 "제품번호#단위 번호" 가 겹치지 않게.
 
     // ===== 헬퍼 함수 =====
-    void DrawImageBufferToCtrl(const uint8_t* data, int width, int height, CWnd* pWnd);
+    void DrawImageBufferToCtrl(const uint8_t* data, int width, int height, CWnd* pWnd,
+        const ViewDetections* detections = nullptr);
+    void ShowDetectionOverlay(const InspectionResult& result, bool top, bool front);
+    const ImageBuffer* ShotOf(CameraRole role) const;   // 역할의 마지막 검사 프레임 (없으면 nullptr)
+    void StampResult(InspectionResult& result, const InspectionUnit& unit);   // 촬영 시각/계수기 + e2e 지연 기록
+
+    // 카메라 기동 (백그라운드 스레드, 진행/완료는 WM_STATION_*)
+    void StartCameras();
+
+    // 촬영(스테이션 전체 동시) → 저장 → 전송 → 결과 반영
+    // 촬영/변환은 UI 스레드, 인코딩/전송은 전송 스레드 → WM_INSPECTION_DONE 에서 결과 반영
+    void RunInspection(bool autoTriggered);
+    void StartSend(std::unique_ptr<InspectionDone> job);
+    void SendUnit(InspectionDone& d);          // 전송 스레드
+    void FinishInspection(uint64_t startNs);   // 다음 촬영 허용
+    void SetAutoMode(bool enable);
 
     // 네트워크 (응답 포함)
-    bool SendImageToServer(const std::string& imgPath, std::string& response);
+    uint64_t ConvertView(const CGrabResultPtr& grab, ImageBuffer& shot, ViewRequest& req);
+    bool PreviewGrab(const CGrabResultPtr& grab, CWnd* pWnd, ImageBuffer& preview);
+    void UpdatePresenceScale(int sensorW, int previewW);
+    bool SendView(ViewRequest& req, uint64_t convertNs, LetterboxGeometry& geom, std::string& response,
+        bool* queued = nullptr);
+    void OpenSpool();
 
     // UI 업데이트
     void InitHistoryList();
@@ -63,6 +191,7 @@ private:
     void AddToHistory(const InspectionResult& result);
     void ClearCurrentResult();
     void UpdateStatistics();
+    void UpdateLatencyView();
 
     // 히스토리 관리
     void LoadHistoryFromFile();
@@ -70,8 +199,12 @@ private:
 
     // 유틸리티
     CString GenerateProductId();
+    void LoadCounters();
+    void SaveCounters();
     CString GetCurrentTimestamp();
 
-    // JSON 파싱 (간단 버전)
-    bool ParseJsonResponse(const std::string& json, InspectionResult& result);
+    // JSON 파싱 (간단 버전). 검출 좌표는 요청을 보낼 때의 레터박스로 센서 좌표로 되돌림
+    // (geomTop 이 null 이면 TOP 검출은 비워 둠)
+    bool ParseJsonResponse(const std::string& json, const LetterboxGeometry* geomTop,
+        const LetterboxGeometry& geomFront, InspectionResult& result);
 };
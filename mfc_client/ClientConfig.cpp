@@ -0,0 +1,275 @@
+﻿#include "ClientConfig.h"
+#include <fstream>
+#include <stdexcept>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// ===================== 섹션별 로더 =====================
+static void LoadPresence(const json& j, PresenceConfig& p)
+{
+    p.bandTop         = j.value("band_top", p.bandTop);
+    p.bandBottom      = j.value("band_bottom", p.bandBottom);
+    p.sampleStep      = j.value("sample_step", p.sampleStep);
+    p.columns         = j.value("columns", p.columns);
+    p.diffThreshold   = j.value("diff_threshold", p.diffThreshold);
+    p.minCoverage     = j.value("min_coverage", p.minCoverage);
+    p.centreTolerance = j.value("centre_tolerance", p.centreTolerance);
+    p.backgroundAlpha = j.value("background_alpha", p.backgroundAlpha);
+    p.rearmFrames     = j.value("rearm_frames", p.rearmFrames);
+}
+
+static void LoadRoi(const json& j, RoiRect& r)
+{
+    // [x, y, w, h]
+    if (!j.is_array() || j.size() != 4) return;
+    r.x = j[0].get<int>();
+    r.y = j[1].get<int>();
+    r.width = j[2].get<int>();
+    r.height = j[3].get<int>();
+}
+
+static void LoadPreprocess(const json& j, PreprocessConfig& p)
+{
+    p.enabled    = j.value("enabled", p.enabled);
+    p.inputSize  = j.value("input_size", p.inputSize);
+    p.sendHeader = j.value("send_header", p.sendHeader);
+    p.sideEnhance = j.value("side_enhance", p.sideEnhance);
+    p.sideEnhanceThreads = j.value("side_enhance_threads", p.sideEnhanceThreads);
+    if (j.contains("roi")) {
+        const json& roi = j["roi"];
+        if (roi.contains("top"))   LoadRoi(roi["top"], p.roiTop);
+        if (roi.contains("front")) LoadRoi(roi["front"], p.roiFront);
+    }
+}
+
+static void LoadEncoder(const json& j, EncoderConfig& e)
+{
+    const std::string codec = j.value("codec", std::string(e.autoSelect ? "auto" : CodecName(e.codec)));
+    e.autoSelect = (codec == "auto");
+    if (!e.autoSelect && !ParseCodecName(codec, e.codec))
+        throw std::runtime_error("unknown encoder.codec: " + codec);
+
+    e.jpegQuality = j.value("jpeg_quality", e.jpegQuality);
+    e.pngThreads  = j.value("png_threads", e.pngThreads);
+    e.archive     = j.value("archive", e.archive);
+    e.archivePng  = j.value("archive_png", e.archivePng);
+
+    CodecSelectorConfig& s = e.selector;
+    s.probeInterval = j.value("probe_interval", s.probeInterval);
+    if (j.contains("link_mbps"))
+        s.initialBandwidth = j["link_mbps"].get<double>() * 1e6 / 8;
+    if (j.contains("candidates")) {
+        s.candidates.clear();
+        for (const auto& c : j["candidates"]) {
+            ImageCodec codecId;
+            if (!ParseCodecName(c.get<std::string>(), codecId))
+                throw std::runtime_error("unknown encoder candidate: " + c.get<std::string>());
+            s.candidates.push_back(codecId);
+        }
+    }
+    if (j.contains("decode_ns_per_pixel")) {
+        for (const auto& item : j["decode_ns_per_pixel"].items()) {
+            ImageCodec codecId;
+            if (ParseCodecName(item.key(), codecId))
+                s.decodeNsPerPixel[static_cast<size_t>(codecId)] = item.value().get<double>();
+        }
+    }
+}
+
+static void LoadServer(const json& j, ServerEndpoint& s)
+{
+    s.host = j.value("host", s.host);
+    s.port = j.value("port", s.port);
+
+    const std::string reply = j.value("reply_format", std::string(s.replyFormat == ReplyFormat::Binary ? "binary" : "json"));
+    if (reply == "json")        s.replyFormat = ReplyFormat::Json;
+    else if (reply == "binary") s.replyFormat = ReplyFormat::Binary;
+    else throw std::runtime_error("unknown server.reply_format: " + reply);
+
+    s.timeouts.connectMs = j.value("connect_timeout_ms", s.timeouts.connectMs);
+    s.timeouts.sendMs    = j.value("send_timeout_ms", s.timeouts.sendMs);
+    s.timeouts.replyMs   = j.value("reply_timeout_ms", s.timeouts.replyMs);
+}
+
+static void LoadPool(const json& j, EndpointPoolConfig& p)
+{
+    if (j.contains("endpoints")) {
+        p.endpoints.clear();
+        for (const json& e : j["endpoints"])
+        {
+            ServerEndpoint s;
+            s.host = e.value("host", s.host);
+            s.port = e.value("port", s.port);
+            if (s.host.empty() || s.port <= 0 || s.port > 65535)
+                throw std::runtime_error("bad server.endpoints entry: " + e.dump());
+            p.endpoints.push_back(s);
+        }
+    }
+    p.probeIntervalMs = j.value("probe_interval_ms", p.probeIntervalMs);
+    p.probeTimeoutMs  = j.value("probe_timeout_ms", p.probeTimeoutMs);
+    p.failThreshold   = j.value("fail_threshold", p.failThreshold);
+}
+
+static void LoadLatency(const json& j, LatencyConfig& l)
+{
+    l.logIntervalSec = j.value("log_interval_sec", l.logIntervalSec);
+}
+
+static void LoadOverlay(const json& j, OverlayConfig& o)
+{
+    o.enabled  = j.value("enabled", o.enabled);
+    o.holdMs   = j.value("hold_ms", o.holdMs);
+    o.minScore = j.value("min_score", o.minScore);
+    o.previewWindow = j.value("preview_window", o.previewWindow);
+}
+
+static void LoadScreen(const json& j, ScreenConfig& s)
+{
+    s.enabled    = j.value("enabled", s.enabled);
+    s.modelTop   = j.value("model_top", s.modelTop);
+    s.modelFront = j.value("model_front", s.modelFront);
+    s.passBelow  = j.value("pass_below", s.passBelow);
+}
+
+static void LoadCameraProfile(const json& j, CameraProfile& p)
+{
+    p.exposureUs       = j.value("exposure_us", p.exposureUs);
+    p.gainDb           = j.value("gain_db", p.gainDb);
+    p.binning          = j.value("binning", p.binning);
+    p.pixelFormat      = j.value("pixel_format", p.pixelFormat);
+    p.packetSize       = j.value("packet_size", p.packetSize);
+    p.interPacketDelay = j.value("inter_packet_delay", p.interPacketDelay);
+    p.frameRate        = j.value("frame_rate", p.frameRate);
+    if (j.contains("sensor_roi"))
+        LoadRoi(j["sensor_roi"], p.sensorRoi);
+    if (p.binning != 0 && p.binning != 1 && p.binning != 2 && p.binning != 4)
+        throw std::runtime_error("camera profile binning must be 1, 2 or 4");
+}
+
+static void LoadGrabStrategy(const json& j, const char* key, GrabStrategyKind& out)
+{
+    if (!j.contains(key))
+        return;
+    const std::string name = j[key].get<std::string>();
+    if (!ParseGrabStrategy(name, out))
+        throw std::runtime_error(std::string("unknown station.grab.") + key + ": " + name);
+}
+
+static void LoadStation(const json& j, StationConfig& st)
+{
+    st.grabTimeoutMs = j.value("grab_timeout_ms", st.grabTimeoutMs);
+    if (j.contains("grab")) {
+        const json& g = j["grab"];
+        LoadGrabStrategy(g, "preview_strategy", st.previewStrategy);
+        LoadGrabStrategy(g, "inspection_strategy", st.inspectionStrategy);
+        st.maxNumBuffer = g.value("max_num_buffer", st.maxNumBuffer);
+        st.outputQueueSize = g.value("output_queue_size", st.outputQueueSize);
+    }
+    st.chunks = j.value("chunks", st.chunks);
+    st.clockCalibrationS = j.value("clock_calibration_s", st.clockCalibrationS);
+    if (!j.contains("cameras"))
+        return;
+
+    // 이름 붙인 프로파일 (카메라 여러 대가 같은 설정을 쓸 때)
+    const json profiles = j.value("profiles", json::object());
+
+    // [{ "role": "top", "serial": "40012345", "roi": [x, y, w, h] }, ...] — 배열 순서 = 슬롯 순서
+    st.cameras.clear();
+    for (const json& c : j["cameras"])
+    {
+        StationCamera cam;
+        const std::string role = c.value("role", std::string());
+        if (!ParseCameraRole(role, cam.role))
+            throw std::runtime_error("unknown station camera role: " + role);
+        cam.serial = c.value("serial", cam.serial);
+        if (c.contains("roi"))
+            LoadRoi(c["roi"], cam.roi);
+        cam.sensorCrop = c.value("sensor_crop", cam.sensorCrop);
+        if (c.contains("preview_roi"))
+            LoadRoi(c["preview_roi"], cam.previewRoi);
+        if (c.contains("profile"))
+        {
+            // "profile": "이름" (station.profiles) 또는 객체
+            const json& p = c["profile"];
+            if (p.is_string()) {
+                const std::string name = p.get<std::string>();
+                if (!profiles.contains(name))
+                    throw std::runtime_error("unknown camera profile: " + name);
+                LoadCameraProfile(profiles[name], cam.profile);
+            }
+            else LoadCameraProfile(p, cam.profile);
+        }
+        st.cameras.push_back(cam);
+    }
+
+    std::string why;
+    if (!ValidateStation(st, &why))
+        throw std::runtime_error("station: " + why);
+}
+
+static void LoadSpool(const json& j, SpoolConfig& s)
+{
+    s.enabled     = j.value("enabled", s.enabled);
+    s.path        = j.value("path", s.path);
+    s.capacityMb  = j.value("capacity_mb", s.capacityMb);
+    s.concurrency = j.value("concurrency", s.concurrency);
+    s.retryMs     = j.value("retry_ms", s.retryMs);
+    if (s.capacityMb < 1)
+        throw std::runtime_error("spool.capacity_mb must be at least 1");
+}
+
+// top/front 카메라에 ROI 가 없으면 preprocess.roi 를 그대로 (기존 설정 호환)
+static void InheritStationRoi(StationConfig& st, const PreprocessConfig& pp)
+{
+    for (StationCamera& cam : st.cameras)
+    {
+        if (!cam.roi.IsEmpty()) continue;
+        if (cam.role == CameraRole::Top)   cam.roi = pp.roiTop;
+        if (cam.role == CameraRole::Front) cam.roi = pp.roiFront;
+    }
+}
+
+// ===================== 설정 파일 로드 =====================
+bool LoadClientConfig(const std::string& path, ClientConfig& cfg, std::string* error)
+{
+    std::ifstream in(path);
+    if (!in) {
+        if (error) *error = "config file not found: " + path;
+        return false;
+    }
+
+    try {
+        json j = json::parse(in, nullptr, true, true); // 주석 허용
+
+        cfg.autoStart = j.value("auto_start", cfg.autoStart);
+        if (j.contains("server"))
+        {
+            LoadServer(j["server"], cfg.server);
+            LoadPool(j["server"], cfg.pool);
+        }
+        if (j.contains("presence"))
+            LoadPresence(j["presence"], cfg.presence);
+        if (j.contains("preprocess"))
+            LoadPreprocess(j["preprocess"], cfg.preprocess);
+        if (j.contains("encoder"))
+            LoadEncoder(j["encoder"], cfg.encoder);
+        if (j.contains("latency"))
+            LoadLatency(j["latency"], cfg.latency);
+        if (j.contains("overlay"))
+            LoadOverlay(j["overlay"], cfg.overlay);
+        if (j.contains("screen"))
+            LoadScreen(j["screen"], cfg.screen);
+        if (j.contains("station"))
+            LoadStation(j["station"], cfg.station);
+        if (j.contains("spool"))
+            LoadSpool(j["spool"], cfg.spool);
+        InheritStationRoi(cfg.station, cfg.preprocess);
+
+        return true;
+    }
+    catch (const std::exception& e) {
+        if (error) *error = e.what();
+        return false;
+    }
+}
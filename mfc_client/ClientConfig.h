@@ -0,0 +1,77 @@
+﻿#pragma once
+#include "PresenceDetector.h"
+#include "Preprocess.h"
+#include "CodecSelector.h"
+#include "InspectionClient.h"
+#include "EndpointPool.h"
+#include "LocalScreen.h"
+#include "Station.h"
+#include <string>
+
+// ===== 전송 전 전처리 (ROI 크롭 + 모델 입력 크기 레터박스) =====
+struct PreprocessConfig
+{
+    bool    enabled = false;     // false 면 기존처럼 전체 프레임 전송
+    int     inputSize = 640;     // 모델 입력 (ai_server.py imgsz)
+    RoiRect roiTop;              // 카메라별 관심 영역 (비어 있으면 전체)
+    RoiRect roiFront;
+    bool    sendHeader = true;   // 요청 헤더에 크롭 기하 정보 포함 (헤더는 메타데이터 때문에 항상 보냄)
+    bool    sideEnhance = false; // FRONT(측면) 대비/엣지/블러를 클라이언트에서 적용 (서버 전처리 생략)
+    int     sideEnhanceThreads = 0; // 측면 전처리 밴드 병렬도 (0 = 코어 수)
+};
+
+// ===== 전송 인코딩 =====
+struct EncoderConfig
+{
+    bool       autoSelect = true;        // "codec": "auto" → 링크 측정값으로 선택
+    ImageCodec codec = ImageCodec::Png;  // autoSelect == false 일 때 고정 코덱
+    int        jpegQuality = 95;
+    int        pngThreads = 0;           // PNG 스트라이프 인코더 스레드 (0 = 코어 수)
+    bool       archive = true;           // 보낸 바이트를 C:\CanClient 에 그대로 저장
+    bool       archivePng = false;       // 감사용: 보낸 코덱과 무관하게 무손실 PNG 도 저장
+    CodecSelectorConfig selector;
+};
+
+// ===== 단계별 지연 계측 =====
+struct LatencyConfig
+{
+    int logIntervalSec = 60;   // 구간 통계를 latency.log 에 남기는 주기 (0 = 끄기)
+};
+
+// ===== 검출 박스 오버레이 (검사 직후 미리보기) =====
+struct OverlayConfig
+{
+    bool  enabled = true;
+    int   holdMs = 1500;       // 오버레이를 보여 주는 동안 라이브 미리보기 멈춤
+    float minScore = 0.25f;    // 이보다 낮은 검출은 그리지 않음
+    bool  previewWindow = true; // 결과 오버레이 창 (IDD_PREVIEW_DLG, 작업자 스레드 합성)
+};
+
+// ===== 오프라인 전송 대기열 (서버에 못 보낸 요청을 디스크에 쌓았다가 재전송) =====
+struct SpoolConfig
+{
+    bool        enabled = true;
+    std::string path = "C:\\CanClient\\spool.bin";   // 메모리 맵 링 파일 (재시작해도 이어서 보냄)
+    int         capacityMb = 256;     // 파일 크기 (가득 차면 새 요청은 버림)
+    int         concurrency = 4;      // 서버 복구 후 동시에 보내는 연결 수
+    int         retryMs = 1000;       // 서버 없을 때 재시도 간격 (실패마다 두 배, 최대 10초)
+};
+
+// ===== 클라이언트 설정 (C:\CanClient\config.json) =====
+// 파일이 없거나 일부 키가 빠져 있으면 기본값을 그대로 쓴다.
+struct ClientConfig
+{
+    ServerEndpoint   server;          // 검사 서버 (C# TcpInspectionServer)
+    EndpointPoolConfig pool;          // 검사 서버 여러 대 + 상태 확인 (server.endpoints)
+    PresenceConfig   presence;        // 연속 검사 트리거
+    PreprocessConfig preprocess;      // ROI 크롭 / 레터박스
+    EncoderConfig    encoder;         // 전송 코덱
+    LatencyConfig    latency;         // 단계별 지연 계측
+    OverlayConfig    overlay;         // 검출 박스 오버레이
+    ScreenConfig     screen;          // 로컬 1차 선별 (확실한 정상은 서버 생략)
+    StationConfig    station;         // 카메라 시리얼 → 역할 (N대 스테이션)
+    SpoolConfig      spool;           // 오프라인 전송 대기열
+    bool           autoStart = false; // 시작 시 연속 검사 모드
+};
+
+bool LoadClientConfig(const std::string& path, ClientConfig& cfg, std::string* error = nullptr);
@@ -0,0 +1,95 @@
+﻿#include "CodecSelector.h"
+#include <limits>
+
+void CCodecSelector::SetConfig(const CodecSelectorConfig& cfg)
+{
+    m_cfg = cfg;
+    if (m_cfg.candidates.empty())
+        m_cfg.candidates = { ImageCodec::Qoi, ImageCodec::RawBgr, ImageCodec::Png };
+
+    m_bandwidth = m_cfg.initialBandwidth;
+    m_bandwidthMeasured = false;
+    m_stats = {};
+    m_choices = 0;
+    m_probeCursor = 0;
+}
+
+void CCodecSelector::SetAvailable(ImageCodec codec, bool available)
+{
+    m_available[Index(codec)] = available;
+}
+
+double CCodecSelector::Blend(double prev, double sample, bool first) const
+{
+    return first ? sample : prev + m_cfg.smoothing * (sample - prev);
+}
+
+double CCodecSelector::EstimateSeconds(ImageCodec codec, size_t pixelCount) const
+{
+    const Stats& s = m_stats[Index(codec)];
+    const double px = static_cast<double>(pixelCount);
+    const double encode = s.encodeNsPerPixel * px * 1e-9;
+    const double transfer = s.bytesPerPixel * px / (m_bandwidth > 0.0 ? m_bandwidth : 1.0);
+    const double decode = m_cfg.decodeNsPerPixel[Index(codec)] * px * 1e-9;
+    return encode + transfer + decode;
+}
+
+ImageCodec CCodecSelector::Choose(size_t pixelCount)
+{
+    ++m_choices;
+
+    // 1) 아직 측정 안 된 후보 우선
+    for (ImageCodec c : m_cfg.candidates)
+    {
+        if (m_available[Index(c)] && !m_stats[Index(c)].measured)
+            return c;
+    }
+
+    // 2) 주기적 재측정 (후보를 돌아가며)
+    if (m_cfg.probeInterval > 0 && m_choices % static_cast<uint64_t>(m_cfg.probeInterval) == 0)
+    {
+        for (size_t n = 0; n < m_cfg.candidates.size(); ++n)
+        {
+            const ImageCodec c = m_cfg.candidates[m_probeCursor++ % m_cfg.candidates.size()];
+            if (m_available[Index(c)])
+                return c;
+        }
+    }
+
+    // 3) 예상 비용 최소
+    ImageCodec best = ImageCodec::Png;
+    double bestCost = std::numeric_limits<double>::max();
+    for (ImageCodec c : m_cfg.candidates)
+    {
+        if (!m_available[Index(c)]) continue;
+        const double cost = EstimateSeconds(c, pixelCount);
+        if (cost < bestCost)
+        {
+            bestCost = cost;
+            best = c;
+        }
+    }
+    return best;
+}
+
+void CCodecSelector::ReportEncode(ImageCodec codec, size_t pixelCount, size_t encodedBytes, double seconds)
+{
+    if (pixelCount == 0) return;
+
+    Stats& s = m_stats[Index(codec)];
+    const double px = static_cast<double>(pixelCount);
+    const bool first = !s.measured;
+
+    s.encodeNsPerPixel = Blend(s.encodeNsPerPixel, seconds * 1e9 / px, first);
+    s.bytesPerPixel = Blend(s.bytesPerPixel, static_cast<double>(encodedBytes) / px, first);
+    s.measured = true;
+}
+
+void CCodecSelector::ReportTransfer(size_t bytes, double seconds)
+{
+    if (bytes < kMinBandwidthSample || seconds <= 0.0) return;
+
+    const double sample = static_cast<double>(bytes) / seconds;
+    m_bandwidth = Blend(m_bandwidth, sample, !m_bandwidthMeasured);
+    m_bandwidthMeasured = true;
+}
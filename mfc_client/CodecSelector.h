@@ -0,0 +1,63 @@
+﻿#pragma once
+#include "ImageEncoder.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+// ===== 링크별 코덱 자동 선택 =====
+// 코덱마다 측정값을 지수이동평균(EWMA)으로 유지하고,
+//   예상 비용 = 인코딩 시간 + 전송 시간(바이트 / 링크 대역폭) + 서버 디코딩 시간
+// 이 가장 작은 코덱을 고른다. 측정이 없는 코덱은 먼저 한 번씩 시도하고,
+// 이후에도 probeInterval 장마다 한 번은 다른 후보를 재측정해 환경 변화를 따라간다.
+struct CodecSelectorConfig
+{
+    std::vector<ImageCodec> candidates;                 // 비어 있으면 QOI/RAW/PNG
+    int    probeInterval = 50;                          // 0 이면 재측정 안 함
+    double smoothing = 0.2;                             // EWMA 계수
+    double initialBandwidth = 100e6 / 8;                // 측정 전 링크 대역폭 가정 (100 Mbps, B/s)
+    std::array<double, static_cast<size_t>(ImageCodec::Count)> decodeNsPerPixel = {
+        12.0,   // png
+        4.0,    // qoi
+        0.5,    // raw
+        6.0     // jpeg
+    };
+};
+
+class CCodecSelector
+{
+public:
+    // 대역폭 측정에 쓸 최소 전송 크기 (작으면 RTT 가 지배해 부정확)
+    static constexpr size_t kMinBandwidthSample = 256 * 1024;
+
+    void SetConfig(const CodecSelectorConfig& cfg);
+
+    // 사용 가능한 코덱만 후보로 남긴다 (빌드에 OpenCV 가 없을 때 등)
+    void SetAvailable(ImageCodec codec, bool available);
+
+    ImageCodec Choose(size_t pixelCount);
+
+    void ReportEncode(ImageCodec codec, size_t pixelCount, size_t encodedBytes, double seconds);
+    void ReportTransfer(size_t bytes, double seconds);
+
+    double BandwidthBytesPerSec() const { return m_bandwidth; }
+    double EstimateSeconds(ImageCodec codec, size_t pixelCount) const;
+
+private:
+    struct Stats
+    {
+        bool   measured = false;
+        double encodeNsPerPixel = 0.0;
+        double bytesPerPixel = 0.0;
+    };
+
+    static size_t Index(ImageCodec c) { return static_cast<size_t>(c); }
+    double Blend(double prev, double sample, bool first) const;
+
+    CodecSelectorConfig m_cfg;
+    std::array<Stats, static_cast<size_t>(ImageCodec::Count)> m_stats{};
+    std::array<bool, static_cast<size_t>(ImageCodec::Count)> m_available{ true, true, true, true };
+    double   m_bandwidth = 0.0;
+    bool     m_bandwidthMeasured = false;
+    uint64_t m_choices = 0;
+    size_t   m_probeCursor = 0;
+};
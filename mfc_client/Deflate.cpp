@@ -0,0 +1,532 @@
+﻿#include "Deflate.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // ===== 상수 =====
+    constexpr int    kWindowSize = 1 << 15;
+    constexpr int    kWindowMask = kWindowSize - 1;
+    constexpr int    kHashBits = 15;
+    constexpr int    kHashSize = 1 << kHashBits;
+    constexpr int    kMinMatch = 3;
+    constexpr int    kMaxMatch = 258;
+    constexpr int    kMaxInsert = 32;            // 이보다 긴 일치는 중간 위치를 해시에 넣지 않음 (속도)
+    constexpr size_t kMaxBlockSymbols = 1 << 15;
+
+    constexpr int kLitLenCodes = 286;
+    constexpr int kDistCodes = 30;
+    constexpr int kCodeLenCodes = 19;
+    constexpr int kMaxBits = 15;
+    constexpr int kMaxCodeLenBits = 7;
+    constexpr int kEndOfBlock = 256;
+
+    const uint16_t kLengthBase[29] = {
+        3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t kLengthExtra[29] = {
+        0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+        3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t kDistBase[30] = {
+        1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+        257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t kDistExtra[30] = {
+        0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+        7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+    const uint8_t kCodeLenOrder[kCodeLenCodes] = {
+        16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+    // 길이/거리 → 코드 번호 룩업 (zlib 과 같은 구성)
+    struct CodeTables
+    {
+        uint8_t lengthCode[kMaxMatch + 1] = {};
+        uint8_t distCode[512] = {};
+
+        CodeTables()
+        {
+            for (int code = 0; code < 28; ++code)
+                for (int n = 0; n < (1 << kLengthExtra[code]); ++n)
+                    lengthCode[kLengthBase[code] + n] = static_cast<uint8_t>(code);
+            lengthCode[kMaxMatch] = 28;
+
+            int dist = 0;
+            int code = 0;
+            for (; code < 16; ++code)
+                for (int n = 0; n < (1 << kDistExtra[code]); ++n)
+                    distCode[dist++] = static_cast<uint8_t>(code);
+            dist >>= 7;
+            for (; code < kDistCodes; ++code)
+                for (int n = 0; n < (1 << (kDistExtra[code] - 7)); ++n)
+                    distCode[256 + dist++] = static_cast<uint8_t>(code);
+        }
+
+        int DistCode(int dist) const
+        {
+            const int d = dist - 1;
+            return d < 256 ? distCode[d] : distCode[256 + (d >> 7)];
+        }
+    };
+
+    const CodeTables& Tables()
+    {
+        static const CodeTables tables;
+        return tables;
+    }
+
+    // ===== 비트 출력 (LSB 우선) =====
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& out) : m_out(out) {}
+
+        void Put(uint32_t bits, int count)
+        {
+            m_buf |= static_cast<uint64_t>(bits) << m_count;
+            m_count += count;
+            if (m_count >= 32)
+            {
+                const uint8_t b[4] = {
+                    static_cast<uint8_t>(m_buf), static_cast<uint8_t>(m_buf >> 8),
+                    static_cast<uint8_t>(m_buf >> 16), static_cast<uint8_t>(m_buf >> 24) };
+                m_out.insert(m_out.end(), b, b + 4);
+                m_buf >>= 32;
+                m_count -= 32;
+            }
+        }
+
+        void AlignToByte()
+        {
+            const int pad = (8 - (m_count & 7)) & 7;
+            if (pad) Put(0, pad);
+        }
+
+        void Flush()
+        {
+            while (m_count > 0)
+            {
+                m_out.push_back(static_cast<uint8_t>(m_buf));
+                m_buf >>= 8;
+                m_count = std::max(0, m_count - 8);
+            }
+            m_buf = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& m_out;
+        uint64_t m_buf = 0;
+        int m_count = 0;
+    };
+
+    // ===== 허프만 =====
+    // 길이 제한은 빈도를 절반으로 줄여 다시 만드는 방식 (블록당 한두 번, 비용 무시 가능)
+    void BuildLengths(const uint32_t* freq, int n, int maxBits, uint8_t* lengths)
+    {
+        std::vector<uint32_t> f(freq, freq + n);
+        std::fill(lengths, lengths + n, uint8_t(0));
+
+        for (;;)
+        {
+            std::vector<uint32_t> weight;
+            std::vector<int> parent;
+            std::vector<int> leafOf;   // 노드 → 심볼 (내부 노드는 -1)
+            using Item = std::pair<uint32_t, int>;
+            std::priority_queue<Item, std::vector<Item>, std::greater<Item>> heap;
+
+            for (int i = 0; i < n; ++i)
+            {
+                if (f[i] == 0) continue;
+                heap.push({ f[i], static_cast<int>(weight.size()) });
+                weight.push_back(f[i]);
+                parent.push_back(-1);
+                leafOf.push_back(i);
+            }
+
+            if (weight.empty()) return;
+            if (weight.size() == 1)
+            {
+                lengths[leafOf[0]] = 1;
+                return;
+            }
+
+            while (heap.size() > 1)
+            {
+                const Item a = heap.top(); heap.pop();
+                const Item b = heap.top(); heap.pop();
+                const int node = static_cast<int>(weight.size());
+                weight.push_back(a.first + b.first);
+                parent.push_back(-1);
+                leafOf.push_back(-1);
+                parent[a.second] = node;
+                parent[b.second] = node;
+                heap.push({ a.first + b.first, node });
+            }
+
+            // 부모가 항상 자식보다 뒤에 만들어지므로 역순으로 깊이 계산
+            std::vector<int> depth(weight.size(), 0);
+            int maxDepth = 0;
+            for (int i = static_cast<int>(weight.size()) - 2; i >= 0; --i)
+            {
+                depth[i] = depth[parent[i]] + 1;
+                if (leafOf[i] >= 0) maxDepth = std::max(maxDepth, depth[i]);
+            }
+
+            if (maxDepth <= maxBits)
+            {
+                for (size_t i = 0; i < weight.size(); ++i)
+                    if (leafOf[i] >= 0) lengths[leafOf[i]] = static_cast<uint8_t>(depth[i]);
+                return;
+            }
+
+            for (uint32_t& v : f)
+                if (v) v = (v >> 1) | 1;
+        }
+    }
+
+    uint16_t ReverseBits(uint32_t code, int len)
+    {
+        uint32_t r = 0;
+        for (int i = 0; i < len; ++i)
+        {
+            r = (r << 1) | (code & 1);
+            code >>= 1;
+        }
+        return static_cast<uint16_t>(r);
+    }
+
+    // 표준(canonical) 코드, 비트 순서를 뒤집어 LSB 우선 출력에 맞춤
+    void BuildCodes(const uint8_t* lengths, int n, uint16_t* codes)
+    {
+        int count[kMaxBits + 1] = {};
+        for (int i = 0; i < n; ++i) count[lengths[i]]++;
+        count[0] = 0;
+
+        uint32_t next[kMaxBits + 1] = {};
+        uint32_t code = 0;
+        for (int bits = 1; bits <= kMaxBits; ++bits)
+        {
+            code = (code + count[bits - 1]) << 1;
+            next[bits] = code;
+        }
+        for (int i = 0; i < n; ++i)
+            codes[i] = lengths[i] ? ReverseBits(next[lengths[i]]++, lengths[i]) : 0;
+    }
+
+    // ===== LZ77 =====
+    struct Symbol
+    {
+        uint16_t litLen;   // dist == 0 이면 리터럴 바이트, 아니면 일치 길이
+        uint16_t dist;
+    };
+
+    inline uint32_t Hash3(const uint8_t* p)
+    {
+        const uint32_t v = p[0] | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16);
+        return (v * 2654435761u) >> (32 - kHashBits);
+    }
+
+    inline int CountTrailingZeros(uint64_t x)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, x);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctzll(x);
+#endif
+    }
+
+    // 8바이트씩 비교 (리틀 엔디언 가정: x86/x64)
+    inline int MatchLength(const uint8_t* a, const uint8_t* b, int maxLen)
+    {
+        int i = 0;
+        while (i + 8 <= maxLen)
+        {
+            uint64_t x, y;
+            std::memcpy(&x, a + i, 8);
+            std::memcpy(&y, b + i, 8);
+            const uint64_t diff = x ^ y;
+            if (diff) return i + (CountTrailingZeros(diff) >> 3);
+            i += 8;
+        }
+        while (i < maxLen && a[i] == b[i]) ++i;
+        return i;
+    }
+
+    // ===== 동적 허프만 블록 출력 =====
+    void WriteBlock(BitWriter& bw, const std::vector<Symbol>& syms, bool final)
+    {
+        const CodeTables& t = Tables();
+
+        uint32_t litFreq[kLitLenCodes] = {};
+        uint32_t distFreq[kDistCodes] = {};
+        for (const Symbol& s : syms)
+        {
+            if (s.dist == 0)
+            {
+                litFreq[s.litLen]++;
+            }
+            else
+            {
+                litFreq[257 + t.lengthCode[s.litLen]]++;
+                distFreq[t.DistCode(s.dist)]++;
+            }
+        }
+        litFreq[kEndOfBlock] = 1;
+
+        // 거리 코드가 1개 이하면 더미를 넣어 완전한 트리로 (일부 디코더 호환)
+        int usedDist = 0;
+        for (uint32_t f : distFreq) usedDist += f ? 1 : 0;
+        for (int i = 0; usedDist < 2; ++i)
+        {
+            if (!distFreq[i]) { distFreq[i] = 1; ++usedDist; }
+        }
+
+        uint8_t litLen[kLitLenCodes], distLen[kDistCodes];
+        uint16_t litCode[kLitLenCodes], distCode[kDistCodes];
+        BuildLengths(litFreq, kLitLenCodes, kMaxBits, litLen);
+        BuildLengths(distFreq, kDistCodes, kMaxBits, distLen);
+        BuildCodes(litLen, kLitLenCodes, litCode);
+        BuildCodes(distLen, kDistCodes, distCode);
+
+        int hlit = kLitLenCodes;
+        while (hlit > 257 && litLen[hlit - 1] == 0) --hlit;
+        int hdist = kDistCodes;
+        while (hdist > 1 && distLen[hdist - 1] == 0) --hdist;
+
+        // ----- 코드 길이 목록 RLE (16/17/18) -----
+        uint8_t all[kLitLenCodes + kDistCodes];
+        std::memcpy(all, litLen, hlit);
+        std::memcpy(all + hlit, distLen, hdist);
+        const int total = hlit + hdist;
+
+        struct ClSymbol { uint8_t sym; uint8_t extra; };
+        ClSymbol rle[kLitLenCodes + kDistCodes];
+        int nrle = 0;
+        uint32_t clFreq[kCodeLenCodes] = {};
+        auto push = [&](int sym, int extra) {
+            rle[nrle++] = { static_cast<uint8_t>(sym), static_cast<uint8_t>(extra) };
+            clFreq[sym]++;
+        };
+
+        for (int i = 0; i < total;)
+        {
+            const uint8_t v = all[i];
+            int run = 1;
+            while (i + run < total && all[i + run] == v) ++run;
+            i += run;
+
+            if (v == 0)
+            {
+                while (run >= 11) { const int r = std::min(run, 138); push(18, r - 11); run -= r; }
+                if (run >= 3)     { push(17, run - 3); run = 0; }
+            }
+            else
+            {
+                push(v, 0);
+                --run;
+                while (run >= 3) { const int r = std::min(run, 6); push(16, r - 3); run -= r; }
+            }
+            while (run-- > 0) push(v, 0);
+        }
+
+        // 코드 길이 코드는 완전한 트리여야 함 (zlib inflate 요구) → 최소 2개
+        int usedCl = 0;
+        for (uint32_t f : clFreq) usedCl += f ? 1 : 0;
+        for (int i = 0; usedCl < 2; ++i)
+        {
+            if (!clFreq[i]) { clFreq[i] = 1; ++usedCl; }
+        }
+
+        uint8_t clLen[kCodeLenCodes];
+        uint16_t clCode[kCodeLenCodes];
+        BuildLengths(clFreq, kCodeLenCodes, kMaxCodeLenBits, clLen);
+        BuildCodes(clLen, kCodeLenCodes, clCode);
+
+        int hclen = kCodeLenCodes;
+        while (hclen > 4 && clLen[kCodeLenOrder[hclen - 1]] == 0) --hclen;
+
+        // ----- 블록 헤더 -----
+        bw.Put(final ? 1 : 0, 1);
+        bw.Put(2, 2);  // BTYPE = 10 (동적 허프만)
+        bw.Put(hlit - 257, 5);
+        bw.Put(hdist - 1, 5);
+        bw.Put(hclen - 4, 4);
+        for (int i = 0; i < hclen; ++i)
+            bw.Put(clLen[kCodeLenOrder[i]], 3);
+
+        for (int i = 0; i < nrle; ++i)
+        {
+            const ClSymbol& s = rle[i];
+            bw.Put(clCode[s.sym], clLen[s.sym]);
+            if (s.sym == 16)      bw.Put(s.extra, 2);
+            else if (s.sym == 17) bw.Put(s.extra, 3);
+            else if (s.sym == 18) bw.Put(s.extra, 7);
+        }
+
+        // ----- 데이터 -----
+        for (const Symbol& s : syms)
+        {
+            if (s.dist == 0)
+            {
+                bw.Put(litCode[s.litLen], litLen[s.litLen]);
+                continue;
+            }
+
+            const int lc = t.lengthCode[s.litLen];
+            bw.Put(litCode[257 + lc], litLen[257 + lc]);
+            if (kLengthExtra[lc]) bw.Put(s.litLen - kLengthBase[lc], kLengthExtra[lc]);
+
+            const int dc = t.DistCode(s.dist);
+            bw.Put(distCode[dc], distLen[dc]);
+            if (kDistExtra[dc]) bw.Put(s.dist - kDistBase[dc], kDistExtra[dc]);
+        }
+        bw.Put(litCode[kEndOfBlock], litLen[kEndOfBlock]);
+    }
+}
+
+namespace Deflate
+{
+    void Compress(const uint8_t* data, size_t len, bool last, std::vector<uint8_t>& out, const Options& opt)
+    {
+        BitWriter bw(out);
+
+        if (len > 0)
+        {
+            std::vector<int32_t> head(kHashSize, -1);
+            std::vector<int32_t> prev(kWindowSize, -1);
+            std::vector<Symbol> syms;
+            syms.reserve(kMaxBlockSymbols);
+
+            size_t pos = 0;
+            while (pos < len)
+            {
+                int bestLen = 0;
+                int bestDist = 0;
+
+                if (pos + kMinMatch <= len)
+                {
+                    const uint32_t h = Hash3(data + pos);
+                    int32_t cand = head[h];
+                    prev[pos & kWindowMask] = cand;
+                    head[h] = static_cast<int32_t>(pos);
+
+                    const int maxLen = static_cast<int>(std::min<size_t>(kMaxMatch, len - pos));
+                    int chain = opt.maxChain;
+
+                    while (cand >= 0 && chain-- > 0)
+                    {
+                        const size_t dist = pos - static_cast<size_t>(cand);
+                        if (dist >= static_cast<size_t>(kWindowSize)) break;
+
+                        // 현재 최장 길이 위치부터 먼저 비교 (빠른 탈락)
+                        if (data[cand + bestLen] == data[pos + bestLen])
+                        {
+                            const int l = MatchLength(data + cand, data + pos, maxLen);
+                            if (l > bestLen)
+                            {
+                                bestLen = l;
+                                bestDist = static_cast<int>(dist);
+                                if (l >= opt.niceLength || l == maxLen) break;
+                            }
+                        }
+
+                        const int32_t next = prev[cand & kWindowMask];
+                        if (next >= cand) break;  // 덮어쓴 슬롯 (윈도 밖)
+                        cand = next;
+                    }
+                }
+
+                if (bestLen >= kMinMatch)
+                {
+                    syms.push_back({ static_cast<uint16_t>(bestLen), static_cast<uint16_t>(bestDist) });
+
+                    const size_t end = pos + bestLen;
+                    if (bestLen <= kMaxInsert)
+                    {
+                        for (size_t p = pos + 1; p < end && p + kMinMatch <= len; ++p)
+                        {
+                            const uint32_t h = Hash3(data + p);
+                            prev[p & kWindowMask] = head[h];
+                            head[h] = static_cast<int32_t>(p);
+                        }
+                    }
+                    pos = end;
+                }
+                else
+                {
+                    syms.push_back({ data[pos], 0 });
+                    ++pos;
+                }
+
+                if (syms.size() >= kMaxBlockSymbols)
+                {
+                    WriteBlock(bw, syms, last && pos >= len);
+                    syms.clear();
+                }
+            }
+            if (!syms.empty())
+                WriteBlock(bw, syms, last);
+        }
+        else if (last)
+        {
+            // 빈 입력의 마지막 블록: 고정 허프만, EOB(7비트 0)만
+            bw.Put(1, 1);
+            bw.Put(1, 2);
+            bw.Put(0, 7);
+        }
+
+        if (!last)
+        {
+            // sync flush: 빈 stored 블록으로 바이트 정렬
+            bw.Put(0, 3);
+            bw.AlignToByte();
+            bw.Put(0x0000, 16);
+            bw.Put(0xFFFF, 16);
+        }
+        bw.Flush();
+    }
+
+    uint32_t Adler32(const uint8_t* data, size_t len, uint32_t adler)
+    {
+        constexpr uint32_t kBase = 65521;
+        constexpr size_t kNMax = 5552;  // 오버플로 없이 누적 가능한 최대 길이
+
+        uint32_t a = adler & 0xFFFF;
+        uint32_t b = adler >> 16;
+        while (len > 0)
+        {
+            const size_t n = std::min(len, kNMax);
+            for (size_t i = 0; i < n; ++i)
+            {
+                a += data[i];
+                b += a;
+            }
+            a %= kBase;
+            b %= kBase;
+            data += n;
+            len -= n;
+        }
+        return (b << 16) | a;
+    }
+
+    uint32_t Adler32Combine(uint32_t adler1, uint32_t adler2, size_t len2)
+    {
+        // zlib adler32_combine 과 동일
+        constexpr uint32_t kBase = 65521;
+        const uint32_t rem = static_cast<uint32_t>(len2 % kBase);
+        uint32_t sum1 = adler1 & 0xFFFF;
+        uint32_t sum2 = static_cast<uint32_t>((static_cast<uint64_t>(rem) * sum1) % kBase);
+        sum1 += (adler2 & 0xFFFF) + kBase - 1;
+        sum2 += ((adler1 >> 16) & 0xFFFF) + ((adler2 >> 16) & 0xFFFF) + kBase - rem;
+        if (sum1 >= kBase) sum1 -= kBase;
+        if (sum1 >= kBase) sum1 -= kBase;
+        if (sum2 >= (kBase << 1)) sum2 -= (kBase << 1);
+        if (sum2 >= kBase) sum2 -= kBase;
+        return sum1 | (sum2 << 16);
+    }
+}
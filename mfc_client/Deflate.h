@@ -0,0 +1,28 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ===== Deflate (RFC 1951) 압축기 =====
+// PNG 스트라이프 인코더용 최소 구현: LZ77(해시 체인, greedy) + 동적 허프만 블록.
+// zlib 헤더/체크섬은 붙이지 않는다 (여러 조각을 이어 붙여 하나의 zlib 스트림을 만들기 위함).
+namespace Deflate
+{
+    struct Options
+    {
+        int maxChain = 16;      // 해시 체인 탐색 횟수 (클수록 느리고 작아짐)
+        int niceLength = 128;   // 이 길이 이상 일치하면 탐색 중단
+    };
+
+    // data 를 압축해 out 뒤에 덧붙인다.
+    // last == true  : 마지막 블록에 BFINAL 설정 (스트림 끝)
+    // last == false : 빈 stored 블록(sync flush)으로 끝내 바이트 정렬 → 다음 조각을 그대로 이어 붙일 수 있음
+    void Compress(const uint8_t* data, size_t len, bool last, std::vector<uint8_t>& out,
+                  const Options& opt = Options());
+
+    // ===== Adler-32 (zlib 트레일러) =====
+    uint32_t Adler32(const uint8_t* data, size_t len, uint32_t adler = 1);
+
+    // adler(A+B) = Combine(adler(A), adler(B), len(B)) — 조각별로 병렬 계산 후 합치기
+    uint32_t Adler32Combine(uint32_t adler1, uint32_t adler2, size_t len2);
+}
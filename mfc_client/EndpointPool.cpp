@@ -0,0 +1,317 @@
+﻿#include "EndpointPool.h"
+#include "LatencyStats.h"
+#include "SocketCompat.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+using namespace Net;
+
+namespace
+{
+    const size_t kRouteMemory = 1024;     // 단위 키 → 서버 기억 (직접 보내는 TOP 과 SIDE 사이, 대기열 SIDE 는 레코드의 핀)
+    const double kEwmaAlpha = 0.2;
+
+    void Ewma(double& avg, double sample)
+    {
+        avg = avg > 0.0 ? avg + kEwmaAlpha * (sample - avg) : sample;
+    }
+}
+
+CEndpointPool::~CEndpointPool()
+{
+    StopProbes();
+}
+
+void CEndpointPool::Configure(const ServerEndpoint& primary, const EndpointPoolConfig& cfg)
+{
+    StopProbes();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cfg = cfg;
+    m_endpoints.clear();
+    m_routes.clear();
+    m_routeOrder.clear();
+
+    const std::vector<ServerEndpoint> list = cfg.endpoints.empty() ? std::vector<ServerEndpoint>{ primary } : cfg.endpoints;
+    for (const ServerEndpoint& e : list)
+    {
+        State s;
+        s.endpoint = e;
+        s.endpoint.replyFormat = primary.replyFormat;
+        s.endpoint.timeouts = primary.timeouts;
+        const std::string address = e.host + ":" + std::to_string(e.port);
+        s.pin = (std::max)(PayloadFingerprint(reinterpret_cast<const uint8_t*>(address.data()), address.size()), 1u);
+        m_endpoints.push_back(s);
+    }
+}
+
+// ===================== 분배 =====================
+int CEndpointPool::PinnedIndex(const RequestHeader::UnitId& unit, uint32_t pin) const
+{
+    const auto it = m_routes.find(unit);
+    if (it != m_routes.end())
+        return it->second;
+    if (pin != 0)
+        for (size_t i = 0; i < m_endpoints.size(); ++i)
+            if (m_endpoints[i].pin == pin)
+                return static_cast<int>(i);
+    return -1;
+}
+
+int CEndpointPool::Route(const RequestHeader::UnitId& unit, uint32_t pin)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    // 같은 단위는 같은 서버 (TOP 을 받은 서버만 SIDE 와 짝지을 수 있음).
+    // 그 서버가 빠졌거나 모르면 다른 서버로 돌리지 않음: TOP 없이 받은 SIDE 는 "TOP없음" 에러가 됨.
+    if (unit.valid && !unit.startsUnit) {
+        const int pinned = PinnedIndex(unit, pin);
+        if (pinned < 0)
+            return kUnknownUnit;
+        return m_endpoints[static_cast<size_t>(pinned)].healthy ? pinned : -1;
+    }
+
+    // 최소 예상 대기: (이 클라이언트 진행 중 / 서버 처리 중 중 큰 쪽 + 1) × 평균 처리 시간. 같으면 돌아가며.
+    // 아직 요청을 안 보낸 서버는 확인 왕복만으로 (먼저 한 번씩 써 봐야 처리 시간을 앎).
+    int best = -1;
+    double bestScore = 0.0;
+    const size_t n = m_endpoints.size();
+    for (size_t k = 0; k < n; ++k)
+    {
+        const size_t i = (m_roundRobin + k) % n;
+        const State& s = m_endpoints[i];
+        if (!s.healthy)
+            continue;
+        const double service = s.serviceMs > 0.0 ? s.serviceMs : s.probeMs;
+        const double score = ((std::max)(s.inFlight, s.serverActive) + 1) * service;
+        if (best < 0 || score < bestScore) {
+            best = static_cast<int>(i);
+            bestScore = score;
+        }
+    }
+    ++m_roundRobin;
+    if (best < 0)
+        return -1;
+
+    if (unit.valid) {
+        const auto ins = m_routes.emplace(unit, best);
+        if (ins.second) {
+            m_routeOrder.push_back(unit);
+            if (m_routeOrder.size() > kRouteMemory) {
+                m_routes.erase(m_routeOrder.front());
+                m_routeOrder.pop_front();
+            }
+        }
+        else ins.first->second = best;   // TOP 을 다시 보냄 (앞선 시도 실패): 새 서버에 다시 고정
+    }
+    return best;
+}
+
+bool CEndpointPool::Stranded(const RequestHeader::UnitId& unit, uint32_t pin) const
+{
+    if (!unit.valid || unit.startsUnit)
+        return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const int pinned = PinnedIndex(unit, pin);
+    return pinned >= 0 && !m_endpoints[static_cast<size_t>(pinned)].healthy;
+}
+
+uint32_t CEndpointPool::PinOf(const RequestHeader::UnitId& unit) const
+{
+    if (!unit.valid)
+        return 0;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_routes.find(unit);
+    return it != m_routes.end() ? m_endpoints[static_cast<size_t>(it->second)].pin : 0;
+}
+
+void CEndpointPool::Begin(int index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    ++m_endpoints[static_cast<size_t>(index)].inFlight;
+}
+
+void CEndpointPool::End(int index, bool ok, const RequestTiming& timing)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    State& s = m_endpoints[static_cast<size_t>(index)];
+    --s.inFlight;
+    if (!ok && timing.cancelled)
+        return;
+    ++s.requests;
+    if (ok) {
+        s.failures = 0;
+        Ewma(s.serviceMs, (timing.sendSeconds + timing.waitSeconds) * 1e3);
+    }
+    else {
+        ++s.failed;
+        s.lastError = timing.timedOut ? "request timeout" : "request failed";
+        MarkFailure(s);
+    }
+}
+
+// 잠금 안에서
+void CEndpointPool::MarkFailure(State& s)
+{
+    ++s.failures;
+    // 확인을 끈 설정이면 요청 실패만으로 빼지 않음 (되살릴 방법이 없으므로)
+    if (m_cfg.probeIntervalMs > 0 && s.failures >= (std::max)(m_cfg.failThreshold, 1))
+        s.healthy = false;
+}
+
+bool CEndpointPool::Healthy(int index) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_endpoints[static_cast<size_t>(index)].healthy;
+}
+
+bool CEndpointPool::HealthyAny() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (const State& s : m_endpoints)
+        if (s.healthy) return true;
+    return false;
+}
+
+// ===================== 상태 확인 =====================
+void CEndpointPool::StartProbes()
+{
+    StopProbes();
+    if (m_cfg.probeIntervalMs <= 0 || m_endpoints.empty())
+        return;
+    m_stop = false;
+    m_probeThread = std::thread(&CEndpointPool::ProbeLoop, this);
+}
+
+void CEndpointPool::StopProbes()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_probeThread.joinable())
+        m_probeThread.join();
+}
+
+CEndpointPool::ProbeResult CEndpointPool::Probe(const ServerEndpoint& endpoint) const
+{
+    ProbeResult r;
+    const uint64_t start = NowNs();
+    const uint64_t deadline = start + static_cast<uint64_t>((std::max)(m_cfg.probeTimeoutMs, 1)) * 1000000ull;
+
+    sockaddr_in addr;
+    if (!Resolve(endpoint.host.c_str(), endpoint.port, addr)) {
+        r.error = "cannot resolve host";
+        return r;
+    }
+    SocketGuard sock(socket(AF_INET, SOCK_STREAM, 0));
+    if (sock.s == kInvalidSocket || !SetNonBlocking(sock.s)) {
+        r.error = "socket failed";
+        return r;
+    }
+    int code = 0;
+    IoWait w = ConnectUntil(sock.s, addr, deadline, &m_stop, code);
+    if (w != IoWait::Ready) {
+        r.error = w == IoWait::Timeout ? "connect timeout" : "connect failed (" + std::to_string(code) + ")";
+        return r;
+    }
+
+    const uint8_t magic[4] = { static_cast<uint8_t>(kHealthCheckMagic >> 24), static_cast<uint8_t>(kHealthCheckMagic >> 16),
+                               static_cast<uint8_t>(kHealthCheckMagic >> 8), static_cast<uint8_t>(kHealthCheckMagic) };
+    if ((w = SendAllUntil(sock.s, magic, sizeof(magic), deadline, &m_stop)) != IoWait::Ready) {
+        r.error = w == IoWait::Timeout ? "send timeout" : "send failed";
+        return r;
+    }
+
+    // 서버는 한 줄 답하고 닫음 (옛 서버는 답 없이 닫음)
+    std::string reply;
+    char buf[512];
+    for (;;) {
+        int got = 0;
+        w = RecvSomeUntil(sock.s, buf, sizeof(buf), got, deadline, &m_stop);
+        if (w == IoWait::Timeout || w == IoWait::Cancelled) {
+            r.error = "reply timeout";
+            return r;
+        }
+        if (w != IoWait::Ready || got <= 0 || reply.size() > 4096)
+            break;
+        reply.append(buf, static_cast<size_t>(got));
+    }
+    r.rttMs = (NowNs() - start) / 1e6;
+    r.ok = true;
+
+    if (!reply.empty()) {
+        try {
+            const json j = json::parse(reply);
+            r.ok = j.value("ok", false);
+            r.aiUp = j.value("ai", true);
+            r.active = j.value("active", 0);
+            r.pending = j.value("pending", 0);
+            if (!r.ok) r.error = "server not ready";
+        }
+        catch (const std::exception&) {
+            // 'CNHC' 를 모르는 서버가 뭔가 답함 → 살아는 있음
+        }
+    }
+    if (r.ok && !r.aiUp)
+        r.error = "AI server down";
+    return r;
+}
+
+void CEndpointPool::ProbeLoop()
+{
+    while (!m_stop)
+    {
+        for (size_t i = 0; i < m_endpoints.size() && !m_stop; ++i)
+        {
+            const ProbeResult r = Probe(m_endpoints[i].endpoint);
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            State& s = m_endpoints[i];
+            ++s.probes;
+            if (r.ok && r.aiUp) {
+                s.healthy = true;
+                s.failures = 0;
+                s.aiUp = true;
+                s.serverActive = r.active;
+                s.serverPending = r.pending;
+                Ewma(s.probeMs, r.rttMs);
+                s.lastError.clear();
+            }
+            else {
+                // AI 서버가 죽은 검사 서버는 받아도 에러 판정뿐 → 바로 제외
+                ++s.probeFailures;
+                s.aiUp = r.aiUp;
+                s.lastError = r.error;
+                if (r.ok) s.healthy = false;
+                else      MarkFailure(s);
+            }
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.wait_for(lock, std::chrono::milliseconds(m_cfg.probeIntervalMs), [this] { return m_stop.load(); });
+    }
+}
+
+// ===================== 보고 =====================
+std::string CEndpointPool::Report() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string text;
+    for (const State& s : m_endpoints)
+    {
+        char line[256];
+        std::snprintf(line, sizeof(line),
+            "server %s:%d %s, in-flight %d, active %d, pending %d, svc %.1f ms, probe %.1f ms, sent %llu, failed %llu%s%s\n",
+            s.endpoint.host.c_str(), s.endpoint.port, s.healthy ? "up" : "DOWN",
+            s.inFlight, s.serverActive, s.serverPending, s.serviceMs, s.probeMs,
+            static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.failed),
+            s.lastError.empty() ? "" : " — ", s.lastError.c_str());
+        text += line;
+    }
+    return text;
+}
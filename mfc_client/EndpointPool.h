@@ -0,0 +1,118 @@
+﻿#pragma once
+#include "InspectionClient.h"
+#include "RequestHeader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===== 검사 서버 풀 설정 (config.json "server") =====
+struct EndpointPoolConfig
+{
+    std::vector<ServerEndpoint> endpoints;   // 비어 있으면 server 1대. 응답 형식/기한은 server 것을 그대로
+    int probeIntervalMs = 1000;              // 상태 확인 주기 (0 = 끄기 → 요청 실패만으로 판단하지 않고 항상 사용)
+    int probeTimeoutMs = 500;                // 확인 1회 기한 (연결 + 응답)
+    int failThreshold = 2;                   // 연속 실패 (확인/요청) 이만큼이면 제외, 확인이 성공하면 복귀
+};
+
+// ===== 상태 확인 요청 =====
+// 연결 → 'CNHC' 4바이트 → 서버가 JSON 한 줄로 답하고 닫음:
+//   {"ok":true,"ai":true,"active":2,"pending":1}
+//   ai      = 서버가 Python AI 서버에 0x01 상태 확인을 보내 "OK" 를 받았는지
+//   active  = 처리 중인 요청 (이 확인 제외), pending = SIDE 를 기다리는 TOP
+// 'CNHC' 를 모르는 옛 서버는 길이 이상치로 보고 그냥 닫는다 → 연결만 되면 살아 있는 것으로.
+const uint32_t kHealthCheckMagic = 0x434E4843;   // 'CNHC' (BE)
+
+// ===== 검사 서버 풀: 상태 확인 + 최소 부하 분배 =====
+// 요청마다 (진행 중 + 서버가 알려 준 처리 중 + 1) × 평균 처리 시간이 가장 작은 건강한 서버로.
+// 같은 검사 단위(TOP → SIDE)는 서버가 메모리에서 짝지으므로 단위 키로 TOP 을 보낸 서버에 고정한다.
+// 고정한 서버가 빠지면 SIDE 는 다른 서버로 보내지 않는다 (TOP 이 없어 짝이 틀림) → 호출자가 대기열로.
+// 고정은 메모리(최근 kRouteMemory 단위)와 서버 핀(host:port 지문, 대기열 레코드에 저장) 두 곳에서 찾는다
+// → 오래 기다린 SIDE 나 재시작 뒤에도 TOP 을 받은 서버로만 간다.
+// 서버 1대 설정이어도 같은 경로 (상태 확인으로 죽은 서버에 연결 기한만큼 매달리지 않음).
+class CEndpointPool
+{
+public:
+    CEndpointPool() = default;
+    ~CEndpointPool();
+    CEndpointPool(const CEndpointPool&) = delete;
+    CEndpointPool& operator=(const CEndpointPool&) = delete;
+
+    // primary = config "server" (endpoints 가 비었을 때 유일한 서버, 응답 형식/기한 기준)
+    void Configure(const ServerEndpoint& primary, const EndpointPoolConfig& cfg);
+    void StartProbes();     // 상태 확인 스레드 (Windows 는 WSAStartup 이후)
+    void StopProbes();
+
+    // 요청 경로. 건강한 서버가 없으면 -1.
+    //   단위 없음 (valid = false)  → 매번 새로 고름
+    //   TOP (startsUnit)           → 새로 고르고 그 서버에 단위 고정 (다시 보내는 TOP 도 다시 고름)
+    //   SIDE 등                    → 고정한 서버 (메모리, 없으면 pin). 그 서버가 빠졌으면 -1,
+    //                                어느 쪽으로도 모르면 kUnknownUnit (기다려도 짝지을 서버가 없음)
+    static constexpr int kUnknownUnit = -2;
+    int  Route(const RequestHeader::UnitId& unit, uint32_t pin = 0);
+    // TOP 을 받은 서버가 빠져 Route 가 -1 을 줄 단위인가 (대기열이 그 단위를 건너뛰고 다른 단위부터 보냄)
+    bool Stranded(const RequestHeader::UnitId& unit, uint32_t pin = 0) const;
+
+    // 서버 핀: host:port 지문 (0 = 없음). 설정 순서가 바뀌거나 재시작해도 같은 서버면 같은 값.
+    uint32_t Pin(int index) const { return m_endpoints[static_cast<size_t>(index)].pin; }
+    uint32_t PinOf(const RequestHeader::UnitId& unit) const;   // 단위를 고정한 서버의 핀 (모르면 0)
+    const ServerEndpoint& Endpoint(int index) const { return m_endpoints[static_cast<size_t>(index)].endpoint; }
+    size_t Size() const { return m_endpoints.size(); }
+
+    // 요청 1건 전후 (진행 중 수, 처리 시간 평균, 연속 실패). 취소된 요청은 실패로 세지 않음.
+    void Begin(int index);
+    void End(int index, bool ok, const RequestTiming& timing);
+
+    bool Healthy(int index) const;
+    bool HealthyAny() const;
+    std::string Report() const;    // 지연 표/로그용: 서버마다 한 줄
+
+private:
+    struct State
+    {
+        ServerEndpoint endpoint;
+        uint32_t pin = 0;               // host:port 지문
+        bool     healthy = true;        // 확인 전에는 사용 (첫 요청이 기다리지 않게)
+        bool     aiUp = true;
+        int      failures = 0;          // 연속 실패
+        int      inFlight = 0;          // 이 클라이언트가 보내는 중
+        int      serverActive = 0;      // 마지막 확인 때 서버가 알려 준 처리 중 요청
+        int      serverPending = 0;
+        double   serviceMs = 0.0;       // 요청 처리 시간 EWMA (전송 + 응답 대기)
+        double   probeMs = 0.0;         // 확인 왕복 EWMA
+        uint64_t requests = 0, failed = 0, probes = 0, probeFailures = 0;
+        std::string lastError;
+    };
+
+    struct ProbeResult
+    {
+        bool ok = false;
+        bool aiUp = true;
+        int  active = 0, pending = 0;
+        double rttMs = 0.0;
+        std::string error;
+    };
+
+    ProbeResult Probe(const ServerEndpoint& endpoint) const;
+    void ProbeLoop();
+    void MarkFailure(State& s);
+    int  PinnedIndex(const RequestHeader::UnitId& unit, uint32_t pin) const;   // 고정 서버 (없으면 -1, 잠금 안에서)
+
+    std::vector<State> m_endpoints;
+    EndpointPoolConfig m_cfg;
+
+    mutable std::mutex m_mutex;
+    std::map<RequestHeader::UnitId, int> m_routes;   // 단위 → 서버 (최근 kRouteMemory 개)
+    std::deque<RequestHeader::UnitId>    m_routeOrder;
+    unsigned                   m_roundRobin = 0;
+
+    std::thread             m_probeThread;
+    std::condition_variable m_wake;
+    std::atomic<bool>       m_stop{ false };
+};
@@ -0,0 +1,181 @@
+﻿#include "FrameConvert.h"
+#include "ThreadPool.h"
+
+#include <type_traits>
+
+const char* RawFormatName(RawFormat format)
+{
+    switch (format) {
+    case RawFormat::Mono8:    return "Mono8";
+    case RawFormat::BayerRG8: return "BayerRG8";
+    case RawFormat::BayerGR8: return "BayerGR8";
+    case RawFormat::BayerGB8: return "BayerGB8";
+    case RawFormat::BayerBG8: return "BayerBG8";
+    case RawFormat::RGB8:     return "RGB8";
+    case RawFormat::BGR8:     return "BGR8";
+    }
+    return "?";
+}
+
+int RawBytesPerPixel(RawFormat format)
+{
+    return (format == RawFormat::RGB8 || format == RawFormat::BGR8) ? 3 : 1;
+}
+
+namespace
+{
+    constexpr bool IsBayer(RawFormat f)
+    {
+        return f == RawFormat::BayerRG8 || f == RawFormat::BayerGR8 ||
+               f == RawFormat::BayerGB8 || f == RawFormat::BayerBG8;
+    }
+
+    // reflect101: -1 → 1, n → n-2 (베이어 색 배치의 홀짝이 유지됨)
+    inline int Reflect(int i, int n)
+    {
+        return i < 0 ? -i : (i >= n ? 2 * n - 2 - i : i);
+    }
+
+    // ===================== 베이어 한 행 (bilinear) =====================
+    // 행의 "주 색" P (R 행이면 R, B 행이면 B) 와 다른 색 S.
+    //   P 위치: P = 자신, G = 상하좌우 평균, S = 대각 평균
+    //   G 위치: G = 자신, P = 좌우 평균,     S = 상하 평균
+    // PIdx = BGR8 안에서 P 의 채널 (R = 2, B = 0), pParity = P 가 놓인 열의 홀짝
+    template <int PIdx>
+    void BayerRow(const uint8_t* u, const uint8_t* m, const uint8_t* d, int w, int pParity, uint8_t* out)
+    {
+        constexpr int S = 2 - PIdx;
+        auto site = [&](int x, int xl, int xr) {
+            uint8_t* o = out + x * 3;
+            o[PIdx] = m[x];
+            o[1] = static_cast<uint8_t>((m[xl] + m[xr] + u[x] + d[x] + 2) >> 2);
+            o[S] = static_cast<uint8_t>((u[xl] + u[xr] + d[xl] + d[xr] + 2) >> 2);
+        };
+        auto green = [&](int x, int xl, int xr) {
+            uint8_t* o = out + x * 3;
+            o[1] = m[x];
+            o[PIdx] = static_cast<uint8_t>((m[xl] + m[xr] + 1) >> 1);
+            o[S] = static_cast<uint8_t>((u[x] + d[x] + 1) >> 1);
+        };
+        auto at = [&](int x, int xl, int xr) {
+            if ((x & 1) == pParity) site(x, xl, xr);
+            else                    green(x, xl, xr);
+        };
+
+        at(0, 1, 1);
+
+        // 안쪽은 2픽셀씩 (색 배치가 고정이라 분기 없음)
+        int x = 1;
+        if (pParity == 1)
+            for (; x + 1 < w - 1; x += 2) { site(x, x - 1, x + 1); green(x + 1, x, x + 2); }
+        else
+            for (; x + 1 < w - 1; x += 2) { green(x, x - 1, x + 1); site(x + 1, x, x + 2); }
+        for (; x < w - 1; ++x)
+            at(x, x - 1, x + 1);
+
+        at(w - 1, w - 2, w - 2);
+    }
+
+    // ===================== 소스: 카메라 원본 → BGR8 행 =====================
+    template <RawFormat F>
+    class RawSource
+    {
+    public:
+        explicit RawSource(const RawFrame& raw) : m_raw(raw) {}
+
+        int    Width() const { return m_raw.width; }
+        int    Height() const { return m_raw.height; }
+        size_t RowFootprint() const
+        {
+            // 베이어는 위/아래 행까지 읽음 (이웃 행은 바로 앞 출력 행에서 이미 캐시에 있음)
+            return static_cast<size_t>(m_raw.width) * RawBytesPerPixel(F) + static_cast<size_t>(m_raw.width) * 3;
+        }
+
+        const uint8_t* Row(int y, uint8_t* out) const
+        {
+            const uint8_t* src = RowPtr(y);
+            const int w = m_raw.width;
+
+            if constexpr (F == RawFormat::BGR8) {
+                return src;   // 이미 BGR8 (복사 없음)
+            }
+            else if constexpr (F == RawFormat::RGB8) {
+                for (int x = 0; x < w; ++x) {
+                    out[x * 3 + 0] = src[x * 3 + 2];
+                    out[x * 3 + 1] = src[x * 3 + 1];
+                    out[x * 3 + 2] = src[x * 3 + 0];
+                }
+            }
+            else if constexpr (F == RawFormat::Mono8) {
+                for (int x = 0; x < w; ++x)
+                    out[x * 3 + 0] = out[x * 3 + 1] = out[x * 3 + 2] = src[x];
+            }
+            else {
+                // R 의 위치 (열 rx, 행 ry)
+                constexpr int rx = (F == RawFormat::BayerGR8 || F == RawFormat::BayerBG8) ? 1 : 0;
+                constexpr int ry = (F == RawFormat::BayerGB8 || F == RawFormat::BayerBG8) ? 1 : 0;
+                const uint8_t* up = RowPtr(Reflect(y - 1, m_raw.height));
+                const uint8_t* dn = RowPtr(Reflect(y + 1, m_raw.height));
+                if ((y & 1) == ry)
+                    BayerRow<2>(up, src, dn, w, rx, out);
+                else
+                    BayerRow<0>(up, src, dn, w, 1 - rx, out);
+            }
+            return out;
+        }
+
+    private:
+        const uint8_t* RowPtr(int y) const { return m_raw.data + static_cast<size_t>(y) * m_raw.stride; }
+
+        RawFrame m_raw;
+    };
+
+    // 형식별 소스를 만들어 fn 에 넘김 (형식은 실행 시간, 행 변환은 컴파일 타임 특수화)
+    template <class Fn>
+    bool WithRawSource(const RawFrame& raw, Fn&& fn)
+    {
+        if (!raw.IsValid())
+            return false;
+        if (IsBayer(raw.format) && (raw.width < 2 || raw.height < 2))
+            return false;
+
+        switch (raw.format) {
+        case RawFormat::Mono8:    fn(RawSource<RawFormat::Mono8>(raw));    return true;
+        case RawFormat::BayerRG8: fn(RawSource<RawFormat::BayerRG8>(raw)); return true;
+        case RawFormat::BayerGR8: fn(RawSource<RawFormat::BayerGR8>(raw)); return true;
+        case RawFormat::BayerGB8: fn(RawSource<RawFormat::BayerGB8>(raw)); return true;
+        case RawFormat::BayerBG8: fn(RawSource<RawFormat::BayerBG8>(raw)); return true;
+        case RawFormat::RGB8:     fn(RawSource<RawFormat::RGB8>(raw));     return true;
+        case RawFormat::BGR8:     fn(RawSource<RawFormat::BGR8>(raw));     return true;
+        }
+        return false;
+    }
+}
+
+// ===================== 원본 → BGR8 =====================
+bool ConvertToBgr(const RawFrame& raw, ImageBuffer& dst, CThreadPool* pool, const Tile::ChannelLut* lut)
+{
+    return WithRawSource(raw, [&](const auto& src) {
+        if (lut)
+            Tile::Run(src, dst, pool, *lut);
+        else
+            Tile::Run(src, dst, pool);
+    });
+}
+
+// ===================== 원본 → 미리보기 (변환 + 면적 평균 축소 융합) =====================
+bool ConvertPreview(const RawFrame& raw, int maxW, int maxH, ImageBuffer& dst, CThreadPool* pool)
+{
+    int w = 0, h = 0;
+    if (!raw.IsValid() || !Tile::FitSize(raw.width, raw.height, maxW, maxH, w, h)) {
+        dst.Allocate(0, 0);
+        return false;
+    }
+    const bool ok = WithRawSource(raw, [&](const auto& src) {
+        using Source = std::decay_t<decltype(src)>;
+        Tile::Run(Tile::AreaDownscale<Source>(src, w, h), dst, pool);
+    });
+    if (!ok)
+        dst.Allocate(0, 0);
+    return ok;
+}
@@ -0,0 +1,45 @@
+﻿#pragma once
+#include "ImageView.h"
+#include "TilePipeline.h"
+
+#include <cstdint>
+
+// ===== 카메라 원본 픽셀 형식 (직접 변환하는 것만, 나머지는 Pylon 변환기로) =====
+enum class RawFormat : uint8_t
+{
+    Mono8,
+    BayerRG8,   // 2x2 첫 행 R G / 둘째 행 G B
+    BayerGR8,
+    BayerGB8,
+    BayerBG8,
+    RGB8,
+    BGR8,
+};
+
+const char* RawFormatName(RawFormat format);
+int         RawBytesPerPixel(RawFormat format);
+
+// ===== 카메라 원본 프레임 (빌린 버퍼, MFC/Pylon 비의존) =====
+struct RawFrame
+{
+    const uint8_t* data = nullptr;
+    int       width = 0;
+    int       height = 0;
+    int       stride = 0;      // 한 행 바이트 수 (패딩 포함)
+    RawFormat format = RawFormat::BGR8;
+
+    bool IsValid() const
+    {
+        return data && width > 0 && height > 0 && stride >= width * RawBytesPerPixel(format);
+    }
+};
+
+// ===== 원본 → BGR8 (타일 파이프라인) =====
+// 베이어는 3x3 bilinear 디모자이크 (경계는 reflect101 → 색 배치가 유지됨), 폭/높이 2 이상.
+// lut 가 있으면 같은 타일 안에서 바로 적용 (별도 패스 없음). pool = nullptr 이면 호출 스레드만.
+bool ConvertToBgr(const RawFrame& raw, ImageBuffer& dst, CThreadPool* pool = nullptr,
+                  const Tile::ChannelLut* lut = nullptr);
+
+// 원본 → 미리보기 (DownscaleToFit 와 같은 크기 규칙/면적 평균).
+// 센서 해상도 BGR8 을 만들지 않고 변환 행을 바로 누적 → ConvertToBgr + DownscaleToFit 와 결과가 같다.
+bool ConvertPreview(const RawFrame& raw, int maxW, int maxH, ImageBuffer& dst, CThreadPool* pool = nullptr);
@@ -0,0 +1,250 @@
+﻿#include "FrameSource.h"
+#include "ImageEncoder.h"
+#include "LatencyStats.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    enum class Role { Unknown, Top, Front };
+
+    // 역할 + 짝 키 (이름에서 역할 단어를 뺀 나머지: capture_123_top → capture_123_)
+    Role RoleFromName(const std::string& path, std::string& key)
+    {
+        key = fs::path(path).stem().string();
+        std::transform(key.begin(), key.end(), key.begin(),
+            [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        static const struct { const char* word; Role role; } kWords[] = {
+            { "top", Role::Top }, { "front", Role::Front }, { "side", Role::Front } };
+        for (const auto& w : kWords)
+        {
+            const size_t pos = key.find(w.word);
+            if (pos != std::string::npos) {
+                key.erase(pos, std::strlen(w.word));
+                return w.role;
+            }
+        }
+        return Role::Unknown;
+    }
+
+    bool ReadFile(const std::string& path, std::vector<uint8_t>& out)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return false;
+        out.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        return !out.empty();
+    }
+
+    // PPM 헤더 토큰 (공백/주석 건너뛰기)
+    bool NextToken(const uint8_t* data, size_t len, size_t& pos, int& value)
+    {
+        while (pos < len) {
+            if (data[pos] == '#') {
+                while (pos < len && data[pos] != '\n') ++pos;
+            }
+            else if (std::isspace(data[pos])) {
+                ++pos;
+            }
+            else {
+                break;
+            }
+        }
+        if (pos >= len || !std::isdigit(data[pos])) return false;
+        value = 0;
+        while (pos < len && std::isdigit(data[pos]) && value < 100000)
+            value = value * 10 + (data[pos++] - '0');
+        return true;
+    }
+}
+
+// ===================== PPM =====================
+bool LoadPpm(const uint8_t* data, size_t len, ImageBuffer& out)
+{
+    if (len < 2 || data[0] != 'P' || data[1] != '6') return false;
+
+    size_t pos = 2;
+    int w = 0, h = 0, maxv = 0;
+    if (!NextToken(data, len, pos, w) || !NextToken(data, len, pos, h) ||
+        !NextToken(data, len, pos, maxv) || maxv != 255 || w <= 0 || h <= 0)
+        return false;
+    ++pos; // 헤더 뒤 공백 1바이트
+
+    const size_t bytes = static_cast<size_t>(w) * h * 3;
+    if (pos > len || len - pos < bytes) return false;
+
+    out.Allocate(w, h);
+    const uint8_t* rgb = data + pos;
+    for (size_t i = 0; i < bytes; i += 3) {
+        out.pixels[i]     = rgb[i + 2];
+        out.pixels[i + 1] = rgb[i + 1];
+        out.pixels[i + 2] = rgb[i];
+    }
+    return true;
+}
+
+bool LoadImageFile(const std::string& path, ImageBuffer& out)
+{
+    std::vector<uint8_t> bytes;
+    if (!ReadFile(path, bytes)) return false;
+    return LoadPpm(bytes.data(), bytes.size(), out) || DecodeImage(bytes.data(), bytes.size(), out);
+}
+
+bool IsImageFileName(const std::string& path)
+{
+    std::string ext = fs::path(path).extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" ||
+           ext == ".ppm" || ext == ".qoi" || ext == ".bgr";
+}
+
+// ===================== 파일 소스 =====================
+void CFileFrameSource::Reset(const FileSourceOptions& opt)
+{
+    m_opt = opt;
+    m_images.clear();
+    m_pairs.clear();
+    m_skipped = 0;
+    m_unpaired = 0;
+    m_emitted = 0;
+    m_startNs = 0;
+}
+
+bool CFileFrameSource::Open(const std::vector<std::string>& paths, const FileSourceOptions& opt, std::string* error)
+{
+    Reset(opt);
+
+    // ===== 파일 목록 (디렉터리는 재귀, 정렬) =====
+    std::vector<std::string> files;
+    for (const std::string& p : paths)
+    {
+        std::error_code ec;
+        if (fs::is_directory(p, ec)) {
+            for (const auto& entry : fs::recursive_directory_iterator(p, ec))
+                if (entry.is_regular_file())
+                    files.push_back(entry.path().string());
+        }
+        else {
+            files.push_back(p);
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    // ===== 디코딩 + 역할 분류 =====
+    std::vector<std::pair<std::string, size_t>> tops, fronts;   // (짝 키, 이미지 번호)
+    for (const std::string& f : files)
+    {
+        const fs::path ext = fs::path(f).extension();
+        if (ext == ".yaml" || ext == ".txt" || ext == ".json" || ext == ".log" || ext == ".csv")
+            continue; // 라벨/설정 파일
+
+        ImageBuffer img;
+        if (!LoadImageFile(f, img)) {
+            ++m_skipped;
+            continue;
+        }
+
+        const size_t idx = m_images.size();
+        m_images.push_back(std::move(img));
+        std::string key;
+        switch (RoleFromName(f, key))
+        {
+        case Role::Top:   tops.emplace_back(key, idx); break;
+        case Role::Front: fronts.emplace_back(key, idx); break;
+        default:          m_pairs.push_back({ fs::path(f).filename().string(), idx, idx }); break;
+        }
+    }
+
+    // ===== TOP ↔ FRONT 짝짓기 =====
+    // 같은 키끼리 (녹화 캡처). 키가 하나도 안 맞으면 (데이터셋 클래스별 이름) 정렬 순서대로.
+    size_t paired = 0;
+    std::vector<bool> frontUsed(fronts.size(), false);
+    for (const auto& t : tops)
+    {
+        for (size_t i = 0; i < fronts.size(); ++i)
+        {
+            if (!frontUsed[i] && fronts[i].first == t.first) {
+                frontUsed[i] = true;
+                m_pairs.push_back({ t.first, t.second, fronts[i].second });
+                ++paired;
+                break;
+            }
+        }
+    }
+    if (paired == 0)
+    {
+        paired = std::min(tops.size(), fronts.size());
+        for (size_t i = 0; i < paired; ++i)
+            m_pairs.push_back({ "pair " + std::to_string(i), tops[i].second, fronts[i].second });
+    }
+    m_unpaired = tops.size() + fronts.size() - 2 * paired;
+
+    if (m_pairs.empty()) {
+        if (error)
+            *error = "no decodable images (" + std::to_string(m_skipped) + " skipped)";
+        return false;
+    }
+    return true;
+}
+
+void CFileFrameSource::OpenSynthetic(int width, int height, size_t count, const FileSourceOptions& opt, uint32_t seed)
+{
+    Reset(opt);
+
+    // 밝은 원판(캔) + 그라디언트 + 노이즈. 쌍마다 위치를 조금씩 옮겨 인코더 캐시 효과를 줄임.
+    for (size_t k = 0; k < std::max<size_t>(count, 1); ++k)
+    {
+        ImageBuffer img;
+        img.Allocate(width, height);
+        const double cx = width * (0.4 + 0.2 * (k % 5) / 4.0), cy = height * 0.5;
+        const double r2 = (height * 0.35) * (height * 0.35);
+        for (int y = 0; y < height; ++y)
+        {
+            uint8_t* row = img.Row(y);
+            for (int x = 0; x < width; ++x)
+            {
+                seed = seed * 1664525u + 1013904223u;
+                const int noise = static_cast<int>((seed >> 24) % 9) - 4;
+                const double dx = x - cx, dy = y - cy;
+                const int base = (dx * dx + dy * dy < r2) ? 170 + (x * 40) / width : 40 + (y * 20) / height;
+                for (int c = 0; c < 3; ++c)
+                    row[x * 3 + c] = static_cast<uint8_t>(std::clamp(base + c * 8 + noise, 0, 255));
+            }
+        }
+        m_images.push_back(std::move(img));
+        m_pairs.push_back({ "synthetic " + std::to_string(k), k, k });
+    }
+}
+
+bool CFileFrameSource::Next(CapturePair& out, uint64_t& scheduledNs)
+{
+    if (m_pairs.empty()) return false;
+    if (m_opt.limit && m_emitted >= m_opt.limit) return false;
+    if (m_opt.loops > 0 && m_emitted >= m_pairs.size() * static_cast<size_t>(m_opt.loops)) return false;
+
+    // ===== 속도 조절 (고정 일정: 밀려도 다음 예정 시각은 그대로) =====
+    const uint64_t now = NowNs();
+    if (m_emitted == 0) m_startNs = now;
+    scheduledNs = now;
+    if (m_opt.rate > 0.0)
+    {
+        scheduledNs = m_startNs + static_cast<uint64_t>(m_emitted * 1e9 / m_opt.rate);
+        if (scheduledNs > now)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(scheduledNs - now));
+    }
+
+    const Pair& p = m_pairs[m_emitted % m_pairs.size()];
+    out.name = p.name;
+    out.top = &m_images[p.top];
+    out.front = &m_images[p.front];
+    ++m_emitted;
+    return true;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include "ImageView.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===== 검사 1회 분량 프레임 (TOP + FRONT) =====
+struct CapturePair
+{
+    std::string       name;      // 보고용 (원본 파일 이름)
+    const ImageBuffer* top = nullptr;
+    const ImageBuffer* front = nullptr;
+};
+
+struct FileSourceOptions
+{
+    double rate = 0.0;     // 초당 검사 수 (0 = 가능한 한 빠르게)
+    int    loops = 1;      // 전체 목록 반복 횟수 (0 = 무한)
+    size_t limit = 0;      // 최대 검사 수 (0 = 제한 없음)
+};
+
+// ===== 파일 기반 카메라 소스 (헤드리스 재생용) =====
+// 디렉터리(재귀)나 파일 목록을 미리 전부 BGR8 로 디코딩해 메모리에 두고,
+// 설정한 속도로 한 쌍씩 내준다 (디스크 I/O 가 측정에 섞이지 않게).
+//
+// 짝짓기 규칙:
+//   - 이름에 "top" 이 들어간 파일 ↔ "front" / "side" 가 들어간 파일 중 나머지 이름이 같은 것끼리
+//     (C:\CanClient\captures 의 capture_<stamp>_top / _front). 이름이 하나도 안 맞으면 정렬 순서대로.
+//   - 역할을 알 수 없는 파일 (datasets/can_defect 이미지 등) 은 같은 영상을 TOP/FRONT 양쪽으로 보냄
+//
+// 디코딩: DecodeImage (QOI / raw BGR8, OpenCV 빌드면 PNG/JPEG) + 바이너리 PPM(P6).
+class CFileFrameSource
+{
+public:
+    // 파일/디렉터리 경로를 읽어 들인다. 하나도 못 읽으면 false.
+    bool Open(const std::vector<std::string>& paths, const FileSourceOptions& opt, std::string* error = nullptr);
+
+    // 합성 영상 count 쌍 (데이터가 없는 환경에서 파이프라인만 측정할 때).
+    // seed 가 다르면 다른 영상 (부하 생성기에서 라인별로 구분).
+    void OpenSynthetic(int width, int height, size_t count, const FileSourceOptions& opt, uint32_t seed = 1234);
+
+    // 다음 쌍. rate 가 있으면 예정 시각까지 대기한다. 끝나면 false.
+    // scheduledNs: 이 쌍의 예정 시각 (NowNs 기준). 밀린 만큼이 대기열 지연.
+    bool Next(CapturePair& out, uint64_t& scheduledNs);
+
+    size_t PairCount() const { return m_pairs.size(); }
+    size_t ImageCount() const { return m_images.size(); }
+    size_t Skipped() const { return m_skipped; }        // 디코딩 실패 파일 수
+    size_t Unpaired() const { return m_unpaired; }      // 짝 없는 TOP/FRONT 수
+
+private:
+    struct Pair
+    {
+        std::string name;
+        size_t top;
+        size_t front;
+    };
+
+    void Reset(const FileSourceOptions& opt);
+
+    FileSourceOptions        m_opt;
+    std::vector<ImageBuffer> m_images;
+    std::vector<Pair>        m_pairs;
+    size_t   m_skipped = 0;
+    size_t   m_unpaired = 0;
+
+    size_t   m_emitted = 0;
+    uint64_t m_startNs = 0;
+};
+
+// 바이너리 PPM(P6, maxval 255) → BGR8
+bool LoadPpm(const uint8_t* data, size_t len, ImageBuffer& out);
+
+// 이미지 파일 1장 → BGR8 (PPM, 그 외 DecodeImage: qoi/bgr, OpenCV 빌드면 png/jpg/bmp). 도구 공용.
+bool LoadImageFile(const std::string& path, ImageBuffer& out);
+
+// 도구가 폴더에서 고르는 확장자인지 (png/jpg/jpeg/bmp/ppm/qoi/bgr, 대소문자 무관)
+bool IsImageFileName(const std::string& path);
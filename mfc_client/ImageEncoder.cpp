@@ -0,0 +1,380 @@
+﻿#include "ImageEncoder.h"
+#include "OpenCvSupport.h"
+#include "PngEncoder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    // ===== 공통 =====
+    void PutU32(uint8_t* p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    uint32_t GetU32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    const char* kCodecNames[] = { "png", "qoi", "raw", "jpeg" };
+    const char* kCodecExts[] = { ".png", ".qoi", ".bgr", ".jpg" };
+
+    // 디코딩 결과 크기 상한 (손상된 헤더로 거대한 할당 방지)
+    constexpr uint32_t kMaxDimension = 16384;
+
+    // ===== QOI =====
+    // https://qoiformat.org/qoi-specification.pdf (3채널, sRGB)
+    constexpr uint8_t kQoiOpIndex = 0x00;
+    constexpr uint8_t kQoiOpDiff = 0x40;
+    constexpr uint8_t kQoiOpLuma = 0x80;
+    constexpr uint8_t kQoiOpRun = 0xC0;
+    constexpr uint8_t kQoiOpRgb = 0xFE;
+    constexpr uint8_t kQoiOpRgba = 0xFF;
+    constexpr uint8_t kQoiMask2 = 0xC0;
+    constexpr size_t  kQoiHeaderSize = 14;
+    constexpr uint8_t kQoiPadding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+    struct QoiPixel { uint8_t r, g, b, a; };
+
+    inline int QoiHash(const QoiPixel& p)
+    {
+        return (p.r * 3 + p.g * 5 + p.b * 7 + p.a * 11) & 63;
+    }
+
+    inline bool SamePixel(const QoiPixel& a, const QoiPixel& b)
+    {
+        return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a;
+    }
+
+    // ===== 인코더 구현 =====
+    class QoiEncoder : public IImageEncoder
+    {
+    public:
+        ImageCodec Codec() const override { return ImageCodec::Qoi; }
+        bool Encode(const ImageView& img, std::vector<uint8_t>& out) override { return QoiEncode(img, out); }
+    };
+
+    class RawBgrEncoder : public IImageEncoder
+    {
+    public:
+        ImageCodec Codec() const override { return ImageCodec::RawBgr; }
+        bool Encode(const ImageView& img, std::vector<uint8_t>& out) override { return RawBgrEncode(img, out); }
+    };
+
+#ifdef CANCLIENT_HAS_OPENCV
+    class OpenCvEncoder : public IImageEncoder
+    {
+    public:
+        OpenCvEncoder(ImageCodec codec, std::vector<int> params)
+            : m_codec(codec), m_params(std::move(params)) {}
+
+        ImageCodec Codec() const override { return m_codec; }
+
+        bool Encode(const ImageView& img, std::vector<uint8_t>& out) override
+        {
+            if (!img.IsValid()) return false;
+            const cv::Mat mat(img.height, img.width, CV_8UC3,
+                              const_cast<uint8_t*>(img.data), img.stride);
+            try
+            {
+                return cv::imencode(CodecExtension(m_codec), mat, out, m_params);
+            }
+            catch (const cv::Exception&)
+            {
+                return false;
+            }
+        }
+
+    private:
+        ImageCodec m_codec;
+        std::vector<int> m_params;
+    };
+#endif
+}
+
+const char* CodecName(ImageCodec codec)
+{
+    const size_t i = static_cast<size_t>(codec);
+    return i < static_cast<size_t>(ImageCodec::Count) ? kCodecNames[i] : "?";
+}
+
+const char* CodecExtension(ImageCodec codec)
+{
+    const size_t i = static_cast<size_t>(codec);
+    return i < static_cast<size_t>(ImageCodec::Count) ? kCodecExts[i] : ".bin";
+}
+
+bool ParseCodecName(const std::string& name, ImageCodec& codec)
+{
+    for (size_t i = 0; i < static_cast<size_t>(ImageCodec::Count); ++i)
+    {
+        if (name == kCodecNames[i])
+        {
+            codec = static_cast<ImageCodec>(i);
+            return true;
+        }
+    }
+    if (name == "jpg") { codec = ImageCodec::Jpeg; return true; }
+    return false;
+}
+
+std::unique_ptr<IImageEncoder> CreateImageEncoder(ImageCodec codec, int jpegQuality, int pngThreads)
+{
+    switch (codec)
+    {
+    case ImageCodec::Png:
+        return std::make_unique<CPngStripeEncoder>(static_cast<size_t>(std::max(0, pngThreads)));
+    case ImageCodec::Qoi:
+        return std::make_unique<QoiEncoder>();
+    case ImageCodec::RawBgr:
+        return std::make_unique<RawBgrEncoder>();
+#ifdef CANCLIENT_HAS_OPENCV
+    case ImageCodec::Jpeg:
+        return std::make_unique<OpenCvEncoder>(codec, std::vector<int>{ cv::IMWRITE_JPEG_QUALITY, jpegQuality });
+#endif
+    default:
+        (void)jpegQuality;
+        return nullptr;
+    }
+}
+
+// ===== QOI =====
+bool QoiEncode(const ImageView& img, std::vector<uint8_t>& out)
+{
+    if (!img.IsValid()) return false;
+
+    const size_t pixels = static_cast<size_t>(img.width) * img.height;
+    out.resize(kQoiHeaderSize + pixels * 4 + sizeof(kQoiPadding));  // 최악의 경우 (RGB op = 4바이트)
+    uint8_t* p = out.data();
+
+    std::memcpy(p, "qoif", 4);
+    PutU32(p + 4, static_cast<uint32_t>(img.width));
+    PutU32(p + 8, static_cast<uint32_t>(img.height));
+    p[12] = 3;  // channels
+    p[13] = 0;  // sRGB
+    p += kQoiHeaderSize;
+
+    QoiPixel index[64] = {};
+    QoiPixel prev = { 0, 0, 0, 255 };
+    int run = 0;
+
+    for (int y = 0; y < img.height; ++y)
+    {
+        const uint8_t* row = img.Row(y);
+        for (int x = 0; x < img.width; ++x, row += 3)
+        {
+            const QoiPixel px = { row[2], row[1], row[0], 255 };  // BGR → RGB
+
+            if (SamePixel(px, prev))
+            {
+                if (++run == 62)
+                {
+                    *p++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+
+            if (run > 0)
+            {
+                *p++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+                run = 0;
+            }
+
+            const int h = QoiHash(px);
+            if (SamePixel(index[h], px))
+            {
+                *p++ = static_cast<uint8_t>(kQoiOpIndex | h);
+            }
+            else
+            {
+                index[h] = px;
+
+                const int8_t vr = static_cast<int8_t>(px.r - prev.r);
+                const int8_t vg = static_cast<int8_t>(px.g - prev.g);
+                const int8_t vb = static_cast<int8_t>(px.b - prev.b);
+                const int8_t vgr = static_cast<int8_t>(vr - vg);
+                const int8_t vgb = static_cast<int8_t>(vb - vg);
+
+                if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                {
+                    *p++ = static_cast<uint8_t>(kQoiOpDiff | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+                }
+                else if (vgr > -9 && vgr < 8 && vg > -33 && vg < 32 && vgb > -9 && vgb < 8)
+                {
+                    *p++ = static_cast<uint8_t>(kQoiOpLuma | (vg + 32));
+                    *p++ = static_cast<uint8_t>(((vgr + 8) << 4) | (vgb + 8));
+                }
+                else
+                {
+                    *p++ = kQoiOpRgb;
+                    *p++ = px.r;
+                    *p++ = px.g;
+                    *p++ = px.b;
+                }
+            }
+            prev = px;
+        }
+    }
+    if (run > 0)
+        *p++ = static_cast<uint8_t>(kQoiOpRun | (run - 1));
+
+    std::memcpy(p, kQoiPadding, sizeof(kQoiPadding));
+    p += sizeof(kQoiPadding);
+
+    out.resize(static_cast<size_t>(p - out.data()));
+    return true;
+}
+
+bool QoiDecode(const uint8_t* data, size_t len, ImageBuffer& out)
+{
+    if (!data || len < kQoiHeaderSize + sizeof(kQoiPadding)) return false;
+    if (std::memcmp(data, "qoif", 4) != 0) return false;
+
+    const uint32_t w = GetU32(data + 4);
+    const uint32_t h = GetU32(data + 8);
+    const uint8_t channels = data[12];
+    if (w == 0 || h == 0 || w > kMaxDimension || h > kMaxDimension) return false;
+    if (channels != 3 && channels != 4) return false;
+
+    out.Allocate(static_cast<int>(w), static_cast<int>(h));
+
+    QoiPixel index[64] = {};
+    QoiPixel px = { 0, 0, 0, 255 };
+    int run = 0;
+
+    const uint8_t* p = data + kQoiHeaderSize;
+    const uint8_t* end = data + len - sizeof(kQoiPadding);
+    uint8_t* dst = out.pixels.data();
+    uint8_t* dstEnd = dst + out.pixels.size();
+
+    for (; dst < dstEnd; dst += 3)
+    {
+        if (run > 0)
+        {
+            --run;
+        }
+        else
+        {
+            if (p >= end) return false;
+            const uint8_t b1 = *p++;
+
+            if (b1 == kQoiOpRgb)
+            {
+                if (end - p < 3) return false;
+                px.r = p[0]; px.g = p[1]; px.b = p[2];
+                p += 3;
+            }
+            else if (b1 == kQoiOpRgba)
+            {
+                if (end - p < 4) return false;
+                px.r = p[0]; px.g = p[1]; px.b = p[2]; px.a = p[3];
+                p += 4;
+            }
+            else if ((b1 & kQoiMask2) == kQoiOpIndex)
+            {
+                px = index[b1];
+            }
+            else if ((b1 & kQoiMask2) == kQoiOpDiff)
+            {
+                px.r = static_cast<uint8_t>(px.r + ((b1 >> 4) & 3) - 2);
+                px.g = static_cast<uint8_t>(px.g + ((b1 >> 2) & 3) - 2);
+                px.b = static_cast<uint8_t>(px.b + (b1 & 3) - 2);
+            }
+            else if ((b1 & kQoiMask2) == kQoiOpLuma)
+            {
+                if (p >= end) return false;
+                const uint8_t b2 = *p++;
+                const int vg = (b1 & 0x3F) - 32;
+                px.r = static_cast<uint8_t>(px.r + vg - 8 + ((b2 >> 4) & 0x0F));
+                px.g = static_cast<uint8_t>(px.g + vg);
+                px.b = static_cast<uint8_t>(px.b + vg - 8 + (b2 & 0x0F));
+            }
+            else  // RUN
+            {
+                run = b1 & 0x3F;
+            }
+            index[QoiHash(px)] = px;
+        }
+
+        dst[0] = px.b;
+        dst[1] = px.g;
+        dst[2] = px.r;
+    }
+    return true;
+}
+
+// ===== Raw BGR =====
+// [ 'BGR8' ][ width u32 BE ][ height u32 BE ][ width*height*3 바이트, 행 패딩 없음 ]
+bool RawBgrEncode(const ImageView& img, std::vector<uint8_t>& out)
+{
+    if (!img.IsValid()) return false;
+
+    const size_t rowBytes = static_cast<size_t>(img.width) * 3;
+    out.resize(12 + rowBytes * img.height);
+    uint8_t* p = out.data();
+
+    std::memcpy(p, "BGR8", 4);
+    PutU32(p + 4, static_cast<uint32_t>(img.width));
+    PutU32(p + 8, static_cast<uint32_t>(img.height));
+    p += 12;
+
+    if (static_cast<size_t>(img.stride) == rowBytes)
+    {
+        std::memcpy(p, img.data, rowBytes * img.height);
+    }
+    else
+    {
+        for (int y = 0; y < img.height; ++y, p += rowBytes)
+            std::memcpy(p, img.Row(y), rowBytes);
+    }
+    return true;
+}
+
+bool RawBgrDecode(const uint8_t* data, size_t len, ImageBuffer& out)
+{
+    if (!data || len < 12 || std::memcmp(data, "BGR8", 4) != 0) return false;
+
+    const uint32_t w = GetU32(data + 4);
+    const uint32_t h = GetU32(data + 8);
+    if (w == 0 || h == 0 || w > kMaxDimension || h > kMaxDimension) return false;
+
+    const size_t bytes = static_cast<size_t>(w) * h * 3;
+    if (len - 12 < bytes) return false;
+
+    out.Allocate(static_cast<int>(w), static_cast<int>(h));
+    std::memcpy(out.pixels.data(), data + 12, bytes);
+    return true;
+}
+
+// ===== 디코딩 =====
+bool DecodeImage(const uint8_t* data, size_t len, ImageBuffer& out)
+{
+    if (!data || len < 4) return false;
+    if (std::memcmp(data, "qoif", 4) == 0) return QoiDecode(data, len, out);
+    if (std::memcmp(data, "BGR8", 4) == 0) return RawBgrDecode(data, len, out);
+
+#ifdef CANCLIENT_HAS_OPENCV
+    try
+    {
+        const cv::Mat buf(1, static_cast<int>(len), CV_8UC1, const_cast<uint8_t*>(data));
+        const cv::Mat img = cv::imdecode(buf, cv::IMREAD_COLOR);
+        if (img.empty() || img.type() != CV_8UC3) return false;
+
+        out.Allocate(img.cols, img.rows);
+        for (int y = 0; y < img.rows; ++y)
+            std::memcpy(out.Row(y), img.ptr<uint8_t>(y), static_cast<size_t>(img.cols) * 3);
+        return true;
+    }
+    catch (const cv::Exception&)
+    {
+        return false;
+    }
+#else
+    return false;
+#endif
+}
@@ -0,0 +1,44 @@
+﻿#pragma once
+#include "ImageView.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ===== 전송 코덱 =====
+enum class ImageCodec : uint8_t
+{
+    Png = 0,     // 무손실, 느림 (멀티스레드 스트라이프 인코더)
+    Qoi = 1,     // 무손실, 빠름 (QOI 포맷)
+    RawBgr = 2,  // 무압축 BGR8 + 12바이트 헤더
+    Jpeg = 3,    // 손실, 고품질
+    Count
+};
+
+const char* CodecName(ImageCodec codec);            // "png", "qoi", "raw", "jpeg"
+const char* CodecExtension(ImageCodec codec);       // ".png", ".qoi", ".bgr", ".jpg"
+bool        ParseCodecName(const std::string& name, ImageCodec& codec);
+
+// ===== 인코더 인터페이스 =====
+// 입력은 항상 BGR8 packed. 결과 바이트는 out 에 덮어쓴다 (용량은 재사용).
+class IImageEncoder
+{
+public:
+    virtual ~IImageEncoder() = default;
+    virtual ImageCodec Codec() const = 0;
+    virtual bool Encode(const ImageView& img, std::vector<uint8_t>& out) = 0;
+};
+
+// 빌드에 해당 백엔드가 없으면 nullptr (JPEG 는 OpenCV 필요)
+// pngThreads: PNG 스트라이프 인코더 스레드 수 (0 = 코어 수)
+std::unique_ptr<IImageEncoder> CreateImageEncoder(ImageCodec codec, int jpegQuality = 95, int pngThreads = 0);
+
+// ===== 디코딩 (벤치마크 / 재생 / 검증용) =====
+// 매직으로 포맷 판별: 'qoif' → QOI, 'BGR8' → Raw, 그 외 → OpenCV imdecode
+bool DecodeImage(const uint8_t* data, size_t len, ImageBuffer& out);
+
+// ===== 개별 코덱 =====
+bool QoiEncode(const ImageView& img, std::vector<uint8_t>& out);
+bool QoiDecode(const uint8_t* data, size_t len, ImageBuffer& out);
+bool RawBgrEncode(const ImageView& img, std::vector<uint8_t>& out);
+bool RawBgrDecode(const uint8_t* data, size_t len, ImageBuffer& out);
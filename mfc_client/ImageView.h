@@ -0,0 +1,41 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ===== 이미지 뷰 (MFC/Pylon 비의존) =====
+// BGR8 packed 버퍼를 복사 없이 가리키는 가벼운 뷰.
+// stride 는 한 행의 바이트 수 (패딩 포함 가능).
+struct ImageView
+{
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;
+
+    ImageView() = default;
+    ImageView(const uint8_t* d, int w, int h, int s = 0)
+        : data(d), width(w), height(h), stride(s > 0 ? s : w * 3) {}
+
+    bool IsValid() const { return data && width > 0 && height > 0 && stride >= width * 3; }
+    const uint8_t* Row(int y) const { return data + static_cast<size_t>(y) * stride; }
+};
+
+// ===== 소유형 BGR8 버퍼 =====
+struct ImageBuffer
+{
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+
+    void Allocate(int w, int h)
+    {
+        width = w;
+        height = h;
+        pixels.resize(static_cast<size_t>(w) * h * 3);
+    }
+
+    int Stride() const { return width * 3; }
+    uint8_t* Row(int y) { return pixels.data() + static_cast<size_t>(y) * Stride(); }
+    ImageView View() const { return ImageView(pixels.data(), width, height, Stride()); }
+};
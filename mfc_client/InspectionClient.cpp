@@ -0,0 +1,152 @@
+﻿#include "InspectionClient.h"
+#include "LatencyStats.h"
+#include "ReplyParser.h"
+#include "SocketCompat.h"
+
+#include <string>
+
+using namespace Net;
+
+namespace
+{
+    void SetError(std::string* error, const char* what, int code = 0)
+    {
+        if (!error) return;
+        *error = what;
+        if (code)
+            *error += " (" + std::to_string(code) + ")";
+    }
+
+    uint64_t DeadlineAfter(uint64_t from, int ms)
+    {
+        return ms > 0 ? from + static_cast<uint64_t>(ms) * 1000000ull : 0;
+    }
+
+    // 기다리다 실패한 이유 → error / timing
+    bool Fail(IoWait w, const char* phase, std::string* error, RequestTiming& timing)
+    {
+        if (w == IoWait::Timeout) {
+            timing.timedOut = true;
+            SetError(error, (std::string(phase) + " timeout").c_str());
+        }
+        else if (w == IoWait::Cancelled) {
+            timing.cancelled = true;
+            SetError(error, (std::string(phase) + " cancelled").c_str());
+        }
+        else {
+            SetError(error, (std::string(phase) + " failed").c_str(), LastError());
+        }
+        return false;
+    }
+
+    const size_t kMaxReplyBytes = 256 * 1024;   // 응답 상한 (검출 16개/뷰 JSON 은 수 KB)
+
+    // 받은 응답이 끝났는지: 바이너리는 크기 필드만큼, JSON 은 최상위 객체가 닫히면.
+    // 서버는 응답 후 닫지만 keep-alive 대체 서버처럼 안 닫는 경우에도 기한까지 기다리지 않게.
+    bool ReplyComplete(const std::string& r)
+    {
+        const size_t want = BinaryReply::ExpectedSize(reinterpret_cast<const uint8_t*>(r.data()), r.size());
+        if (want)
+            return r.size() >= want;
+
+        int depth = 0;
+        bool inString = false, escape = false;
+        for (char c : r)
+        {
+            if (inString) {
+                if (escape)         escape = false;
+                else if (c == '\\') escape = true;
+                else if (c == '"')  inString = false;
+            }
+            else if (c == '"')             inString = true;
+            else if (c == '{' || c == '[') ++depth;
+            else if (c == '}' || c == ']') { if (--depth == 0) return true; }
+        }
+        return false;
+    }
+}
+
+// ===================== 검사 요청 전송 =====================
+bool SendInspectionRequest(const ServerEndpoint& server,
+    const uint8_t* header, size_t headerSize,
+    const uint8_t* data, size_t size,
+    std::string& response,
+    CLatencyStats* stats, RequestTiming* timingOut, std::string* error,
+    const std::atomic<bool>* cancel)
+{
+    response.clear();
+    RequestTiming local;
+    RequestTiming& timing = timingOut ? *timingOut : local;
+    timing = RequestTiming();
+    if (size > 0x7FFFFFFF) {
+        SetError(error, "payload too large");
+        return false;
+    }
+    const NetTimeouts& limits = server.timeouts;
+
+    // ===== 주소 =====
+    const uint64_t connectStart = NowNs();
+    sockaddr_in addr;
+    if (!Resolve(server.host.c_str(), server.port, addr)) {
+        SetError(error, "cannot resolve host");
+        return false;
+    }
+
+    // ===== 소켓 생성 + 연결 (논블로킹, 기한) =====
+    SocketGuard sock(socket(AF_INET, SOCK_STREAM, 0));
+    if (sock.s == kInvalidSocket) {
+        SetError(error, "socket failed", LastError());
+        return false;
+    }
+    if (!SetNonBlocking(sock.s)) {
+        SetError(error, "non-blocking mode failed", LastError());
+        return false;
+    }
+    int code = 0;
+    const IoWait connected = ConnectUntil(sock.s, addr, DeadlineAfter(connectStart, limits.connectMs), cancel, code);
+    if (connected == IoWait::Failed) {
+        SetError(error, "connect failed", code);
+        return false;
+    }
+    if (connected != IoWait::Ready)
+        return Fail(connected, "connect", error, timing);
+    if (stats) stats->Record(Stage::Connect, NowNs() - connectStart);
+
+    // ===== 요청 헤더 (선택) → 길이(BE) → 본문 =====
+    const uint64_t sendStart = NowNs();
+    const uint64_t sendDeadline = DeadlineAfter(sendStart, limits.sendMs);
+    IoWait w = IoWait::Ready;
+    if (header && headerSize && (w = SendAllUntil(sock.s, header, headerSize, sendDeadline, cancel)) != IoWait::Ready)
+        return Fail(w, "header send", error, timing);
+
+    const uint32_t netSize = htonl(static_cast<uint32_t>(size));
+    if ((w = SendAllUntil(sock.s, reinterpret_cast<const uint8_t*>(&netSize), sizeof(netSize), sendDeadline, cancel)) != IoWait::Ready ||
+        (w = SendAllUntil(sock.s, data, size, sendDeadline, cancel)) != IoWait::Ready)
+        return Fail(w, "data send", error, timing);
+    const uint64_t sendEnd = NowNs();
+    if (stats) stats->Record(Stage::Send, sendEnd - sendStart);
+
+    // ===== 응답 수신 (서버는 JSON 한 덩어리 또는 바이너리 응답을 보내고 닫음) =====
+    // 여러 세그먼트로 나눠 와도 끝날 때까지 (닫힘 / 완결 / 상한). 끊김(RST 포함)은 받은 데까지,
+    // 아무것도 못 받았으면 기존처럼 빈 응답. 기한 초과/취소만 실패.
+    const uint64_t replyDeadline = DeadlineAfter(sendEnd, limits.replyMs);
+    char recvBuf[8192];
+    while (response.size() < kMaxReplyBytes)
+    {
+        int got = 0;
+        w = RecvSomeUntil(sock.s, recvBuf, sizeof(recvBuf), got, replyDeadline, cancel);
+        if (w == IoWait::Timeout || w == IoWait::Cancelled)
+            return Fail(w, "reply", error, timing);
+        if (w != IoWait::Ready || got <= 0)
+            break;
+        response.append(recvBuf, static_cast<size_t>(got));
+        if (ReplyComplete(response))
+            break;
+    }
+    const uint64_t recvEnd = NowNs();
+    if (stats) stats->Record(Stage::ServerWait, recvEnd - sendEnd);
+
+    timing.sendSeconds = (sendEnd - sendStart) / 1e9;
+    timing.waitSeconds = (recvEnd - sendEnd) / 1e9;
+    return true;
+}
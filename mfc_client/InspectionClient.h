@@ -0,0 +1,66 @@
+﻿#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "RequestHeader.h"
+
+class CLatencyStats;
+
+// ===== 요청 1건 단계별 기한 (ms, 0 = 무제한) =====
+// 서버가 멈춰도 스테이션이 무한정 서지 않게. 넘기면 그 요청만 실패 (대기열이 있으면 거기로).
+struct NetTimeouts
+{
+    int connectMs = 2000;   // 연결 (꺼진 서버는 바로 거절, 케이블/스위치 문제는 여기까지 기다림)
+    int sendMs = 5000;      // 헤더 + 길이 + 본문 전체
+    int replyMs = 10000;    // 전송 완료 → 응답 (AI 추론 포함)
+};
+
+// ===== 검사 서버 주소 =====
+struct ServerEndpoint
+{
+    std::string host = "10.10.21.121";
+    int         port = 9000;
+    ReplyFormat replyFormat = ReplyFormat::Json;   // Binary 면 요청 헤더로 바이너리 응답 요청
+    NetTimeouts timeouts;
+};
+
+// ===== 본문 지문 =====
+// 대체 서버가 짝지은 TOP/SIDE 를 응답에 되돌려 주고, 부하 생성기가 자기가 보낸 것과 비교하는 용도.
+// 길이 + 앞 64KB 의 FNV-1a (수 MB 본문도 수십 us).
+inline uint32_t PayloadFingerprint(const uint8_t* data, size_t size)
+{
+    uint32_t h = 2166136261u ^ static_cast<uint32_t>(size);
+    const size_t n = size < 64 * 1024 ? size : 64 * 1024;
+    for (size_t i = 0; i < n; ++i)
+        h = (h ^ data[i]) * 16777619u;
+    return h;
+}
+
+// ===== 요청 1건 결과 =====
+struct RequestTiming
+{
+    double sendSeconds = 0.0;    // 길이+본문 send (링크 대역폭 추정용)
+    double waitSeconds = 0.0;    // 전송 완료 → 응답 수신
+    bool   timedOut = false;     // 실패 사유가 기한 초과
+    bool   cancelled = false;    // 실패 사유가 취소 (호출 측 종료 등)
+};
+
+// ===== 검사 요청 전송 (Winsock / BSD 소켓 공용) =====
+// 연결 → [헤더] → [4바이트 길이(BE)][본문] → 응답 수신 → 종료.
+// 응답은 여러 세그먼트로 와도 끝날 때까지 모아 받는다: 바이너리('CNRP')는 크기 필드만큼,
+// JSON 은 최상위 객체가 닫힐 때까지 (문자열 안의 괄호는 세지 않음), 아니면 서버가 닫을 때까지.
+// 최대 256 KB (kMaxReplyBytes). 끊기면 받은 데까지, 아무것도 없으면 빈 문자열로 true (기존 동작과 동일).
+// 논블로킹 소켓으로 단계마다 server.timeouts 기한을 두고, cancel 이 켜지면 50 ms 안에 포기한다.
+// stats 가 있으면 Connect / Send / ServerWait 단계를 기록한다.
+// 실패 시 false, 사유는 error 에 (기한 초과/취소는 timing 에도).
+// Windows 에서는 호출 전에 WSAStartup 이 되어 있어야 한다.
+bool SendInspectionRequest(const ServerEndpoint& server,
+    const uint8_t* header, size_t headerSize,
+    const uint8_t* data, size_t size,
+    std::string& response,
+    CLatencyStats* stats = nullptr,
+    RequestTiming* timing = nullptr,
+    std::string* error = nullptr,
+    const std::atomic<bool>* cancel = nullptr);
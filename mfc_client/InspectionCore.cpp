@@ -0,0 +1,312 @@
+﻿#include "InspectionCore.h"
+#include "RequestHeader.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+// ===================== 응답 파싱 =====================
+bool ParseInspectionReply(const std::string& text, InspectionReply& out, std::string* error)
+{
+    ReplyError e;
+    if (ParseInspectionReply(text.data(), text.size(), out, &e))
+        return true;
+    if (error) *error = ReplyErrorName(e);
+    return false;
+}
+
+// ===================== 검출 → 센서 좌표 =====================
+void MapDetectionsToSensor(const DetectionList& in, const LetterboxGeometry& geom, ViewDetections& out)
+{
+    out.Clear();
+    const RoiRect& roi = geom.roi;
+    for (const Detection& d : in) {
+        if (out.count >= ViewDetections::kCapacity) break;
+        SensorDetection& o = out.items[out.count++];
+        o.labelId = d.labelId;
+        const float score = std::min(std::max(d.score, 0.0f), 6.5535f);
+        o.score = static_cast<uint16_t>(std::lround(score * 10000.0f));
+        o.x = o.y = o.w = o.h = 0;
+        if (!d.HasBox())
+            continue;
+
+        double x = d.x, y = d.y, w = d.w, h = d.h;
+        MapBoxToSource(geom, x, y, w, h);
+
+        // 패딩에 걸친 부분은 잘라 냄 (크롭 영역 밖은 전송하지 않았음)
+        const double x0 = std::max(x, static_cast<double>(roi.x));
+        const double y0 = std::max(y, static_cast<double>(roi.y));
+        const double x1 = std::min(x + w, static_cast<double>(roi.x + roi.width));
+        const double y1 = std::min(y + h, static_cast<double>(roi.y + roi.height));
+        if (x1 <= x0 || y1 <= y0)
+            continue;
+        o.x = static_cast<uint16_t>(std::min(x0, 65535.0));
+        o.y = static_cast<uint16_t>(std::min(y0, 65535.0));
+        o.w = static_cast<uint16_t>(std::min(std::ceil(x1 - x0), 65535.0));
+        o.h = static_cast<uint16_t>(std::min(std::ceil(y1 - y0), 65535.0));
+    }
+}
+
+// ===================== 파이프라인 =====================
+CInspectionPipeline::CInspectionPipeline(CLatencyStats& stats)
+    : m_stats(stats)
+{
+    Configure(m_cfg);
+}
+
+void CInspectionPipeline::Configure(const ClientConfig& cfg)
+{
+    m_cfg = cfg;
+    const EncoderConfig& ec = m_cfg.encoder;
+    m_codecSelector.SetConfig(ec.selector);
+
+    for (size_t i = 0; i < m_encoders.size(); ++i)
+    {
+        const ImageCodec codec = static_cast<ImageCodec>(i);
+        m_encoders[i] = CreateImageEncoder(codec, ec.jpegQuality, ec.pngThreads);
+        m_codecSelector.SetAvailable(codec, m_encoders[i] != nullptr);
+    }
+
+    // 측면 전처리 (스레드 풀을 가지므로 설정이 켜졌을 때만)
+    const PreprocessConfig& pp = m_cfg.preprocess;
+    m_sideEnhancer.reset(pp.sideEnhance
+        ? new CSideEnhancer(static_cast<size_t>(pp.sideEnhanceThreads > 0 ? pp.sideEnhanceThreads : 0))
+        : nullptr);
+
+    // 로컬 선별 모델 (못 읽으면 그 뷰는 서버로)
+    const ScreenConfig& sc = m_cfg.screen;
+    const std::string* paths[2] = { &sc.modelTop, &sc.modelFront };
+    for (int i = 0; i < 2; ++i)
+    {
+        m_screen[i] = CScreenModel();
+        if (!sc.enabled || paths[i]->empty())
+            continue;
+        std::string err;
+        if (m_screen[i].Load(*paths[i], &err))
+            Log("[INFO] 로컬 선별 모델: " + *paths[i] + " (" + m_screen[i].Describe() + ")\n");
+        else
+            Log("[WARNING] 로컬 선별 모델 로드 실패: " + err + "\n");
+    }
+}
+
+IImageEncoder* CInspectionPipeline::SelectEncoder(size_t pixelCount)
+{
+    const EncoderConfig& ec = m_cfg.encoder;
+    const ImageCodec codec = ec.autoSelect ? m_codecSelector.Choose(pixelCount) : ec.codec;
+    return m_encoders[static_cast<size_t>(codec)].get();  // 빌드에 없으면 nullptr
+}
+
+// ===================== 뷰 1장: (크롭/레터박스) → 인코딩 → 보관 → 전송 =====================
+bool CInspectionPipeline::ProcessView(const ViewRequest& req, ViewOutcome& out)
+{
+    out = ViewOutcome();
+    const uint64_t convertStart = req.convertStartNs ? req.convertStartNs : NowNs();
+    ImageView view = req.frame;
+
+    // ===== ROI 크롭 + 모델 입력 크기 레터박스 (선택) =====
+    const PreprocessConfig& pp = m_cfg.preprocess;
+    RequestHeader::Fields hdr;
+    hdr.replyFormat = m_cfg.server.replyFormat;
+    hdr.hasRole = true;
+    hdr.role = req.role;
+    hdr.sequence = req.sequence;
+    hdr.SetProductId(req.productId.c_str());
+    hdr.pixelFormat = req.rawFormat >= 0 ? static_cast<uint8_t>(1 + req.rawFormat) : RequestHeader::kPixelUnknown;
+    hdr.cameraTicks = req.stamp.cameraTicks;
+    if (req.stamp.HasHostTime())
+        hdr.captureUs = SteadyToUnixUs(req.stamp.hostNs);
+    if (req.stamp.frameCounter >= 0)
+        hdr.frameCounter = static_cast<uint32_t>(req.stamp.frameCounter);
+
+    if (pp.enabled)
+    {
+        hdr.flags = RequestHeader::kFlagLetterboxed;
+        hdr.geometry = ComputeLetterbox(view.width, view.height, req.roi, pp.inputSize);
+        LetterboxResize(view, hdr.geometry, m_letterbox);
+        out.geometry = hdr.geometry;
+        view = m_letterbox.View();
+    }
+    else
+    {
+        out.geometry = IdentityGeometry(view.width, view.height);
+        hdr.geometry = out.geometry;
+    }
+    if (pp.enabled && !pp.sendHeader) {
+        // 크롭 기하는 알리지 않음 (헤더 자체는 메타데이터 때문에 항상)
+        hdr.flags = 0;
+        hdr.geometry = IdentityGeometry(view.width, view.height);
+    }
+
+    // ===== 측면 전처리 (서버가 받을 이미지에 그대로, 좌표 불변) =====
+    if (IsSideRole(req.role) && m_sideEnhancer)
+    {
+        m_sideEnhancer->Apply(view, m_enhanced);
+        view = m_enhanced.View();
+        hdr.flags |= RequestHeader::kFlagSideEnhanced;
+    }
+    m_stats.Record(Stage::Convert, NowNs() - convertStart);
+
+    const size_t pixelCount = static_cast<size_t>(view.width) * view.height;
+    IImageEncoder* encoder = SelectEncoder(pixelCount);
+
+    if (!encoder)
+    {
+        // 고정 코덱이 이 빌드에 없음 (OpenCV 미포함 빌드에서 jpeg) → 무손실 PNG 로 대체
+        Log("[WARNING] 설정된 코덱 사용 불가, PNG 로 전송\n");
+        encoder = m_encoders[static_cast<size_t>(ImageCodec::Png)].get();
+    }
+
+    // ===== 메모리 인코딩 =====
+    const uint64_t t0 = NowNs();
+    if (!encoder->Encode(view, m_encoded)) {
+        out.error = "encode failed";
+        Log("[ERROR] 이미지 인코딩 실패\n");
+        return false;
+    }
+    const uint64_t encodeNs = NowNs() - t0;
+    m_stats.Record(Stage::Encode, encodeNs);
+    m_codecSelector.ReportEncode(encoder->Codec(), pixelCount, m_encoded.size(), encodeNs / 1e9);
+    out.codec = encoder->Codec();
+    out.encodedBytes = m_encoded.size();
+    out.fingerprint = PayloadFingerprint(m_encoded.data(), m_encoded.size());
+
+    // 헤더 (항상): 역할/단위 번호/시각/코덱 + 크롭 기하, 측면 전처리 알림, 응답 형식. 고정 버퍼 (할당 없음)
+    hdr.codec = encoder->Codec();
+    RequestHeader::Buffer header;
+    RequestHeader::Serialize(hdr, header);
+
+    char msg[160];
+    std::snprintf(msg, sizeof(msg), "[INFO] 인코딩 %s: %zu bytes, %.1f ms\n",
+        CodecName(encoder->Codec()), m_encoded.size(), encodeNs / 1e6);
+    Log(msg);
+
+    // ===== 보관용 저장 (보낸 바이트 그대로) =====
+    const EncoderConfig& ec = m_cfg.encoder;
+    if (ec.archive && !req.archiveBase.empty())
+    {
+        std::ofstream file(req.archiveBase + CodecExtension(encoder->Codec()), std::ios::binary);
+        file.write(reinterpret_cast<const char*>(m_encoded.data()), static_cast<std::streamsize>(m_encoded.size()));
+    }
+
+    // ===== 전송 (서버 없으면 / 밀린 게 있으면 오프라인 대기열) =====
+    bool ok = true;
+    if (!m_dryRun && req.send)
+    {
+        const RequestHeader::UnitId unit = RequestHeader::UnitOf(hdr);
+        const bool backlog = m_spool && m_spool->IsOpen() && m_spool->Depth() > 0;
+        if (!backlog)
+        {
+            RequestTiming timing;
+            const int route = m_pool ? m_pool->Route(unit) : -1;
+            if (m_pool && route < 0) {
+                ok = false;
+                out.error = "no healthy server for this unit";   // 대기열로 (TOP 을 받은 서버가 돌아오면 이어서)
+            }
+            else {
+                out.endpoint = route;
+                if (route >= 0) m_pool->Begin(route);
+                ok = SendInspectionRequest(route >= 0 ? m_pool->Endpoint(route) : m_cfg.server,
+                    header.data(), header.size(),
+                    m_encoded.data(), m_encoded.size(), out.response, &m_stats, &timing, &out.error, m_cancel);
+                if (route >= 0) m_pool->End(route, ok, timing);
+            }
+            if (ok) {
+                out.sent = true;
+                m_codecSelector.ReportTransfer(m_encoded.size(), timing.sendSeconds);
+                LogResponse(out.response);
+            }
+            else {
+                Log("[ERROR] 전송 실패: " + out.error + "\n");
+            }
+        }
+
+        // 실패한 요청은 서버가 처리하지 않았으므로 그대로 다시 보내도 된다
+        // (응답 기한 초과는 처리했을 수도 있음 → 최소 1회 전달). 취소는 종료 중이라 쌓지 않음.
+        const bool cancelled = m_cancel && m_cancel->load();
+        if ((backlog || !ok) && !cancelled && m_spool && m_spool->IsOpen())
+        {
+            // SIDE 는 TOP 을 받은 서버를 같이 적어 둠 (재시작 뒤에도 그 서버로만)
+            const uint32_t pin = m_pool ? m_pool->PinOf(unit) : 0;
+            if (m_spool->Push(header.data(), header.size(), m_encoded.data(), m_encoded.size(), pin)) {
+                ok = true;
+                out.queued = true;
+                out.error.clear();
+                Log("[INFO] 오프라인 대기열에 저장 (" + std::to_string(m_spool->Depth()) + "건 대기)\n");
+            }
+            else {
+                ok = false;
+                out.error = "spool full";
+                Log("[ERROR] 오프라인 대기열 가득 참, 요청 버림\n");
+            }
+        }
+    }
+
+    // ===== 감사용 무손실 PNG (전송 후, 멀티스레드 스트라이프 인코더) =====
+    const bool sentPng = encoder->Codec() == ImageCodec::Png;
+    if (ec.archivePng && !req.archiveBase.empty() && !(sentPng && ec.archive))
+    {
+        const std::vector<uint8_t>& png = sentPng ? m_encoded : m_archivePng;
+        if (sentPng || m_encoders[static_cast<size_t>(ImageCodec::Png)]->Encode(view, m_archivePng))
+        {
+            std::ofstream file(req.archiveBase + ".png", std::ios::binary);
+            file.write(reinterpret_cast<const char*>(png.data()), static_cast<std::streamsize>(png.size()));
+        }
+    }
+    return ok;
+}
+
+// ===================== 로컬 1차 선별 =====================
+bool CInspectionPipeline::ScreenPair(const ViewRequest& top, const ViewRequest& front, ScreenVerdict& verdict)
+{
+    verdict = ScreenVerdict();
+    if (!ScreenEnabled())
+        return false;
+
+    CStageTimer timer(m_stats, Stage::Screen);
+    // TOP 이 이미 애매하면 FRONT 는 계산하지 않음 (어차피 서버로)
+    const float passBelow = m_cfg.screen.passBelow;
+    if (m_screen[0].IsLoaded() && top.frame.IsValid())
+        verdict.top = m_screen[0].Run(top.frame, top.roi, m_screenScratch);
+    if (verdict.top >= 0.0f && verdict.top < passBelow && m_screen[1].IsLoaded() && front.frame.IsValid())
+        verdict.front = m_screen[1].Run(front.frame, front.roi, m_screenScratch);
+
+    verdict.local = IsLocalPass(verdict, passBelow);
+    return verdict.local;
+}
+
+void CInspectionPipeline::LogResponse(const std::string& response) const
+{
+    if (response.empty()) {
+        Log("[WARNING] 응답 없음\n");
+        return;
+    }
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(response.data());
+    if (!BinaryReply::ExpectedSize(p, response.size())) {
+        Log("[응답 수신] " + response + "\n");
+        return;
+    }
+
+    // 바이너리 응답은 요약만
+    char msg[160];
+    InspectionReply reply;
+    if (BinaryReply::IsTopAck(p, response.size()))
+        std::snprintf(msg, sizeof(msg), "[응답 수신] binary TOP saved (%zu bytes)\n", response.size());
+    else if (BinaryReply::Decode(p, response.size(), reply))
+        std::snprintf(msg, sizeof(msg), "[응답 수신] binary %s, det %u/%u, server %.1f ms (AI %.1f ms)\n",
+            reply.result.c_str(), reply.top.count, reply.side.count, reply.serverUs / 1e3, reply.aiUs / 1e3);
+    else
+        std::snprintf(msg, sizeof(msg), "[응답 수신] binary 손상 (%zu bytes)\n", response.size());
+    Log(msg);
+}
+
+bool CInspectionPipeline::ParseReply(const std::string& text, InspectionReply& out)
+{
+    CStageTimer timer(m_stats, Stage::Parse);
+    std::string err;
+    if (ParseInspectionReply(text, out, &err))
+        return true;
+
+    Log("[ERROR] 응답 파싱 실패: " + err + "\n");
+    return false;
+}
@@ -0,0 +1,170 @@
+﻿#pragma once
+#include "CameraClock.h"
+#include "ClientConfig.h"
+#include "CodecSelector.h"
+#include "EndpointPool.h"
+#include "ImageEncoder.h"
+#include "InspectionClient.h"
+#include "LatencyStats.h"
+#include "LocalScreen.h"
+#include "OutboundQueue.h"
+#include "Preprocess.h"
+#include "ReplyParser.h"
+#include "SideEnhance.h"
+#include "Station.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ===== 검사 코어 (MFC/Pylon/Winsock UI 비의존) =====
+// BGR8 프레임 1장 → (ROI 크롭/레터박스) → 인코딩 → 보관 → 전송 → 응답.
+// 다이얼로그(카메라)와 헤드리스 재생 도구(파일)가 같은 경로를 쓴다.
+
+// ===== 서버 응답 (InspectionReply / 파서는 ReplyParser.h) =====
+// {"result","reason","timestamp"} JSON 파싱. result 가 없으면 실패. error 는 실패 시에만 채움.
+bool ParseInspectionReply(const std::string& json, InspectionReply& out, std::string* error = nullptr);
+
+// ===== 결과 모델용 검출 (센서 좌표) =====
+// 응답의 DetectionList 는 전송 이미지 좌표 + 라벨 문자열이라 크다.
+// 결과/이력에는 라벨 ID 와 센서 좌표 박스만 12바이트로 남긴다 (할당 없음).
+struct SensorDetection
+{
+    uint8_t  labelId = DefectLabels::kUnknown;
+    uint16_t score = 0;                      // x10000
+    uint16_t x = 0, y = 0, w = 0, h = 0;     // 센서 좌표 (박스 없으면 w = h = 0)
+
+    float Score() const { return score / 10000.0f; }
+    bool  HasBox() const { return w > 0 && h > 0; }
+};
+
+struct ViewDetections
+{
+    static constexpr size_t kCapacity = DetectionList::kCapacity;
+
+    SensorDetection items[kCapacity];
+    uint8_t         count = 0;
+
+    void Clear() { count = 0; }
+    const SensorDetection* begin() const { return items; }
+    const SensorDetection* end() const { return items + count; }
+};
+
+// 전송 이미지 좌표 → 센서 좌표 (레터박스 역변환 후 크롭 영역으로 클립)
+void MapDetectionsToSensor(const DetectionList& in, const LetterboxGeometry& geom, ViewDetections& out);
+
+// ===== 뷰 1장 처리 요청 =====
+struct ViewRequest
+{
+    ImageView   frame;                 // 센서 해상도 BGR8
+    RoiRect     roi;                   // 카메라별 관심 영역
+    std::string archiveBase;           // 보관 경로 (확장자 제외). 비어 있으면 저장 안 함
+    uint64_t    convertStartNs = 0;    // 픽셀 변환 시작 시각 (0 = 이 호출부터 Convert 단계)
+    CameraRole  role = CameraRole::Top; // 측면 역할(front/side2) → preprocess.sideEnhance 적용 대상
+    bool        send = true;           // false = 인코딩/보관까지 (서버가 받지 않는 역할)
+    FrameStamp  stamp;                 // 카메라 타임스탬프/계수기 (청크), 노출 시각의 호스트 시계 값
+
+    // 요청 헤더 v3 메타데이터 (서버가 도착 순서/파일 이름 없이 뷰를 식별)
+    uint64_t    sequence = 0;          // 검사 단위 번호 (같은 캔의 뷰는 같은 값)
+    std::string productId;             // "CK1012" (16자까지)
+    int         rawFormat = -1;        // 카메라 원본 RawFormat, -1 = 모름 (Pylon 변환기 경로)
+};
+
+// ===== 캔 1개 = 검사 단위 1개 (스테이션 카메라 N대의 뷰) =====
+struct InspectionUnit
+{
+    uint64_t                 sequence = 0;
+    std::vector<ViewRequest> views;      // 스테이션 슬롯 순서
+
+    int IndexOf(CameraRole role) const   // 없으면 -1
+    {
+        for (size_t i = 0; i < views.size(); ++i)
+            if (views[i].role == role) return static_cast<int>(i);
+        return -1;
+    }
+    const ViewRequest* Find(CameraRole role) const
+    {
+        const int i = IndexOf(role);
+        return i >= 0 ? &views[i] : nullptr;
+    }
+};
+
+struct ViewOutcome
+{
+    bool              sent = false;
+    bool              queued = false;    // 서버 대신 오프라인 대기열로 (응답은 배출 때 콜백으로)
+    int               endpoint = -1;     // 보낸 서버 (서버 풀 순번, 풀이 없으면 -1)
+    ImageCodec        codec = ImageCodec::Png;
+    size_t            encodedBytes = 0;
+    uint32_t          fingerprint = 0;   // 보낸 본문 PayloadFingerprint (짝 검증용)
+    LetterboxGeometry geometry;        // 전송 이미지 ↔ 센서 좌표 변환용
+    std::string       response;
+    std::string       error;
+};
+
+class CInspectionPipeline
+{
+public:
+    using LogFn = std::function<void(const std::string&)>;
+
+    explicit CInspectionPipeline(CLatencyStats& stats);
+
+    // 설정 반영 (인코더/코덱 선택기 재구성)
+    void Configure(const ClientConfig& cfg);
+    void SetLogger(LogFn log) { m_log = std::move(log); }
+
+    // dryRun == true 면 전송 없이 인코딩까지만 (로컬 벤치마크용)
+    void SetDryRun(bool dryRun) { m_dryRun = dryRun; }
+
+    // 오프라인 대기열 (없으면 기존처럼 전송 실패 = 오류). 대기열에 남은 게 있으면 순서를 지키려고 바로 넣는다.
+    void SetSpool(COutboundQueue* spool) { m_spool = spool; }
+
+    // 검사 서버 풀 (없으면 config "server" 1대). 단위 키로 서버를 고르고 결과를 풀 상태에 반영.
+    // 건강한 서버가 없으면 연결을 시도하지 않고 실패 → 오프라인 대기열.
+    void SetEndpointPool(CEndpointPool* pool) { m_pool = pool; }
+
+    // 켜지면 진행 중인 전송을 50 ms 안에 포기 (도구 종료 등). 기한은 server.timeouts.
+    void SetCancel(const std::atomic<bool>* cancel) { m_cancel = cancel; }
+
+    bool ProcessView(const ViewRequest& req, ViewOutcome& out);
+
+    // 로컬 1차 선별 (Screen 단계 기록). true = 두 뷰 모두 확실한 정상 → 서버 생략 가능.
+    // 설정이 꺼져 있거나 모델이 없으면 항상 false (verdict 확률은 -1).
+    bool ScreenPair(const ViewRequest& top, const ViewRequest& front, ScreenVerdict& verdict);
+    bool ScreenEnabled() const { return m_cfg.screen.enabled && (m_screen[0].IsLoaded() || m_screen[1].IsLoaded()); }
+
+    // 파싱 (Parse 단계 기록)
+    bool ParseReply(const std::string& json, InspectionReply& out);
+
+    const ClientConfig& Config() const { return m_cfg; }
+    CLatencyStats&      Latency() { return m_stats; }
+    double              LinkBandwidth() const { return m_codecSelector.BandwidthBytesPerSec(); }
+
+private:
+    IImageEncoder* SelectEncoder(size_t pixelCount);
+    void Log(const std::string& msg) const { if (m_log) m_log(msg); }
+    void LogResponse(const std::string& response) const;
+
+    CLatencyStats& m_stats;
+    ClientConfig   m_cfg;
+    LogFn          m_log;
+    bool           m_dryRun = false;
+    COutboundQueue* m_spool = nullptr;
+    CEndpointPool*  m_pool = nullptr;
+    const std::atomic<bool>* m_cancel = nullptr;
+
+    std::array<std::unique_ptr<IImageEncoder>, static_cast<size_t>(ImageCodec::Count)> m_encoders;
+    CCodecSelector       m_codecSelector;
+    ImageBuffer          m_letterbox;     // 재사용 버퍼
+    ImageBuffer          m_enhanced;      // 측면 전처리 결과 (재사용)
+    std::unique_ptr<CSideEnhancer> m_sideEnhancer;
+    std::vector<uint8_t> m_encoded;       // 재사용 버퍼
+    std::vector<uint8_t> m_archivePng;    // 감사용 PNG 버퍼
+
+    CScreenModel          m_screen[2];    // 0 = TOP, 1 = FRONT
+    CScreenModel::Scratch m_screenScratch;
+};
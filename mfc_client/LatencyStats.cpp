@@ -0,0 +1,157 @@
+﻿#include "LatencyStats.h"
+#include <cstdio>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    const char* kStageNames[] = {
+        "grab", "convert", "screen", "encode", "connect", "send", "server", "parse", "ui", "total", "e2e" };
+
+    inline int FloorLog2(uint64_t v)
+    {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanReverse64(&idx, v);
+        return static_cast<int>(idx);
+#else
+        return 63 - __builtin_clzll(v);
+#endif
+    }
+}
+
+const char* StageName(Stage stage)
+{
+    const size_t i = static_cast<size_t>(stage);
+    return i < static_cast<size_t>(Stage::Count) ? kStageNames[i] : "?";
+}
+
+// ===================== 버킷 =====================
+namespace HdrBuckets
+{
+    int IndexOf(uint64_t ns)
+    {
+        if (ns < static_cast<uint64_t>(kSubCount))
+            return static_cast<int>(ns);
+
+        const int msb = FloorLog2(ns);
+        if (msb > kMaxMsb)
+            return kCount - 1;
+
+        // [2^msb, 2^(msb+1)) 구간을 kSubCount 등분
+        const int shift = msb - kSubBits;
+        return ((shift + 1) << kSubBits) + static_cast<int>((ns >> shift) - kSubCount);
+    }
+
+    uint64_t UpperBound(int index)
+    {
+        if (index < kSubCount)
+            return static_cast<uint64_t>(index);
+
+        const int shift = (index >> kSubBits) - 1;
+        const uint64_t sub = static_cast<uint64_t>(index & (kSubCount - 1)) + kSubCount;
+        return ((sub + 1) << shift) - 1;
+    }
+}
+
+// ===================== 스냅샷 =====================
+uint64_t HistogramSnapshot::PercentileNs(double q) const
+{
+    if (total == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total) + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > total) rank = total;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < HdrBuckets::kCount; ++i)
+    {
+        seen += counts[i];
+        if (seen >= rank)
+        {
+            const uint64_t v = HdrBuckets::UpperBound(i);
+            return (maxNs && v > maxNs) ? maxNs : v;
+        }
+    }
+    return maxNs;
+}
+
+void HistogramSnapshot::Subtract(const HistogramSnapshot& earlier)
+{
+    int highest = -1;
+    for (int i = 0; i < HdrBuckets::kCount; ++i)
+    {
+        counts[i] -= earlier.counts[i];
+        if (counts[i]) highest = i;
+    }
+    total -= earlier.total;
+    sumNs -= earlier.sumNs;
+
+    // 구간 최대값은 구간에 남은 가장 높은 버킷의 상한 (누적 최대값을 넘지 않게)
+    if (highest < 0)
+        maxNs = 0;
+    else if (HdrBuckets::UpperBound(highest) < maxNs)
+        maxNs = HdrBuckets::UpperBound(highest);
+}
+
+void CLatencyHistogram::Snapshot(HistogramSnapshot& out) const
+{
+    // 기록과 동시에 읽으므로 카운트 합으로 total 을 맞춘다
+    out.total = 0;
+    for (int i = 0; i < HdrBuckets::kCount; ++i)
+    {
+        out.counts[i] = m_counts[i].load(std::memory_order_relaxed);
+        out.total += out.counts[i];
+    }
+    out.sumNs = m_sum.load(std::memory_order_relaxed);
+    out.maxNs = m_max.load(std::memory_order_relaxed);
+}
+
+// ===================== 단계별 통계 =====================
+CLatencyStats::CLatencyStats()
+    : m_hist(new CLatencyHistogram[static_cast<size_t>(Stage::Count)]),
+      m_last(static_cast<size_t>(Stage::Count))
+{
+}
+
+void CLatencyStats::AppendRow(std::string& out, Stage stage, const HistogramSnapshot& s)
+{
+    char line[128];
+    std::snprintf(line, sizeof(line), "%-8s %7llu %9.2f %9.2f %9.2f %9.2f\n",
+        StageName(stage),
+        static_cast<unsigned long long>(s.total),
+        s.PercentileNs(0.50) / 1e6,
+        s.PercentileNs(0.99) / 1e6,
+        s.PercentileNs(0.999) / 1e6,
+        s.maxNs / 1e6);
+    out += line;
+}
+
+std::string CLatencyStats::Report() const
+{
+    std::string out = "stage          n   p50(ms)   p99(ms)  p999(ms)   max(ms)\n";
+    HistogramSnapshot snap;
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i)
+    {
+        m_hist[i].Snapshot(snap);
+        AppendRow(out, static_cast<Stage>(i), snap);
+    }
+    return out;
+}
+
+std::string CLatencyStats::IntervalReport()
+{
+    std::string out = "stage          n   p50(ms)   p99(ms)  p999(ms)   max(ms)\n";
+    HistogramSnapshot snap;
+    for (size_t i = 0; i < static_cast<size_t>(Stage::Count); ++i)
+    {
+        m_hist[i].Snapshot(snap);
+        HistogramSnapshot interval = snap;
+        interval.Subtract(m_last[i]);
+        m_last[i] = snap;
+        AppendRow(out, static_cast<Stage>(i), interval);
+    }
+    return out;
+}
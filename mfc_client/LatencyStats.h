@@ -0,0 +1,133 @@
+﻿#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ===== 검사 단계 =====
+enum class Stage : uint8_t
+{
+    Grab,         // RetrieveResult
+    Convert,      // BGR8 변환 (+ ROI 크롭/레터박스)
+    Screen,       // 로컬 1차 선별 (int8 CNN, 두 뷰)
+    Encode,       // 전송 코덱 인코딩
+    Connect,      // 소켓 생성 + connect
+    Send,         // 헤더 + 길이 + 본문 send
+    ServerWait,   // 전송 완료 → 응답 수신
+    Parse,        // 응답 JSON 파싱
+    UiUpdate,     // 결과 표시 + 히스토리
+    Total,        // 검사 1회 전체
+    EndToEnd,     // 카메라 노출 → 결과 표시 (청크 타임스탬프를 호스트 시계로 옮겨서)
+    Count
+};
+
+const char* StageName(Stage stage);
+
+// 단조 시계 (ns). steady_clock = Windows 에서 QueryPerformanceCounter.
+inline uint64_t NowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+// ===== HDR 히스토그램 버킷 (log-linear) =====
+// 2의 거듭제곱 구간마다 128개 선형 버킷 → 상대 오차 < 0.8%.
+// 범위 1 ns ~ 2^38 ns(약 275초), 그 이상은 마지막 버킷.
+namespace HdrBuckets
+{
+    constexpr int kSubBits = 7;
+    constexpr int kSubCount = 1 << kSubBits;
+    constexpr int kMaxMsb = 37;
+    constexpr int kCount = (kMaxMsb - kSubBits + 2) * kSubCount;
+
+    int      IndexOf(uint64_t ns);
+    uint64_t UpperBound(int index);   // 버킷에 들어가는 가장 큰 값
+}
+
+// ===== 스냅샷 (계산용 일반 배열) =====
+struct HistogramSnapshot
+{
+    std::array<uint64_t, HdrBuckets::kCount> counts{};
+    uint64_t total = 0;
+    uint64_t sumNs = 0;
+    uint64_t maxNs = 0;
+
+    uint64_t PercentileNs(double q) const;   // q = 0.5, 0.99, 0.999 ...
+    double   MeanNs() const { return total ? static_cast<double>(sumNs) / total : 0.0; }
+
+    // 이전 스냅샷을 빼서 구간 통계로 (maxNs 는 구간 버킷 기준 추정)
+    void Subtract(const HistogramSnapshot& earlier);
+};
+
+// ===== 락프리 히스토그램 =====
+// Record 는 relaxed 원자 연산 3~4개 (수십 ns). 여러 스레드에서 동시에 호출 가능.
+class CLatencyHistogram
+{
+public:
+    void Record(uint64_t ns)
+    {
+        m_counts[HdrBuckets::IndexOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(ns, std::memory_order_relaxed);
+
+        uint64_t cur = m_max.load(std::memory_order_relaxed);
+        while (ns > cur && !m_max.compare_exchange_weak(cur, ns, std::memory_order_relaxed)) {}
+    }
+
+    void Snapshot(HistogramSnapshot& out) const;
+
+private:
+    std::array<std::atomic<uint64_t>, HdrBuckets::kCount> m_counts{};
+    std::atomic<uint64_t> m_sum{ 0 };
+    std::atomic<uint64_t> m_max{ 0 };
+};
+
+// ===== 단계별 지연 통계 =====
+class CLatencyStats
+{
+public:
+    CLatencyStats();
+
+    void Record(Stage stage, uint64_t ns) { m_hist[static_cast<size_t>(stage)].Record(ns); }
+    void Snapshot(Stage stage, HistogramSnapshot& out) const { m_hist[static_cast<size_t>(stage)].Snapshot(out); }
+
+    // 단계 | n | p50 | p99 | p999 | max (ms) 표. 줄 끝은 '\n'.
+    std::string Report() const;          // 시작 이후 누적
+    std::string IntervalReport();        // 직전 IntervalReport 호출 이후 (주기 로그용, 단일 스레드에서 호출)
+
+private:
+    static void AppendRow(std::string& out, Stage stage, const HistogramSnapshot& s);
+
+    std::unique_ptr<CLatencyHistogram[]> m_hist;   // 버킷 배열이 커서 힙에 둠
+    std::vector<HistogramSnapshot>       m_last;   // IntervalReport 기준점
+};
+
+// ===== 스코프 타이머 =====
+// 생성 ~ 소멸(또는 Stop) 구간을 기록. 실행하지 않은 단계는 Cancel.
+class CStageTimer
+{
+public:
+    CStageTimer(CLatencyStats& stats, Stage stage)
+        : m_stats(stats), m_stage(stage), m_start(NowNs()) {}
+    ~CStageTimer() { Stop(); }
+
+    CStageTimer(const CStageTimer&) = delete;
+    CStageTimer& operator=(const CStageTimer&) = delete;
+
+    void Stop()
+    {
+        if (m_start)
+        {
+            m_stats.Record(m_stage, NowNs() - m_start);
+            m_start = 0;
+        }
+    }
+    void Cancel() { m_start = 0; }
+
+private:
+    CLatencyStats& m_stats;
+    Stage          m_stage;
+    uint64_t       m_start;
+};
@@ -0,0 +1,416 @@
+﻿#include "LocalScreen.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+
+namespace
+{
+    constexpr uint32_t kMagic = 0x4D534E43;   // 'CNSM' (Little-Endian 으로 읽은 값)
+    constexpr uint16_t kVersion = 1;
+    constexpr uint8_t  kLayerConv = 1;
+    constexpr uint8_t  kLayerDense = 2;
+    constexpr int      kMaxChannels = 1024;
+
+    // ===== 경계 검사 읽기 =====
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* p, size_t n) : m_p(p), m_end(p + n) {}
+
+        bool Bytes(void* out, size_t n)
+        {
+            if (static_cast<size_t>(m_end - m_p) < n) return false;
+            std::memcpy(out, m_p, n);
+            m_p += n;
+            return true;
+        }
+        bool U8(uint8_t& v) { return Bytes(&v, 1); }
+        bool U16(uint16_t& v)
+        {
+            uint8_t b[2];
+            if (!Bytes(b, 2)) return false;
+            v = static_cast<uint16_t>(b[0] | (b[1] << 8));
+            return true;
+        }
+        bool U32(uint32_t& v)
+        {
+            uint8_t b[4];
+            if (!Bytes(b, 4)) return false;
+            v = b[0] | (b[1] << 8) | (b[2] << 16) | (static_cast<uint32_t>(b[3]) << 24);
+            return true;
+        }
+        bool F32(float& v)
+        {
+            uint32_t u;
+            if (!U32(u)) return false;
+            std::memcpy(&v, &u, 4);
+            return true;
+        }
+        bool AtEnd() const { return m_p == m_end; }
+
+    private:
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+    };
+
+    void PutU16(std::vector<uint8_t>& o, uint16_t v) { o.push_back(static_cast<uint8_t>(v)); o.push_back(static_cast<uint8_t>(v >> 8)); }
+    void PutU32(std::vector<uint8_t>& o, uint32_t v) { for (int i = 0; i < 4; ++i) o.push_back(static_cast<uint8_t>(v >> (8 * i))); }
+    void PutF32(std::vector<uint8_t>& o, float f) { uint32_t u; std::memcpy(&u, &f, 4); PutU32(o, u); }
+
+    int OutSize(int in, int kernel, int stride, int pad)
+    {
+        return (in + 2 * pad - kernel) / stride + 1;
+    }
+
+    inline uint8_t Requantize(int32_t acc, float multiplier)
+    {
+        const long v = std::lrintf(static_cast<float>(acc) * multiplier);
+        return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    float DefectProbability(float normalLogit, float defectLogit)
+    {
+        return 1.0f / (1.0f + std::exp(normalLogit - defectLogit));
+    }
+
+    // [outC][k][k][inC] → [k][k][inC][outC] (int16: 곱셈 폭 확보)
+    void Pack(CScreenModel::Conv& c)
+    {
+        const int taps = c.kernel * c.kernel;
+        c.packed.resize(c.weight.size());
+        for (int oc = 0; oc < c.outC; ++oc)
+            for (int t = 0; t < taps; ++t)
+                for (int ic = 0; ic < c.inC; ++ic)
+                    c.packed[(static_cast<size_t>(t) * c.inC + ic) * c.outC + oc] =
+                        c.weight[(static_cast<size_t>(oc) * taps + t) * c.inC + ic];
+    }
+
+    bool Fail(std::string* error, const char* msg)
+    {
+        if (error) *error = msg;
+        return false;
+    }
+}
+
+// ===================== 로드 / 저장 =====================
+bool CScreenModel::Load(const std::string& path, std::string* error)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        if (error) *error = "screen model not found: " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return LoadFromMemory(data.data(), data.size(), error);
+}
+
+bool CScreenModel::LoadFromMemory(const uint8_t* data, size_t size, std::string* error)
+{
+    m_inputSize = 0;
+    m_convs.clear();
+
+    Reader r(data, size);
+    uint32_t magic;
+    uint16_t version, inputSize;
+    uint8_t layers, reserved[3];
+    if (!r.U32(magic) || magic != kMagic) return Fail(error, "not a CNSM model");
+    if (!r.U16(version) || version != kVersion) return Fail(error, "unsupported CNSM version");
+    if (!r.U16(inputSize) || !r.U8(layers) || !r.Bytes(reserved, 3)) return Fail(error, "truncated header");
+    if (inputSize < 8 || inputSize > 1024) return Fail(error, "bad input size");
+
+    std::vector<Conv> convs;
+    Dense dense;
+    bool haveDense = false;
+    int channels = 3, side = inputSize;
+
+    for (int i = 0; i < layers; ++i)
+    {
+        uint8_t type;
+        if (!r.U8(type)) return Fail(error, "truncated layer");
+        if (haveDense) return Fail(error, "dense layer must be last");
+
+        if (type == kLayerConv)
+        {
+            Conv c;
+            uint8_t k, s, p, pad0;
+            uint16_t inC, outC;
+            if (!r.U8(k) || !r.U8(s) || !r.U8(p) || !r.U8(pad0) || !r.U16(inC) || !r.U16(outC))
+                return Fail(error, "truncated conv header");
+            c.kernel = k; c.stride = s; c.pad = p; c.inC = inC; c.outC = outC;
+            if (k == 0 || k > 7 || s == 0 || p >= k || inC != channels || outC == 0 || outC > kMaxChannels)
+                return Fail(error, "bad conv shape");
+            const int outSide = OutSize(side, k, s, p);
+            if (outSide < 1) return Fail(error, "conv output empty");
+
+            c.weight.resize(static_cast<size_t>(outC) * k * k * inC);
+            c.bias.resize(outC);
+            c.multiplier.resize(outC);
+            if (!r.Bytes(c.weight.data(), c.weight.size())) return Fail(error, "truncated conv weights");
+            for (auto& b : c.bias) { uint32_t u; if (!r.U32(u)) return Fail(error, "truncated conv bias"); b = static_cast<int32_t>(u); }
+            for (auto& m : c.multiplier) if (!r.F32(m) || !std::isfinite(m)) return Fail(error, "bad conv multiplier");
+            Pack(c);
+
+            convs.push_back(std::move(c));
+            channels = outC;
+            side = outSide;
+        }
+        else if (type == kLayerDense)
+        {
+            uint16_t inC, outC;
+            if (!r.U16(inC) || !r.U16(outC) || !r.F32(dense.inScale)) return Fail(error, "truncated dense header");
+            if (inC != channels || outC != 2) return Fail(error, "bad dense shape");
+            dense.inC = inC;
+            dense.outC = outC;
+            dense.weight.resize(static_cast<size_t>(inC) * outC);
+            dense.bias.resize(outC);
+            for (auto& w : dense.weight) if (!r.F32(w)) return Fail(error, "truncated dense weights");
+            for (auto& b : dense.bias) if (!r.F32(b)) return Fail(error, "truncated dense bias");
+            haveDense = true;
+        }
+        else
+        {
+            return Fail(error, "unknown layer type");
+        }
+    }
+    if (convs.empty() || !haveDense) return Fail(error, "model needs conv layers and a dense head");
+    if (!r.AtEnd()) return Fail(error, "trailing bytes");
+
+    m_inputSize = inputSize;
+    m_convs = std::move(convs);
+    m_dense = std::move(dense);
+    return true;
+}
+
+std::vector<uint8_t> CScreenModel::Serialize() const
+{
+    std::vector<uint8_t> o;
+    PutU32(o, kMagic);
+    PutU16(o, kVersion);
+    PutU16(o, static_cast<uint16_t>(m_inputSize));
+    o.push_back(static_cast<uint8_t>(m_convs.size() + 1));
+    o.insert(o.end(), 3, 0);
+    for (const Conv& c : m_convs)
+    {
+        o.push_back(kLayerConv);
+        o.push_back(static_cast<uint8_t>(c.kernel));
+        o.push_back(static_cast<uint8_t>(c.stride));
+        o.push_back(static_cast<uint8_t>(c.pad));
+        o.push_back(0);
+        PutU16(o, static_cast<uint16_t>(c.inC));
+        PutU16(o, static_cast<uint16_t>(c.outC));
+        const uint8_t* w = reinterpret_cast<const uint8_t*>(c.weight.data());
+        o.insert(o.end(), w, w + c.weight.size());
+        for (int32_t b : c.bias) PutU32(o, static_cast<uint32_t>(b));
+        for (float m : c.multiplier) PutF32(o, m);
+    }
+    o.push_back(kLayerDense);
+    PutU16(o, static_cast<uint16_t>(m_dense.inC));
+    PutU16(o, static_cast<uint16_t>(m_dense.outC));
+    PutF32(o, m_dense.inScale);
+    for (float w : m_dense.weight) PutF32(o, w);
+    for (float b : m_dense.bias) PutF32(o, b);
+    return o;
+}
+
+void CScreenModel::MakeRandom(int inputSize, const std::vector<int>& channels, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> w8(-127, 127);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    m_inputSize = inputSize;
+    m_convs.clear();
+    int inC = 3;
+    for (int outC : channels)
+    {
+        Conv c;
+        c.inC = inC;
+        c.outC = outC;
+        const int fanIn = c.kernel * c.kernel * inC;
+        c.weight.resize(static_cast<size_t>(outC) * fanIn);
+        for (auto& w : c.weight) w = static_cast<int8_t>(w8(rng));
+        c.bias.resize(outC);
+        for (auto& b : c.bias) b = static_cast<int32_t>(unit(rng) * 2000.0f);
+        // 활성값이 0~255 중간쯤에 머물도록 (무작위 부호 합 ~ sqrt(fanIn))
+        c.multiplier.assign(outC, 1.0f / (std::sqrt(static_cast<float>(fanIn)) * 48.0f));
+        Pack(c);
+        m_convs.push_back(std::move(c));
+        inC = outC;
+    }
+    m_dense.inC = inC;
+    m_dense.outC = 2;
+    m_dense.inScale = 1.0f / 255.0f;
+    m_dense.weight.resize(static_cast<size_t>(inC) * 2);
+    for (auto& w : m_dense.weight) w = unit(rng);
+    m_dense.bias = { 0.0f, -2.0f };
+}
+
+size_t CScreenModel::MacCount() const
+{
+    size_t macs = 0;
+    int side = m_inputSize;
+    for (const Conv& c : m_convs) {
+        side = OutSize(side, c.kernel, c.stride, c.pad);
+        macs += static_cast<size_t>(side) * side * c.outC * c.kernel * c.kernel * c.inC;
+    }
+    return macs + static_cast<size_t>(m_dense.inC) * m_dense.outC;
+}
+
+std::string CScreenModel::Describe() const
+{
+    std::string s = "input " + std::to_string(m_inputSize);
+    for (const Conv& c : m_convs)
+        s += " → conv" + std::to_string(c.kernel) + "s" + std::to_string(c.stride) + " " + std::to_string(c.outC);
+    char tail[64];
+    std::snprintf(tail, sizeof(tail), " → gap → dense %d (%.2f MMAC)", m_dense.outC, MacCount() / 1e6);
+    return s + tail;
+}
+
+// ===================== 추론 =====================
+float CScreenModel::Run(const ImageView& frame, const RoiRect& roi, Scratch& scratch) const
+{
+    if (!IsLoaded() || !frame.IsValid()) return -1.0f;
+    const LetterboxGeometry geom = ComputeLetterbox(frame.width, frame.height, roi, m_inputSize);
+    LetterboxResize(frame, geom, scratch.input);
+    return RunPrepared(scratch.input.View(), scratch);
+}
+
+float CScreenModel::RunPrepared(const ImageView& input, Scratch& scratch) const
+{
+    if (!IsLoaded() || input.width != m_inputSize || input.height != m_inputSize) return -1.0f;
+
+    // 입력을 조밀한 NHWC 로 (stride 패딩 제거)
+    const size_t rowBytes = static_cast<size_t>(m_inputSize) * 3;
+    scratch.a.resize(rowBytes * m_inputSize);
+    for (int y = 0; y < m_inputSize; ++y)
+        std::memcpy(scratch.a.data() + y * rowBytes, input.Row(y), rowBytes);
+
+    int side = m_inputSize;
+    std::vector<uint8_t>* in = &scratch.a;
+    std::vector<uint8_t>* out = &scratch.b;
+    for (const Conv& c : m_convs)
+    {
+        const int outSide = OutSize(side, c.kernel, c.stride, c.pad);
+        out->resize(static_cast<size_t>(outSide) * outSide * c.outC);
+        ConvLayer(c, in->data(), side, side, out->data(), outSide, outSide);
+        std::swap(in, out);
+        side = outSide;
+    }
+    return Head(in->data(), side, side);
+}
+
+// 출력 픽셀마다 outC 개 누적기를 두고 입력 값 하나를 모든 출력 채널에 뿌린다.
+// 재배치한 가중치([k][k][inC][outC])를 읽으면 가장 안쪽 루프가 연속 메모리라 자동 벡터화되고,
+// ReLU 뒤 0 인 입력은 건너뛴다.
+void CScreenModel::ConvLayer(const Conv& c, const uint8_t* in, int inW, int inH,
+                             uint8_t* out, int outW, int outH)
+{
+    const int k = c.kernel, inC = c.inC, outC = c.outC;
+
+    thread_local std::vector<int32_t> acc;
+    acc.resize(outC);
+
+    for (int oy = 0; oy < outH; ++oy)
+    {
+        for (int ox = 0; ox < outW; ++ox)
+        {
+            std::copy(c.bias.begin(), c.bias.end(), acc.begin());
+            int32_t* a = acc.data();
+
+            for (int ky = 0; ky < k; ++ky)
+            {
+                const int iy = oy * c.stride + ky - c.pad;
+                if (iy < 0 || iy >= inH) continue;
+                for (int kx = 0; kx < k; ++kx)
+                {
+                    const int ix = ox * c.stride + kx - c.pad;
+                    if (ix < 0 || ix >= inW) continue;
+                    const uint8_t* px = in + (static_cast<size_t>(iy) * inW + ix) * inC;
+                    const int16_t* w = c.packed.data() + static_cast<size_t>(ky * k + kx) * inC * outC;
+                    for (int ic = 0; ic < inC; ++ic, w += outC)
+                    {
+                        const int32_t v = px[ic];
+                        if (v == 0) continue;
+                        for (int oc = 0; oc < outC; ++oc)
+                            a[oc] += v * w[oc];
+                    }
+                }
+            }
+
+            uint8_t* o = out + (static_cast<size_t>(oy) * outW + ox) * outC;
+            for (int oc = 0; oc < outC; ++oc)
+                o[oc] = Requantize(a[oc], c.multiplier[oc]);
+        }
+    }
+}
+
+float CScreenModel::Head(const uint8_t* act, int w, int h) const
+{
+    const int C = m_dense.inC;
+    thread_local std::vector<uint32_t> sum;
+    sum.assign(C, 0);
+    const size_t n = static_cast<size_t>(w) * h;
+    for (size_t i = 0; i < n; ++i, act += C)
+        for (int c = 0; c < C; ++c)
+            sum[c] += act[c];
+
+    float logit[2];
+    for (int o = 0; o < 2; ++o) {
+        float z = m_dense.bias[o];
+        for (int c = 0; c < C; ++c)
+            z += m_dense.weight[static_cast<size_t>(o) * C + c] * (static_cast<float>(sum[c]) / n * m_dense.inScale);
+        logit[o] = z;
+    }
+    return DefectProbability(logit[0], logit[1]);
+}
+
+// ===================== 참조 경로 (자체 검사) =====================
+float CScreenModel::RunReference(const ImageView& input) const
+{
+    if (!IsLoaded() || input.width != m_inputSize || input.height != m_inputSize) return -1.0f;
+
+    // 채널 우선 정수 배열, 가중치는 파일 순서 그대로
+    int side = m_inputSize, C = 3;
+    std::vector<int> act(static_cast<size_t>(C) * side * side);
+    for (int y = 0; y < side; ++y)
+        for (int x = 0; x < side; ++x)
+            for (int ch = 0; ch < 3; ++ch)
+                act[(static_cast<size_t>(ch) * side + y) * side + x] = input.Row(y)[x * 3 + ch];
+
+    for (const Conv& c : m_convs)
+    {
+        const int o = OutSize(side, c.kernel, c.stride, c.pad);
+        std::vector<int> next(static_cast<size_t>(c.outC) * o * o);
+        for (int oc = 0; oc < c.outC; ++oc)
+            for (int oy = 0; oy < o; ++oy)
+                for (int ox = 0; ox < o; ++ox)
+                {
+                    int32_t a = c.bias[oc];
+                    for (int ky = 0; ky < c.kernel; ++ky)
+                        for (int kx = 0; kx < c.kernel; ++kx)
+                            for (int ic = 0; ic < c.inC; ++ic)
+                            {
+                                const int iy = oy * c.stride + ky - c.pad;
+                                const int ix = ox * c.stride + kx - c.pad;
+                                const int v = (iy < 0 || iy >= side || ix < 0 || ix >= side)
+                                    ? 0 : act[(static_cast<size_t>(ic) * side + iy) * side + ix];
+                                a += v * c.weight[((static_cast<size_t>(oc) * c.kernel + ky) * c.kernel + kx) * c.inC + ic];
+                            }
+                    next[(static_cast<size_t>(oc) * o + oy) * o + ox] = Requantize(a, c.multiplier[oc]);
+                }
+        act.swap(next);
+        side = o;
+        C = c.outC;
+    }
+
+    // NHWC 로 되돌려 같은 헤드 사용 (합 순서까지 같게)
+    std::vector<uint8_t> nhwc(static_cast<size_t>(C) * side * side);
+    for (int ch = 0; ch < C; ++ch)
+        for (int i = 0; i < side * side; ++i)
+            nhwc[static_cast<size_t>(i) * C + ch] = static_cast<uint8_t>(act[static_cast<size_t>(ch) * side * side + i]);
+    return Head(nhwc.data(), side, side);
+}
@@ -0,0 +1,103 @@
+﻿#pragma once
+#include "ImageView.h"
+#include "Preprocess.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===== 로컬 1차 선별 설정 =====
+struct ScreenConfig
+{
+    bool        enabled = false;
+    std::string modelTop;            // 'CNSM' 모델 경로 (비어 있거나 못 읽으면 이 뷰는 항상 서버로)
+    std::string modelFront;
+    float       passBelow = 0.05f;   // 두 뷰 모두 불량 확률이 이보다 낮으면 로컬에서 정상 처리
+};
+
+// ===== int8 CNN 선별 모델 ('CNSM') =====
+// 전처리(ROI 크롭 + 레터박스)를 모델 입력 크기(보통 160)로 바로 한 BGR8 영상 → 불량 확률.
+// 3x3 Conv+ReLU 몇 층 → 전역 평균 풀링 → Dense(정상/불량 logit). python_ai/train_screen.py 가 학습/양자화/출력.
+//
+// 파일 (Little-Endian):
+//   magic 'CNSM', u16 version(=1), u16 inputSize, u8 layerCount, u8 reserved[3]
+//   층마다 u8 type
+//     1 = Conv + ReLU : u8 kernel, u8 stride, u8 pad, u8 reserved, u16 inC, u16 outC,
+//                       int8 weight[outC][kernel][kernel][inC], int32 bias[outC], float multiplier[outC]
+//         uint8 입력 x int8 가중치 → int32 누적 + bias → x multiplier → 반올림, 0~255 로 자름 (ReLU 포함).
+//         첫 층 입력은 픽셀 값 그대로 (1/255 정규화는 multiplier 에 들어 있음). 패딩 = 0.
+//     2 = 전역 평균 풀링 + Dense (마지막 층) : u16 in, u16 out(=2), float inScale,
+//                       float weight[out][in], float bias[out]
+//         풀링 평균(uint8 단위) x inScale = 실수 활성값.
+class CScreenModel
+{
+public:
+    // 추론 작업 버퍼 (스레드마다 하나, 재사용하면 할당 없음)
+    struct Scratch
+    {
+        ImageBuffer          input;
+        std::vector<uint8_t> a, b;
+    };
+
+    bool Load(const std::string& path, std::string* error = nullptr);
+    bool LoadFromMemory(const uint8_t* data, size_t size, std::string* error = nullptr);
+    std::vector<uint8_t> Serialize() const;
+
+    // 무작위 가중치 (모델 없이 처리량 측정 / 자체 검사). channels = 층별 출력 채널 (모두 stride 2)
+    void MakeRandom(int inputSize, const std::vector<int>& channels, uint32_t seed);
+
+    bool   IsLoaded() const { return m_inputSize > 0 && !m_convs.empty(); }
+    int    InputSize() const { return m_inputSize; }
+    size_t MacCount() const;   // 1회 곱셈-누적 수 (보고용)
+    std::string Describe() const;
+
+    // 원본 프레임의 roi 를 모델 입력 크기로 레터박스해 추론. 불량 확률 0~1.
+    float Run(const ImageView& frame, const RoiRect& roi, Scratch& scratch) const;
+
+    // 이미 inputSize x inputSize 로 맞춘 입력
+    float RunPrepared(const ImageView& input, Scratch& scratch) const;
+
+    // 자체 검사용: 같은 수식을 단순 인덱싱으로 다시 계산 (최적화 경로와 비트 단위로 같아야 함)
+    float RunReference(const ImageView& input) const;
+
+    struct Conv
+    {
+        int kernel = 3, stride = 2, pad = 1, inC = 0, outC = 0;
+        std::vector<int8_t>  weight;       // [outC][k][k][inC]
+        std::vector<int32_t> bias;         // [outC]
+        std::vector<float>   multiplier;   // [outC]
+        std::vector<int16_t> packed;       // [k][k][inC][outC] 추론용 재배치 (로드 시 생성)
+    };
+
+    struct Dense
+    {
+        int inC = 0, outC = 0;
+        float inScale = 1.0f;
+        std::vector<float> weight;   // [outC][inC]
+        std::vector<float> bias;     // [outC]
+    };
+
+private:
+    static void ConvLayer(const Conv& c, const uint8_t* in, int inW, int inH,
+                          uint8_t* out, int outW, int outH);
+    float Head(const uint8_t* act, int w, int h) const;
+
+    int               m_inputSize = 0;
+    std::vector<Conv> m_convs;
+    Dense             m_dense;
+};
+
+// ===== 두 뷰 선별 판정 =====
+struct ScreenVerdict
+{
+    bool  local = false;     // true = 서버 생략, 로컬 정상
+    float top = -1.0f;       // 뷰별 불량 확률 (-1 = 모델 없음)
+    float front = -1.0f;
+};
+
+// 두 뷰 모두 모델이 있고 passBelow 미만일 때만 로컬 정상. 나머지(애매/불량 의심/모델 없음)는 서버로.
+inline bool IsLocalPass(const ScreenVerdict& v, float passBelow)
+{
+    return v.top >= 0.0f && v.front >= 0.0f && v.top < passBelow && v.front < passBelow;
+}
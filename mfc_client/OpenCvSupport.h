@@ -0,0 +1,12 @@
+﻿#pragma once
+
+// ===== OpenCV 선택 의존성 =====
+// 프로젝트 설정(Debug|x64)에 OpenCV include 경로가 잡혀 있을 때만 사용.
+// 없으면 CANCLIENT_HAS_OPENCV 가 정의되지 않고 관련 기능은 비활성화된다.
+#if defined(__has_include)
+#if __has_include(<opencv2/core.hpp>) && __has_include(<opencv2/imgcodecs.hpp>)
+#define CANCLIENT_HAS_OPENCV 1
+#include <opencv2/core.hpp>
+#include <opencv2/imgcodecs.hpp>
+#endif
+#endif
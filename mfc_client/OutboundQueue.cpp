@@ -0,0 +1,643 @@
+﻿#include "OutboundQueue.h"
+#include "CameraClock.h"
+#include "LatencyStats.h"
+#include "PngEncoder.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    const uint32_t kQueueMagic = 0x51534E43;   // 'CNSQ'
+    const uint32_t kRecordMagic = 0x43524E43;  // 'CNRC'
+    const uint32_t kWrapMagic = 0x50574E43;    // 'CNWP' (여기부터 끝까지 비움, 0 에서 계속)
+    const uint32_t kVersion = 1;
+
+    // 파일 머리 위치
+    const size_t kMetaMagic = 0, kMetaVersion = 4, kMetaCapacity = 8, kMetaHead = 16,
+                 kMetaTail = 24, kMetaUsed = 32, kMetaCount = 40, kMetaNextId = 48, kMetaSize = 56;
+
+    // 레코드 머리: magic(4) state(1) pad(3) headerLen(4) bodyLen(4) id(8) enqueuedMs(8) crc(4) pin(4)
+    // pin = 같은 단위의 TOP 을 받은 서버 (CEndpointPool::Pin, 0 = 모름). state 처럼 CRC 밖이라 제자리에서 바뀜.
+    const size_t kRecState = 4, kRecHeaderLen = 8, kRecBodyLen = 12, kRecId = 16, kRecTime = 24,
+                 kRecCrc = 32, kRecPin = 36, kRecSize = 40;
+    const uint8_t kPending = 0, kDone = 1;
+
+    const int kMaxBackoffMs = 10000;
+
+    template <typename T> T Load(const uint8_t* p) { T v; std::memcpy(&v, p, sizeof(v)); return v; }
+    template <typename T> void Store(uint8_t* p, T v) { std::memcpy(p, &v, sizeof(v)); }
+
+    uint64_t Align8(uint64_t n) { return (n + 7) & ~uint64_t(7); }
+
+    // 레코드 CRC: 길이/번호/시각 + 헤더 + 본문 (state 는 제외 — 완료 표시는 제자리에서 바뀜)
+    uint32_t RecordCrc(const uint8_t* rec, uint32_t headerLen, uint32_t bodyLen)
+    {
+        uint32_t crc = PngCrc32(rec + kRecHeaderLen, kRecCrc - kRecHeaderLen);
+        return PngCrc32(rec + kRecSize, static_cast<size_t>(headerLen) + bodyLen, crc);
+    }
+
+    // 같은 검사 단위 (v3 헤더 없으면 valid = false)
+    RequestHeader::UnitId UnitOf(const uint8_t* header, uint32_t headerLen)
+    {
+        RequestHeader::Fields f;
+        if (!RequestHeader::Parse(header, headerLen, f))
+            return RequestHeader::UnitId();
+        return RequestHeader::UnitOf(f);
+    }
+}
+
+COutboundQueue::~COutboundQueue()
+{
+    Close();
+}
+
+// ===================== 파일 매핑 =====================
+bool COutboundQueue::MapFile(const std::string& path, uint64_t size, bool& existed, std::string* error)
+{
+    existed = false;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+        nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = "cannot open spool file: " + path;
+        return false;
+    }
+    LARGE_INTEGER current{};
+    GetFileSizeEx(file, &current);
+    existed = current.QuadPart >= static_cast<LONGLONG>(kDataOffset);
+    size = (std::max)(size, static_cast<uint64_t>(current.QuadPart));
+
+    // 매핑 크기가 파일보다 크면 파일이 늘어난다
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE,
+        static_cast<DWORD>(size >> 32), static_cast<DWORD>(size), nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, static_cast<SIZE_T>(size)) : nullptr;
+    if (!view) {
+        if (error) *error = "cannot map spool file (" + std::to_string(GetLastError()) + ")";
+        if (mapping) CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+    m_file = file;
+    m_mapping = mapping;
+    m_base = static_cast<uint8_t*>(view);
+#else
+    const int fd = open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd < 0) {
+        if (error) *error = "cannot open spool file: " + path;
+        return false;
+    }
+    struct stat st{};
+    fstat(fd, &st);
+    existed = static_cast<uint64_t>(st.st_size) >= kDataOffset;
+    size = (std::max)(size, static_cast<uint64_t>(st.st_size));
+    if (static_cast<uint64_t>(st.st_size) < size && ftruncate(fd, static_cast<off_t>(size)) != 0) {
+        if (error) *error = "cannot grow spool file (" + std::to_string(errno) + ")";
+        close(fd);
+        return false;
+    }
+    void* view = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (view == MAP_FAILED) {
+        if (error) *error = "cannot map spool file (" + std::to_string(errno) + ")";
+        close(fd);
+        return false;
+    }
+    m_fd = fd;
+    m_base = static_cast<uint8_t*>(view);
+#endif
+    m_mapSize = size;
+    return true;
+}
+
+void COutboundQueue::UnmapFile()
+{
+    if (!m_base)
+        return;
+    Flush(0, m_mapSize);
+#ifdef _WIN32
+    UnmapViewOfFile(m_base);
+    CloseHandle(static_cast<HANDLE>(m_mapping));
+    CloseHandle(static_cast<HANDLE>(m_file));
+    m_mapping = m_file = nullptr;
+#else
+    munmap(m_base, m_mapSize);
+    close(m_fd);
+    m_fd = -1;
+#endif
+    m_base = nullptr;
+    m_mapSize = 0;
+}
+
+// 더러운 페이지를 디스크로 내보내기 시작 (완료를 기다리지 않고, 호출끼리 순서도 보장하지 않음).
+// 프로세스가 죽어도 페이지 캐시는 OS 가 쓰므로 안전. 전원이 나가면 최근 레코드나 머리 갱신 일부가
+// 빠질 수 있고, 그때는 열 때 CRC 검사(Recover)가 깨진 꼬리를 버린다 — 최근 몇 건 손실, 쓰레기 전송은 없음.
+void COutboundQueue::Flush(uint64_t fileOffset, uint64_t length)
+{
+    if (!m_base || !length)
+        return;
+    const uint64_t begin = fileOffset & ~uint64_t(4095);
+    const uint64_t end = (std::min)(fileOffset + length, m_mapSize);
+#ifdef _WIN32
+    FlushViewOfFile(m_base + begin, static_cast<SIZE_T>(end - begin));
+#else
+    msync(m_base + begin, end - begin, MS_ASYNC);
+#endif
+}
+
+// ===================== 열기 / 복구 =====================
+bool COutboundQueue::Open(const std::string& path, uint64_t capacityBytes, std::string* error)
+{
+    Close();
+    capacityBytes = Align8((std::max)(capacityBytes, uint64_t(1) << 20));
+
+    // 기존 대기열이면 그 용량대로 매핑 (설정이 바뀌어도 파일을 늘리거나 자르지 않음)
+    {
+        uint8_t meta[kMetaSize] = {};
+        std::ifstream in(path, std::ios::binary);
+        if (in.read(reinterpret_cast<char*>(meta), sizeof(meta)) &&
+            Load<uint32_t>(meta + kMetaMagic) == kQueueMagic && Load<uint32_t>(meta + kMetaVersion) == kVersion)
+            capacityBytes = Align8((std::max)(Load<uint64_t>(meta + kMetaCapacity), uint64_t(kRecSize)));
+    }
+
+    bool existed = false;
+    if (!MapFile(path, kDataOffset + capacityBytes, existed, error))
+        return false;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const uint64_t fileCapacity = Load<uint64_t>(m_base + kMetaCapacity);
+    if (existed &&
+        Load<uint32_t>(m_base + kMetaMagic) == kQueueMagic &&
+        Load<uint32_t>(m_base + kMetaVersion) == kVersion &&
+        fileCapacity >= kRecSize && fileCapacity % 8 == 0 && kDataOffset + fileCapacity <= m_mapSize)
+    {
+        m_capacity = fileCapacity;
+        m_head = Load<uint64_t>(m_base + kMetaHead);
+        m_tail = Load<uint64_t>(m_base + kMetaTail);
+        m_used = Load<uint64_t>(m_base + kMetaUsed);
+        m_nextId = Load<uint64_t>(m_base + kMetaNextId);
+        if (!Recover())
+            Format(m_capacity);
+    }
+    else
+    {
+        Format(capacityBytes);
+    }
+    m_enqueued = m_delivered = m_dropped = m_retries = m_abandoned = 0;
+    return true;
+}
+
+void COutboundQueue::Format(uint64_t capacity)
+{
+    m_capacity = capacity;
+    m_head = m_tail = m_used = m_count = 0;
+    m_nextId = 1;
+    std::memset(m_base, 0, kMetaSize);
+    Store<uint32_t>(m_base + kMetaMagic, kQueueMagic);
+    Store<uint32_t>(m_base + kMetaVersion, kVersion);
+    Store<uint64_t>(m_base + kMetaCapacity, m_capacity);
+    WriteMeta();
+}
+
+void COutboundQueue::WriteMeta()
+{
+    Store<uint64_t>(m_base + kMetaHead, m_head);
+    Store<uint64_t>(m_base + kMetaTail, m_tail);
+    Store<uint64_t>(m_base + kMetaUsed, m_used);
+    Store<uint64_t>(m_base + kMetaCount, m_count);
+    Store<uint64_t>(m_base + kMetaNextId, m_nextId);
+    Flush(0, kMetaSize);
+}
+
+// head 부터 used 바이트를 따라가며 레코드 검증. 깨진 레코드를 만나면 거기서 꼬리를 자른다.
+// 머리 자체가 말이 안 되면 false (새로 포맷).
+bool COutboundQueue::Recover()
+{
+    if (m_head >= m_capacity || m_tail >= m_capacity || m_used > m_capacity || m_head % 8 || m_tail % 8)
+        return false;
+
+    uint64_t pos = m_head, walked = 0, pending = 0, maxId = 0;
+    while (walked < m_used)
+    {
+        const uint8_t* rec = Data() + pos;
+        const uint32_t magic = Load<uint32_t>(rec);
+        if (magic == kWrapMagic && pos != 0) {
+            walked += m_capacity - pos;
+            pos = 0;
+            continue;
+        }
+        if (magic != kRecordMagic || m_capacity - pos < kRecSize)
+            break;
+        const uint32_t headerLen = Load<uint32_t>(rec + kRecHeaderLen);
+        const uint32_t bodyLen = Load<uint32_t>(rec + kRecBodyLen);
+        const uint64_t size = Align8(kRecSize + static_cast<uint64_t>(headerLen) + bodyLen);
+        if (size > m_capacity - pos || walked + size > m_used ||
+            Load<uint32_t>(rec + kRecCrc) != RecordCrc(rec, headerLen, bodyLen))
+            break;
+
+        if (rec[kRecState] == kPending)
+            ++pending;
+        maxId = (std::max)(maxId, Load<uint64_t>(rec + kRecId));
+        walked += size;
+        pos += size;
+        if (pos == m_capacity)
+            pos = 0;
+    }
+
+    // 쓰다 만 꼬리 (머리 갱신 전에 꺼짐 등) → 버림
+    m_tail = pos;
+    m_used = walked;
+    m_count = pending;
+    m_nextId = (std::max)(m_nextId, maxId + 1);
+    if (m_used == 0)
+        m_head = m_tail = 0;
+    AdvanceHead();
+    WriteMeta();
+    return true;
+}
+
+void COutboundQueue::Close()
+{
+    StopDrain();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base)
+        WriteMeta();
+    UnmapFile();
+    m_inFlight.clear();
+    m_inFlightKeys.clear();
+    m_keylessInFlight = false;
+}
+
+// ===================== 넣기 =====================
+bool COutboundQueue::Push(const uint8_t* header, size_t headerSize, const uint8_t* body, size_t bodySize, uint32_t pin)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_base || headerSize > 0xFFFFFFFF || bodySize > 0xFFFFFFFF) {
+        ++m_dropped;
+        return false;
+    }
+
+    const uint64_t size = Align8(kRecSize + static_cast<uint64_t>(headerSize) + bodySize);
+    if (m_used == 0)
+        m_head = m_tail = 0;
+
+    // 자리 찾기: 꼬리 뒤 → 안 맞으면 랩 표시 후 0 부터 (head 앞까지)
+    uint64_t at = m_tail, gap = 0;
+    const bool linear = m_used == 0 || m_tail > m_head;
+    if (linear) {
+        if (size > m_capacity - m_tail) {
+            if (size > m_head) { ++m_dropped; return false; }
+            gap = m_capacity - m_tail;
+            at = 0;
+        }
+    }
+    else if (m_tail + size > m_head) {
+        ++m_dropped;
+        return false;
+    }
+
+    uint8_t* rec = Data() + at;
+    std::memset(rec, 0, kRecSize);
+    Store<uint32_t>(rec, kRecordMagic);
+    rec[kRecState] = kPending;
+    Store<uint32_t>(rec + kRecHeaderLen, static_cast<uint32_t>(headerSize));
+    Store<uint32_t>(rec + kRecBodyLen, static_cast<uint32_t>(bodySize));
+    Store<uint64_t>(rec + kRecId, m_nextId);
+    Store<int64_t>(rec + kRecTime, SteadyToUnixMs(NowNs()));
+    Store<uint32_t>(rec + kRecPin, pin);
+    if (headerSize) std::memcpy(rec + kRecSize, header, headerSize);
+    if (bodySize)   std::memcpy(rec + kRecSize + headerSize, body, bodySize);
+    Store<uint32_t>(rec + kRecCrc, RecordCrc(rec, static_cast<uint32_t>(headerSize), static_cast<uint32_t>(bodySize)));
+    Flush(kDataOffset + at, size);
+
+    // 레코드를 다 쓴 다음 머리 갱신 (랩 표시도 이때). 디스크 도달 순서는 Flush 주석 참고.
+    if (gap) {
+        Store<uint32_t>(Data() + m_tail, kWrapMagic);
+        Flush(kDataOffset + m_tail, 4);
+    }
+    m_used += gap + size;
+    m_tail = at + size == m_capacity ? 0 : at + size;
+    ++m_count;
+    ++m_nextId;
+    ++m_enqueued;
+    WriteMeta();
+
+    lock.unlock();
+    m_wake.notify_one();
+    return true;
+}
+
+// 완료된(보내는 중이 아닌) 레코드와 랩 표시를 head 에서 걷어 공간 반환
+void COutboundQueue::AdvanceHead()
+{
+    while (m_used > 0)
+    {
+        const uint8_t* rec = Data() + m_head;
+        const uint32_t magic = Load<uint32_t>(rec);
+        if (magic == kWrapMagic) {
+            m_used -= m_capacity - m_head;
+            m_head = 0;
+            continue;
+        }
+        if (rec[kRecState] != kDone || m_inFlight.count(m_head))
+            break;
+        const uint64_t size = Align8(kRecSize + static_cast<uint64_t>(Load<uint32_t>(rec + kRecHeaderLen)) +
+                                     Load<uint32_t>(rec + kRecBodyLen));
+        m_used -= size;
+        m_head += size;
+        if (m_head == m_capacity)
+            m_head = 0;
+    }
+    if (m_used == 0)
+        m_head = m_tail = 0;
+}
+
+// ===================== 상태 =====================
+size_t COutboundQueue::Depth() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return static_cast<size_t>(m_count);
+}
+
+COutboundQueue::Status COutboundQueue::GetStatus() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Status s;
+    s.records = static_cast<size_t>(m_count);
+    s.bytes = m_used;
+    s.capacity = m_capacity;
+    s.enqueued = m_enqueued;
+    s.delivered = m_delivered;
+    s.dropped = m_dropped;
+    s.retries = m_retries;
+    s.abandoned = m_abandoned;
+    s.serverDown = m_backoffMs > 0;
+
+    // 가장 오래된 대기 레코드 (head 근처라 금방 찾음)
+    uint64_t pos = m_head, walked = 0;
+    while (m_base && walked < m_used)
+    {
+        const uint8_t* rec = Data() + pos;
+        if (Load<uint32_t>(rec) == kWrapMagic) {
+            walked += m_capacity - pos;
+            pos = 0;
+            continue;
+        }
+        if (rec[kRecState] == kPending) {
+            s.oldestMs = Load<int64_t>(rec + kRecTime);
+            break;
+        }
+        const uint64_t size = Align8(kRecSize + static_cast<uint64_t>(Load<uint32_t>(rec + kRecHeaderLen)) +
+                                     Load<uint32_t>(rec + kRecBodyLen));
+        walked += size;
+        pos = pos + size == m_capacity ? 0 : pos + size;
+    }
+    return s;
+}
+
+std::string FormatSpoolStatus(const COutboundQueue::Status& s, int64_t nowUnixMs)
+{
+    char line[200];
+    const double oldestS = s.oldestMs > 0 && nowUnixMs > s.oldestMs ? (nowUnixMs - s.oldestMs) / 1e3 : 0.0;
+    std::snprintf(line, sizeof(line), "spool %zu frames, %.1f/%.0f MB, oldest %.0f s, %s (retries %llu), sent %llu, dropped %llu, abandoned %llu\n",
+        s.records, s.bytes / 1048576.0, s.capacity / 1048576.0, oldestS,
+        s.serverDown ? "server down" : "server up",
+        static_cast<unsigned long long>(s.retries), static_cast<unsigned long long>(s.delivered),
+        static_cast<unsigned long long>(s.dropped), static_cast<unsigned long long>(s.abandoned));
+    return line;
+}
+
+// ===================== 배출 =====================
+void COutboundQueue::StartDrain(const ServerEndpoint& server, int concurrency, int retryMs, DeliveredFn onDelivered)
+{
+    StopDrain();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = false;
+        m_cancel = false;
+        m_server = server;
+        m_onDelivered = std::move(onDelivered);
+        m_retryMs = (std::max)(retryMs, 50);
+        m_backoffMs = 0;
+        m_retryAtNs = 0;
+    }
+    for (int i = 0; i < (std::max)(concurrency, 1); ++i)
+        m_workers.emplace_back(&COutboundQueue::Worker, this);
+}
+
+void COutboundQueue::StopDrain()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+        m_cancel = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers)
+        t.join();
+    m_workers.clear();
+}
+
+// 다음 보낼 단위 (잠금 안에서): 보내는 중이 아닌 첫 대기 레코드 + 뒤따르는 같은 키 레코드 전부.
+// 서버가 끊겨 있으면 탐지용으로 한 단위만, 키 없는 레코드는 혼자서만.
+bool COutboundQueue::ClaimUnit(std::vector<Claim>& unit)
+{
+    unit.clear();
+    if (!m_base || m_count == 0 || m_keylessInFlight)
+        return false;
+    if (m_backoffMs > 0 && (!m_inFlight.empty() || NowNs() < m_retryAtNs))
+        return false;
+
+    RequestHeader::UnitId key;
+    bool found = false;
+    uint64_t pos = m_head, walked = 0;
+    while (walked < m_used)
+    {
+        const uint8_t* rec = Data() + pos;
+        if (Load<uint32_t>(rec) == kWrapMagic) {
+            walked += m_capacity - pos;
+            pos = 0;
+            continue;
+        }
+        const uint32_t headerLen = Load<uint32_t>(rec + kRecHeaderLen);
+        const uint32_t bodyLen = Load<uint32_t>(rec + kRecBodyLen);
+        const uint64_t size = Align8(kRecSize + static_cast<uint64_t>(headerLen) + bodyLen);
+
+        if (rec[kRecState] == kPending && !m_inFlight.count(pos))
+        {
+            const RequestHeader::UnitId recKey = UnitOf(rec + kRecSize, headerLen);
+            Claim c;
+            c.offset = pos;
+            c.header = rec + kRecSize;
+            c.headerLen = headerLen;
+            c.body = rec + kRecSize + headerLen;
+            c.bodyLen = bodyLen;
+            c.pin = Load<uint32_t>(rec + kRecPin);
+
+            if (!found)
+            {
+                if (!recKey.valid) {
+                    // 도착 순서 서버: 앞선 것이 다 끝나야 보냄
+                    if (!m_inFlight.empty())
+                        return false;
+                    unit.push_back(c);
+                    break;
+                }
+                // TOP 을 받은 서버가 빠진 단위는 그 서버가 돌아올 때까지 두고 뒤 단위부터
+                if (!m_inFlightKeys.count(recKey) && !(m_pool && m_pool->Stranded(recKey, c.pin))) {
+                    found = true;
+                    key = recKey;
+                    unit.push_back(c);
+                }
+            }
+            else if (recKey == key)
+                unit.push_back(c);
+        }
+        walked += size;
+        pos = pos + size == m_capacity ? 0 : pos + size;
+    }
+    if (unit.empty())
+        return false;
+
+    for (const Claim& c : unit)
+        m_inFlight.insert(c.offset);
+    if (!key.valid) m_keylessInFlight = true;
+    else            m_inFlightKeys.insert(key);
+    unit.front().key = key;
+    return true;
+}
+
+void COutboundQueue::Worker()
+{
+    std::vector<Claim> unit;
+    std::string response, error;
+    RequestTiming timing;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while (!m_stop && !ClaimUnit(unit))
+                m_wake.wait_for(lock, std::chrono::milliseconds(100));
+            if (m_stop)
+                return;
+        }
+        // 단위 첫 레코드가 TOP 이면 아무 서버나, 아니면 (TOP 은 이미 보냄) TOP 을 받은 서버가 돌아올 때까지 대기
+        const RequestHeader::UnitId key = unit.front().key;
+        const int route = m_pool ? m_pool->Route(key, unit.front().pin) : -1;
+
+        // TOP 을 받은 서버를 모름 (핀 없는 옛 레코드, 설정에서 빠진 서버): 다른 서버로 보내면 짝이 틀리므로 버리고 알림
+        if (route == CEndpointPool::kUnknownUnit) {
+            Abandon(unit);
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlightKeys.erase(key);
+            continue;
+        }
+
+        // 단위 안에서는 순서대로 (TOP → SIDE), 같은 서버로. 레코드는 보내는 중이라 덮어써지지 않음.
+        for (size_t i = 0; i < unit.size(); ++i)
+        {
+            const Claim& c = unit[i];
+            bool ok = false;
+            timing = RequestTiming();
+            if (!m_pool || route >= 0) {
+                if (route >= 0) m_pool->Begin(route);
+                ok = SendInspectionRequest(route >= 0 ? m_pool->Endpoint(route) : m_server,
+                    c.header, c.headerLen, c.body, c.bodyLen, response, nullptr, &timing, &error, &m_cancel);
+                // 빈 응답 = 서버가 처리 도중 끊음 (추론 중 재시작 등). 직접 보낼 때는 화면에 에러로 보이지만
+                // 대기열 레코드는 아무도 모르게 사라지므로 실패로 보고 남겨 둔다.
+                if (ok && response.empty()) {
+                    ok = false;
+                    error = "empty reply";
+                }
+                if (route >= 0) m_pool->End(route, ok, timing);
+            }
+
+            RequestHeader::Fields meta;
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (!ok)
+            {
+                // 서버 아직 없음: 남은 레코드 반환, 모두 같이 쉬었다가 한 단위로 다시 탐지
+                for (size_t j = i; j < unit.size(); ++j)
+                    m_inFlight.erase(unit[j].offset);
+                if (timing.cancelled)
+                    break;               // 멈추는 중: 다음 실행에서 다시
+                ++m_retries;
+                if (route >= 0 && !m_pool->Healthy(route) && m_pool->HealthyAny()) {
+                    m_backoffMs = 0;     // 이 서버는 풀에서 빠짐: 쉬지 않고 다른 서버로
+                    m_retryAtNs = 0;
+                    break;
+                }
+                m_backoffMs = m_backoffMs ? (std::min)(m_backoffMs * 2, kMaxBackoffMs) : m_retryMs;
+                m_retryAtNs = NowNs() + static_cast<uint64_t>(m_backoffMs) * 1000000ull;
+                break;
+            }
+
+            Data()[c.offset + kRecState] = kDone;
+            Flush(kDataOffset + c.offset + kRecState, 1);
+            // TOP 을 받은 서버를 남은 레코드에 기록 (SIDE 가 실패해 남아도, 재시작 뒤에도 같은 서버로)
+            if (i == 0 && key.startsUnit && route >= 0)
+                for (size_t j = 1; j < unit.size(); ++j) {
+                    Store<uint32_t>(Data() + unit[j].offset + kRecPin, m_pool->Pin(route));
+                    Flush(kDataOffset + unit[j].offset + kRecPin, 4);
+                }
+            m_inFlight.erase(c.offset);
+            --m_count;
+            ++m_delivered;
+            m_backoffMs = 0;
+            m_retryAtNs = 0;
+            RequestHeader::Parse(c.header, c.headerLen, meta);
+            AdvanceHead();
+            WriteMeta();
+            lock.unlock();
+            m_wake.notify_all();
+
+            if (m_onDelivered)
+                m_onDelivered(meta, response);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!key.valid) m_keylessInFlight = false;
+        else            m_inFlightKeys.erase(key);
+    }
+}
+
+// 보낼 서버가 없는 단위: 완료로 표시하고 빈 응답으로 알림 (받는 쪽이 에러로 표시)
+void COutboundQueue::Abandon(const std::vector<Claim>& unit)
+{
+    std::vector<RequestHeader::Fields> metas(unit.size());
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (size_t i = 0; i < unit.size(); ++i)
+        {
+            const Claim& c = unit[i];
+            RequestHeader::Parse(c.header, c.headerLen, metas[i]);   // AdvanceHead 전에 (공간이 재사용됨)
+            Data()[c.offset + kRecState] = kDone;
+            Flush(kDataOffset + c.offset + kRecState, 1);
+            m_inFlight.erase(c.offset);
+            --m_count;
+            ++m_abandoned;
+        }
+        AdvanceHead();
+        WriteMeta();
+    }
+    m_wake.notify_all();
+
+    if (m_onDelivered)
+        for (const RequestHeader::Fields& meta : metas)
+            m_onDelivered(meta, std::string());
+}
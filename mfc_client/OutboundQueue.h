@@ -0,0 +1,136 @@
+﻿#pragma once
+#include "EndpointPool.h"
+#include "InspectionClient.h"
+#include "RequestHeader.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ===== 오프라인 전송 대기열 (디스크 파일을 메모리 맵한 링 버퍼) =====
+// 서버에 연결할 수 없을 때 보낼 요청([CNHD 헤더][본문])을 그대로 쌓아 두고,
+// 서버가 돌아오면 동시 연결 수를 제한해 최대 속도로 비운다. 프로세스를 다시 켜도 이어서 보낸다.
+//
+// 파일 = 4 KB 머리 + 데이터 영역 (capacity). 레코드는 8바이트 정렬, 끝에 안 맞으면 랩 표시 후 0 부터.
+//  머리:   magic 'CNSQ' | version | capacity | head | tail | used | count | nextId   (u64, 리틀 엔디언)
+//  레코드: magic 'CNRC' | state(0 대기, 1 완료) | headerLen | bodyLen | id | enqueuedMs | crc32 | 헤더 | 본문
+// 레코드를 다 쓴 뒤에 머리(tail/count)를 갱신하고, 열 때 head 부터 CRC 를 확인해 깨진 꼬리는 버린다.
+// 프로세스가 죽어도 쌓인 것은 남고, 전원이 나가면 최근 몇 건은 잃을 수 있다 (플러시는 비동기).
+// 전달은 최소 1회 (보내는 중에 꺼지면 다시 보냄). 빈 응답(처리 중 끊김)은 전달로 치지 않는다.
+//
+// 같은 검사 단위(헤더 v3 의 제품번호 + 단위 번호)는 한 작업자가 대기열 순서대로 보낸다 (TOP → SIDE).
+// 단위끼리는 동시에. v3 역할이 없는 레코드는 도착 순서로 짝짓는 서버를 위해 하나씩 차례로.
+// TOP 은 이미 보냈고 그 서버가 풀에서 빠진 단위는 다른 서버로 돌리지 않고 남겨 둔다 (CEndpointPool::Route).
+// 그 서버는 레코드의 pin 으로 기억하므로 재시작 뒤에도 같다. 어느 서버인지 모르면 보내지 않고 버린다 (abandoned).
+class COutboundQueue
+{
+public:
+    struct Status
+    {
+        size_t   records = 0;       // 보내지 않은 레코드
+        uint64_t bytes = 0;         // 쓰는 중인 데이터 영역 (랩 틈 포함)
+        uint64_t capacity = 0;
+        int64_t  oldestMs = 0;      // 가장 오래된 대기 레코드의 Unix ms (0 = 없음)
+        uint64_t enqueued = 0;      // 이번 실행에서 넣은 수
+        uint64_t delivered = 0;     // 이번 실행에서 보낸 수
+        uint64_t dropped = 0;       // 가득 차서 못 넣은 수
+        uint64_t retries = 0;       // 보내기 실패 (서버 아직 없음)
+        uint64_t abandoned = 0;     // TOP 을 받은 서버를 몰라 보내지 않고 버림 (빈 응답으로 알림)
+        bool     serverDown = false;
+    };
+
+    // 보낸 레코드의 헤더 메타데이터와 서버 응답 (작업자 스레드에서 호출). 빈 응답 = 버린 레코드 (abandoned)
+    using DeliveredFn = std::function<void(const RequestHeader::Fields& meta, const std::string& response)>;
+
+    COutboundQueue() = default;
+    ~COutboundQueue();
+    COutboundQueue(const COutboundQueue&) = delete;
+    COutboundQueue& operator=(const COutboundQueue&) = delete;
+
+    // 있으면 이어서 (파일의 용량을 그대로), 없으면 capacityBytes 로 새로.
+    bool Open(const std::string& path, uint64_t capacityBytes, std::string* error = nullptr);
+    void Close();                   // 배출 중이면 먼저 멈춤
+    bool IsOpen() const { return m_base != nullptr; }
+
+    // 가득 찼거나 닫혀 있으면 false (dropped 증가).
+    // pin = 같은 단위의 TOP 을 받은 서버 (CEndpointPool::PinOf, 0 = 없음/모름). TOP 이 대기열에 같이 있으면 무시.
+    bool Push(const uint8_t* header, size_t headerSize, const uint8_t* body, size_t bodySize, uint32_t pin = 0);
+
+    size_t Depth() const;           // 보내지 않은 레코드 수 (보내는 중 포함)
+    Status GetStatus() const;
+
+    // 배출: 작업자 concurrency 개. 실패하면 모든 작업자가 retryMs 부터 두 배씩 (최대 10초) 쉬었다 다시.
+    void StartDrain(const ServerEndpoint& server, int concurrency, int retryMs, DeliveredFn onDelivered);
+    void StopDrain();
+
+    // 검사 서버 풀 (StartDrain 전에). 있으면 server 대신 단위마다 풀이 고른 서버로.
+    // 실패한 서버가 풀에서 빠지고 다른 서버가 남아 있으면 쉬지 않고 바로 다시 보낸다.
+    void SetEndpointPool(CEndpointPool* pool) { m_pool = pool; }
+
+private:
+    struct Claim
+    {
+        uint64_t offset = 0;        // 데이터 영역 안 레코드 위치
+        const uint8_t* header = nullptr;
+        uint32_t headerLen = 0;
+        const uint8_t* body = nullptr;
+        uint32_t bodyLen = 0;
+        RequestHeader::UnitId key;  // 단위 키 (첫 레코드에만, startsUnit = 첫 레코드가 TOP)
+        uint32_t pin = 0;           // 레코드에 저장된 서버 핀
+    };
+
+    bool MapFile(const std::string& path, uint64_t size, bool& existed, std::string* error);
+    void UnmapFile();
+    void Flush(uint64_t fileOffset, uint64_t length);
+    bool Recover();                 // 열 때 head 부터 검증, 깨진 꼬리 잘라냄
+    void Format(uint64_t capacity);
+    void WriteMeta();
+    void AdvanceHead();             // 완료/랩 레코드를 건너뛰어 공간 반환 (잠금 안에서)
+    bool ClaimUnit(std::vector<Claim>& unit);
+    void Worker();
+    void Abandon(const std::vector<Claim>& unit);
+
+    uint8_t* Data() const { return m_base + kDataOffset; }
+
+    static constexpr uint64_t kDataOffset = 4096;
+
+    // 파일 매핑
+#ifdef _WIN32
+    void* m_file = nullptr;
+    void* m_mapping = nullptr;
+#else
+    int   m_fd = -1;
+#endif
+    uint8_t* m_base = nullptr;
+    uint64_t m_mapSize = 0;
+
+    // 머리 사본 (m_mutex)
+    mutable std::mutex m_mutex;
+    uint64_t m_capacity = 0, m_head = 0, m_tail = 0, m_used = 0, m_count = 0, m_nextId = 1;
+    std::set<uint64_t> m_inFlight;  // 보내는 중인 레코드 위치
+    std::set<RequestHeader::UnitId> m_inFlightKeys;   // 보내는 중인 단위
+    bool     m_keylessInFlight = false;
+    uint64_t m_enqueued = 0, m_delivered = 0, m_dropped = 0, m_retries = 0, m_abandoned = 0;
+
+    // 배출 (StopDrain 이 m_cancel 을 켜서 멈춘 서버에 보내는 중인 요청도 바로 끝냄)
+    std::atomic<bool>        m_cancel{ false };
+    std::vector<std::thread> m_workers;
+    std::condition_variable  m_wake;
+    bool                     m_stop = false;
+    ServerEndpoint           m_server;
+    CEndpointPool*           m_pool = nullptr;
+    DeliveredFn              m_onDelivered;
+    int                      m_retryMs = 1000;
+    int                      m_backoffMs = 0;    // 0 = 서버 정상
+    uint64_t                 m_retryAtNs = 0;
+};
+
+// 지연 표/로그 한 줄: "spool 12 frames, 34.5/256 MB, oldest 42 s, server down (retries 3), sent 10, dropped 0"
+std::string FormatSpoolStatus(const COutboundQueue::Status& s, int64_t nowUnixMs);
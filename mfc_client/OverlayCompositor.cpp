@@ -0,0 +1,285 @@
+﻿#include "OverlayCompositor.h"
+#include "TilePipeline.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// ===================== 5x7 글꼴 =====================
+namespace
+{
+    constexpr int kGlyphW = 5;
+    constexpr int kGlyphH = 7;
+
+    // ASCII 0x20~0x7E, 열 단위 5바이트 (bit0 = 맨 윗줄)
+    const uint8_t kFont5x7[95][kGlyphW] = {
+        { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, // ' ' ! "
+        { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, // # $ %
+        { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, { 0x00, 0x1C, 0x22, 0x41, 0x00 }, // & ' (
+        { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ) * +
+        { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, // , - .
+        { 0x20, 0x10, 0x08, 0x04, 0x02 }, { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, // / 0 1
+        { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, { 0x18, 0x14, 0x12, 0x7F, 0x10 }, // 2 3 4
+        { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 5 6 7
+        { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, // 8 9 :
+        { 0x00, 0x56, 0x36, 0x00, 0x00 }, { 0x08, 0x14, 0x22, 0x41, 0x00 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, // ; < =
+        { 0x00, 0x41, 0x22, 0x14, 0x08 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, { 0x32, 0x49, 0x79, 0x41, 0x3E }, // > ? @
+        { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // A B C
+        { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x09, 0x01 }, // D E F
+        { 0x3E, 0x41, 0x49, 0x49, 0x7A }, { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, // G H I
+        { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, { 0x7F, 0x40, 0x40, 0x40, 0x40 }, // J K L
+        { 0x7F, 0x02, 0x0C, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // M N O
+        { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, // P Q R
+        { 0x46, 0x49, 0x49, 0x49, 0x31 }, { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, // S T U
+        { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x3F, 0x40, 0x38, 0x40, 0x3F }, { 0x63, 0x14, 0x08, 0x14, 0x63 }, // V W X
+        { 0x07, 0x08, 0x70, 0x08, 0x07 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 }, // Y Z [
+        { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, // \ ] ^
+        { 0x40, 0x40, 0x40, 0x40, 0x40 }, { 0x00, 0x01, 0x02, 0x04, 0x00 }, { 0x20, 0x54, 0x54, 0x54, 0x78 }, // _ ` a
+        { 0x7F, 0x48, 0x44, 0x44, 0x38 }, { 0x38, 0x44, 0x44, 0x44, 0x20 }, { 0x38, 0x44, 0x44, 0x48, 0x7F }, // b c d
+        { 0x38, 0x54, 0x54, 0x54, 0x18 }, { 0x08, 0x7E, 0x09, 0x01, 0x02 }, { 0x0C, 0x52, 0x52, 0x52, 0x3E }, // e f g
+        { 0x7F, 0x08, 0x04, 0x04, 0x78 }, { 0x00, 0x44, 0x7D, 0x40, 0x00 }, { 0x20, 0x40, 0x44, 0x3D, 0x00 }, // h i j
+        { 0x7F, 0x10, 0x28, 0x44, 0x00 }, { 0x00, 0x41, 0x7F, 0x40, 0x00 }, { 0x7C, 0x04, 0x18, 0x04, 0x78 }, // k l m
+        { 0x7C, 0x08, 0x04, 0x04, 0x78 }, { 0x38, 0x44, 0x44, 0x44, 0x38 }, { 0x7C, 0x14, 0x14, 0x14, 0x08 }, // n o p
+        { 0x08, 0x14, 0x14, 0x18, 0x7C }, { 0x7C, 0x08, 0x04, 0x04, 0x08 }, { 0x48, 0x54, 0x54, 0x54, 0x20 }, // q r s
+        { 0x04, 0x3F, 0x44, 0x40, 0x20 }, { 0x3C, 0x40, 0x40, 0x20, 0x7C }, { 0x1C, 0x20, 0x40, 0x20, 0x1C }, // t u v
+        { 0x3C, 0x40, 0x30, 0x40, 0x3C }, { 0x44, 0x28, 0x10, 0x28, 0x44 }, { 0x0C, 0x50, 0x50, 0x50, 0x3C }, // w x y
+        { 0x44, 0x64, 0x54, 0x4C, 0x44 }, { 0x00, 0x08, 0x36, 0x41, 0x00 }, { 0x00, 0x00, 0x7F, 0x00, 0x00 }, // z { |
+        { 0x00, 0x41, 0x36, 0x08, 0x00 }, { 0x08, 0x04, 0x08, 0x10, 0x08 },                                     // } ~
+    };
+
+    const uint8_t* Glyph(char ch)
+    {
+        const unsigned c = static_cast<unsigned char>(ch);
+        return kFont5x7[(c >= 0x20 && c <= 0x7E) ? c - 0x20 : '?' - 0x20];
+    }
+
+    // 사각형을 영상 안으로 자름. 남는 게 없으면 false
+    bool Clip(const ImageBuffer& img, int& x, int& y, int& w, int& h)
+    {
+        int x1 = x + w, y1 = y + h;
+        x = std::max(x, 0);
+        y = std::max(y, 0);
+        x1 = std::min(x1, img.width);
+        y1 = std::min(y1, img.height);
+        w = x1 - x;
+        h = y1 - y;
+        return w > 0 && h > 0;
+    }
+}
+
+// ===================== 래스터라이저 =====================
+namespace Raster
+{
+    void FillRect(ImageBuffer& img, int x, int y, int w, int h, Color c)
+    {
+        if (!Clip(img, x, y, w, h)) return;
+
+        // 첫 행만 픽셀 단위로 칠하고 나머지 행은 복사
+        uint8_t* first = img.Row(y) + x * 3;
+        for (int i = 0; i < w; ++i) {
+            first[i * 3 + 0] = c.b;
+            first[i * 3 + 1] = c.g;
+            first[i * 3 + 2] = c.r;
+        }
+        for (int row = 1; row < h; ++row)
+            std::memcpy(img.Row(y + row) + x * 3, first, static_cast<size_t>(w) * 3);
+    }
+
+    void StrokeRect(ImageBuffer& img, int x, int y, int w, int h, int thickness, Color c)
+    {
+        if (w <= 0 || h <= 0) return;
+        const int t = std::max(1, std::min(thickness, std::min((w + 1) / 2, (h + 1) / 2)));
+        FillRect(img, x, y, w, t, c);                   // 위
+        FillRect(img, x, y + h - t, w, t, c);           // 아래
+        FillRect(img, x, y + t, t, h - 2 * t, c);       // 왼쪽
+        FillRect(img, x + w - t, y + t, t, h - 2 * t, c); // 오른쪽
+    }
+
+    int TextWidth(std::string_view text, int scale)
+    {
+        return text.empty() ? 0 : static_cast<int>(text.size()) * (kGlyphW + 1) * scale - scale;
+    }
+
+    int TextHeight(int scale)
+    {
+        return kGlyphH * scale;
+    }
+
+    void PutText(ImageBuffer& img, int x, int y, std::string_view text, int scale, Color c)
+    {
+        scale = std::max(scale, 1);
+        for (char ch : text) {
+            const uint8_t* g = Glyph(ch);
+            for (int col = 0; col < kGlyphW; ++col) {
+                // 세로로 이어진 점은 한 번에 칠함
+                uint8_t bits = g[col];
+                int row = 0;
+                while (bits) {
+                    if (!(bits & 1)) { bits >>= 1; ++row; continue; }
+                    int run = 0;
+                    while (bits & 1) { bits >>= 1; ++run; }
+                    FillRect(img, x + col * scale, y + row * scale, scale, run * scale, c);
+                    row += run;
+                }
+            }
+            x += (kGlyphW + 1) * scale;
+        }
+    }
+}
+
+// ===================== 면적 평균 축소 (타일 파이프라인, 합성기 작업자 스레드 1개) =====================
+void DownscaleToFit(const ImageView& src, int maxW, int maxH, ImageBuffer& dst)
+{
+    int w = 0, h = 0;
+    if (!src.IsValid() || !Tile::FitSize(src.width, src.height, maxW, maxH, w, h)) {
+        dst.Allocate(0, 0);
+        return;
+    }
+    Tile::Run(Tile::AreaDownscale<Tile::ViewSource>(Tile::ViewSource(src), w, h), dst, nullptr);
+}
+
+// ===================== 합성기 =====================
+COverlayCompositor::COverlayCompositor()
+    : m_worker([this] { WorkerLoop(); })
+{
+}
+
+COverlayCompositor::~COverlayCompositor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    if (m_worker.joinable())
+        m_worker.join();
+}
+
+void COverlayCompositor::SetReadyCallback(ReadyFn fn)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_ready = std::move(fn);
+}
+
+void COverlayCompositor::Submit(int slot, const ImageView& frame, const ViewDetections& detections,
+                                int maxW, int maxH, float minScore)
+{
+    if (slot < 0 || slot >= kSlots) return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Job& job = m_slots[slot].job;
+        job.pending = true;
+        job.frame = frame;
+        job.detections = detections;
+        job.maxW = maxW;
+        job.maxH = maxH;
+        job.minScore = minScore;
+    }
+    m_wake.notify_one();
+}
+
+void COverlayCompositor::WaitIdle()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] {
+        if (m_busy) return false;
+        for (const Slot& s : m_slots)
+            if (s.job.pending) return false;
+        return true;
+    });
+}
+
+bool COverlayCompositor::TakeLatest(int slot, ImageBuffer& out)
+{
+    if (slot < 0 || slot >= kSlots) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Slot& s = m_slots[slot];
+    if (!s.fresh) return false;
+    std::swap(out, s.front);
+    s.fresh = false;
+    return true;
+}
+
+void COverlayCompositor::WorkerLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        int index = -1;
+        m_wake.wait(lock, [&] {
+            if (m_stop) return true;
+            for (int i = 0; i < kSlots; ++i)
+                if (m_slots[i].job.pending) { index = i; return true; }
+            return false;
+        });
+        if (m_stop) return;
+
+        Slot& s = m_slots[index];
+        const Job job = s.job;
+        s.job.pending = false;
+        m_busy = true;
+        lock.unlock();
+
+        // back 은 작업자만 만지므로 잠금 밖에서 그림
+        const auto t0 = std::chrono::steady_clock::now();
+        Compose(job, s.back);
+        m_lastMs.store(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count(),
+                       std::memory_order_relaxed);
+
+        lock.lock();
+        std::swap(s.back, s.front);
+        s.fresh = true;
+        m_busy = false;
+        const ReadyFn ready = m_ready;
+        m_idle.notify_all();
+
+        if (ready) {
+            lock.unlock();
+            ready(index);
+            lock.lock();
+        }
+    }
+}
+
+void COverlayCompositor::Compose(const Job& job, ImageBuffer& out)
+{
+    DownscaleToFit(job.frame, job.maxW, job.maxH, out);
+    if (out.width == 0)
+        return;
+
+    const Raster::Color kDefect{ 48, 48, 255 };   // BGR
+    const Raster::Color kNormal{ 48, 220, 48 };
+    const Raster::Color kWhite{ 255, 255, 255 };
+    const Raster::Color kBlack{ 0, 0, 0 };
+
+    const double sx = static_cast<double>(out.width) / job.frame.width;
+    const double sy = static_cast<double>(out.height) / job.frame.height;
+    const int thickness = out.width >= 320 ? 2 : 1;
+    const int scale = out.width >= 480 ? 2 : 1;
+
+    char text[48];
+    for (const SensorDetection& d : job.detections)
+    {
+        if (!d.HasBox() || d.Score() < job.minScore) continue;
+
+        const bool defect = DefectLabels::IsDefect(d.labelId);
+        const Raster::Color color = defect ? kDefect : kNormal;
+
+        const int x = static_cast<int>(d.x * sx);
+        const int y = static_cast<int>(d.y * sy);
+        const int w = std::max(1, static_cast<int>(std::ceil(d.w * sx)));
+        const int h = std::max(1, static_cast<int>(std::ceil(d.h * sy)));
+        Raster::StrokeRect(out, x, y, w, h, thickness, color);
+
+        // 라벨은 박스 위 (위쪽 여유가 없으면 박스 안), 배경을 칠해 영상 위에서도 읽히게
+        std::snprintf(text, sizeof(text), "%s %.2f", DefectLabels::ClassName(d.labelId), d.Score());
+        const int tw = Raster::TextWidth(text, scale) + 2;
+        const int th = Raster::TextHeight(scale) + 2;
+        const int ty = y - th >= 0 ? y - th : y;
+        Raster::FillRect(out, x, ty, tw, th, color);
+        Raster::PutText(out, x + 1, ty + 1, text, scale, defect ? kWhite : kBlack);
+    }
+}
@@ -0,0 +1,98 @@
+﻿#pragma once
+#include "ImageView.h"
+#include "InspectionCore.h"
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string_view>
+#include <thread>
+
+// ===== 소프트웨어 래스터라이저 (BGR8, MFC/GDI 비의존) =====
+// 미리보기 해상도 버퍼에 사각형/글자를 직접 찍는다. 영상 밖으로 나간 부분은 잘라 냄.
+namespace Raster
+{
+    struct Color { uint8_t b, g, r; };
+
+    void FillRect(ImageBuffer& img, int x, int y, int w, int h, Color c);
+    void StrokeRect(ImageBuffer& img, int x, int y, int w, int h, int thickness, Color c);
+
+    // 내장 5x7 글꼴 (ASCII 0x20~0x7E, 그 외는 '?'). scale 배 확대, 글자 간격 1칸.
+    int  TextWidth(std::string_view text, int scale);
+    int  TextHeight(int scale);
+    void PutText(ImageBuffer& img, int x, int y, std::string_view text, int scale, Color c);
+}
+
+// src 전체를 maxW x maxH 안에 비율 유지로 면적 평균 축소.
+// 너비는 4의 배수로 맞춤 (24bpp DIB 행이 4바이트 정렬되도록 → StretchDIBits/SetDIBitsToDevice 에 그대로).
+void DownscaleToFit(const ImageView& src, int maxW, int maxH, ImageBuffer& dst);
+
+// ===== 검출 오버레이 합성기 =====
+// 마지막 검사 프레임(센서 해상도, 빌린 버퍼)을 작업자 스레드에서 미리보기 해상도로 줄이고
+// 그 위에 검출 박스/라벨을 그린다. 원본은 복사하지 않으므로 frame 버퍼는
+// 완료 콜백이 오거나 WaitIdle() 이 돌아올 때까지 건드리면 안 된다.
+// 완성본은 TakeLatest() 로 호출 측 버퍼와 맞바꿔 가져간다 (정상 상태에서 할당 없음).
+class COverlayCompositor
+{
+public:
+    static constexpr int kSlots = 2;   // 0 = TOP, 1 = FRONT
+    using ReadyFn = std::function<void(int slot)>;
+
+    COverlayCompositor();
+    ~COverlayCompositor();
+
+    COverlayCompositor(const COverlayCompositor&) = delete;
+    COverlayCompositor& operator=(const COverlayCompositor&) = delete;
+
+    // 완성 알림 (작업자 스레드에서 호출 → UI 는 PostMessage 로 넘길 것)
+    void SetReadyCallback(ReadyFn fn);
+
+    // 같은 슬롯에 아직 시작 안 한 요청이 있으면 새 요청으로 덮어씀
+    void Submit(int slot, const ImageView& frame, const ViewDetections& detections,
+                int maxW, int maxH, float minScore);
+
+    // 대기 중/진행 중 작업이 모두 끝날 때까지 (frame 버퍼 재사용 전에 호출)
+    void WaitIdle();
+
+    // 새 완성본이 있으면 out 과 맞바꾸고 true
+    bool TakeLatest(int slot, ImageBuffer& out);
+
+    // 마지막 합성 소요 시간 (축소 + 그리기)
+    double LastComposeMs() const { return m_lastMs.load(std::memory_order_relaxed); }
+
+private:
+    struct Job
+    {
+        bool           pending = false;
+        ImageView      frame;
+        ViewDetections detections;
+        int            maxW = 0;
+        int            maxH = 0;
+        float          minScore = 0.0f;
+    };
+
+    struct Slot
+    {
+        Job         job;
+        ImageBuffer back;      // 작업자 전용
+        ImageBuffer front;     // 완성본 (m_mutex 보호)
+        bool        fresh = false;
+    };
+
+    void WorkerLoop();
+    static void Compose(const Job& job, ImageBuffer& out);
+
+    std::array<Slot, kSlots> m_slots;
+    ReadyFn                  m_ready;
+
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    bool                    m_busy = false;
+    bool                    m_stop = false;
+    std::atomic<double>     m_lastMs{ 0.0 };
+    std::thread             m_worker;
+};
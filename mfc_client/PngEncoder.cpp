@@ -0,0 +1,235 @@
+﻿#include "PngEncoder.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace
+{
+    constexpr int kBpp = 3;   // RGB8
+    const uint8_t kPngSignature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+    const uint8_t kZlibHeader[2] = { 0x78, 0x01 };  // deflate, 32K 윈도, 최저 레벨 표기
+
+    void PutU32(std::vector<uint8_t>& out, uint32_t v)
+    {
+        const uint8_t b[4] = {
+            static_cast<uint8_t>(v >> 24), static_cast<uint8_t>(v >> 16),
+            static_cast<uint8_t>(v >> 8), static_cast<uint8_t>(v) };
+        out.insert(out.end(), b, b + 4);
+    }
+
+    // 타입(4바이트) + 데이터 → [길이][타입][데이터][CRC]
+    void WriteChunk(std::vector<uint8_t>& out, const char* type, const uint8_t* data, size_t len)
+    {
+        PutU32(out, static_cast<uint32_t>(len));
+        const size_t start = out.size();
+        out.insert(out.end(), type, type + 4);
+        if (len) out.insert(out.end(), data, data + len);
+        PutU32(out, PngCrc32(out.data() + start, len + 4));
+    }
+
+    void BgrToRgb(const uint8_t* src, uint8_t* dst, int width)
+    {
+        for (int x = 0; x < width; ++x, src += 3, dst += 3)
+        {
+            dst[0] = src[2];
+            dst[1] = src[1];
+            dst[2] = src[0];
+        }
+    }
+
+    inline uint8_t Paeth(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = std::abs(p - a);
+        const int pb = std::abs(p - b);
+        const int pc = std::abs(p - c);
+        if (pa <= pb && pa <= pc) return static_cast<uint8_t>(a);
+        if (pb <= pc) return static_cast<uint8_t>(b);
+        return static_cast<uint8_t>(c);
+    }
+
+    void ApplyFilter(PngFilter type, const uint8_t* cur, const uint8_t* prev, size_t n, uint8_t* out)
+    {
+        switch (type)
+        {
+        case PngFilter::None:
+            std::memcpy(out, cur, n);
+            break;
+        case PngFilter::Sub:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = static_cast<uint8_t>(cur[i] - (i >= kBpp ? cur[i - kBpp] : 0));
+            break;
+        case PngFilter::Up:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = static_cast<uint8_t>(cur[i] - prev[i]);
+            break;
+        case PngFilter::Average:
+            for (size_t i = 0; i < n; ++i)
+                out[i] = static_cast<uint8_t>(cur[i] - (((i >= kBpp ? cur[i - kBpp] : 0) + prev[i]) >> 1));
+            break;
+        case PngFilter::Paeth:
+        default:
+            for (size_t i = 0; i < n; ++i)
+            {
+                const int a = i >= kBpp ? cur[i - kBpp] : 0;
+                const int c = i >= kBpp ? prev[i - kBpp] : 0;
+                out[i] = static_cast<uint8_t>(cur[i] - Paeth(a, prev[i], c));
+            }
+            break;
+        }
+    }
+
+    // 부호 있는 바이트로 본 절대값 합 (작을수록 deflate 가 잘 압축)
+    uint64_t FilterCost(const uint8_t* p, size_t n)
+    {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i)
+            sum += static_cast<uint64_t>(std::abs(static_cast<int>(static_cast<int8_t>(p[i]))));
+        return sum;
+    }
+}
+
+// ===== CRC-32 =====
+uint32_t PngCrc32(const uint8_t* data, size_t len, uint32_t crc)
+{
+    struct Table
+    {
+        uint32_t v[256];
+        Table()
+        {
+            for (uint32_t n = 0; n < 256; ++n)
+            {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : (c >> 1);
+                v[n] = c;
+            }
+        }
+    };
+    static const Table table;
+
+    uint32_t c = crc ^ 0xFFFFFFFFu;
+    for (size_t i = 0; i < len; ++i)
+        c = table.v[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// ===== 인코더 =====
+CPngStripeEncoder::CPngStripeEncoder(size_t threads, const PngEncodeOptions& opt)
+    : m_pool(threads), m_opt(opt)
+{
+}
+
+void CPngStripeEncoder::EncodeStripe(const ImageView& img, Stripe& s, bool first, bool last)
+{
+    const size_t rowBytes = static_cast<size_t>(img.width) * kBpp;
+    const size_t lineBytes = rowBytes + 1;
+
+    // 필터 (띠 첫 행도 원본 윗행을 참조 → 단일 스레드와 같은 결과)
+    std::vector<uint8_t> prev(rowBytes, 0), cur(rowBytes), best(rowBytes), trial(rowBytes);
+    if (s.firstRow > 0)
+        BgrToRgb(img.Row(s.firstRow - 1), prev.data(), img.width);
+
+    s.filtered.resize(lineBytes * s.rows);
+    for (int r = 0; r < s.rows; ++r)
+    {
+        BgrToRgb(img.Row(s.firstRow + r), cur.data(), img.width);
+        uint8_t* line = s.filtered.data() + lineBytes * r;
+
+        PngFilter type = m_opt.filter;
+        if (type == PngFilter::Adaptive)
+        {
+            uint64_t bestCost = UINT64_MAX;
+            for (int f = 0; f <= static_cast<int>(PngFilter::Paeth); ++f)
+            {
+                ApplyFilter(static_cast<PngFilter>(f), cur.data(), prev.data(), rowBytes, trial.data());
+                const uint64_t cost = FilterCost(trial.data(), rowBytes);
+                if (cost < bestCost)
+                {
+                    bestCost = cost;
+                    type = static_cast<PngFilter>(f);
+                    best.swap(trial);
+                }
+            }
+            std::memcpy(line + 1, best.data(), rowBytes);
+        }
+        else
+        {
+            ApplyFilter(type, cur.data(), prev.data(), rowBytes, line + 1);
+        }
+        line[0] = static_cast<uint8_t>(type);
+        prev.swap(cur);
+    }
+
+    // deflate 조각 (+ 첫 띠는 zlib 헤더), 청크 CRC 까지 이 스레드에서
+    s.adler = Deflate::Adler32(s.filtered.data(), s.filtered.size());
+    s.chunk.assign({ 'I', 'D', 'A', 'T' });
+    if (first)
+        s.chunk.insert(s.chunk.end(), kZlibHeader, kZlibHeader + 2);
+    Deflate::Compress(s.filtered.data(), s.filtered.size(), last, s.chunk, m_opt.deflate);
+    s.crc = PngCrc32(s.chunk.data(), s.chunk.size());
+}
+
+bool CPngStripeEncoder::Encode(const ImageView& img, std::vector<uint8_t>& out)
+{
+    if (!img.IsValid()) return false;
+
+    // ----- 띠 나누기 -----
+    int rowsPer = m_opt.stripeRows;
+    if (rowsPer <= 0)
+    {
+        const int target = static_cast<int>(m_pool.Size() * 2);
+        rowsPer = std::max(16, (img.height + target - 1) / target);
+    }
+    const size_t count = static_cast<size_t>((img.height + rowsPer - 1) / rowsPer);
+
+    m_stripes.resize(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        m_stripes[i].firstRow = static_cast<int>(i) * rowsPer;
+        m_stripes[i].rows = std::min(rowsPer, img.height - m_stripes[i].firstRow);
+    }
+
+    m_pool.ParallelFor(count, [&](size_t i) {
+        EncodeStripe(img, m_stripes[i], i == 0, i + 1 == count);
+    });
+
+    // ----- 이어 붙이기 -----
+    uint32_t adler = m_stripes[0].adler;
+    size_t total = 8 + 25 + 16 + 12;
+    for (size_t i = 1; i < count; ++i)
+        adler = Deflate::Adler32Combine(adler, m_stripes[i].adler, m_stripes[i].filtered.size());
+    for (const Stripe& s : m_stripes)
+        total += s.chunk.size() + 8;
+
+    out.clear();
+    out.reserve(total);
+    out.insert(out.end(), kPngSignature, kPngSignature + 8);
+
+    uint8_t ihdr[13] = {};
+    const uint32_t w = static_cast<uint32_t>(img.width);
+    const uint32_t h = static_cast<uint32_t>(img.height);
+    ihdr[0] = static_cast<uint8_t>(w >> 24); ihdr[1] = static_cast<uint8_t>(w >> 16);
+    ihdr[2] = static_cast<uint8_t>(w >> 8);  ihdr[3] = static_cast<uint8_t>(w);
+    ihdr[4] = static_cast<uint8_t>(h >> 24); ihdr[5] = static_cast<uint8_t>(h >> 16);
+    ihdr[6] = static_cast<uint8_t>(h >> 8);  ihdr[7] = static_cast<uint8_t>(h);
+    ihdr[8] = 8;    // bit depth
+    ihdr[9] = 2;    // truecolor
+    // [10] 압축 0, [11] 필터 0, [12] 인터레이스 0
+    WriteChunk(out, "IHDR", ihdr, sizeof(ihdr));
+
+    for (const Stripe& s : m_stripes)
+    {
+        PutU32(out, static_cast<uint32_t>(s.chunk.size() - 4));
+        out.insert(out.end(), s.chunk.begin(), s.chunk.end());
+        PutU32(out, s.crc);
+    }
+
+    // zlib 트레일러 (Adler-32, BE) 는 마지막 IDAT 로 따로
+    const uint8_t trailer[4] = {
+        static_cast<uint8_t>(adler >> 24), static_cast<uint8_t>(adler >> 16),
+        static_cast<uint8_t>(adler >> 8), static_cast<uint8_t>(adler) };
+    WriteChunk(out, "IDAT", trailer, sizeof(trailer));
+    WriteChunk(out, "IEND", nullptr, 0);
+    return true;
+}
@@ -0,0 +1,62 @@
+﻿#pragma once
+#include "Deflate.h"
+#include "ImageEncoder.h"
+#include "ThreadPool.h"
+#include <vector>
+
+// ===== PNG 필터 선택 =====
+enum class PngFilter : uint8_t
+{
+    None = 0,
+    Sub = 1,
+    Up = 2,
+    Average = 3,
+    Paeth = 4,
+    Adaptive = 5   // 행마다 5종 중 절대값 합이 가장 작은 것 (libpng 기본 휴리스틱)
+};
+
+// ===== 멀티스레드 스트라이프 PNG 인코더 =====
+// 이미지를 가로 띠(stripe)로 나눠 띠마다 별도 스레드에서 필터 + deflate 한 뒤
+// 하나의 zlib 스트림으로 이어 붙인다.
+//  - 필터는 원본(필터 전) 윗행만 참조하므로 띠 경계와 무관하게 단일 스레드 결과와 같은 필터 바이트
+//  - 띠마다 sync flush 로 바이트 정렬 → IDAT 청크 하나씩, CRC 도 띠 스레드에서 계산
+//  - zlib 트레일러 Adler-32 는 띠별 값을 Adler32Combine 으로 합성
+// 결과는 표준 PNG (8비트 truecolor, 비인터레이스). 입력 BGR8 → PNG RGB.
+struct PngEncodeOptions
+{
+    PngFilter filter = PngFilter::Adaptive;
+    int       stripeRows = 0;   // 0 이면 스레드 수 x 2 개의 띠가 되도록 자동
+    Deflate::Options deflate;
+};
+
+class CPngStripeEncoder : public IImageEncoder
+{
+public:
+    // threads: 0 이면 hardware_concurrency
+    explicit CPngStripeEncoder(size_t threads = 0, const PngEncodeOptions& opt = PngEncodeOptions());
+
+    ImageCodec Codec() const override { return ImageCodec::Png; }
+    bool Encode(const ImageView& img, std::vector<uint8_t>& out) override;
+
+    size_t Threads() const { return m_pool.Size(); }
+
+private:
+    struct Stripe
+    {
+        int firstRow = 0;
+        int rows = 0;
+        std::vector<uint8_t> filtered;   // [필터 바이트 + 행] x rows
+        std::vector<uint8_t> chunk;      // "IDAT" + deflate 조각 (CRC 계산 범위)
+        uint32_t adler = 1;
+        uint32_t crc = 0;
+    };
+
+    void EncodeStripe(const ImageView& img, Stripe& s, bool first, bool last);
+
+    CThreadPool         m_pool;
+    PngEncodeOptions    m_opt;
+    std::vector<Stripe> m_stripes;   // 프레임 간 버퍼 재사용
+};
+
+// PNG 청크 CRC-32 (ISO 3309)
+uint32_t PngCrc32(const uint8_t* data, size_t len, uint32_t crc = 0);
@@ -0,0 +1,177 @@
+﻿#include "Preprocess.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CANCLIENT_SSE2 1
+#endif
+
+// ===================== 레터박스 기하 계산 =====================
+LetterboxGeometry ComputeLetterbox(int srcW, int srcH, const RoiRect& roi, int dstSize)
+{
+    LetterboxGeometry g;
+    g.outW = dstSize;
+    g.outH = dstSize;
+
+    // ROI 클램프 (비어 있으면 전체 프레임)
+    RoiRect r = roi;
+    if (r.IsEmpty()) r = RoiRect{ 0, 0, srcW, srcH };
+    r.x = std::clamp(r.x, 0, std::max(0, srcW - 1));
+    r.y = std::clamp(r.y, 0, std::max(0, srcH - 1));
+    r.width = std::clamp(r.width, 1, srcW - r.x);
+    r.height = std::clamp(r.height, 1, srcH - r.y);
+    g.roi = r;
+
+    // 비율 유지 축소/확대
+    const double ratio = std::min(static_cast<double>(dstSize) / r.width,
+                                  static_cast<double>(dstSize) / r.height);
+    g.scaledW = std::clamp(static_cast<int>(std::lround(r.width * ratio)), 1, dstSize);
+    g.scaledH = std::clamp(static_cast<int>(std::lround(r.height * ratio)), 1, dstSize);
+
+    // 가운데 정렬 (ultralytics: round(dw - 0.1))
+    g.padX = static_cast<int>(std::lround((dstSize - g.scaledW) / 2.0 - 0.1));
+    g.padY = static_cast<int>(std::lround((dstSize - g.scaledH) / 2.0 - 0.1));
+    g.padX = std::max(0, g.padX);
+    g.padY = std::max(0, g.padY);
+    return g;
+}
+
+LetterboxGeometry IdentityGeometry(int width, int height)
+{
+    LetterboxGeometry g;
+    g.roi = RoiRect{ 0, 0, width, height };
+    g.scaledW = g.outW = width;
+    g.scaledH = g.outH = height;
+    return g;
+}
+
+// ===================== bilinear 좌표표 =====================
+namespace
+{
+    struct Tap
+    {
+        int   i0;   // 첫 번째 샘플 인덱스
+        int   i1;   // 두 번째 샘플 인덱스
+        float a;    // 두 번째 샘플 가중치
+    };
+
+    // OpenCV INTER_LINEAR 와 같은 좌표 매핑: (d + 0.5) * scale - 0.5
+    void BuildTaps(int srcLen, int dstLen, std::vector<Tap>& taps)
+    {
+        taps.resize(dstLen);
+        const double scale = static_cast<double>(srcLen) / dstLen;
+        for (int d = 0; d < dstLen; ++d)
+        {
+            double f = (d + 0.5) * scale - 0.5;
+            int i0 = static_cast<int>(std::floor(f));
+            float a = static_cast<float>(f - i0);
+            if (i0 < 0) { i0 = 0; a = 0.0f; }
+            if (i0 >= srcLen - 1) { i0 = srcLen - 1; a = 0.0f; }
+            taps[d] = Tap{ i0, std::min(i0 + 1, srcLen - 1), a };
+        }
+    }
+
+    // 가로 방향 보간 (행 1개 → float 행). 3채널 gather 라 스칼라로 처리.
+    void HorizontalPass(const uint8_t* row, const std::vector<Tap>& xt, float* out)
+    {
+        const int n = static_cast<int>(xt.size());
+        for (int x = 0; x < n; ++x)
+        {
+            const uint8_t* p0 = row + xt[x].i0 * 3;
+            const uint8_t* p1 = row + xt[x].i1 * 3;
+            const float a = xt[x].a;
+            out[0] = p0[0] + (p1[0] - p0[0]) * a;
+            out[1] = p0[1] + (p1[1] - p0[1]) * a;
+            out[2] = p0[2] + (p1[2] - p0[2]) * a;
+            out += 3;
+        }
+    }
+
+    // 세로 방향 보간 (float 행 2개 → uint8 출력 행)
+    void VerticalPass(const float* r0, const float* r1, float b, uint8_t* out, int n)
+    {
+        const float b0 = 1.0f - b;
+        int i = 0;
+#ifdef CANCLIENT_SSE2
+        const __m128 w0 = _mm_set1_ps(b0);
+        const __m128 w1 = _mm_set1_ps(b);
+        for (; i + 8 <= n; i += 8)
+        {
+            __m128 lo = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r0 + i), w0),
+                                   _mm_mul_ps(_mm_loadu_ps(r1 + i), w1));
+            __m128 hi = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(r0 + i + 4), w0),
+                                   _mm_mul_ps(_mm_loadu_ps(r1 + i + 4), w1));
+            __m128i v16 = _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(v16, v16));
+        }
+#endif
+        for (; i < n; ++i)
+        {
+            float v = r0[i] * b0 + r1[i] * b;
+            out[i] = static_cast<uint8_t>(std::clamp(static_cast<int>(std::lrint(v)), 0, 255));
+        }
+    }
+}
+
+// ===================== 크롭 + 레터박스 리사이즈 =====================
+void LetterboxResize(const ImageView& src, const LetterboxGeometry& g,
+                     ImageBuffer& dst, uint8_t padValue)
+{
+    dst.Allocate(g.outW, g.outH);
+    std::memset(dst.pixels.data(), padValue, dst.pixels.size());
+    if (!src.IsValid() || g.roi.IsEmpty()) return;
+
+    std::vector<Tap> xt, yt;
+    BuildTaps(g.roi.width, g.scaledW, xt);
+    BuildTaps(g.roi.height, g.scaledH, yt);
+
+    const int rowLen = g.scaledW * 3;
+    std::vector<float> buf0(rowLen), buf1(rowLen);
+    float* rows[2] = { buf0.data(), buf1.data() };
+    int cached[2] = { -1, -1 };   // 각 버퍼에 들어 있는 원본 행 번호
+
+    auto srcRow = [&](int y) {
+        return src.Row(g.roi.y + y) + g.roi.x * 3;
+    };
+
+    // 필요한 원본 행만 가로 보간하고 재사용 (축소 시 대부분의 행은 건너뜀)
+    // keep: 같은 출력 행에서 함께 쓰일 다른 원본 행 (그 슬롯은 덮어쓰지 않음)
+    auto fetch = [&](int sy, int keep) -> const float* {
+        for (int k = 0; k < 2; ++k)
+            if (cached[k] == sy) return rows[k];
+        int slot = (cached[0] == keep) ? 1 : 0;
+        HorizontalPass(srcRow(sy), xt, rows[slot]);
+        cached[slot] = sy;
+        return rows[slot];
+    };
+
+    for (int dy = 0; dy < g.scaledH; ++dy)
+    {
+        const Tap& t = yt[dy];
+        const float* r0 = fetch(t.i0, t.i1);
+        const float* r1 = fetch(t.i1, t.i0);
+
+        uint8_t* out = dst.Row(g.padY + dy) + g.padX * 3;
+        VerticalPass(r0, r1, t.a, out, rowLen);
+    }
+}
+
+// ===================== 좌표 역변환 =====================
+void MapPointToSource(const LetterboxGeometry& g, double& x, double& y)
+{
+    const double sx = g.scaledW > 0 ? static_cast<double>(g.roi.width) / g.scaledW : 1.0;
+    const double sy = g.scaledH > 0 ? static_cast<double>(g.roi.height) / g.scaledH : 1.0;
+    x = (x - g.padX) * sx + g.roi.x;
+    y = (y - g.padY) * sy + g.roi.y;
+}
+
+void MapBoxToSource(const LetterboxGeometry& g, double& x, double& y, double& w, double& h)
+{
+    const double sx = g.scaledW > 0 ? static_cast<double>(g.roi.width) / g.scaledW : 1.0;
+    const double sy = g.scaledH > 0 ? static_cast<double>(g.roi.height) / g.scaledH : 1.0;
+    MapPointToSource(g, x, y);
+    w *= sx;
+    h *= sy;
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include "ImageView.h"
+
+// ===== 관심 영역 (센서 픽셀 좌표) =====
+// width/height 가 0 이면 전체 프레임.
+struct RoiRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+
+    bool IsEmpty() const { return width <= 0 || height <= 0; }
+};
+
+// ===== 크롭 + 레터박스 기하 정보 =====
+// 모델 입력(outW x outH) 좌표 ↔ 원본 센서 좌표 변환에 필요한 값 전부.
+// 요청 헤더에 그대로 실려 서버로 전달된다.
+struct LetterboxGeometry
+{
+    RoiRect roi;          // 실제 잘라낸 영역 (프레임 경계로 클램프됨)
+    int scaledW = 0;      // 리사이즈된 내용 크기
+    int scaledH = 0;
+    int padX = 0;         // 좌/상 패딩
+    int padY = 0;
+    int outW = 0;         // 모델 입력 크기
+    int outH = 0;
+
+    double Scale() const { return roi.width > 0 ? static_cast<double>(scaledW) / roi.width : 1.0; }
+};
+
+// ROI 를 프레임 안으로 클램프하고 dstSize x dstSize 레터박스 배치를 계산.
+// (ultralytics LetterBox 와 같은 규칙: 비율 유지, 가운데 정렬)
+LetterboxGeometry ComputeLetterbox(int srcW, int srcH, const RoiRect& roi, int dstSize);
+
+// 전처리 없이 원본 그대로 보낼 때의 기하 정보 (좌표 변환 = 항등)
+LetterboxGeometry IdentityGeometry(int width, int height);
+
+// src 의 geom.roi 영역을 bilinear 로 리사이즈해 dst(outW x outH, BGR8)에 배치.
+// 남는 영역은 padValue(기본 114, YOLO 학습 시 패딩 색)로 채운다.
+void LetterboxResize(const ImageView& src, const LetterboxGeometry& geom,
+                     ImageBuffer& dst, uint8_t padValue = 114);
+
+// 모델 입력 좌표 → 원본 센서 좌표
+void MapPointToSource(const LetterboxGeometry& geom, double& x, double& y);
+void MapBoxToSource(const LetterboxGeometry& geom, double& x, double& y, double& w, double& h);
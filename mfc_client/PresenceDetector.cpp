@@ -0,0 +1,100 @@
+﻿#include "PresenceDetector.h"
+#include <algorithm>
+#include <cmath>
+
+void CPresenceDetector::Reset()
+{
+    m_profile.clear();
+    m_background.clear();
+    m_hasBackground = false;
+    m_armed = true;
+    m_present = false;
+    m_emptyFrames = 0;
+    m_coverage = 0.0;
+    m_centroid = 0.0;
+}
+
+// ===================== 열별 밝기 프로파일 =====================
+void CPresenceDetector::BuildProfile(const ImageView& frame)
+{
+    const int cols = std::max(1, m_cfg.columns);
+    const int step = std::max(1, m_cfg.sampleStep);
+
+    int y0 = static_cast<int>(frame.height * std::clamp(m_cfg.bandTop, 0.0, 1.0));
+    int y1 = static_cast<int>(frame.height * std::clamp(m_cfg.bandBottom, 0.0, 1.0));
+    if (y1 <= y0) { y0 = 0; y1 = frame.height; }
+
+    std::vector<uint32_t> sum(cols, 0), cnt(cols, 0);
+
+    for (int y = y0; y < y1; y += step)
+    {
+        const uint8_t* row = frame.Row(y);
+        for (int x = 0; x < frame.width; x += step)
+        {
+            const uint8_t* p = row + x * 3;
+            // BT.601 근사 (B, G, R 순서)
+            uint32_t luma = (p[0] * 29u + p[1] * 150u + p[2] * 77u) >> 8;
+            int c = static_cast<int>(static_cast<int64_t>(x) * cols / frame.width);
+            sum[c] += luma;
+            cnt[c]++;
+        }
+    }
+
+    m_profile.assign(cols, 0.0);
+    for (int c = 0; c < cols; ++c)
+        m_profile[c] = cnt[c] ? static_cast<double>(sum[c]) / cnt[c] : 0.0;
+}
+
+// ===================== 프레임 처리 =====================
+bool CPresenceDetector::Update(const ImageView& frame)
+{
+    if (!frame.IsValid()) return false;
+
+    BuildProfile(frame);
+
+    // 첫 프레임은 배경으로 사용 (빈 컨베이어 상태에서 켜야 함)
+    if (!m_hasBackground || m_background.size() != m_profile.size()) {
+        m_background = m_profile;
+        m_hasBackground = true;
+        m_present = false;
+        return false;
+    }
+
+    const int cols = static_cast<int>(m_profile.size());
+    int occupied = 0;
+    double mass = 0.0, moment = 0.0;
+
+    for (int c = 0; c < cols; ++c)
+    {
+        double d = std::fabs(m_profile[c] - m_background[c]);
+        if (d > m_cfg.diffThreshold) {
+            occupied++;
+            mass += d;
+            moment += d * (c + 0.5) / cols;
+        }
+    }
+
+    m_coverage = static_cast<double>(occupied) / cols;
+    m_centroid = (mass > 0.0) ? moment / mass : 0.0;
+    m_present = (m_coverage >= m_cfg.minCoverage);
+
+    if (!m_present)
+    {
+        // 빈 화면: 조명 변화를 따라가도록 배경 천천히 갱신
+        const double a = std::clamp(m_cfg.backgroundAlpha, 0.0, 1.0);
+        for (int c = 0; c < cols; ++c)
+            m_background[c] += a * (m_profile[c] - m_background[c]);
+
+        if (++m_emptyFrames >= m_cfg.rearmFrames)
+            m_armed = true;
+        return false;
+    }
+
+    m_emptyFrames = 0;
+
+    if (m_armed && std::fabs(m_centroid - 0.5) <= m_cfg.centreTolerance) {
+        m_armed = false; // 캔이 빠져나갈 때까지 재발사 금지
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,53 @@
+﻿#pragma once
+#include "ImageView.h"
+#include <vector>
+
+// ===== 캔 존재 감지 설정 =====
+struct PresenceConfig
+{
+    double bandTop = 0.30;          // 검사 띠 시작 (높이 비율)
+    double bandBottom = 0.70;       // 검사 띠 끝 (높이 비율)
+    int    sampleStep = 8;          // 다운샘플 간격 (센서 px, 미리보기 프레임이면 그 배율로 환산해 설정)
+    int    columns = 32;            // 가로 열(bin) 개수
+    double diffThreshold = 18.0;    // 배경 대비 밝기 차 (열 점유 판정)
+    double minCoverage = 0.15;      // 점유 열 비율 최소값 (캔 존재 판정)
+    double centreTolerance = 0.08;  // 중심 허용 오차 (폭 비율)
+    double backgroundAlpha = 0.05;  // 빈 화면일 때 배경 갱신 비율
+    int    rearmFrames = 3;         // 재무장까지 필요한 빈 프레임 수
+};
+
+// ===== 캔 존재 감지기 =====
+// 미리보기 프레임의 가운데 띠를 열 단위로 다운샘플링해 배경 프로파일과 비교한다.
+// 캔이 들어와 화면 중앙에 오면 Update()가 한 번 true 를 돌려주고,
+// 캔이 빠져나가 빈 화면이 rearmFrames 만큼 이어질 때까지 다시 발사하지 않는다.
+class CPresenceDetector
+{
+public:
+    CPresenceDetector() = default;
+    explicit CPresenceDetector(const PresenceConfig& cfg) : m_cfg(cfg) {}
+
+    void SetConfig(const PresenceConfig& cfg) { m_cfg = cfg; Reset(); }
+    const PresenceConfig& Config() const { return m_cfg; }
+
+    void Reset();
+
+    // 프레임 1장 처리. 캔이 중앙에 도착한 순간에만 true.
+    bool Update(const ImageView& frame);
+
+    bool   IsPresent() const { return m_present; }
+    double Coverage() const { return m_coverage; }   // 0~1
+    double Centroid() const { return m_centroid; }   // 0~1 (0.5 = 중앙)
+
+private:
+    void BuildProfile(const ImageView& frame);
+
+    PresenceConfig      m_cfg;
+    std::vector<double> m_profile;      // 현재 프레임 열별 평균 밝기
+    std::vector<double> m_background;   // 빈 화면 배경 프로파일
+    bool   m_hasBackground = false;
+    bool   m_armed = true;
+    bool   m_present = false;
+    int    m_emptyFrames = 0;
+    double m_coverage = 0.0;
+    double m_centroid = 0.0;
+};
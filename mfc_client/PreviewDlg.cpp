@@ -0,0 +1,116 @@
+﻿#include "pch.h"
+#include "framework.h"
+#include "CanClient.h"
+#include "PreviewDlg.h"
+#include "afxdialogex.h"
+
+#ifdef _DEBUG
+#define new DEBUG_NEW
+#endif
+
+// ===================== 메시지 맵 =====================
+BEGIN_MESSAGE_MAP(CPreviewDlg, CDialogEx)
+    ON_WM_PAINT()
+END_MESSAGE_MAP()
+
+// ===================== 생성 =====================
+CPreviewDlg::CPreviewDlg(CWnd* pParent)
+    : CDialogEx(IDD_PREVIEW_DLG, pParent)
+{
+}
+
+BOOL CPreviewDlg::CreateModeless(CWnd* pParent)
+{
+    if (!Create(IDD_PREVIEW_DLG, pParent))
+        return FALSE;
+
+    // 메인 창 오른쪽에 붙여 둠 (화면 밖이면 그대로)
+    CRect main, self;
+    pParent->GetWindowRect(&main);
+    GetWindowRect(&self);
+    if (main.right + self.Width() <= GetSystemMetrics(SM_CXVIRTUALSCREEN))
+        SetWindowPos(nullptr, main.right, main.top, 0, 0, SWP_NOSIZE | SWP_NOZORDER | SWP_NOACTIVATE);
+    return TRUE;
+}
+
+CWnd* CPreviewDlg::SlotCtrl(int slot) const
+{
+    return GetDlgItem(slot == 0 ? IDC_IMG_LEFT : IDC_IMG_RIGHT);
+}
+
+CSize CPreviewDlg::TargetSize(int slot) const
+{
+    CWnd* ctrl = GetSafeHwnd() ? SlotCtrl(slot) : nullptr;
+    if (!ctrl) return CSize(0, 0);
+    CRect rc;
+    ctrl->GetClientRect(&rc);
+    return rc.Size();
+}
+
+// ===================== 표시 =====================
+void CPreviewDlg::Present(int slot, ImageBuffer& image)
+{
+    if (slot < 0 || slot >= kSlots) return;
+    std::swap(m_images[slot], image);
+
+    if (!m_userClosed && !IsWindowVisible())
+        ShowWindow(SW_SHOWNOACTIVATE);
+    DrawSlot(slot);
+}
+
+void CPreviewDlg::Reveal()
+{
+    m_userClosed = false;
+    if (!IsWindowVisible())
+        ShowWindow(SW_SHOWNOACTIVATE);
+}
+
+void CPreviewDlg::OnCancel()
+{
+    // 모델리스: 파괴하지 않고 숨김
+    m_userClosed = true;
+    ShowWindow(SW_HIDE);
+}
+
+void CPreviewDlg::OnPaint()
+{
+    CPaintDC dc(this);
+    for (int slot = 0; slot < kSlots; ++slot) {
+        // 정적 컨트롤이 먼저 자기 영역을 칠하게 한 뒤 그 위에 그림
+        if (CWnd* ctrl = SlotCtrl(slot))
+            ctrl->UpdateWindow();
+        DrawSlot(slot);
+    }
+}
+
+// ===================== 1:1 출력 (가운데 정렬, 남는 영역 검정) =====================
+void CPreviewDlg::DrawSlot(int slot)
+{
+    CWnd* ctrl = SlotCtrl(slot);
+    const ImageBuffer& img = m_images[slot];
+    if (!ctrl || img.width <= 0 || img.height <= 0) return;
+
+    CClientDC dc(ctrl);
+    CRect rc;
+    ctrl->GetClientRect(&rc);
+
+    const int x = (rc.Width() - img.width) / 2;
+    const int y = (rc.Height() - img.height) / 2;
+
+    CBrush brush(RGB(0, 0, 0));
+    dc.FillRect(rc, &brush);
+
+    // 합성기 출력 너비는 4의 배수 → 24bpp DIB 행 정렬 그대로 사용
+    BITMAPINFO bmi = {};
+    bmi.bmiHeader.biSize = sizeof(BITMAPINFOHEADER);
+    bmi.bmiHeader.biWidth = img.width;
+    bmi.bmiHeader.biHeight = -img.height; // 상단부터
+    bmi.bmiHeader.biPlanes = 1;
+    bmi.bmiHeader.biBitCount = 24;
+    bmi.bmiHeader.biCompression = BI_RGB;
+
+    SetDIBitsToDevice(dc.GetSafeHdc(),
+        x, y, img.width, img.height,
+        0, 0, 0, img.height,
+        img.pixels.data(), &bmi, DIB_RGB_COLORS);
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include "ImageView.h"
+
+// ===== 검사 결과 오버레이 창 (IDD_PREVIEW_DLG) =====
+// 합성기(COverlayCompositor)가 미리보기 해상도로 만든 TOP/FRONT 오버레이를
+// IDC_IMG_LEFT / IDC_IMG_RIGHT 에 1:1 로 그린다 (스케일링 없음).
+// 모델리스 창. 닫기는 숨기기만 하고, 불량이 나오면 Reveal() 로 다시 띄운다.
+class CPreviewDlg : public CDialogEx
+{
+public:
+    static constexpr int kSlots = 2;   // 0 = TOP(왼쪽), 1 = FRONT(오른쪽)
+
+    explicit CPreviewDlg(CWnd* pParent = nullptr);
+
+#ifdef AFX_DESIGN_TIME
+    enum { IDD = IDD_PREVIEW_DLG };
+#endif
+
+    BOOL CreateModeless(CWnd* pParent);
+
+    // 합성 목표 크기 (표시 컨트롤 클라이언트 영역)
+    CSize TargetSize(int slot) const;
+
+    // 완성본을 보관 중인 버퍼와 맞바꾸고 다시 그림 (image 에는 이전 버퍼가 돌아감)
+    void Present(int slot, ImageBuffer& image);
+
+    // 사용자가 닫았더라도 다시 표시
+    void Reveal();
+
+protected:
+    virtual void OnCancel();
+    afx_msg void OnPaint();
+    DECLARE_MESSAGE_MAP()
+
+private:
+    CWnd* SlotCtrl(int slot) const;
+    void  DrawSlot(int slot);
+
+    ImageBuffer m_images[kSlots];
+    bool        m_userClosed = false;
+};
@@ -0,0 +1,787 @@
+﻿#include "ReplyParser.h"
+
+#include <charconv>
+#include <ctime>
+
+const char* ReplyErrorName(ReplyError e)
+{
+    switch (e)
+    {
+    case ReplyError::None:          return "none";
+    case ReplyError::Empty:         return "empty response";
+    case ReplyError::Syntax:        return "syntax error";
+    case ReplyError::NotObject:     return "not an object";
+    case ReplyError::MissingResult: return "missing 'result'";
+    case ReplyError::TypeMismatch:  return "type mismatch";
+    case ReplyError::TooDeep:       return "nesting too deep";
+    }
+    return "?";
+}
+
+// ===================== 불량 라벨 =====================
+namespace
+{
+    struct LabelEntry { std::string_view className; std::string_view name; };
+
+    const LabelEntry kLabels[DefectLabels::kCount] = {
+        { "top_dent",     "상단찌그러짐" },
+        { "top_no_tap",   "뚜껑없음" },
+        { "side_dent",    "측면찌그러짐" },
+        { "side_foreign", "스크래치" },
+        { "top_normal",   "정상(상단)" },
+        { "side_normal",  "정상(측면)" },
+    };
+}
+
+namespace DefectLabels
+{
+    const char* Name(uint8_t id)
+    {
+        return id < kCount ? kLabels[id].name.data() : "?";
+    }
+
+    const char* ClassName(uint8_t id)
+    {
+        return id < kCount ? kLabels[id].className.data() : "?";
+    }
+
+    uint8_t IdOf(std::string_view label)
+    {
+        for (uint8_t i = 0; i < kCount; ++i)
+            if (label == kLabels[i].name || label == kLabels[i].className)
+                return i;
+        return kUnknown;
+    }
+}
+
+// ===================== JSON =====================
+namespace
+{
+    // 값을 버리는 문자열 싱크 (알 수 없는 키 / 건너뛰는 값)
+    struct NullSink
+    {
+        void Append(const char*, size_t) {}
+        void AppendCodePoint(const char*, size_t) {}
+    };
+
+    // 이 스키마 키만 구분하면 되므로 짧은 고정 버퍼
+    using KeyText = FixedText<16>;
+
+    enum class Field : uint8_t { Other, Result, Reason, Timestamp, DetTop, DetSide };
+
+    Field FieldOf(const KeyText& key)
+    {
+        if (key.truncated) return Field::Other;
+        const std::string_view k = key.View();
+        if (k == "result")    return Field::Result;
+        if (k == "reason")    return Field::Reason;
+        if (k == "timestamp") return Field::Timestamp;
+        if (k == "det_top")   return Field::DetTop;
+        if (k == "det_side")  return Field::DetSide;
+        return Field::Other;
+    }
+
+    int HexValue(uint8_t c)
+    {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    size_t EncodeUtf8(uint32_t cp, char* out)
+    {
+        if (cp < 0x80) { out[0] = static_cast<char>(cp); return 1; }
+        if (cp < 0x800) {
+            out[0] = static_cast<char>(0xC0 | (cp >> 6));
+            out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 2;
+        }
+        if (cp < 0x10000) {
+            out[0] = static_cast<char>(0xE0 | (cp >> 12));
+            out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+            return 3;
+        }
+        out[0] = static_cast<char>(0xF0 | (cp >> 18));
+        out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 4;
+    }
+
+    // 값 종류 (검출 항목 형태 판정용)
+    enum class Kind : uint8_t { String, Number, Other };
+
+    class Reader
+    {
+    public:
+        Reader(const char* data, size_t size)
+            : m_p(reinterpret_cast<const uint8_t*>(data))
+            , m_end(reinterpret_cast<const uint8_t*>(data) + size) {}
+
+        ReplyError Error() const { return m_err; }
+
+        bool Fail(ReplyError e)
+        {
+            if (m_err == ReplyError::None) m_err = e;
+            return false;
+        }
+
+        void SkipBom()
+        {
+            if (m_end - m_p >= 3 && m_p[0] == 0xEF && m_p[1] == 0xBB && m_p[2] == 0xBF)
+                m_p += 3;
+        }
+
+        void SkipWs()
+        {
+            while (m_p < m_end && (*m_p == ' ' || *m_p == '\t' || *m_p == '\n' || *m_p == '\r'))
+                ++m_p;
+        }
+
+        // 공백 건너뛰고 다음 바이트 (끝이면 0)
+        uint8_t Peek()
+        {
+            SkipWs();
+            return m_p < m_end ? *m_p : 0;
+        }
+
+        bool Expect(uint8_t c)
+        {
+            if (Peek() != c) return Fail(ReplyError::Syntax);
+            ++m_p;
+            return true;
+        }
+
+        // ===== 문자열 ('"' 위치에서 시작) =====
+        template <class Sink>
+        bool String(Sink& sink)
+        {
+            ++m_p;   // 여는 따옴표
+            for (;;)
+            {
+                // ASCII 구간은 한 번에 복사
+                const uint8_t* run = m_p;
+                while (m_p < m_end && *m_p >= 0x20 && *m_p < 0x80 && *m_p != '"' && *m_p != '\\')
+                    ++m_p;
+                if (m_p != run)
+                    sink.Append(reinterpret_cast<const char*>(run), static_cast<size_t>(m_p - run));
+
+                if (m_p >= m_end) return Fail(ReplyError::Syntax);
+                const uint8_t c = *m_p;
+                if (c == '"') { ++m_p; return true; }
+                if (c < 0x20) return Fail(ReplyError::Syntax);   // 제어 문자
+                if (c == '\\') {
+                    if (!Escape(sink)) return false;
+                    continue;
+                }
+                if (!Utf8Sequence(sink)) return false;
+            }
+        }
+
+        // ===== 숫자 (JSON 문법 그대로) =====
+        // 값은 out 이 있을 때만 변환. 단, nlohmann 은 double 로 넘치는 수(1e400)를
+        // 파싱 오류로 보므로 지수부가 있거나 아주 긴 수는 항상 변환해 넘침을 확인한다.
+        bool Number(double* out)
+        {
+            const uint8_t* start = m_p;
+            if (m_p < m_end && *m_p == '-') ++m_p;
+            if (m_p >= m_end) return Fail(ReplyError::Syntax);
+            if (*m_p == '0') ++m_p;
+            else if (*m_p >= '1' && *m_p <= '9') SkipDigits();
+            else return Fail(ReplyError::Syntax);
+
+            if (m_p < m_end && *m_p == '.') {
+                ++m_p;
+                if (!SkipDigits()) return Fail(ReplyError::Syntax);
+            }
+            bool hasExp = false;
+            if (m_p < m_end && (*m_p == 'e' || *m_p == 'E')) {
+                hasExp = true;
+                ++m_p;
+                if (m_p < m_end && (*m_p == '+' || *m_p == '-')) ++m_p;
+                if (!SkipDigits()) return Fail(ReplyError::Syntax);
+            }
+
+            if (!out && !hasExp && m_p - start < 300)
+                return true;
+
+            double v = 0.0;
+            const auto r = std::from_chars(reinterpret_cast<const char*>(start),
+                                           reinterpret_cast<const char*>(m_p), v);
+            if (r.ec == std::errc::result_out_of_range) {
+                if (Overflows(start, m_p)) return Fail(ReplyError::Syntax);
+                v = *start == '-' ? -0.0 : 0.0;   // 언더플로 → 0 (strtod 와 동일)
+            }
+            if (out) *out = v;
+            return true;
+        }
+
+        // ===== 임의 값 건너뛰기 (문법 검사 포함) =====
+        bool SkipValue(int depth, Kind* kind = nullptr, double* number = nullptr)
+        {
+            if (kind) *kind = Kind::Other;
+            switch (Peek())
+            {
+            case '"': {
+                NullSink sink;
+                if (kind) *kind = Kind::String;
+                return String(sink);
+            }
+            case '{': return Container(depth, '}');
+            case '[': return Container(depth, ']');
+            case 't': return Literal("true", 4);
+            case 'f': return Literal("false", 5);
+            case 'n': return Literal("null", 4);
+            default:
+                if (kind) *kind = Kind::Number;
+                return Number(number);
+            }
+        }
+
+        // ===== 객체 키 (다음 ':' 까지 소비) =====
+        bool Key(KeyText& key)
+        {
+            if (Peek() != '"') return Fail(ReplyError::Syntax);
+            key.Clear();
+            if (!String(key)) return false;
+            return Expect(':');
+        }
+
+        // ===== det_top / det_side =====
+        // [[label, score, ...], ...] — 형태가 맞는 항목만 채택. 배열이 아니면 없는 것으로.
+        bool Detections(DetectionList& list, int depth)
+        {
+            list.Clear();
+            if (Peek() != '[')
+                return SkipValue(depth);
+            if (depth + 1 > ReplyParser::kMaxDepth) return Fail(ReplyError::TooDeep);
+            list.present = true;
+            ++m_p;
+            if (Peek() == ']') { ++m_p; return true; }
+            for (;;)
+            {
+                if (!DetectionItem(list, depth + 1)) return false;
+                const uint8_t c = Peek();
+                ++m_p;
+                if (c == ']') return true;
+                if (c != ',') return Fail(ReplyError::Syntax);
+            }
+        }
+
+    private:
+        bool SkipDigits()
+        {
+            const uint8_t* start = m_p;
+            while (m_p < m_end && *m_p >= '0' && *m_p <= '9') ++m_p;
+            return m_p != start;
+        }
+
+        // from_chars 범위 초과가 넘침(±inf)인지 언더플로인지: 10진 지수로 판정
+        static bool Overflows(const uint8_t* p, const uint8_t* end)
+        {
+            if (*p == '-') ++p;
+            long exp10 = 0;
+            if (*p != '0') {
+                const uint8_t* q = p;
+                while (q < end && *q >= '0' && *q <= '9') ++q;
+                exp10 = static_cast<long>(q - p) - 1;
+                p = q;
+            }
+            else {
+                ++p;
+                if (p < end && *p == '.') {
+                    ++p;
+                    long zeros = 0;
+                    while (p < end && *p == '0') { ++p; ++zeros; }
+                    exp10 = -(zeros + 1);
+                }
+            }
+            while (p < end && *p != 'e' && *p != 'E') ++p;
+            if (p < end) {
+                ++p;
+                bool neg = false;
+                if (*p == '+' || *p == '-') neg = *p++ == '-';
+                long e = 0;
+                while (p < end && e < 100000) e = e * 10 + (*p++ - '0');
+                exp10 += neg ? -e : e;
+            }
+            return exp10 > 0;
+        }
+
+        bool Literal(const char* word, size_t n)
+        {
+            if (static_cast<size_t>(m_end - m_p) < n || std::memcmp(m_p, word, n) != 0)
+                return Fail(ReplyError::Syntax);
+            m_p += n;
+            return true;
+        }
+
+        bool Container(int depth, uint8_t close)
+        {
+            if (depth + 1 > ReplyParser::kMaxDepth) return Fail(ReplyError::TooDeep);
+            ++m_p;
+            if (Peek() == close) { ++m_p; return true; }
+            for (;;)
+            {
+                if (close == '}') {
+                    if (Peek() != '"') return Fail(ReplyError::Syntax);
+                    NullSink sink;
+                    if (!String(sink) || !Expect(':')) return false;
+                }
+                if (!SkipValue(depth + 1)) return false;
+                const uint8_t c = Peek();
+                ++m_p;
+                if (c == close) return true;
+                if (c != ',') return Fail(ReplyError::Syntax);
+            }
+        }
+
+        // 항목 1개. 채택 조건: 배열, 원소 2개 이상, [0] 문자열, [1] 숫자.
+        bool DetectionItem(DetectionList& list, int depth)
+        {
+            if (Peek() != '[')
+                return SkipValue(depth);
+            if (depth + 1 > ReplyParser::kMaxDepth) return Fail(ReplyError::TooDeep);
+            ++m_p;
+
+            // 용량이 차면 임시 슬롯에 파싱만 하고 버림
+            Detection spare;
+            Detection& d = list.count < DetectionList::kCapacity ? list.items[list.count] : spare;
+            d.label.Clear();
+            d.score = 0.0f;
+
+            bool labelOk = false, scoreOk = false;
+            double box[4] = {};
+            unsigned boxMask = 0;   // 2~5번 원소 중 숫자였던 것
+            int index = 0;
+            if (Peek() == ']') { ++m_p; return true; }
+            for (;; ++index)
+            {
+                if (index == 0 && Peek() == '"') {
+                    if (!String(d.label)) return false;
+                    labelOk = true;
+                }
+                else if (index == 1) {
+                    Kind kind;
+                    double v = 0.0;
+                    if (!SkipValue(depth + 1, &kind, &v)) return false;
+                    if (kind == Kind::Number) { d.score = static_cast<float>(v); scoreOk = true; }
+                }
+                else if (index >= 2 && index <= 5) {
+                    Kind kind;
+                    if (!SkipValue(depth + 1, &kind, &box[index - 2])) return false;
+                    if (kind == Kind::Number) boxMask |= 1u << (index - 2);
+                }
+                else if (!SkipValue(depth + 1)) {
+                    return false;
+                }
+                const uint8_t c = Peek();
+                ++m_p;
+                if (c == ']') break;
+                if (c != ',') return Fail(ReplyError::Syntax);
+            }
+
+            if (labelOk && scoreOk) {
+                d.labelId = d.label.truncated ? DefectLabels::kUnknown : DefectLabels::IdOf(d.label.View());
+                // 박스는 네 값이 모두 숫자일 때만 (전송 이미지 좌표, u16 범위로 자름)
+                if (boxMask == 0xF) {
+                    d.x = BoxCoord(box[0]); d.y = BoxCoord(box[1]);
+                    d.w = BoxCoord(box[2]); d.h = BoxCoord(box[3]);
+                }
+                else {
+                    d.x = d.y = d.w = d.h = 0;
+                }
+                if (&d == &spare) ++list.dropped;
+                else ++list.count;
+            }
+            return true;
+        }
+
+        static uint16_t BoxCoord(double v)
+        {
+            if (!(v > 0.0)) return 0;
+            if (v >= 65535.0) return 65535;
+            return static_cast<uint16_t>(v);
+        }
+
+        template <class Sink>
+        bool Escape(Sink& sink)
+        {
+            if (m_end - m_p < 2) return Fail(ReplyError::Syntax);
+            const uint8_t e = m_p[1];
+            m_p += 2;
+            char ch;
+            switch (e)
+            {
+            case '"':  ch = '"';  break;
+            case '\\': ch = '\\'; break;
+            case '/':  ch = '/';  break;
+            case 'b':  ch = '\b'; break;
+            case 'f':  ch = '\f'; break;
+            case 'n':  ch = '\n'; break;
+            case 'r':  ch = '\r'; break;
+            case 't':  ch = '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!Hex4(cp)) return false;
+                if (cp >= 0xDC00 && cp <= 0xDFFF) return Fail(ReplyError::Syntax);   // 짝 없는 하위 서로게이트
+                if (cp >= 0xD800 && cp <= 0xDBFF) {
+                    uint32_t low;
+                    if (m_end - m_p < 2 || m_p[0] != '\\' || m_p[1] != 'u') return Fail(ReplyError::Syntax);
+                    m_p += 2;
+                    if (!Hex4(low)) return false;
+                    if (low < 0xDC00 || low > 0xDFFF) return Fail(ReplyError::Syntax);
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                }
+                char buf[4];
+                const size_t n = EncodeUtf8(cp, buf);
+                if (n == 1) sink.Append(buf, 1);
+                else sink.AppendCodePoint(buf, n);
+                return true;
+            }
+            default:
+                return Fail(ReplyError::Syntax);
+            }
+            sink.Append(&ch, 1);
+            return true;
+        }
+
+        bool Hex4(uint32_t& cp)
+        {
+            if (m_end - m_p < 4) return Fail(ReplyError::Syntax);
+            cp = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int h = HexValue(m_p[i]);
+                if (h < 0) return Fail(ReplyError::Syntax);
+                cp = (cp << 4) | static_cast<uint32_t>(h);
+            }
+            m_p += 4;
+            return true;
+        }
+
+        // RFC 3629 (겹친 인코딩 / 서로게이트 / U+10FFFF 초과 거부)
+        template <class Sink>
+        bool Utf8Sequence(Sink& sink)
+        {
+            const uint8_t c = *m_p;
+            size_t n;
+            uint8_t lo = 0x80, hi = 0xBF;   // 두 번째 바이트 범위
+            if (c >= 0xC2 && c <= 0xDF)      n = 2;
+            else if (c == 0xE0)              { n = 3; lo = 0xA0; }
+            else if (c >= 0xE1 && c <= 0xEC) n = 3;
+            else if (c == 0xED)              { n = 3; hi = 0x9F; }
+            else if (c >= 0xEE && c <= 0xEF) n = 3;
+            else if (c == 0xF0)              { n = 4; lo = 0x90; }
+            else if (c >= 0xF1 && c <= 0xF3) n = 4;
+            else if (c == 0xF4)              { n = 4; hi = 0x8F; }
+            else return Fail(ReplyError::Syntax);
+
+            if (static_cast<size_t>(m_end - m_p) < n) return Fail(ReplyError::Syntax);
+            if (m_p[1] < lo || m_p[1] > hi) return Fail(ReplyError::Syntax);
+            for (size_t i = 2; i < n; ++i)
+                if (m_p[i] < 0x80 || m_p[i] > 0xBF) return Fail(ReplyError::Syntax);
+
+            sink.AppendCodePoint(reinterpret_cast<const char*>(m_p), n);
+            m_p += n;
+            return true;
+        }
+
+        const uint8_t* m_p;
+        const uint8_t* m_end;
+        ReplyError     m_err = ReplyError::None;
+    };
+
+    // 중복 키 처리용 상태: 마지막 값 기준으로 판정
+    enum class Slot : uint8_t { Absent, String, Wrong };
+
+    template <size_t N>
+    bool ReadText(Reader& r, FixedText<N>& text, Slot& slot)
+    {
+        if (r.Peek() == '"') {
+            text.Clear();
+            slot = Slot::String;
+            return r.String(text);
+        }
+        slot = Slot::Wrong;
+        return r.SkipValue(1);
+    }
+}
+
+bool ParseInspectionReply(const char* data, size_t size, InspectionReply& out, ReplyError* error)
+{
+    out.Clear();
+    auto fail = [&](ReplyError e) {
+        if (error) *error = e;
+        return false;
+    };
+    if (size == 0)
+        return fail(ReplyError::Empty);
+    if (BinaryReply::ExpectedSize(reinterpret_cast<const uint8_t*>(data), size))
+        return BinaryReply::Decode(reinterpret_cast<const uint8_t*>(data), size, out, error);
+
+    Reader r(data, size);
+    r.SkipBom();
+
+    Slot result = Slot::Absent, reason = Slot::Absent, timestamp = Slot::Absent;
+    bool ok = true;
+    bool object = r.Peek() == '{';
+
+    if (!object) {
+        ok = r.SkipValue(0);
+    }
+    else {
+        r.Expect('{');
+        if (r.Peek() == '}') {
+            r.Expect('}');
+        }
+        else {
+            KeyText key;
+            for (;;)
+            {
+                if (!(ok = r.Key(key))) break;
+                switch (FieldOf(key))
+                {
+                case Field::Result:    ok = ReadText(r, out.result, result); break;
+                case Field::Reason:    ok = ReadText(r, out.reason, reason); break;
+                case Field::Timestamp: ok = ReadText(r, out.timestamp, timestamp); break;
+                case Field::DetTop:    ok = r.Detections(out.top, 1); break;
+                case Field::DetSide:   ok = r.Detections(out.side, 1); break;
+                case Field::Other:     ok = r.SkipValue(1); break;
+                }
+                if (!ok) break;
+                const uint8_t c = r.Peek();
+                if (c == '}') { r.Expect('}'); break; }
+                if (!(ok = r.Expect(','))) break;
+            }
+        }
+    }
+
+    // 뒤에 공백 외 내용이 있으면 문법 오류. nlohmann 과 같이 NUL 바이트는 입력 끝으로 본다.
+    if (ok && r.Peek() != 0) {
+        r.Fail(ReplyError::Syntax);
+        ok = false;
+    }
+    if (!ok)
+        return fail(r.Error());
+
+    if (!object)                  return fail(ReplyError::NotObject);
+    if (result == Slot::Absent)   return fail(ReplyError::MissingResult);
+    if (result == Slot::Wrong || reason == Slot::Wrong || timestamp == Slot::Wrong)
+        return fail(ReplyError::TypeMismatch);
+
+    if (error) *error = ReplyError::None;
+    return true;
+}
+
+// ===================== 바이너리 응답 =====================
+namespace
+{
+    uint16_t GetU16(const uint8_t* p) { return static_cast<uint16_t>((p[0] << 8) | p[1]); }
+
+    uint32_t GetU32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    void PutU16(uint8_t* p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 8);
+        p[1] = static_cast<uint8_t>(v);
+    }
+
+    void PutU32(uint8_t* p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    template <size_t N>
+    void AppendText(FixedText<N>& t, const char* s)
+    {
+        t.Append(s, std::strlen(s));
+    }
+
+    const char* ResultText(BinaryReply::Verdict v)
+    {
+        switch (v)
+        {
+        case BinaryReply::Verdict::Normal: return "정상";
+        case BinaryReply::Verdict::Defect: return "불량";
+        default:                           return "에러";
+        }
+    }
+
+    const char* FixedReason(BinaryReply::ReasonCode code)
+    {
+        switch (code)
+        {
+        case BinaryReply::ReasonCode::BadImage:      return "bad image";
+        case BinaryReply::ReasonCode::NoAiReply:     return "AI응답없음";
+        case BinaryReply::ReasonCode::NoCan:         return "캔인식실패";
+        case BinaryReply::ReasonCode::AiParseFailed: return "AI응답파싱실패";
+        case BinaryReply::ReasonCode::NoTop:         return "TOP없음";
+        case BinaryReply::ReasonCode::BadRole:       return "역할오류";
+        default:                                     return nullptr;
+        }
+    }
+
+    // 서버 BuildCombinedReason 과 같은 형식: 비정상이면 첫 검출 라벨을 괄호로
+    void AppendViewReason(FixedText<256>& reason, BinaryReply::ViewVerdict v, const DetectionList& list)
+    {
+        if (v == BinaryReply::ViewVerdict::Normal) {
+            AppendText(reason, "정상");
+        }
+        else if (v == BinaryReply::ViewVerdict::Abnormal) {
+            AppendText(reason, "비정상(");
+            if (list.count > 0) reason.Append(list.items[0].label.data, list.items[0].label.size);
+            else AppendText(reason, "불량");
+            AppendText(reason, ")");
+        }
+        else if (v == BinaryReply::ViewVerdict::Error) {
+            AppendText(reason, "에러");
+        }
+    }
+
+    // Unix ms → "yyyy-MM-dd HH:mm:ss" (로컬 시각, 서버 JSON 응답과 같은 형식)
+    void FormatTimestamp(uint64_t ms, FixedText<32>& out)
+    {
+        const std::time_t t = static_cast<std::time_t>(ms / 1000);
+        std::tm tm{};
+#ifdef _WIN32
+        if (localtime_s(&tm, &t) != 0) return;
+#else
+        if (!localtime_r(&t, &tm)) return;
+#endif
+        char buf[32];
+        const size_t n = std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        out.Append(buf, n);
+    }
+
+    bool ReadDetections(const uint8_t*& p, uint8_t count, DetectionList& list)
+    {
+        list.Clear();
+        list.present = true;
+        for (uint8_t i = 0; i < count; ++i, p += BinaryReply::kDetectionSize)
+        {
+            if (list.count >= DetectionList::kCapacity) { ++list.dropped; continue; }
+            Detection& d = list.items[list.count++];
+            d.labelId = p[0];
+            d.label.Clear();
+            AppendText(d.label, DefectLabels::Name(d.labelId));
+            d.score = GetU16(p + 2) / 10000.0f;
+            d.x = GetU16(p + 4);
+            d.y = GetU16(p + 6);
+            d.w = GetU16(p + 8);
+            d.h = GetU16(p + 10);
+        }
+        return true;
+    }
+
+    uint8_t* WriteDetections(uint8_t* p, const DetectionList& list)
+    {
+        for (const Detection& d : list) {
+            const float score = d.score < 0.0f ? 0.0f : (d.score > 6.5535f ? 6.5535f : d.score);
+            p[0] = d.labelId;
+            p[1] = 0;
+            PutU16(p + 2, static_cast<uint32_t>(score * 10000.0f + 0.5f));
+            PutU16(p + 4, d.x);
+            PutU16(p + 6, d.y);
+            PutU16(p + 8, d.w);
+            PutU16(p + 10, d.h);
+            p += BinaryReply::kDetectionSize;
+        }
+        return p;
+    }
+}
+
+namespace BinaryReply
+{
+    size_t ExpectedSize(const uint8_t* data, size_t size)
+    {
+        if (!data || size < 8 || GetU32(data) != kMagic) return 0;
+        return GetU16(data + 6);
+    }
+
+    bool IsTopAck(const uint8_t* data, size_t size)
+    {
+        return ExpectedSize(data, size) && data[5] == static_cast<uint8_t>(Kind::TopAck);
+    }
+
+    bool Decode(const uint8_t* p, size_t size, InspectionReply& out, ReplyError* error)
+    {
+        out.Clear();
+        auto fail = [&](ReplyError e) {
+            if (error) *error = e;
+            return false;
+        };
+
+        // ===== 경계 검사: 헤더 → 크기 필드 → 검출 개수 =====
+        if (size < kHeaderSize || GetU32(p) != kMagic || p[4] != kVersion)
+            return fail(ReplyError::Syntax);
+        const size_t declared = GetU16(p + 6);
+        const uint8_t topCount = p[28], sideCount = p[29];
+        if (declared > size || declared != kHeaderSize + (topCount + sideCount) * kDetectionSize)
+            return fail(ReplyError::Syntax);
+        if (p[5] == static_cast<uint8_t>(Kind::TopAck))
+            return fail(ReplyError::MissingResult);
+        if (p[5] != static_cast<uint8_t>(Kind::Verdict) || p[8] > 2 || p[9] > 3 || p[10] > 3)
+            return fail(ReplyError::Syntax);
+
+        const Verdict result = static_cast<Verdict>(p[8]);
+        const ViewVerdict topResult = static_cast<ViewVerdict>(p[9]);
+        const ViewVerdict sideResult = static_cast<ViewVerdict>(p[10]);
+        const ReasonCode reason = static_cast<ReasonCode>(p[11]);
+
+        out.binary = true;
+        out.serverUs = GetU32(p + 12);
+        out.aiUs = GetU32(p + 16);
+        const uint64_t timestampMs = (uint64_t(GetU32(p + 20)) << 32) | GetU32(p + 24);
+
+        const uint8_t* d = p + kHeaderSize;
+        ReadDetections(d, topCount, out.top);
+        ReadDetections(d, sideCount, out.side);
+
+        // ===== JSON 응답과 같은 문자열 =====
+        AppendText(out.result, ResultText(result));
+        if (const char* fixed = FixedReason(reason)) {
+            AppendText(out.reason, fixed);
+        }
+        else {
+            AppendText(out.reason, "TOP: ");
+            AppendViewReason(out.reason, topResult, out.top);
+            AppendText(out.reason, " · SIDE: ");
+            AppendViewReason(out.reason, sideResult, out.side);
+        }
+        if (timestampMs)
+            FormatTimestamp(timestampMs, out.timestamp);
+
+        if (error) *error = ReplyError::None;
+        return true;
+    }
+
+    size_t Serialize(const Fields& f, const DetectionList& top, const DetectionList& side, uint8_t* out)
+    {
+        const size_t size = kHeaderSize + (top.count + side.count) * kDetectionSize;
+        PutU32(out + 0, kMagic);
+        out[4] = kVersion;
+        out[5] = static_cast<uint8_t>(f.kind);
+        PutU16(out + 6, static_cast<uint32_t>(size));
+        out[8] = static_cast<uint8_t>(f.result);
+        out[9] = static_cast<uint8_t>(f.topResult);
+        out[10] = static_cast<uint8_t>(f.sideResult);
+        out[11] = static_cast<uint8_t>(f.reason);
+        PutU32(out + 12, f.serverUs);
+        PutU32(out + 16, f.aiUs);
+        PutU32(out + 20, static_cast<uint32_t>(f.timestampMs >> 32));
+        PutU32(out + 24, static_cast<uint32_t>(f.timestampMs));
+        out[28] = top.count;
+        out[29] = side.count;
+        out[30] = out[31] = 0;
+        WriteDetections(WriteDetections(out + kHeaderSize, top), side);
+        return size;
+    }
+}
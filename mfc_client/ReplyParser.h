@@ -0,0 +1,199 @@
+﻿#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+// ===== 검사 서버 응답 전용 파서 =====
+// {"result","reason","timestamp", "det_top"/"det_side"} 스키마만 아는 단일 패스 파서.
+// DOM 을 만들지 않고 고정 크기 InspectionReply 에 바로 기록 → 힙 할당 0.
+// 문법/UTF-8/이스케이프 검사는 nlohmann::json::parse 와 같은 기준
+// (tools/reply_parser_bench.cpp 가 퍼징으로 동등성 확인).
+// 요청 헤더로 바이너리 응답을 요청했으면 'CNRP' 응답을 같은 구조체로 읽는다 (BinaryReply).
+
+// 고정 용량 UTF-8 문자열. 넘치면 코드포인트 경계에서 자르고 truncated 표시.
+template <size_t N>
+struct FixedText
+{
+    static constexpr size_t kCapacity = N - 1;
+
+    char     data[N];
+    uint16_t size = 0;
+    bool     truncated = false;
+
+    FixedText() { data[0] = '\0'; }
+
+    void Clear() { size = 0; truncated = false; data[0] = '\0'; }
+
+    // ASCII 구간: 들어가는 만큼 복사
+    void Append(const char* s, size_t n)
+    {
+        if (truncated) return;
+        const size_t room = kCapacity - size;
+        if (n > room) { n = room; truncated = true; }
+        std::memcpy(data + size, s, n);
+        size = static_cast<uint16_t>(size + n);
+        data[size] = '\0';
+    }
+
+    // 멀티바이트 코드포인트: 전부 들어가거나 하나도 안 들어감
+    void AppendCodePoint(const char* s, size_t n)
+    {
+        if (truncated) return;
+        if (n > kCapacity - size) { truncated = true; return; }
+        Append(s, n);
+    }
+
+    const char*      c_str() const { return data; }
+    std::string_view View() const { return std::string_view(data, size); }
+    std::string      Str() const { return std::string(data, size); }
+    bool             Empty() const { return size == 0; }
+
+    bool operator==(std::string_view s) const { return View() == s; }
+    bool operator!=(std::string_view s) const { return View() != s; }
+};
+
+// ===== 불량 라벨 (datasets/can_defect/data.yaml 클래스 순서) =====
+// 바이너리 응답은 라벨을 ID 로 보낸다. 이름은 AI 서버 LABEL_MAP 의 표시 이름.
+namespace DefectLabels
+{
+    constexpr uint8_t kCount = 6;
+    constexpr uint8_t kUnknown = 0xFF;
+
+    const char* Name(uint8_t id);              // 표시 이름 ("상단찌그러짐" ...), 모르면 "?"
+    const char* ClassName(uint8_t id);         // 클래스 이름 (ASCII, "top_dent" ...), 모르면 "?"
+    uint8_t     IdOf(std::string_view label);  // 표시 이름 또는 클래스 이름(top_dent ...) → ID
+    inline bool IsDefect(uint8_t id) { return id < 4; }   // top_dent ~ side_foreign
+}
+
+// ===== 검출 1개 ([label, score, x, y, w, h]) =====
+struct Detection
+{
+    FixedText<32> label;
+    float         score = 0.0f;
+    uint8_t       labelId = DefectLabels::kUnknown;
+    uint16_t      x = 0, y = 0, w = 0, h = 0;   // 전송 이미지 좌표 (없으면 0)
+
+    bool HasBox() const { return w > 0 && h > 0; }
+};
+
+// 뷰 하나의 검출 목록 (고정 용량, 넘치면 dropped 만 증가)
+struct DetectionList
+{
+    static constexpr size_t kCapacity = 16;
+
+    Detection items[kCapacity];
+    uint8_t   count = 0;
+    uint16_t  dropped = 0;
+    bool      present = false;   // 응답에 배열이 있었는지
+
+    void Clear() { count = 0; dropped = 0; present = false; }
+    const Detection* begin() const { return items; }
+    const Detection* end() const { return items + count; }
+};
+
+// ===== 서버 응답 =====
+struct InspectionReply
+{
+    FixedText<16>  result;      // "정상" / "불량" / "에러"
+    FixedText<256> reason;      // 불량 종류 (없으면 빈 문자열)
+    FixedText<32>  timestamp;   // 서버 시각 (없으면 빈 문자열)
+    DetectionList  top;         // det_top  (AI 서버가 넘겨줄 때만)
+    DetectionList  side;        // det_side
+
+    // 바이너리 응답에만 있는 서버 측 시간 (JSON 이면 0)
+    bool           binary = false;
+    uint32_t       serverUs = 0;   // 서버: 본문 수신 완료 → 회신
+    uint32_t       aiUs = 0;       // 서버: AI 호출 왕복
+
+    void Clear()
+    {
+        result.Clear(); reason.Clear(); timestamp.Clear();
+        top.Clear(); side.Clear();
+        binary = false; serverUs = aiUs = 0;
+    }
+};
+
+enum class ReplyError : uint8_t
+{
+    None,
+    Empty,           // 빈 응답
+    Syntax,          // JSON 문법 / UTF-8 / 이스케이프 오류
+    NotObject,       // 최상위가 객체가 아님
+    MissingResult,   // result 없음
+    TypeMismatch,    // result/reason/timestamp 가 문자열이 아님
+    TooDeep,         // 중첩 깊이 초과 (kMaxDepth)
+};
+
+const char* ReplyErrorName(ReplyError e);
+
+namespace ReplyParser
+{
+    constexpr int kMaxDepth = 64;
+}
+
+// 단일 패스 파싱. 중복 키는 nlohmann 과 같이 마지막 값이 이김.
+// 알 수 없는 키(ok, top_fp ...)는 문법 검사만 하고 건너뜀.
+// 검출 항목은 [문자열, 숫자, ...] 형태만 채택 (형태가 다르면 건너뜀).
+// 2~5번 원소가 모두 숫자면 박스 x, y, w, h (0~65535 로 자르고 소수점 버림), 그 뒤 원소는 무시.
+// 'CNRP' 로 시작하면 바이너리 응답으로 읽는다 (BinaryReply::Decode).
+bool ParseInspectionReply(const char* data, size_t size, InspectionReply& out, ReplyError* error = nullptr);
+
+// ===== 바이너리 응답 'CNRP' v1 =====
+// 요청 헤더 replyFormat = Binary 일 때 서버가 JSON 대신 보낸다. 다중 바이트 필드는 Big-Endian.
+//
+//  off  size  field
+//   0    4    magic 'CNRP'
+//   4    1    version (=1)
+//   5    1    kind          (Kind: 0 = 판정, 1 = TOP 저장 응답)
+//   6    2    size          (매직 포함 전체 바이트 수)
+//   8    1    result        (Verdict: 0 정상, 1 불량, 2 에러)
+//   9    1    topResult     (ViewVerdict: 0 정상, 1 비정상, 2 없음, 3 에러)
+//  10    1    sideResult
+//  11    1    reasonCode    (ReasonCode: 0 = TOP/SIDE 결과로 사유 조립, 그 외 고정 사유)
+//  12    4    serverUs      (본문 수신 완료 → 회신)
+//  16    4    aiUs          (AI 호출 왕복)
+//  20    8    timestamp     (서버 시각, Unix ms)
+//  28    1    topCount
+//  29    1    sideCount
+//  30    2    reserved
+//  32   12*N  검출 (TOP 다음 SIDE): labelId u8, reserved u8, score u16 (x10000),
+//             x, y, w, h u16 (전송 이미지 좌표, 없으면 0)
+namespace BinaryReply
+{
+    constexpr uint32_t kMagic = 0x434E5250;   // 'CNRP'
+    constexpr uint8_t  kVersion = 1;
+    constexpr size_t   kHeaderSize = 32;
+    constexpr size_t   kDetectionSize = 12;
+    constexpr size_t   kMaxSize = kHeaderSize + 2 * 255 * kDetectionSize;
+
+    enum class Kind : uint8_t { Verdict = 0, TopAck = 1 };
+    enum class Verdict : uint8_t { Normal = 0, Defect = 1, Error = 2 };
+    enum class ViewVerdict : uint8_t { Normal = 0, Abnormal = 1, None = 2, Error = 3 };
+    enum class ReasonCode : uint8_t { Combined = 0, BadImage = 1, NoAiReply = 2, NoCan = 3, AiParseFailed = 4, NoTop = 5, BadRole = 6 };
+
+    // 매직으로 시작하면 헤더의 크기 필드, 아니면 0 (수신 루프용)
+    size_t ExpectedSize(const uint8_t* data, size_t size);
+
+    // TOP 저장 응답인지
+    bool IsTopAck(const uint8_t* data, size_t size);
+
+    // 경계 검사 후 InspectionReply 로. reason/timestamp 는 JSON 응답과 같은 문자열로 조립.
+    // 판정이 아니면(TOP 저장 응답) MissingResult — JSON {"ok":true} 와 같은 취급.
+    bool Decode(const uint8_t* data, size_t size, InspectionReply& out, ReplyError* error = nullptr);
+
+    // 판정 응답 직렬화 (대체 서버 / 시험용). out 은 kMaxSize 이상. 쓴 바이트 수.
+    struct Fields
+    {
+        Kind        kind = Kind::Verdict;
+        Verdict     result = Verdict::Error;
+        ViewVerdict topResult = ViewVerdict::None;
+        ViewVerdict sideResult = ViewVerdict::None;
+        ReasonCode  reason = ReasonCode::Combined;
+        uint32_t    serverUs = 0;
+        uint32_t    aiUs = 0;
+        uint64_t    timestampMs = 0;
+    };
+    size_t Serialize(const Fields& f, const DetectionList& top, const DetectionList& side, uint8_t* out);
+}
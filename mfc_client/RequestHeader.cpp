@@ -0,0 +1,132 @@
+﻿#include "RequestHeader.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    void PutU16(uint8_t* p, int v)
+    {
+        const uint16_t u = static_cast<uint16_t>(std::clamp(v, 0, 0xFFFF));
+        p[0] = static_cast<uint8_t>(u >> 8);
+        p[1] = static_cast<uint8_t>(u);
+    }
+
+    void PutU32(uint8_t* p, uint32_t v)
+    {
+        p[0] = static_cast<uint8_t>(v >> 24);
+        p[1] = static_cast<uint8_t>(v >> 16);
+        p[2] = static_cast<uint8_t>(v >> 8);
+        p[3] = static_cast<uint8_t>(v);
+    }
+
+    void PutU64(uint8_t* p, uint64_t v)
+    {
+        PutU32(p, static_cast<uint32_t>(v >> 32));
+        PutU32(p + 4, static_cast<uint32_t>(v));
+    }
+
+    int GetU16(const uint8_t* p) { return (p[0] << 8) | p[1]; }
+
+    uint32_t GetU32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    uint64_t GetU64(const uint8_t* p) { return (uint64_t(GetU32(p)) << 32) | GetU32(p + 4); }
+}
+
+namespace RequestHeader
+{
+    void Fields::SetProductId(const char* id)
+    {
+        productId.fill('\0');
+        if (id)
+            for (size_t i = 0; i < kProductIdSize && id[i]; ++i)
+                productId[i] = id[i];
+    }
+
+    UnitId UnitOf(const Fields& f)
+    {
+        UnitId id;
+        if (!f.hasRole)
+            return id;
+        id.valid = true;
+        id.productId = f.productId;
+        id.sequence = f.sequence;
+        id.startsUnit = f.role == CameraRole::Top;
+        return id;
+    }
+
+    void Serialize(const Fields& f, Buffer& out)
+    {
+        uint8_t* p = out.data();
+        const LetterboxGeometry& g = f.geometry;
+
+        PutU32(p + 0, kMagic);
+        p[4] = kVersion;
+        p[5] = f.flags;
+        PutU16(p + 6, static_cast<int>(kSize));
+        PutU16(p + 8, g.roi.x);
+        PutU16(p + 10, g.roi.y);
+        PutU16(p + 12, g.roi.width);
+        PutU16(p + 14, g.roi.height);
+        PutU16(p + 16, g.scaledW);
+        PutU16(p + 18, g.scaledH);
+        PutU16(p + 20, g.padX);
+        PutU16(p + 22, g.padY);
+        PutU16(p + 24, g.outW);
+        PutU16(p + 26, g.outH);
+        p[28] = static_cast<uint8_t>(f.replyFormat);
+        p[29] = f.hasRole ? static_cast<uint8_t>(f.role) : kNoRole;
+        p[30] = f.pixelFormat;
+        p[31] = static_cast<uint8_t>(f.codec);
+        PutU64(p + 32, f.sequence);
+        PutU64(p + 40, static_cast<uint64_t>(f.captureUs));
+        PutU64(p + 48, f.cameraTicks);
+        PutU32(p + 56, f.frameCounter);
+        std::memcpy(p + 60, f.productId.data(), kProductIdSize);   // NUL 채움 그대로
+        PutU32(p + 76, 0);
+    }
+
+    bool Parse(const uint8_t* p, size_t len, Fields& out)
+    {
+        if (!p || len < kSizeV1) return false;
+        if (GetU32(p) != kMagic) return false;
+        if (p[4] < 1) return false;
+        const size_t headerSize = static_cast<size_t>(GetU16(p + 6));
+        if (headerSize < kSizeV1) return false;
+
+        LetterboxGeometry& g = out.geometry;
+        out.flags = p[5];
+        g.roi.x = GetU16(p + 8);
+        g.roi.y = GetU16(p + 10);
+        g.roi.width = GetU16(p + 12);
+        g.roi.height = GetU16(p + 14);
+        g.scaledW = GetU16(p + 16);
+        g.scaledH = GetU16(p + 18);
+        g.padX = GetU16(p + 20);
+        g.padY = GetU16(p + 22);
+        g.outW = GetU16(p + 24);
+        g.outH = GetU16(p + 26);
+        out.replyFormat = ReplyFormat::Json;
+        if (p[4] >= 2 && headerSize >= kSizeV2 && len >= kSizeV2 && p[28] == static_cast<uint8_t>(ReplyFormat::Binary))
+            out.replyFormat = ReplyFormat::Binary;
+
+        if (p[4] >= 3 && headerSize >= kSize && len >= kSize)
+        {
+            out.hasRole = p[29] < static_cast<uint8_t>(CameraRole::Count);
+            if (out.hasRole)
+                out.role = static_cast<CameraRole>(p[29]);
+            out.pixelFormat = p[30];
+            if (p[31] < static_cast<uint8_t>(ImageCodec::Count))
+                out.codec = static_cast<ImageCodec>(p[31]);
+            out.sequence = GetU64(p + 32);
+            out.captureUs = static_cast<int64_t>(GetU64(p + 40));
+            out.cameraTicks = GetU64(p + 48);
+            out.frameCounter = GetU32(p + 56);
+            out.productId.fill('\0');
+            std::memcpy(out.productId.data(), p + 60, kProductIdSize);
+        }
+        return true;
+    }
+}
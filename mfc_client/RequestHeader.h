@@ -0,0 +1,104 @@
+﻿#pragma once
+#include "ImageEncoder.h"
+#include "Preprocess.h"
+#include "Station.h"
+#include <array>
+#include <cstdint>
+#include <tuple>
+
+// ===== 검사 요청 헤더 (선택) =====
+// 기존 프레이밍 [4바이트 길이(BE)][이미지] 앞에 붙는 고정 길이 헤더.
+// 서버는 첫 4바이트가 매직이면 헤더로, 아니면 기존 길이로 해석한다.
+// 모든 다중 바이트 필드는 Big-Endian (기존 길이 필드와 동일).
+//
+//  off  size  field
+//   0    4    magic 'CNHD'
+//   4    1    version (=3, kVersion)
+//   5    1    flags
+//   6    2    headerSize (매직 포함 전체 바이트 수, 이후 버전 확장 시 건너뛰기용)
+//   8    8    roi x, y, w, h        (u16 x4, 센서 좌표)
+//  16    4    scaledW, scaledH      (u16 x2)
+//  20    4    padX, padY            (u16 x2)
+//  24    4    outW, outH            (u16 x2)
+//  28    1    replyFormat           (v2, ReplyFormat: 0 = JSON, 1 = 바이너리 'CNRP' v1)
+//  29    1    role                  (v3, CameraRole: 0 top, 1 front(SIDE), 2 bottom, 3 side2 / 0xFF 없음)
+//  30    1    pixelFormat           (v3, 카메라 원본 형식: 0 모름/기타, 1 + RawFormat)
+//  31    1    codec                 (v3, ImageCodec: 본문 인코딩)
+//  32    8    sequence              (v3, 검사 단위 번호 — 같은 캔의 뷰는 같은 값)
+//  40    8    captureUs             (v3, 노출 시각 Unix µs, 0 = 모름)
+//  48    8    cameraTicks           (v3, 카메라 타임스탬프 원값, 0 = 없음)
+//  56    4    frameCounter          (v3, 카메라 프레임 번호, 0xFFFFFFFF = 없음)
+//  60   16    productId             (v3, ASCII, NUL 채움)
+//  76    4    reserved
+//
+// v1 서버는 headerSize 만큼 건너뛰므로 v2 헤더를 받아도 JSON 으로 응답한다
+// → 클라이언트는 응답 첫 바이트로 형식을 판별 (JSON 폴백).
+// v3 부터 역할/단위 번호가 헤더에 있으므로 서버는 도착 순서로 TOP/SIDE 를 추측하지 않는다
+// (v2 이하 헤더나 헤더 없는 요청만 기존처럼 도착 순서).
+
+// 요청한 응답 형식
+enum class ReplyFormat : uint8_t
+{
+    Json = 0,
+    Binary = 1,    // ReplyParser.h BinaryReply
+};
+
+namespace RequestHeader
+{
+    constexpr uint32_t kMagic = 0x434E4844; // 'CNHD'
+    constexpr uint8_t  kVersion = 3;
+    constexpr size_t   kSize = 80;
+    constexpr size_t   kSizeV1 = 28;
+    constexpr size_t   kSizeV2 = 32;
+    constexpr size_t   kProductIdSize = 16;
+
+    constexpr uint8_t  kNoRole = 0xFF;
+    constexpr uint8_t  kPixelUnknown = 0;       // 1 + RawFormat 은 FrameConvert.h 순서
+    constexpr uint32_t kNoFrameCounter = 0xFFFFFFFF;
+
+    // flags
+    constexpr uint8_t kFlagLetterboxed = 0x01;  // 이미지가 ROI 크롭 + 레터박스 됨
+    constexpr uint8_t kFlagSideEnhanced = 0x02; // 측면 전처리(대비/엣지/블러) 적용됨 → 서버 전처리 생략
+
+    struct Fields
+    {
+        uint8_t flags = 0;
+        LetterboxGeometry geometry;
+        ReplyFormat replyFormat = ReplyFormat::Json;
+
+        // v3 메타데이터 (Parse: v2 이하면 기본값 그대로 → hasRole = false)
+        bool       hasRole = false;
+        CameraRole role = CameraRole::Top;
+        uint8_t    pixelFormat = kPixelUnknown;
+        ImageCodec codec = ImageCodec::Png;
+        uint64_t   sequence = 0;
+        int64_t    captureUs = 0;
+        uint64_t   cameraTicks = 0;
+        uint32_t   frameCounter = kNoFrameCounter;
+        std::array<char, kProductIdSize + 1> productId{};   // NUL 종료 (길면 잘림)
+
+        void SetProductId(const char* id);
+    };
+
+    using Buffer = std::array<uint8_t, kSize>;
+
+    // 힙 할당 없이 고정 버퍼에 직렬화
+    void Serialize(const Fields& f, Buffer& out);
+
+    // 역직렬화 (매직/버전/길이 검사, v1 헤더는 replyFormat = Json). 실패 시 false.
+    bool Parse(const uint8_t* data, size_t len, Fields& out);
+
+    // 검사 단위 키 = 제품번호 + 단위 번호 (서버 짝짓기, 대기열/서버 풀 경로). 고정 크기라 요청마다 할당 없음.
+    struct UnitId
+    {
+        std::array<char, kProductIdSize + 1> productId{};
+        uint64_t sequence = 0;
+        bool     valid = false;        // v3 역할이 없으면 false (도착 순서 서버)
+        bool     startsUnit = false;   // TOP: 서버가 이 요청으로 새 단위를 시작 (비교에는 안 씀)
+
+        bool operator<(const UnitId& o) const { return std::tie(valid, sequence, productId) < std::tie(o.valid, o.sequence, o.productId); }
+        bool operator==(const UnitId& o) const { return valid == o.valid && sequence == o.sequence && productId == o.productId; }
+        bool operator!=(const UnitId& o) const { return !(*this == o); }
+    };
+    UnitId UnitOf(const Fields& f);
+}
@@ -0,0 +1,442 @@
+﻿#include "SideEnhance.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CANCLIENT_SSE2 1
+#endif
+
+namespace
+{
+    // OpenCV cvtColor(BGR2GRAY) 8비트 계수 (Q14)
+    constexpr int kGrayShift = 14;
+    constexpr int kGrayB = 1868, kGrayG = 9617, kGrayR = 4899;
+
+    // OpenCV Canny 방향 판정 (tan 22.5° x 2^15)
+    constexpr int kCannyShift = 15;
+    constexpr int kTg22 = 13573;
+
+    // 밴드 작업 집합 목표 (L2 절반 정도)
+    constexpr size_t kBandBytes = 256 * 1024;
+
+    inline uint8_t Saturate(long v) { return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v)); }
+
+    // OpenCV convertScaleAbs: |v*α + β| 를 float 로 계산 후 반올림 (짝수 쪽)
+    inline uint8_t ContrastValue(int v, const SideEnhanceParams& p)
+    {
+        return Saturate(std::lrintf(std::fabs(static_cast<float>(v) * p.alpha + p.beta)));
+    }
+
+    // OpenCV addWeighted (8비트): float 가중합 후 반올림
+    inline uint8_t BlendValue(int image, int edge, const SideEnhanceParams& p)
+    {
+        return Saturate(std::lrintf(static_cast<float>(image) * p.imageWeight + static_cast<float>(edge) * p.edgeWeight));
+    }
+
+    inline int Clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
+
+    // BORDER_REFLECT_101 (크기 1 이면 0)
+    inline int Reflect101(int i, int n)
+    {
+        if (n == 1) return 0;
+        if (i < 0) return -i;
+        if (i >= n) return 2 * n - 2 - i;
+        return i;
+    }
+
+    // 비최대 억제 + 이중 임계값 분류 (OpenCV canny.cpp 와 같은 비교)
+    // magP/magC/magN: 위/현재/아래 행 크기 (인덱스 -1, w 는 0)
+    inline uint8_t ClassifyPixel(int m, int xs, int ys, const int16_t* magP, const int16_t* magC,
+                                 const int16_t* magN, int x, int low, int high)
+    {
+        if (m <= low) return 0;
+        const int ax = std::abs(xs);
+        const int ay = std::abs(ys) << kCannyShift;
+        const int tg22x = ax * kTg22;
+        bool peak;
+        if (ay < tg22x) {
+            peak = m > magC[x - 1] && m >= magC[x + 1];
+        }
+        else {
+            const int tg67x = tg22x + (ax << (kCannyShift + 1));
+            if (ay > tg67x) {
+                peak = m > magP[x] && m >= magN[x];
+            }
+            else {
+                const int s = (xs ^ ys) < 0 ? -1 : 1;
+                peak = m > magP[x - s] && m > magN[x + s];
+            }
+        }
+        if (!peak) return 0;
+        return m > high ? 2 : 1;
+    }
+
+    // 3x3 Sobel (L1 크기). g0/g1/g2 = 위/현재/아래 그레이 행, 인덱스 -1 과 w 는 복제 테두리.
+    void SobelRow(const uint8_t* g0, const uint8_t* g1, const uint8_t* g2, int w,
+                  int16_t* dx, int16_t* dy, int16_t* mag)
+    {
+        int x = 0;
+#ifdef CANCLIENT_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        auto load = [&](const uint8_t* p) {
+            return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), zero);
+        };
+        for (; x + 8 <= w; x += 8)
+        {
+            const __m128i a0 = load(g0 + x - 1), a1 = load(g0 + x), a2 = load(g0 + x + 1);
+            const __m128i b0 = load(g1 + x - 1), b2 = load(g1 + x + 1);
+            const __m128i c0 = load(g2 + x - 1), c1 = load(g2 + x), c2 = load(g2 + x + 1);
+
+            const __m128i gx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(a2, a0), _mm_sub_epi16(c2, c0)),
+                                             _mm_slli_epi16(_mm_sub_epi16(b2, b0), 1));
+            const __m128i gy = _mm_sub_epi16(_mm_add_epi16(_mm_add_epi16(c0, c2), _mm_slli_epi16(c1, 1)),
+                                             _mm_add_epi16(_mm_add_epi16(a0, a2), _mm_slli_epi16(a1, 1)));
+            // |v| = max(v, -v)
+            const __m128i ax = _mm_max_epi16(gx, _mm_sub_epi16(zero, gx));
+            const __m128i ay = _mm_max_epi16(gy, _mm_sub_epi16(zero, gy));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dx + x), gx);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dy + x), gy);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(mag + x), _mm_add_epi16(ax, ay));
+        }
+#endif
+        for (; x < w; ++x)
+        {
+            const int gx = (g0[x + 1] - g0[x - 1]) + 2 * (g1[x + 1] - g1[x - 1]) + (g2[x + 1] - g2[x - 1]);
+            const int gy = (g2[x - 1] + 2 * g2[x] + g2[x + 1]) - (g0[x - 1] + 2 * g0[x] + g0[x + 1]);
+            dx[x] = static_cast<int16_t>(gx);
+            dy[x] = static_cast<int16_t>(gy);
+            mag[x] = static_cast<int16_t>(std::abs(gx) + std::abs(gy));
+        }
+    }
+
+    // 가로 [1 2 1] (3채널 인터리브, 양 끝 3바이트는 반사 테두리)
+    void BlurRowH(const int16_t* in, int n, uint16_t* out)
+    {
+        int i = 0;
+#ifdef CANCLIENT_SSE2
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m128i l = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i - 3));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+            const __m128i r = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 3));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                _mm_add_epi16(_mm_add_epi16(l, r), _mm_slli_epi16(c, 1)));
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = static_cast<uint16_t>(in[i - 3] + 2 * in[i] + in[i + 3]);
+    }
+
+    // 세로 [1 2 1] 후 /16 반올림 (OpenCV 고정소수점 GaussianBlur 와 동일)
+    void BlurRowV(const uint16_t* a, const uint16_t* b, const uint16_t* c, int n, uint8_t* out)
+    {
+        int i = 0;
+#ifdef CANCLIENT_SSE2
+        const __m128i eight = _mm_set1_epi16(8);
+        for (; i + 16 <= n; i += 16)
+        {
+            auto sum = [&](int o) {
+                const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + o));
+                const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + o));
+                const __m128i vc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i + o));
+                return _mm_srli_epi16(_mm_add_epi16(_mm_add_epi16(_mm_add_epi16(va, vc), _mm_slli_epi16(vb, 1)), eight), 4);
+            };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(sum(0), sum(8)));
+        }
+#endif
+        for (; i < n; ++i)
+            out[i] = static_cast<uint8_t>((a[i] + 2 * b[i] + c[i] + 8) >> 4);
+    }
+
+    // 밴드 나누기: 작업 집합이 kBandBytes 근처, 스레드당 최소 2개
+    int BandRows(int width, int height, size_t threads)
+    {
+        const size_t perRow = static_cast<size_t>(width) * 12;   // 원본 3 + 그레이 1 + dx/dy/mag 6 + 맵 1 (+여유)
+        int rows = static_cast<int>(std::max<size_t>(8, kBandBytes / std::max<size_t>(1, perRow)));
+        const int minBands = static_cast<int>(threads * 2);
+        if (threads > 1 && (height + rows - 1) / rows < minBands)
+            rows = std::max(8, (height + minBands - 1) / minBands);
+        return std::min(rows, std::max(1, height));
+    }
+}
+
+// ===================== 생성 =====================
+CSideEnhancer::CSideEnhancer(size_t threads, const SideEnhanceParams& params)
+    : m_params(params), m_pool(new CThreadPool(threads))
+{
+    for (int v = 0; v < 256; ++v)
+    {
+        const int c = ContrastValue(v, m_params);
+        m_grayB[v] = c * kGrayB;
+        m_grayG[v] = c * kGrayG;
+        m_grayR[v] = c * kGrayR;
+        m_blend[0][v] = BlendValue(c, 0, m_params);
+        m_blend[1][v] = BlendValue(c, 255, m_params);
+    }
+}
+
+CSideEnhancer::~CSideEnhancer() = default;
+
+size_t CSideEnhancer::Threads() const
+{
+    return m_pool->Size();
+}
+
+// ===================== 적용 =====================
+void CSideEnhancer::Apply(const ImageView& src, ImageBuffer& dst)
+{
+    m_edgeCount = 0;
+    if (!src.IsValid()) {
+        dst.Allocate(0, 0);
+        return;
+    }
+    const int w = src.width, h = src.height;
+    dst.Allocate(w, h);
+    m_map.resize(static_cast<size_t>(w) * h);
+
+    const int bandRows = BandRows(w, h, m_pool->Size());
+    const size_t bands = static_cast<size_t>((h + bandRows - 1) / bandRows);
+    m_seeds.resize(bands);
+
+    // 1패스: 엣지 후보 분류
+    m_pool->ParallelFor(bands, [&](size_t b) {
+        const int y0 = static_cast<int>(b) * bandRows;
+        m_seeds[b].clear();
+        ClassifyBand(src, y0, std::min(h, y0 + bandRows), m_seeds[b]);
+    });
+
+    // 이력 추적 (맵 전체가 연결될 수 있어 순차)
+    Hysteresis(w, h);
+
+    // 2패스: 혼합 + 블러
+    m_pool->ParallelFor(bands, [&](size_t b) {
+        const int y0 = static_cast<int>(b) * bandRows;
+        BlendBlurBand(src, y0, std::min(h, y0 + bandRows), dst);
+    });
+}
+
+void CSideEnhancer::ClassifyBand(const ImageView& src, int y0, int y1, std::vector<uint32_t>& seeds)
+{
+    const int w = src.width, h = src.height;
+    const int rows = y1 - y0;
+    const int gStride = w + 2;    // 좌우 복제 테두리
+    const int mStride = w + 2;    // 좌우 0
+
+    // 밴드 작업 버퍼 (스레드마다 재사용)
+    thread_local std::vector<uint8_t> gray;
+    thread_local std::vector<int16_t> mag, dx, dy;
+    gray.resize(static_cast<size_t>(rows + 4) * gStride);
+    mag.assign(static_cast<size_t>(rows + 2) * mStride, 0);
+    dx.resize(static_cast<size_t>(rows) * w);
+    dy.resize(static_cast<size_t>(rows) * w);
+
+    // 그레이 행 y0-2 .. y1+1 (세로 복제 테두리)
+    auto grayRow = [&](int r) { return gray.data() + static_cast<size_t>(r - (y0 - 2)) * gStride + 1; };
+    for (int r = y0 - 2; r <= y1 + 1; ++r)
+    {
+        const uint8_t* s = src.Row(Clamp(r, 0, h - 1));
+        uint8_t* g = grayRow(r);
+        for (int x = 0; x < w; ++x, s += 3)
+            g[x] = static_cast<uint8_t>((m_grayB[s[0]] + m_grayG[s[1]] + m_grayR[s[2]] + (1 << (kGrayShift - 1))) >> kGrayShift);
+        g[-1] = g[0];
+        g[w] = g[w - 1];
+    }
+
+    // 크기 행 y0-1 .. y1 (영상 밖 행은 0), dx/dy 는 밴드 행만
+    auto magRow = [&](int r) { return mag.data() + static_cast<size_t>(r - (y0 - 1)) * mStride + 1; };
+    thread_local std::vector<int16_t> haloDx, haloDy;
+    haloDx.resize(w);
+    haloDy.resize(w);
+    for (int r = y0 - 1; r <= y1; ++r)
+    {
+        if (r < 0 || r >= h) continue;
+        const bool inBand = r >= y0 && r < y1;
+        int16_t* rdx = inBand ? dx.data() + static_cast<size_t>(r - y0) * w : haloDx.data();
+        int16_t* rdy = inBand ? dy.data() + static_cast<size_t>(r - y0) * w : haloDy.data();
+        SobelRow(grayRow(r - 1), grayRow(r), grayRow(r + 1), w, rdx, rdy, magRow(r));
+    }
+
+    // 비최대 억제 → 후보 맵
+    const int low = m_params.cannyLow, high = m_params.cannyHigh;
+    for (int y = y0; y < y1; ++y)
+    {
+        const int16_t* mp = magRow(y - 1);
+        const int16_t* mc = magRow(y);
+        const int16_t* mn = magRow(y + 1);
+        const int16_t* rdx = dx.data() + static_cast<size_t>(y - y0) * w;
+        const int16_t* rdy = dy.data() + static_cast<size_t>(y - y0) * w;
+        uint8_t* out = m_map.data() + static_cast<size_t>(y) * w;
+        for (int x = 0; x < w; ++x)
+        {
+            const uint8_t c = ClassifyPixel(mc[x], rdx[x], rdy[x], mp, mc, mn, x, low, high);
+            out[x] = c;
+            if (c == 2)
+                seeds.push_back(static_cast<uint32_t>(y) * w + x);
+        }
+    }
+}
+
+void CSideEnhancer::Hysteresis(int w, int h)
+{
+    m_stack.clear();
+    size_t edges = 0;
+    for (const auto& band : m_seeds)
+        for (uint32_t i : band)
+            if (m_map[i] == 2) {
+                m_map[i] = 255;
+                ++edges;
+                m_stack.push_back(i);
+                while (!m_stack.empty())
+                {
+                    const uint32_t p = m_stack.back();
+                    m_stack.pop_back();
+                    const int x = static_cast<int>(p % w), y = static_cast<int>(p / w);
+                    for (int ny = std::max(0, y - 1); ny <= std::min(h - 1, y + 1); ++ny)
+                        for (int nx = std::max(0, x - 1); nx <= std::min(w - 1, x + 1); ++nx)
+                        {
+                            uint8_t& m = m_map[static_cast<size_t>(ny) * w + nx];
+                            if (m == 1 || m == 2) {
+                                m = 255;
+                                ++edges;
+                                m_stack.push_back(static_cast<uint32_t>(ny) * w + nx);
+                            }
+                        }
+                }
+            }
+    m_edgeCount = edges;
+}
+
+void CSideEnhancer::BlendBlurBand(const ImageView& src, int y0, int y1, ImageBuffer& dst) const
+{
+    const int w = src.width, h = src.height;
+    const int n = w * 3;
+
+    thread_local std::vector<int16_t> blended;
+    thread_local std::vector<uint16_t> hbuf;
+    blended.resize(static_cast<size_t>(n) + 6);
+    hbuf.resize(static_cast<size_t>(n) * 3);
+
+    // 원본 행 r → 대비/혼합 → 가로 블러 결과를 slot 에
+    auto horizontal = [&](int r, uint16_t* outRow) {
+        const int sy = Reflect101(r, h);
+        const uint8_t* s = src.Row(sy);
+        const uint8_t* e = m_map.data() + static_cast<size_t>(sy) * w;
+        int16_t* b = blended.data() + 3;
+        for (int x = 0; x < w; ++x)
+        {
+            const uint8_t* lut = m_blend[e[x] == 255 ? 1 : 0];
+            b[x * 3] = lut[s[x * 3]];
+            b[x * 3 + 1] = lut[s[x * 3 + 1]];
+            b[x * 3 + 2] = lut[s[x * 3 + 2]];
+        }
+        const int l = Reflect101(-1, w), rr = Reflect101(w, w);
+        for (int c = 0; c < 3; ++c) {
+            b[-3 + c] = b[l * 3 + c];
+            b[n + c] = b[rr * 3 + c];
+        }
+        BlurRowH(b, n, outRow);
+    };
+
+    uint16_t* rowsBuf[3] = { hbuf.data(), hbuf.data() + n, hbuf.data() + 2 * n };
+    horizontal(y0 - 1, rowsBuf[0]);
+    horizontal(y0, rowsBuf[1]);
+    for (int y = y0; y < y1; ++y)
+    {
+        horizontal(y + 1, rowsBuf[2]);
+        BlurRowV(rowsBuf[0], rowsBuf[1], rowsBuf[2], n, dst.Row(y));
+        std::rotate(rowsBuf, rowsBuf + 1, rowsBuf + 3);
+    }
+}
+
+// ===================== 참조 구현 (단계별, OpenCV 의미 그대로) =====================
+void SideEnhanceReference(const ImageView& src, ImageBuffer& dst, const SideEnhanceParams& p)
+{
+    if (!src.IsValid()) {
+        dst.Allocate(0, 0);
+        return;
+    }
+    const int w = src.width, h = src.height;
+    const size_t count = static_cast<size_t>(w) * h;
+
+    // 1) convertScaleAbs
+    std::vector<uint8_t> contrast(count * 3);
+    for (int y = 0; y < h; ++y)
+        for (int i = 0; i < w * 3; ++i)
+            contrast[static_cast<size_t>(y) * w * 3 + i] = ContrastValue(src.Row(y)[i], p);
+
+    // 2) BGR2GRAY
+    std::vector<int> gray(count);
+    for (size_t i = 0; i < count; ++i)
+        gray[i] = (contrast[i * 3] * kGrayB + contrast[i * 3 + 1] * kGrayG + contrast[i * 3 + 2] * kGrayR
+                   + (1 << (kGrayShift - 1))) >> kGrayShift;
+
+    // 3) Canny: Sobel (BORDER_REPLICATE) → L1 크기 → 비최대 억제 → 이력 추적
+    auto g = [&](int x, int y) { return gray[static_cast<size_t>(Clamp(y, 0, h - 1)) * w + Clamp(x, 0, w - 1)]; };
+    std::vector<int> gx(count), gy(count);
+    std::vector<int16_t> mag(static_cast<size_t>(w + 2) * (h + 2), 0);   // 테두리 0
+    auto m = [&](int x, int y) -> int16_t& { return mag[static_cast<size_t>(y + 1) * (w + 2) + x + 1]; };
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+        {
+            const int vx = g(x + 1, y - 1) - g(x - 1, y - 1) + 2 * (g(x + 1, y) - g(x - 1, y)) + g(x + 1, y + 1) - g(x - 1, y + 1);
+            const int vy = g(x - 1, y + 1) + 2 * g(x, y + 1) + g(x + 1, y + 1) - g(x - 1, y - 1) - 2 * g(x, y - 1) - g(x + 1, y - 1);
+            gx[static_cast<size_t>(y) * w + x] = vx;
+            gy[static_cast<size_t>(y) * w + x] = vy;
+            m(x, y) = static_cast<int16_t>(std::abs(vx) + std::abs(vy));
+        }
+
+    std::vector<uint8_t> cls(count);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            cls[static_cast<size_t>(y) * w + x] = ClassifyPixel(m(x, y), gx[static_cast<size_t>(y) * w + x],
+                gy[static_cast<size_t>(y) * w + x], &m(0, y - 1), &m(0, y), &m(0, y + 1), x, p.cannyLow, p.cannyHigh);
+
+    std::vector<uint8_t> edge(count, 0);
+    std::vector<size_t> queue;
+    for (size_t i = 0; i < count; ++i)
+        if (cls[i] == 2 && !edge[i]) {
+            edge[i] = 255;
+            queue.assign(1, i);
+            for (size_t q = 0; q < queue.size(); ++q)
+            {
+                const int x = static_cast<int>(queue[q] % w), y = static_cast<int>(queue[q] / w);
+                for (int dy = -1; dy <= 1; ++dy)
+                    for (int dx = -1; dx <= 1; ++dx)
+                    {
+                        const int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+                        const size_t j = static_cast<size_t>(ny) * w + nx;
+                        if (cls[j] && !edge[j]) {
+                            edge[j] = 255;
+                            queue.push_back(j);
+                        }
+                    }
+            }
+        }
+
+    // 4) addWeighted (엣지 3채널 복제)
+    std::vector<int> blended(count * 3);
+    for (size_t i = 0; i < count * 3; ++i)
+        blended[i] = BlendValue(contrast[i], edge[i / 3], p);
+
+    // 5) GaussianBlur 3x3 (BORDER_REFLECT_101), 가중치 [1 2 1]x[1 2 1] / 16
+    static const int k[3] = { 1, 2, 1 };
+    dst.Allocate(w, h);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+            for (int c = 0; c < 3; ++c)
+            {
+                int acc = 0;
+                for (int j = -1; j <= 1; ++j)
+                    for (int i = -1; i <= 1; ++i)
+                        acc += k[j + 1] * k[i + 1] *
+                            blended[(static_cast<size_t>(Reflect101(y + j, h)) * w + Reflect101(x + i, w)) * 3 + c];
+                dst.Row(y)[x * 3 + c] = static_cast<uint8_t>((acc + 8) >> 4);
+            }
+}
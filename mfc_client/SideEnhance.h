@@ -0,0 +1,65 @@
+﻿#pragma once
+#include "ImageView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class CThreadPool;
+
+// ===== 측면 카메라 전처리 (ai_server.py infer_image "side" 와 같은 연산) =====
+//   convertScaleAbs(α, β) → BGR2GRAY → Canny(low, high, 3x3, L1) → addWeighted(원본 wImage, 엣지 wEdge)
+//   → GaussianBlur 3x3 (σ 자동)
+// 서버가 받는 이미지(레터박스 후 또는 원본)에 그대로 적용해 보내고, 헤더 플래그로 서버 쪽 전처리를 생략시킨다.
+struct SideEnhanceParams
+{
+    float alpha = 1.4f;
+    float beta = 15.0f;
+    int   cannyLow = 60;
+    int   cannyHigh = 180;
+    float imageWeight = 0.85f;
+    float edgeWeight = 0.15f;
+};
+
+// 캐시 크기 행 묶음(밴드) 단위 2패스, 밴드는 스레드 풀에 분배.
+//   1패스: 대비 LUT + 그레이 + Sobel + 비최대 억제 → 엣지 후보 맵 (1바이트/픽셀) + 강한 엣지 시드
+//   (사이) 이력 추적: 시드에서 8방향으로 약한 후보를 따라가며 확정 (맵만 다시 읽음)
+//   2패스: 대비 + 엣지 혼합 LUT → 가로/세로 3x3 블러 → 출력
+// 중간 BGR 영상은 만들지 않는다 (원본 2번 읽기 + 맵 + 출력 1번 쓰기).
+// 정수/LUT 연산은 OpenCV 8비트 경로와 비트 단위로 같게 맞춤 (SideEnhanceReference 로 검증).
+class CSideEnhancer
+{
+public:
+    explicit CSideEnhancer(size_t threads = 0, const SideEnhanceParams& params = SideEnhanceParams());   // 0 = 코어 수
+    ~CSideEnhancer();
+
+    CSideEnhancer(const CSideEnhancer&) = delete;
+    CSideEnhancer& operator=(const CSideEnhancer&) = delete;
+
+    void   Apply(const ImageView& src, ImageBuffer& dst);
+    size_t Threads() const;
+
+    // 마지막 Apply 의 엣지 맵 (255 = 엣지, 그 외 = 아님) / 엣지 픽셀 수 (검증/보고용)
+    const std::vector<uint8_t>& EdgeMap() const { return m_map; }
+    size_t EdgeCount() const { return m_edgeCount; }
+
+private:
+    void ClassifyBand(const ImageView& src, int y0, int y1, std::vector<uint32_t>& seeds);
+    void Hysteresis(int width, int height);
+    void BlendBlurBand(const ImageView& src, int y0, int y1, ImageBuffer& dst) const;
+
+    SideEnhanceParams            m_params;
+    std::unique_ptr<CThreadPool> m_pool;
+
+    int32_t m_grayB[256], m_grayG[256], m_grayR[256];   // 대비 적용 후 그레이 가중치 (Q14)
+    uint8_t m_blend[2][256];                             // [엣지 여부][원본 값] → 대비 + 혼합 결과
+
+    std::vector<uint8_t>               m_map;     // 0 = 아님, 1 = 약한 후보, 2 = 강한 후보 → 255 = 엣지
+    std::vector<std::vector<uint32_t>> m_seeds;   // 밴드별 강한 후보 위치
+    std::vector<uint32_t>              m_stack;
+    size_t m_edgeCount = 0;
+};
+
+// 단계별 전체 영상 단순 구현 (OpenCV 함수 의미 그대로, 느림). 검증/벤치마크 기준용.
+void SideEnhanceReference(const ImageView& src, ImageBuffer& dst, const SideEnhanceParams& params = SideEnhanceParams());
@@ -0,0 +1,229 @@
+﻿#pragma once
+// ===== Winsock / BSD 소켓 공용 최소 래퍼 =====
+// 검사 코어와 도구(재생/부하/대체 서버)가 같은 소켓 코드를 쓰기 위한 얇은 층.
+// Windows 에서는 사용 전에 WSAStartup 이 되어 있어야 한다 (NetStartup).
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace Net
+{
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    const SocketHandle kInvalidSocket = INVALID_SOCKET;
+    const int kSendFlags = 0;
+    inline void CloseSocket(SocketHandle s) { closesocket(s); }
+    inline int  LastError() { return WSAGetLastError(); }
+    inline bool Startup() { WSADATA wsa; return WSAStartup(MAKEWORD(2, 2), &wsa) == 0; }
+    inline void Cleanup() { WSACleanup(); }
+    inline bool SetNonBlocking(SocketHandle s) { u_long on = 1; return ioctlsocket(s, FIONBIO, &on) == 0; }
+    inline bool WouldBlock(int err) { return err == WSAEWOULDBLOCK || err == WSAEINPROGRESS || err == WSAEINTR; }
+#else
+    using SocketHandle = int;
+    const SocketHandle kInvalidSocket = -1;
+    const int kSendFlags = MSG_NOSIGNAL;   // 끊긴 연결에 send 해도 SIGPIPE 로 죽지 않게
+    inline void CloseSocket(SocketHandle s) { close(s); }
+    inline int  LastError() { return errno; }
+    inline bool Startup() { return true; }
+    inline void Cleanup() {}
+    inline bool SetNonBlocking(SocketHandle s)
+    {
+        const int flags = fcntl(s, F_GETFL, 0);
+        return flags >= 0 && fcntl(s, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+    inline bool WouldBlock(int err) { return err == EAGAIN || err == EWOULDBLOCK || err == EINPROGRESS || err == EINTR; }
+#endif
+
+    // 소켓 자동 종료
+    struct SocketGuard
+    {
+        SocketHandle s;
+        explicit SocketGuard(SocketHandle h = kInvalidSocket) : s(h) {}
+        ~SocketGuard() { if (s != kInvalidSocket) CloseSocket(s); }
+        SocketGuard(const SocketGuard&) = delete;
+        SocketGuard& operator=(const SocketGuard&) = delete;
+    };
+
+    // size 바이트를 전부 보냄 (64KB 청크). 실패 시 false.
+    inline bool SendAll(SocketHandle s, const uint8_t* data, size_t size)
+    {
+        size_t total = 0;
+        while (total < size) {
+            const size_t left = size - total;
+            const int chunk = static_cast<int>(left < 64 * 1024 ? left : 64 * 1024);
+            const int sent = send(s, reinterpret_cast<const char*>(data) + total, chunk, kSendFlags);
+            if (sent <= 0)
+                return false;
+            total += static_cast<size_t>(sent);
+        }
+        return true;
+    }
+
+    // 정확히 size 바이트 수신. 끊기면 false.
+    inline bool RecvExact(SocketHandle s, uint8_t* data, size_t size)
+    {
+        size_t total = 0;
+        while (total < size) {
+            const size_t left = size - total;
+            const int chunk = static_cast<int>(left < 1024 * 1024 ? left : 1024 * 1024);
+            const int got = recv(s, reinterpret_cast<char*>(data) + total, chunk, 0);
+            if (got <= 0)
+                return false;
+            total += static_cast<size_t>(got);
+        }
+        return true;
+    }
+
+    // ===== 논블로킹 소켓: 기한 + 협조적 취소 =====
+    // 요청 1건 = 짧은 연결 1개를 부르는 스레드가 직접 끝까지 몰고 가므로, 소켓 하나의 준비 상태만 기다린다.
+    // 기한(deadlineNs)은 steady_clock ns (LatencyStats NowNs 와 같은 시계), 0 = 무제한.
+    // cancel 이 켜지면 kCancelSliceMs 안에 Cancelled 로 돌아온다.
+    enum class IoWait { Ready, Timeout, Cancelled, Failed };
+
+    const int kCancelSliceMs = 50;
+
+    inline uint64_t SteadyNs()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // 읽기(forWrite = false) / 쓰기 가능할 때까지 대기.
+    // Windows 는 select (WSAPoll 은 구버전에서 거절된 연결을 알리지 않음), 그 외는 poll.
+    inline IoWait WaitSocket(SocketHandle s, bool forWrite, uint64_t deadlineNs, const std::atomic<bool>* cancel)
+    {
+        for (;;)
+        {
+            if (cancel && cancel->load(std::memory_order_relaxed))
+                return IoWait::Cancelled;
+
+            int sliceMs = cancel ? kCancelSliceMs : -1;
+            if (deadlineNs) {
+                const uint64_t now = SteadyNs();
+                if (now >= deadlineNs)
+                    return IoWait::Timeout;
+                const uint64_t leftMs = (deadlineNs - now + 999999) / 1000000;
+                if (sliceMs < 0 || leftMs < static_cast<uint64_t>(sliceMs))
+                    sliceMs = static_cast<int>(leftMs < 0x7FFFFFFF ? leftMs : 0x7FFFFFFF);
+            }
+#ifdef _WIN32
+            fd_set ready, failed;
+            FD_ZERO(&ready);
+            FD_ZERO(&failed);
+            FD_SET(s, &ready);
+            FD_SET(s, &failed);
+            timeval tv{ sliceMs / 1000, (sliceMs % 1000) * 1000 };
+            const int r = select(0, forWrite ? nullptr : &ready, forWrite ? &ready : nullptr, &failed,
+                sliceMs < 0 ? nullptr : &tv);
+#else
+            pollfd p{ s, static_cast<short>(forWrite ? POLLOUT : POLLIN), 0 };
+            const int r = poll(&p, 1, sliceMs);
+#endif
+            if (r > 0)
+                return IoWait::Ready;     // 오류/끊김도 Ready → 다음 send/recv/SO_ERROR 가 알려 줌
+            if (r < 0 && !WouldBlock(LastError()))
+                return IoWait::Failed;
+        }
+    }
+
+    // 논블로킹 소켓으로 기한 안에 연결. Failed 면 code 에 소켓 오류.
+    inline IoWait ConnectUntil(SocketHandle s, const sockaddr_in& addr, uint64_t deadlineNs,
+        const std::atomic<bool>* cancel, int& code)
+    {
+        code = 0;
+        if (connect(s, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0)
+            return IoWait::Ready;
+        code = LastError();
+        if (!WouldBlock(code))
+            return IoWait::Failed;
+
+        const IoWait w = WaitSocket(s, true, deadlineNs, cancel);
+        if (w != IoWait::Ready)
+            return w;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        if (getsockopt(s, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&err), &len) != 0)
+            err = LastError();
+        code = err;
+        return err ? IoWait::Failed : IoWait::Ready;
+    }
+
+    // SendAll 의 기한/취소 판
+    inline IoWait SendAllUntil(SocketHandle s, const uint8_t* data, size_t size, uint64_t deadlineNs,
+        const std::atomic<bool>* cancel)
+    {
+        size_t total = 0;
+        while (total < size) {
+            const size_t left = size - total;
+            const int chunk = static_cast<int>(left < 64 * 1024 ? left : 64 * 1024);
+            const int sent = send(s, reinterpret_cast<const char*>(data) + total, chunk, kSendFlags);
+            if (sent > 0) {
+                total += static_cast<size_t>(sent);
+                continue;
+            }
+            if (sent == 0 || !WouldBlock(LastError()))
+                return IoWait::Failed;
+            const IoWait w = WaitSocket(s, true, deadlineNs, cancel);
+            if (w != IoWait::Ready)
+                return w;
+        }
+        return IoWait::Ready;
+    }
+
+    // 한 번 받을 수 있을 때까지 기다렸다가 recv. got = 0 이면 상대가 닫음.
+    inline IoWait RecvSomeUntil(SocketHandle s, char* buf, int capacity, int& got, uint64_t deadlineNs,
+        const std::atomic<bool>* cancel)
+    {
+        for (;;) {
+            got = recv(s, buf, capacity, 0);
+            if (got >= 0)
+                return IoWait::Ready;
+            if (!WouldBlock(LastError()))
+                return IoWait::Failed;
+            const IoWait w = WaitSocket(s, false, deadlineNs, cancel);
+            if (w != IoWait::Ready)
+                return w;
+        }
+    }
+
+    // IPv4 주소 또는 호스트 이름 → sockaddr_in
+    inline bool Resolve(const char* host, int port, sockaddr_in& addr)
+    {
+        addr = sockaddr_in();
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(static_cast<uint16_t>(port));
+        if (inet_pton(AF_INET, host, &addr.sin_addr) == 1)
+            return true;
+
+        addrinfo hints = {};
+        hints.ai_family = AF_INET;
+        hints.ai_socktype = SOCK_STREAM;
+        addrinfo* found = nullptr;
+        if (getaddrinfo(host, nullptr, &hints, &found) != 0 || !found)
+            return false;
+        addr.sin_addr = reinterpret_cast<const sockaddr_in*>(found->ai_addr)->sin_addr;
+        freeaddrinfo(found);
+        return true;
+    }
+}
@@ -0,0 +1,171 @@
+﻿#include "Station.h"
+
+#include <cstdio>
+
+namespace
+{
+    const char* const kRoleNames[] = { "top", "front", "bottom", "side2" };
+    static_assert(sizeof(kRoleNames) / sizeof(kRoleNames[0]) == static_cast<size_t>(CameraRole::Count),
+        "role names");
+}
+
+const char* CameraRoleName(CameraRole role)
+{
+    const size_t i = static_cast<size_t>(role);
+    return i < static_cast<size_t>(CameraRole::Count) ? kRoleNames[i] : "?";
+}
+
+bool ParseCameraRole(const std::string& name, CameraRole& out)
+{
+    if (name == "side") {
+        out = CameraRole::Front;
+        return true;
+    }
+    for (size_t i = 0; i < static_cast<size_t>(CameraRole::Count); ++i)
+        if (name == kRoleNames[i]) {
+            out = static_cast<CameraRole>(i);
+            return true;
+        }
+    return false;
+}
+
+// ===================== 그랩 전략 =====================
+namespace
+{
+    const char* const kStrategyNames[] = { "latest_only", "one_by_one", "latest_images", "upcoming" };
+}
+
+const char* GrabStrategyName(GrabStrategyKind kind)
+{
+    const size_t i = static_cast<size_t>(kind);
+    return i < sizeof(kStrategyNames) / sizeof(kStrategyNames[0]) ? kStrategyNames[i] : "?";
+}
+
+bool ParseGrabStrategy(const std::string& name, GrabStrategyKind& out)
+{
+    for (size_t i = 0; i < sizeof(kStrategyNames) / sizeof(kStrategyNames[0]); ++i)
+        if (name == kStrategyNames[i]) {
+            out = static_cast<GrabStrategyKind>(i);
+            return true;
+        }
+    return false;
+}
+
+std::string FormatGrabCounters(const GrabCounters& c)
+{
+    char buf[224];
+    std::snprintf(buf, sizeof(buf),
+        "frames %llu, skipped %llu, incomplete %llu, failed %llu, stale %llu, missed %llu, resend %llu, underrun %llu",
+        static_cast<unsigned long long>(c.frames), static_cast<unsigned long long>(c.skipped),
+        static_cast<unsigned long long>(c.incomplete), static_cast<unsigned long long>(c.failed),
+        static_cast<unsigned long long>(c.stale), static_cast<unsigned long long>(c.missed),
+        static_cast<unsigned long long>(c.resends),
+        static_cast<unsigned long long>(c.underruns));
+    return buf;
+}
+
+// ===================== 스테이션 설정 =====================
+StationConfig::StationConfig()
+{
+    StationCamera top, front;
+    top.role = CameraRole::Top;
+    front.role = CameraRole::Front;
+    cameras = { top, front };
+}
+
+int StationConfig::Find(CameraRole role) const
+{
+    for (size_t i = 0; i < cameras.size(); ++i)
+        if (cameras[i].role == role)
+            return static_cast<int>(i);
+    return -1;
+}
+
+bool ValidateStation(const StationConfig& station, std::string* error)
+{
+    if (station.cameras.empty()) {
+        if (error) *error = "station has no cameras";
+        return false;
+    }
+    for (size_t i = 0; i < station.cameras.size(); ++i)
+        for (size_t j = i + 1; j < station.cameras.size(); ++j)
+        {
+            const StationCamera& a = station.cameras[i];
+            const StationCamera& b = station.cameras[j];
+            if (a.role == b.role) {
+                if (error) *error = std::string("duplicate camera role: ") + CameraRoleName(a.role);
+                return false;
+            }
+            if (!a.serial.empty() && a.serial == b.serial) {
+                if (error) *error = "duplicate camera serial: " + a.serial;
+                return false;
+            }
+        }
+    return true;
+}
+
+// ===================== 장치 배정 =====================
+bool AssignStationDevices(const StationConfig& station, const std::vector<std::string>& serials,
+                          std::vector<size_t>& slotDevice, std::string* error)
+{
+    if (!ValidateStation(station, error))
+        return false;
+
+    const size_t kNone = static_cast<size_t>(-1);
+    slotDevice.assign(station.cameras.size(), kNone);
+    std::vector<bool> used(serials.size(), false);
+
+    // 1) 시리얼 지정 슬롯
+    for (size_t s = 0; s < station.cameras.size(); ++s)
+    {
+        const StationCamera& cam = station.cameras[s];
+        if (cam.serial.empty()) continue;
+        for (size_t d = 0; d < serials.size(); ++d)
+            if (!used[d] && serials[d] == cam.serial) {
+                slotDevice[s] = d;
+                used[d] = true;
+                break;
+            }
+        if (slotDevice[s] == kNone) {
+            if (error) *error = std::string("camera not found: ") + CameraRoleName(cam.role) + " (serial " + cam.serial + ")";
+            return false;
+        }
+    }
+
+    // 2) 미지정 슬롯 → 남은 장치 열거 순서대로
+    size_t next = 0;
+    for (size_t s = 0; s < station.cameras.size(); ++s)
+    {
+        if (slotDevice[s] != kNone) continue;
+        while (next < serials.size() && used[next]) ++next;
+        if (next >= serials.size()) {
+            if (error) *error = "not enough cameras: need " + std::to_string(station.cameras.size()) +
+                ", found " + std::to_string(serials.size());
+            return false;
+        }
+        slotDevice[s] = next;
+        used[next] = true;
+    }
+    return true;
+}
+
+// ===================== 기동 시간 =====================
+std::string FormatStationStartup(const StationConfig& station, const StationStartup& timing)
+{
+    auto ms = [](uint64_t ns) { return ns / 1e6; };
+    char buf[160];
+    std::snprintf(buf, sizeof(buf), "startup %.1f ms: init %.1f, enumerate %.1f, open %.1f (",
+        ms(timing.totalNs), ms(timing.initNs), ms(timing.enumerateNs), ms(timing.openAllNs));
+    std::string text = buf;
+
+    uint64_t serialNs = 0;   // 순차로 열었다면 걸렸을 시간
+    for (size_t s = 0; s < timing.openNs.size(); ++s)
+    {
+        const char* role = s < station.cameras.size() ? CameraRoleName(station.cameras[s].role) : "?";
+        std::snprintf(buf, sizeof(buf), "%s%s %.1f", s ? ", " : "", role, ms(timing.openNs[s]));
+        text += buf;
+        serialNs += timing.openNs[s];
+    }
+    std::snprintf(buf, sizeof(buf), "; serial %.1f), grab %.1f", ms(serialNs), ms(timing.startGrabNs));
+    return text + buf;
+}
@@ -0,0 +1,108 @@
+﻿#pragma once
+#include "CameraProfile.h"
+#include "Preprocess.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ===== 카메라 역할 =====
+// 검사 서버는 TOP → SIDE(FRONT) 두 장을 받아 듀얼 분석한다. 그 외 역할은 인코딩/보관까지.
+enum class CameraRole : uint8_t
+{
+    Top = 0,
+    Front = 1,     // 측면 (서버의 SIDE)
+    Bottom = 2,
+    Side2 = 3,     // 두 번째 측면 (반대쪽)
+    Count
+};
+
+const char* CameraRoleName(CameraRole role);                          // "top" / "front" / "bottom" / "side2"
+bool        ParseCameraRole(const std::string& name, CameraRole& out); // "side" 는 front 로
+inline bool IsSideRole(CameraRole role) { return role == CameraRole::Front || role == CameraRole::Side2; }
+inline bool IsServerRole(CameraRole role) { return role == CameraRole::Top || role == CameraRole::Front; }
+
+// ===== 스테이션 카메라 1대 =====
+struct StationCamera
+{
+    CameraRole  role = CameraRole::Top;
+    std::string serial;    // 비어 있으면 남은 장치 중 열거 순서대로 (기존 devices[0]/[1] 동작)
+    RoiRect     roi;       // 전처리 관심 영역 (비어 있으면 top/front 는 preprocess.roi 를 물려받음)
+    CameraProfile profile; // 열 때 적용할 노출/게인/센서 ROI/비닝/패킷/픽셀 형식 (비어 있으면 카메라 설정 그대로)
+    bool        sensorCrop = false; // 검사 때 카메라 창(Offset/Width/Height)을 roi 로 좁힘 (전송/변환/인코딩 모두 비례 감소)
+    RoiRect     previewRoi;         // sensorCrop 일 때 미리보기 창 (센서 픽셀, 비어 있으면 센서 전체)
+};
+
+// ===== 그랩 전략 (Pylon EGrabStrategy 와 1:1) =====
+enum class GrabStrategyKind : uint8_t
+{
+    LatestImageOnly,   // 가장 최근 1장만 (미리보기, 밀린 프레임은 건너뜀)
+    OneByOne,          // 도착 순서대로 전부 (버퍼가 모자라면 카메라 쪽에서 유실)
+    LatestImages,      // 최근 outputQueueSize 장
+    UpcomingImage,     // 요청한 뒤 찍힌 다음 1장
+};
+
+const char* GrabStrategyName(GrabStrategyKind kind);   // "latest_only" / "one_by_one" / "latest_images" / "upcoming"
+bool        ParseGrabStrategy(const std::string& name, GrabStrategyKind& out);
+
+// ===== 그랩 계수기 (슬롯별, 회선 대역폭 문제 확인용) =====
+struct GrabCounters
+{
+    uint64_t frames = 0;       // 받은 정상 프레임
+    uint64_t skipped = 0;      // 전략이 건너뛴 프레임 (LatestImageOnly 미리보기에선 정상, OneByOne 에선 버퍼 부족)
+    uint64_t incomplete = 0;   // 일부 패킷 유실로 불완전한 프레임 (GigE 대역폭/패킷 간격 문제)
+    uint64_t failed = 0;       // 그 밖의 그랩 실패
+    uint64_t stale = 0;        // 센서 창 전환 전 프레임이라 버림
+    uint64_t missed = 0;       // 검사 그랩 대기 시간 안에 프레임이 오지 않음
+    uint64_t resends = 0;      // GigE 스트림 재전송 요청 (스트림 그래버 통계)
+    uint64_t underruns = 0;    // 스트림 그래버 버퍼 부족
+};
+
+// "frames 1234, skipped 10, incomplete 2, failed 0, stale 3, missed 1, resend 5, underrun 0"
+std::string FormatGrabCounters(const GrabCounters& c);
+
+// ===== 검사 스테이션 (시리얼 → 역할) =====
+struct StationConfig
+{
+    std::vector<StationCamera> cameras;   // 슬롯 순서 = 그랩 결과/뷰 순서
+    int grabTimeoutMs = 800;              // 검사 1단위 그랩 대기 (모든 카메라)
+
+    // 그랩 전략: 미리보기/검사 전략이 다르면 검사 때 그랩을 다시 시작 (재시작 후 첫 프레임 = 트리거 뒤 프레임)
+    GrabStrategyKind previewStrategy = GrabStrategyKind::LatestImageOnly;
+    GrabStrategyKind inspectionStrategy = GrabStrategyKind::LatestImageOnly;
+    int maxNumBuffer = 0;                 // 카메라별 그랩 버퍼 수 (0 = Pylon 기본 10)
+    int outputQueueSize = 0;              // LatestImages 출력 큐 길이 (0 = Pylon 기본)
+
+    // 프레임 타임스탬프: 청크 모드 (카메라 타임스탬프/프레임·트리거 계수기) + 카메라 시계 → 호스트 시계 보정 주기
+    bool chunks = true;
+    int  clockCalibrationS = 10;          // 0 = 열 때 한 번만
+
+    StationConfig();                      // 기본: top, front (시리얼 미지정)
+
+    int Find(CameraRole role) const;      // 슬롯 번호, 없으면 -1
+};
+
+// 설정 검사: 카메라 1대 이상, 역할/시리얼 중복 없음. 실패 시 error 에 이유.
+bool ValidateStation(const StationConfig& station, std::string* error = nullptr);
+
+// 열거된 장치 시리얼 → 슬롯 배정 (slotDevice[슬롯] = 장치 인덱스).
+// 시리얼을 지정한 슬롯을 먼저 맞추고, 미지정 슬롯은 남은 장치를 열거 순서대로 채운다.
+// 지정한 시리얼이 없거나 장치가 모자라면 false + error.
+bool AssignStationDevices(const StationConfig& station, const std::vector<std::string>& serials,
+                          std::vector<size_t>& slotDevice, std::string* error = nullptr);
+
+// ===== 스테이션 기동 시간 (단계별) =====
+// 다이얼로그는 먼저 뜨고 카메라는 백그라운드에서 장치별 병렬로 열린다.
+struct StationStartup
+{
+    uint64_t              initNs = 0;        // PylonInitialize
+    uint64_t              enumerateNs = 0;   // 장치 열거 + 시리얼 배정
+    std::vector<uint64_t> openNs;            // 슬롯별 CreateDevice + Open + 설정 (병렬, 0 = 실패)
+    uint64_t              openAllNs = 0;     // 병렬 열기 전체 (≈ 가장 느린 슬롯)
+    uint64_t              startGrabNs = 0;   // StartGrabbing
+    uint64_t              totalNs = 0;       // 기동 시작 → 첫 그랩 가능
+};
+
+// "startup 1234.5 ms: init .., enumerate .., open .. (top .., front ..; serial ..), grab .."
+std::string FormatStationStartup(const StationConfig& station, const StationStartup& timing);
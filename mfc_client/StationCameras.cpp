@@ -0,0 +1,694 @@
+﻿#include "pch.h"
+#include "StationCameras.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <initializer_list>
+#include <thread>
+
+#include "LatencyStats.h"
+
+using namespace Pylon;
+using namespace GenApi;
+
+// ===================== 프로파일 적용 헬퍼 (GenApi 노드) =====================
+namespace
+{
+    // 이름 후보 중 처음으로 있는 노드 (SFNC 이름 → 구형 GigE "...Abs" 이름)
+    INode* FindNode(INodeMap& nodes, std::initializer_list<const char*> names)
+    {
+        for (const char* name : names)
+            if (INode* node = nodes.GetNode(name))
+                if (IsAvailable(node))
+                    return node;
+        return nullptr;
+    }
+
+    // 범위 밖이면 가까운 값(증분 배수)으로 맞추고 경고
+    bool SetInt(INodeMap& nodes, std::initializer_list<const char*> names, int64_t value,
+                CameraProfileReport& report)
+    {
+        CIntegerPtr p(FindNode(nodes, names));
+        const std::string name = *names.begin();
+        if (!IsWritable(p)) {
+            report.warnings.push_back(name + " not supported");
+            return false;
+        }
+        const int64_t fitted = FitToRange(value, IntRange{ p->GetMin(), p->GetMax(), p->GetInc() });
+        if (fitted != value)
+            report.warnings.push_back(name + " " + std::to_string(value) + " -> " + std::to_string(fitted));
+        p->SetValue(fitted);
+        return true;
+    }
+
+    bool SetFloat(INodeMap& nodes, std::initializer_list<const char*> names, double value,
+                  CameraProfileReport& report)
+    {
+        CFloatPtr p(FindNode(nodes, names));
+        const std::string name = *names.begin();
+        if (!IsWritable(p)) {
+            report.warnings.push_back(name + " not supported");
+            return false;
+        }
+        const double fitted = (std::min)((std::max)(value, p->GetMin()), p->GetMax());
+        if (fitted != value)
+            report.warnings.push_back(name + " " + std::to_string(value) + " -> " + std::to_string(fitted));
+        p->SetValue(fitted);
+        return true;
+    }
+
+    bool SetEnum(INodeMap& nodes, const char* name, const char* value, CameraProfileReport& report)
+    {
+        CEnumerationPtr p(nodes.GetNode(name));
+        if (!IsWritable(p)) {
+            report.warnings.push_back(std::string(name) + " not supported");
+            return false;
+        }
+        IEnumEntry* entry = p->GetEntryByName(value);
+        if (!entry || !IsAvailable(entry)) {
+            report.warnings.push_back(std::string(name) + " " + value + " not supported");
+            return false;
+        }
+        p->SetIntValue(entry->GetValue());
+        return true;
+    }
+
+    int64_t ReadInt(INodeMap& nodes, const char* name, int64_t fallback)
+    {
+        CIntegerPtr p(nodes.GetNode(name));
+        return IsReadable(p) ? p->GetValue() : fallback;
+    }
+
+    // 카메라 창 쓰기: 오프셋 0 → 크기 → 오프셋 (크기 최대값이 현재 오프셋에 따라 달라짐)
+    void WriteWindow(INodeMap& nodes, const RoiRect& w)
+    {
+        CIntegerPtr(nodes.GetNode("OffsetX"))->SetValue(0);
+        CIntegerPtr(nodes.GetNode("OffsetY"))->SetValue(0);
+        CIntegerPtr(nodes.GetNode("Width"))->SetValue(w.width);
+        CIntegerPtr(nodes.GetNode("Height"))->SetValue(w.height);
+        CIntegerPtr(nodes.GetNode("OffsetX"))->SetValue(w.x);
+        CIntegerPtr(nodes.GetNode("OffsetY"))->SetValue(w.y);
+    }
+
+    bool SameRect(const RoiRect& a, const RoiRect& b)
+    {
+        return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+    }
+
+    std::vector<std::string> EnumEntries(INodeMap& nodes, const char* name)
+    {
+        std::vector<std::string> out;
+        CEnumerationPtr p(nodes.GetNode(name));
+        if (!IsReadable(p))
+            return out;
+        NodeList_t entries;
+        p->GetEntries(entries);
+        for (INode* node : entries) {
+            CEnumEntryPtr e(node);
+            if (IsAvailable(e))
+                out.emplace_back(e->GetSymbolic().c_str());
+        }
+        return out;
+    }
+}
+
+// ===================== 프로파일 적용 (열린 직후, 그랩 전) =====================
+// 항목마다 카메라 범위로 검증/조정하고 실패는 경고로 남긴 채 다음 항목으로 (카메라는 계속 사용).
+void CStationCameras::ApplyProfile(CInstantCamera& camera, const CameraProfile& profile,
+                                   CameraProfileReport& report)
+{
+    INodeMap& nodes = camera.GetNodeMap();
+    auto guarded = [&report](const char* what, auto&& fn) {
+        try { fn(); }
+        catch (const GenericException& e) { report.warnings.push_back(std::string(what) + ": " + e.GetDescription()); }
+    };
+
+    if (!profile.IsEmpty())
+    {
+        // 1) 비닝 (ROI 범위가 바뀌므로 먼저)
+        if (profile.binning > 0)
+            guarded("binning", [&] {
+                SetInt(nodes, { "BinningHorizontal" }, profile.binning, report);
+                SetInt(nodes, { "BinningVertical" }, profile.binning, report);
+            });
+
+        // 2) 센서 ROI: 오프셋 0 → 크기 → 오프셋 (크기 최대값이 현재 오프셋에 따라 달라짐)
+        if (!profile.sensorRoi.IsEmpty())
+            guarded("roi", [&] {
+                const RoiRect r = BinnedRoi(profile.sensorRoi, profile.binning);
+                SetInt(nodes, { "OffsetX" }, 0, report);
+                SetInt(nodes, { "OffsetY" }, 0, report);
+                SetInt(nodes, { "Width" }, r.width, report);
+                SetInt(nodes, { "Height" }, r.height, report);
+                SetInt(nodes, { "OffsetX" }, r.x, report);
+                SetInt(nodes, { "OffsetY" }, r.y, report);
+            });
+
+        // 3) 픽셀 형식 ("auto" = 카메라가 지원하는 것 중 변환 비용 최소)
+        if (!profile.pixelFormat.empty())
+            guarded("pixel format", [&] {
+                std::string format = profile.pixelFormat;
+                if (format == "auto") {
+                    format = ChoosePixelFormat(EnumEntries(nodes, "PixelFormat"));
+                    if (format.empty())
+                        report.warnings.push_back("PixelFormat auto: no directly converted format");
+                }
+                if (!format.empty())
+                    SetEnum(nodes, "PixelFormat", format.c_str(), report);
+            });
+
+        // 4) GigE 패킷 크기 / 패킷 간격 (USB 카메라에는 노드가 없음 → 경고만)
+        if (profile.packetSize > 0)
+            guarded("packet size", [&] { SetInt(nodes, { "GevSCPSPacketSize" }, profile.packetSize, report); });
+        if (profile.interPacketDelay >= 0)
+            guarded("inter-packet delay", [&] { SetInt(nodes, { "GevSCPD" }, profile.interPacketDelay, report); });
+
+        // 5) 노출 / 게인 (자동 끄고 고정값)
+        if (profile.exposureUs > 0.0)
+            guarded("exposure", [&] {
+                if (IsWritable(nodes.GetNode("ExposureAuto")))
+                    SetEnum(nodes, "ExposureAuto", "Off", report);
+                SetFloat(nodes, { "ExposureTime", "ExposureTimeAbs" }, profile.exposureUs, report);
+            });
+        if (profile.gainDb >= 0.0)
+            guarded("gain", [&] {
+                if (IsWritable(nodes.GetNode("GainAuto")))
+                    SetEnum(nodes, "GainAuto", "Off", report);
+                SetFloat(nodes, { "Gain" }, profile.gainDb, report);   // 구형 GigE 는 GainRaw(정수)만 → 경고
+            });
+
+        // 6) 프레임 속도 상한
+        if (profile.frameRate > 0.0)
+            guarded("frame rate", [&] {
+                CBooleanPtr enable(nodes.GetNode("AcquisitionFrameRateEnable"));
+                if (IsWritable(enable))
+                    enable->SetValue(true);
+                SetFloat(nodes, { "AcquisitionFrameRate", "AcquisitionFrameRateAbs" }, profile.frameRate, report);
+            });
+    }
+
+    // ===== 적용 결과 (프로파일이 없어도 기록) =====
+    guarded("report", [&] {
+        CIntegerPtr width(nodes.GetNode("Width"));
+        CIntegerPtr height(nodes.GetNode("Height"));
+        CIntegerPtr payload(nodes.GetNode("PayloadSize"));
+        CEnumerationPtr format(nodes.GetNode("PixelFormat"));
+        CFloatPtr fps(FindNode(nodes, { "ResultingFrameRate", "ResultingFrameRateAbs" }));
+        if (IsReadable(width))   report.width = static_cast<int>(width->GetValue());
+        if (IsReadable(height))  report.height = static_cast<int>(height->GetValue());
+        if (IsReadable(payload)) report.payloadBytes = payload->GetValue();
+        if (IsReadable(format))  report.pixelFormat = format->ToString().c_str();
+        if (IsReadable(fps))     report.cameraFps = fps->GetValue();
+    });
+}
+
+// ===================== 센서 창 준비 (프로파일 적용 직후, 그랩 전) =====================
+// 두 창을 카메라 증분/범위에 맞춰 계산하고, 검사 창의 프레임당 바이트를 재 둔 뒤 미리보기 창으로.
+void CStationCameras::PrepareWindow(CInstantCamera& camera, const StationCamera& cam,
+                                    SlotWindow& window, CameraProfileReport& report)
+{
+    window = SlotWindow();
+    if (!cam.sensorCrop || cam.roi.IsEmpty())
+        return;
+
+    INodeMap& nodes = camera.GetNodeMap();
+    CIntegerPtr width(nodes.GetNode("Width"));
+    CIntegerPtr height(nodes.GetNode("Height"));
+    CIntegerPtr offsetX(nodes.GetNode("OffsetX"));
+    CIntegerPtr offsetY(nodes.GetNode("OffsetY"));
+    if (!IsWritable(width) || !IsWritable(height) || !IsWritable(offsetX) || !IsWritable(offsetY)) {
+        report.warnings.push_back("sensor_crop: camera window not writable");
+        return;
+    }
+
+    SensorLimits limits;
+    limits.maxW = static_cast<int>(ReadInt(nodes, "WidthMax", width->GetMax()));
+    limits.maxH = static_cast<int>(ReadInt(nodes, "HeightMax", height->GetMax()));
+    limits.incW = static_cast<int>(width->GetInc());
+    limits.incH = static_cast<int>(height->GetInc());
+    // 베이어 배치가 바뀌지 않도록 오프셋은 짝수
+    limits.incX = (std::max)(2, static_cast<int>(offsetX->GetInc()));
+    limits.incY = (std::max)(2, static_cast<int>(offsetY->GetInc()));
+
+    window.binning = static_cast<int>(ReadInt(nodes, "BinningHorizontal", 1));
+    window.inspection = AlignSensorWindow(cam.roi, window.binning, limits);
+    window.preview = AlignSensorWindow(cam.previewRoi, window.binning, limits);
+
+    try {
+        WriteWindow(nodes, window.inspection);
+        report.inspectionBytes = ReadInt(nodes, "PayloadSize", 0);
+        WriteWindow(nodes, window.preview);
+        report.payloadBytes = ReadInt(nodes, "PayloadSize", 0);
+        report.width = window.preview.width;
+        report.height = window.preview.height;
+        window.current = window.preview;
+        window.enabled = true;
+    }
+    catch (const GenericException& e) {
+        report.warnings.push_back(std::string("sensor_crop: ") + e.GetDescription());
+        report.inspectionBytes = 0;
+    }
+}
+
+// ===================== 청크 데이터 (프레임마다 카메라 타임스탬프/계수기) =====================
+// GigE ace: Timestamp / Framecounter / Triggerinputcounter / FrameTriggerIgnoredCounter
+// USB ace:  Timestamp / CounterValue (Counter1 = 프레임 트리거, Counter2 = 프레임 시작)
+// 카메라에 없는 항목은 건너뛰고, 타임스탬프가 없으면 경고 (그랩 결과 타임스탬프로 대신).
+bool CStationCameras::EnableChunks(CInstantCamera& camera, CameraProfileReport& report)
+{
+    INodeMap& nodes = camera.GetNodeMap();
+    try {
+        CBooleanPtr active(nodes.GetNode("ChunkModeActive"));
+        CEnumerationPtr selector(nodes.GetNode("ChunkSelector"));
+        CBooleanPtr enable(nodes.GetNode("ChunkEnable"));
+        if (!IsWritable(active) || !IsWritable(selector)) {
+            report.warnings.push_back("ChunkModeActive not supported");
+            return false;
+        }
+        active->SetValue(true);
+
+        bool timestamp = false;
+        static const char* const kChunks[] = {
+            "Timestamp", "Framecounter", "FrameID", "Triggerinputcounter", "FrameTriggerIgnoredCounter", "CounterValue",
+        };
+        for (const char* name : kChunks)
+        {
+            IEnumEntry* entry = selector->GetEntryByName(name);
+            if (!entry || !IsAvailable(entry))
+                continue;
+            selector->SetIntValue(entry->GetValue());
+            if (IsWritable(enable)) {
+                enable->SetValue(true);
+                timestamp = timestamp || std::string(name) == "Timestamp";
+            }
+        }
+        if (!timestamp)
+            report.warnings.push_back("Timestamp chunk not supported");
+        return true;
+    }
+    catch (const GenericException& e) {
+        report.warnings.push_back(std::string("chunks: ") + e.GetDescription());
+        return false;
+    }
+}
+
+FrameStamp CStationCameras::ReadStamp(size_t slot, const CGrabResultPtr& grab) const
+{
+    FrameStamp stamp;
+    stamp.arrivalNs = NowNs();
+    try {
+        if (m_chunks[slot] && grab->IsChunkDataAvailable())
+        {
+            INodeMap& chunks = grab->GetChunkDataNodeMap();
+            auto read = [&chunks](std::initializer_list<const char*> names) -> int64_t {
+                CIntegerPtr p(FindNode(chunks, names));
+                return IsReadable(p) ? p->GetValue() : -1;
+            };
+            const int64_t ts = read({ "ChunkTimestamp" });
+            if (ts > 0)
+                stamp.cameraTicks = static_cast<uint64_t>(ts);
+            stamp.frameCounter = read({ "ChunkFramecounter", "ChunkFrameID" });
+            stamp.triggerCounter = read({ "ChunkTriggerinputcounter" });
+            stamp.triggerIgnored = read({ "ChunkFrameTriggerIgnoredCounter" });
+
+            // USB: 카운터 값 하나를 선택자로 나눠 읽음
+            CEnumerationPtr counter(chunks.GetNode("ChunkCounterSelector"));
+            CIntegerPtr value(chunks.GetNode("ChunkCounterValue"));
+            if (IsWritable(counter) && IsReadable(value)) {
+                counter->FromString("Counter1");
+                stamp.triggerCounter = value->GetValue();
+                if (stamp.frameCounter < 0) {
+                    counter->FromString("Counter2");
+                    stamp.frameCounter = value->GetValue();
+                }
+            }
+        }
+    }
+    catch (const GenericException&) {
+        // 청크 파싱 실패 → 그랩 결과 값으로
+    }
+    if (stamp.cameraTicks == 0)
+        stamp.cameraTicks = grab->GetTimeStamp();   // GigE 스트림 리더 / USB 전송 타임스탬프 (0 = 없음)
+    stamp.hostNs = m_clocks[slot].ToHostNs(stamp.cameraTicks);
+    return stamp;
+}
+
+// ===================== 카메라 시계 보정 =====================
+// 래치 명령 왕복을 5번 재서 가장 짧은 것으로 (왕복이 길면 래치 시점이 불확실).
+bool CStationCameras::CalibrateSlot(size_t slot)
+{
+    INodeMap& nodes = m_cameras[slot].GetNodeMap();
+    CCommandPtr latch(FindNode(nodes, { "TimestampLatch", "GevTimestampControlLatch" }));
+    CIntegerPtr value(FindNode(nodes, { "TimestampLatchValue", "GevTimestampValue" }));
+    if (!IsWritable(latch) || !IsReadable(value))
+        return false;
+
+    CCameraClock& clock = m_clocks[slot];
+    clock.Begin();
+    for (int i = 0; i < 5; ++i)
+    {
+        const uint64_t before = NowNs();
+        latch->Execute();
+        const uint64_t after = NowNs();
+        clock.AddSample(before, static_cast<uint64_t>(value->GetValue(false, true)), after);   // 캐시 무시
+    }
+    return clock.Commit();
+}
+
+void CStationCameras::CalibrateClocks(bool force)
+{
+    if (!IsOpen())
+        return;
+    const uint64_t period = static_cast<uint64_t>((std::max)(m_station.clockCalibrationS, 0)) * 1000000000ull;
+    if (!force && period == 0)
+        return;
+    const uint64_t now = NowNs();
+    for (size_t s = 0; s < Count(); ++s)
+    {
+        const CCameraClock& clock = m_clocks[s];
+        if (!force && clock.Calibrated() && now - clock.LastCalibrationNs() < period)
+            continue;
+        try {
+            CalibrateSlot(s);
+        }
+        catch (const GenericException& e) {
+            ++m_retrieveErrors;
+            m_lastError = std::string("clock: ") + e.GetDescription();
+        }
+    }
+}
+
+// ===================== 미리보기 ↔ 검사 전환 =====================
+void CStationCameras::SetMode(Mode mode)
+{
+    if (mode == m_mode)
+        return;
+    m_mode = mode;
+
+    const GrabStrategyKind strategy =
+        mode == Mode::Inspection ? m_station.inspectionStrategy : m_station.previewStrategy;
+    const bool restart = strategy != m_strategy && m_cameras.IsGrabbing();
+
+    std::vector<size_t> pending;   // 그랩 중 못 바꾼 슬롯 (또는 어차피 재시작)
+    for (size_t s = 0; s < m_windows.size(); ++s)
+    {
+        SlotWindow& w = m_windows[s];
+        if (!w.enabled) continue;
+        const RoiRect& target = mode == Mode::Inspection ? w.inspection : w.preview;
+        if (SameRect(target, w.current)) continue;
+        if (restart) {
+            pending.push_back(s);
+            continue;
+        }
+
+        INodeMap& nodes = m_cameras[s].GetNodeMap();
+        CIntegerPtr offsetX(nodes.GetNode("OffsetX"));
+        CIntegerPtr offsetY(nodes.GetNode("OffsetY"));
+        const bool sameSize = target.width == w.current.width && target.height == w.current.height;
+        if (sameSize && IsWritable(offsetX) && IsWritable(offsetY)) {
+            // 같은 크기 → 오프셋만 (대부분 그랩 중에도 허용, 버퍼 크기 그대로)
+            offsetX->SetValue(target.x);
+            offsetY->SetValue(target.y);
+            w.current = target;
+        }
+        else if (IsWritable(nodes.GetNode("Width")) && IsWritable(nodes.GetNode("Height"))) {
+            WriteWindow(nodes, target);
+            w.current = target;
+        }
+        else
+            pending.push_back(s);
+    }
+
+    if (pending.empty() && !restart)
+        return;
+
+    // 크기 변경이 잠겨 있거나 (TLParamsLocked) 전략이 바뀜 → 배열 그랩을 멈추고 한꺼번에
+    const bool grabbing = m_cameras.IsGrabbing();
+    if (grabbing)
+        m_cameras.StopGrabbing();
+    for (size_t s : pending) {
+        SlotWindow& w = m_windows[s];
+        const RoiRect& target = mode == Mode::Inspection ? w.inspection : w.preview;
+        WriteWindow(m_cameras[s].GetNodeMap(), target);
+        w.current = target;
+    }
+    if (grabbing)
+        StartGrabbing(strategy);
+}
+
+void CStationCameras::StartGrabbing(GrabStrategyKind strategy)
+{
+    static const EGrabStrategy kPylon[] = {
+        GrabStrategy_LatestImageOnly, GrabStrategy_OneByOne, GrabStrategy_LatestImages, GrabStrategy_UpcomingImage,
+    };
+    m_cameras.StartGrabbing(kPylon[static_cast<size_t>(strategy)]);
+    m_strategy = strategy;
+}
+
+RoiRect CStationCameras::FrameRoi(size_t slot) const
+{
+    const StationCamera& cam = m_station.cameras[slot];
+    if (slot >= m_windows.size() || !m_windows[slot].enabled)
+        return cam.roi;
+    const SlotWindow& w = m_windows[slot];
+    return RoiInWindow(cam.roi, w.binning, w.current);
+}
+
+std::string CStationCameras::StatusReport()
+{
+    std::string text;
+    for (size_t s = 0; s < Count() && s < m_reports.size(); ++s)
+    {
+        // GigE 스트림 그래버 통계 (USB 는 노드가 없음 → 0)
+        GrabCounters& c = m_counters[s];
+        if (m_cameras[s].IsOpen()) {
+            INodeMap& stream = m_cameras[s].GetStreamGrabberNodeMap();
+            c.resends = static_cast<uint64_t>(ReadInt(stream, "Statistic_Resend_Request_Count", 0));
+            c.underruns = static_cast<uint64_t>(ReadInt(stream, "Statistic_Buffer_Underrun_Count", 0));
+        }
+        text += FormatProfileReport(CameraRoleName(Role(s)), m_reports[s], m_rates[s].fps) + "\n";
+        text += "       " + FormatGrabCounters(c) + "\n";
+        if (m_clocks[s].Calibrated()) {
+            char clock[96];
+            std::snprintf(clock, sizeof(clock), "       clock \xC2\xB1%.2f ms, drift %.1f ppm, %.0f s ago\n",
+                m_clocks[s].UncertaintyNs() / 1e6, m_clocks[s].DriftPpm(),
+                (NowNs() - m_clocks[s].LastCalibrationNs()) / 1e9);
+            text += clock;
+        }
+    }
+    if (m_retrieveErrors)
+        text += "grab errors " + std::to_string(m_retrieveErrors) + " (last: " + m_lastError + ")\n";
+    return text;
+}
+
+// ===================== 열기 =====================
+bool CStationCameras::Open(const StationConfig& station, StationStartup* timing,
+                           SlotOpenedFn onSlot, std::string* error)
+{
+    Close();
+
+    StationStartup local;
+    StationStartup& t = timing ? *timing : local;
+    const size_t n = station.cameras.size();
+
+    try {
+        uint64_t phase = NowNs();
+        CTlFactory& factory = CTlFactory::GetInstance();
+        DeviceInfoList_t devices;
+        factory.EnumerateDevices(devices);
+
+        std::vector<std::string> serials;
+        for (size_t d = 0; d < devices.size(); ++d)
+            serials.emplace_back(devices[d].GetSerialNumber().c_str());
+
+        std::vector<size_t> slotDevice;
+        const bool assigned = AssignStationDevices(station, serials, slotDevice, error);
+        t.enumerateNs = NowNs() - phase;
+        if (!assigned)
+            return false;
+
+        m_station = station;
+        m_serials.clear();
+        for (size_t s = 0; s < n; ++s)
+            m_serials.push_back(serials[slotDevice[s]]);
+        m_cameras.Initialize(n);
+        m_reports.assign(n, CameraProfileReport());
+        m_rates.assign(n, RateMeter());
+        m_windows.assign(n, SlotWindow());
+        m_counters.assign(n, GrabCounters());
+        m_clocks.assign(n, CCameraClock());
+        m_chunks.assign(n, 0);
+        m_retrieveErrors = 0;
+        m_mode = Mode::Preview;
+
+        // ===== 슬롯별 병렬 열기 (장치마다 독립 → 스레드 하나씩) =====
+        phase = NowNs();
+        t.openNs.assign(n, 0);
+        std::vector<std::string> failures(n);
+        std::vector<std::thread> workers;
+        for (size_t s = 0; s < n; ++s)
+        {
+            workers.emplace_back([&, s] {
+                const uint64_t start = NowNs();
+                try {
+                    m_cameras[s].Attach(factory.CreateDevice(devices[slotDevice[s]]));
+                    m_cameras[s].SetCameraContext(static_cast<intptr_t>(s));
+                    m_cameras[s].Open();
+                    ApplyProfile(m_cameras[s], station.cameras[s].profile, m_reports[s]);
+                    // 청크는 PayloadSize 를 바꾸므로 창 준비(페이로드 기록) 전에
+                    if (station.chunks)
+                        m_chunks[s] = EnableChunks(m_cameras[s], m_reports[s]) ? 1 : 0;
+                    PrepareWindow(m_cameras[s], station.cameras[s], m_windows[s], m_reports[s]);
+                    // 그랩 버퍼 (StartGrabbing 때 할당, OneByOne 에서 밀린 프레임을 담는 깊이)
+                    if (station.maxNumBuffer > 0)
+                        m_cameras[s].MaxNumBuffer.SetValue(station.maxNumBuffer);
+                    if (station.outputQueueSize > 0)
+                        m_cameras[s].OutputQueueSize.SetValue(station.outputQueueSize);
+                    // 카메라 시계: GigE 는 틱 주파수 노드 (ace 125 MHz), USB 는 ns
+                    INodeMap& nodes = m_cameras[s].GetNodeMap();
+                    m_clocks[s].SetTickFrequency(static_cast<double>(ReadInt(nodes, "GevTimestampTickFrequency", 1000000000)));
+                    if (!CalibrateSlot(s))
+                        m_reports[s].warnings.push_back("timestamp latch not supported (no host time)");
+                    t.openNs[s] = NowNs() - start;
+                }
+                catch (const GenericException& e) {
+                    failures[s] = std::string(CameraRoleName(station.cameras[s].role)) + " (" +
+                        m_serials[s] + "): " + e.GetDescription();
+                }
+                if (onSlot)
+                    onSlot(s, failures[s].empty());
+            });
+        }
+        for (std::thread& w : workers)
+            w.join();
+        t.openAllNs = NowNs() - phase;
+
+        for (const std::string& f : failures)
+            if (!f.empty()) {
+                if (error) *error = "camera open failed: " + f;
+                Close();
+                return false;
+            }
+
+        // 미리보기 전략으로 시작 (기본: 카메라마다 최신 프레임만 유지)
+        phase = NowNs();
+        StartGrabbing(station.previewStrategy);
+        t.startGrabNs = NowNs() - phase;
+        return true;
+    }
+    catch (const GenericException& e) {
+        if (error) *error = e.GetDescription();
+        Close();
+        return false;
+    }
+}
+
+void CStationCameras::Close()
+{
+    if (m_cameras.GetSize() == 0)
+        return;
+    if (m_cameras.IsGrabbing()) m_cameras.StopGrabbing();
+    // 열기 도중 실패한 경우 붙지 않은 슬롯이 섞여 있으므로 하나씩
+    for (size_t s = 0; s < m_cameras.GetSize(); ++s)
+        if (m_cameras[s].IsPylonDeviceAttached() && m_cameras[s].IsOpen())
+            m_cameras[s].Close();
+    m_cameras.DestroyDevice();
+    m_cameras.Initialize(0);
+}
+
+void CStationCameras::EnsureGrabbing()
+{
+    if (m_cameras.GetSize() == 0)
+        return;
+    if (!m_cameras.IsOpen())
+        m_cameras.Open();
+    if (!m_cameras.IsGrabbing())
+        StartGrabbing(m_mode == Mode::Inspection ? m_station.inspectionStrategy : m_station.previewStrategy);
+}
+
+// ===================== 검사 단위 그랩 =====================
+size_t CStationCameras::GrabUnit(unsigned timeoutMs, std::vector<CGrabResultPtr>& out,
+                                 std::vector<FrameStamp>* stamps)
+{
+    const size_t n = Count();
+    out.assign(n, CGrabResultPtr());
+    if (stamps)
+        stamps->assign(n, FrameStamp());
+    if (!IsGrabbing())
+        return 0;
+
+    // 배열 RetrieveResult 는 카메라를 돌아가며 꺼내 준다 → 컨텍스트(슬롯)로 분류
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    size_t filled = 0;
+    while (filled < n)
+    {
+        const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+        if (left <= 0)
+            break;
+
+        CGrabResultPtr grab;
+        try {
+            if (!m_cameras.RetrieveResult(static_cast<unsigned>(left), grab, TimeoutHandling_Return))
+                break;
+        }
+        catch (const GenericException& e) {
+            ++m_retrieveErrors;
+            m_lastError = e.GetDescription();
+            break;
+        }
+
+        const size_t slot = static_cast<size_t>(grab->GetCameraContext());
+        if (slot >= n)
+            continue;
+        GrabCounters& c = m_counters[slot];
+
+        if (!grab->GrabSucceeded()) {
+            // GigE 0xE1000014 = 패킷 유실로 버퍼가 다 채워지지 않음 (대역폭/패킷 간격 문제)
+            const std::string why = grab->GetErrorDescription().c_str();
+            if (grab->GetErrorCode() == 0xE1000014u || why.find("ncomplete") != std::string::npos)
+                ++c.incomplete;
+            else
+                ++c.failed;
+            continue;
+        }
+        c.skipped += grab->GetNumberOfSkippedImages();
+
+        // 창 전환 전에 찍힌 프레임 (오프셋/크기가 현재 창과 다름)은 버림
+        const SlotWindow& w = m_windows[slot];
+        if (w.enabled &&
+            (static_cast<int>(grab->GetOffsetX()) != w.current.x || static_cast<int>(grab->GetOffsetY()) != w.current.y ||
+             static_cast<int>(grab->GetWidth()) != w.current.width || static_cast<int>(grab->GetHeight()) != w.current.height)) {
+            ++c.stale;
+            continue;
+        }
+        ++c.frames;
+        if (!out[slot].IsValid())
+            ++filled;
+
+        // 실제 fps: 1초 이상 모이면 갱신
+        RateMeter& rate = m_rates[slot];
+        const int64_t number = grab->GetImageNumber();
+        const uint64_t now = NowNs();
+        if (rate.startNumber < 0 || number < rate.startNumber) {
+            rate.startNumber = number;
+            rate.startNs = now;
+        }
+        else if (now - rate.startNs >= 1000000000ull) {
+            rate.fps = (number - rate.startNumber) * 1e9 / (now - rate.startNs);
+            rate.startNumber = number;
+            rate.startNs = now;
+        }
+        out[slot] = grab;   // 같은 슬롯이 또 오면 더 새 프레임으로
+        if (stamps)
+            (*stamps)[slot] = ReadStamp(slot, grab);
+    }
+
+    // 검사 그랩에서 못 받은 슬롯 (미리보기 50ms 대기는 느린 카메라면 흔하므로 세지 않음)
+    if (m_mode == Mode::Inspection)
+        for (size_t s = 0; s < n; ++s)
+            if (!out[s].IsValid())
+                ++m_counters[s].missed;
+    return filled;
+}
@@ -0,0 +1,112 @@
+﻿#pragma once
+#include <pylon/PylonIncludes.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "CameraClock.h"
+#include "Station.h"
+
+// ===== 검사 스테이션 카메라 N대 (Pylon CInstantCameraArray) =====
+// 설정의 시리얼 → 역할로 장치를 슬롯에 배정하고, 모든 카메라를 한 배열로 동시에 그랩한다.
+// 슬롯 i 의 카메라 컨텍스트 = i → 그랩 결과가 어느 역할인지 GetCameraContext 로 안다.
+// 장치 열기는 슬롯마다 스레드 하나로 병렬 (GigE 는 장치당 수백 ms~초 → 가장 느린 카메라 시간만큼만).
+// Open 은 오래 걸리므로 UI 스레드가 아닌 기동 스레드에서 부르고, 끝날 때까지 다른 멤버를 쓰지 않는다.
+class CStationCameras
+{
+public:
+    // 미리보기 ↔ 검사: 센서 창(preview_roi ↔ roi 를 덮는 최소 창) + 그랩 전략
+    enum class Mode { Preview, Inspection };
+
+    using SlotOpenedFn = std::function<void(size_t slot, bool ok)>;
+
+    // 열거 → 배정 → 슬롯별 병렬 Open + 프로파일 + 청크 + 버퍼 수 + 시계 보정 → StartGrabbing(미리보기 전략).
+    // onSlot 은 슬롯이 열릴 때마다 (열기 스레드에서) 호출. timing 에 단계별 시간.
+    // 실패하면 열린 장치를 모두 정리하고 false + error (Pylon 예외도 여기서 잡아 error 로).
+    bool Open(const StationConfig& station, StationStartup* timing = nullptr,
+              SlotOpenedFn onSlot = nullptr, std::string* error = nullptr);
+    void Close();
+
+    bool   IsOpen() const { return m_cameras.GetSize() > 0 && m_cameras.IsOpen(); }
+    bool   IsGrabbing() const { return m_cameras.GetSize() > 0 && m_cameras.IsGrabbing(); }
+    size_t Count() const { return m_station.cameras.size(); }
+
+    CameraRole         Role(size_t slot) const { return m_station.cameras[slot].role; }
+    const RoiRect&     Roi(size_t slot) const { return m_station.cameras[slot].roi; }
+    const std::string& Serial(size_t slot) const { return m_serials[slot]; }   // 실제 장치 시리얼
+    int                SlotOf(CameraRole role) const { return m_station.Find(role); }
+
+    // 프로파일 적용 결과 (크기/형식/프레임당 바이트/카메라 fps/경고)와 실제 받은 fps
+    const CameraProfileReport& Report(size_t slot) const { return m_reports[slot]; }
+    double                     MeasuredFps(size_t slot) const { return m_rates[slot].fps; }
+    const GrabCounters&        Counters(size_t slot) const { return m_counters[slot]; }
+    std::string                StatusReport();         // 슬롯마다 2줄 (설정 결과, 그랩 계수) + 예외 (지연 표 아래)
+
+    // 닫혔거나 멈춰 있으면 다시 Open / StartGrabbing
+    void EnsureGrabbing();
+
+    // 모드 전환. 그랩 전략이 같으면 sensorCrop 슬롯의 카메라 창만: 크기가 같으면 그랩 중 오프셋만,
+    // 크기가 달라도 카메라가 그랩 중 쓰기를 허용하면 그대로, 아니면 배열 그랩을 잠깐 멈췄다 다시 시작.
+    // 전략이 다르면 멈춘 김에 창을 쓰고 새 전략으로 시작 (버퍼가 비워져 이후 프레임은 모두 전환 뒤).
+    // 전환 전 창으로 찍힌 프레임은 GrabUnit 이 버린다 (결과의 오프셋/크기로 구분).
+    void SetMode(Mode mode);
+    Mode CurrentMode() const { return m_mode; }
+
+    // 카메라 시계 보정 (래치 왕복). 열 때 한 번, 이후 clockCalibrationS 마다 (force = 주기 무시).
+    // 그랩 중에도 되지만 GigE 는 카메라당 수 ms → UI 타이머에서 검사 중이 아닐 때 부른다.
+    void CalibrateClocks(bool force = false);
+    const CCameraClock& Clock(size_t slot) const { return m_clocks[slot]; }
+
+    // 현재 창 기준 전처리 ROI (창 안 프레임 좌표, 비닝 반영). sensorCrop 이 아니면 설정 roi 그대로.
+    RoiRect FrameRoi(size_t slot) const;
+
+    // 슬롯마다 최신 성공 프레임 1장 (out[슬롯], 못 받은 슬롯은 빈 포인터).
+    // 모든 슬롯이 차거나 timeoutMs 가 지나면 반환. 반환값 = 받은 슬롯 수.
+    // 실패/불완전/건너뜀은 계수기로, RetrieveResult 예외도 여기서 잡아 계수 (호출부로 던지지 않음).
+    // stamps 를 주면 같은 슬롯 순서로 청크 타임스탬프/계수기 + 호스트 시각.
+    size_t GrabUnit(unsigned timeoutMs, std::vector<Pylon::CGrabResultPtr>& out,
+                    std::vector<FrameStamp>* stamps = nullptr);
+
+private:
+    // 이미지 번호(전략이 버린 프레임 포함) 증가량 / 시간 → 카메라가 실제로 보낸 fps
+    struct RateMeter
+    {
+        int64_t  startNumber = -1;
+        uint64_t startNs = 0;
+        double   fps = 0.0;
+    };
+
+    // 슬롯별 센서 창 (sensorCrop 일 때만 enabled)
+    struct SlotWindow
+    {
+        bool    enabled = false;
+        int     binning = 1;
+        RoiRect preview;
+        RoiRect inspection;
+        RoiRect current;     // 카메라에 마지막으로 쓴 창
+    };
+
+    static void ApplyProfile(Pylon::CInstantCamera& camera, const CameraProfile& profile,
+                             CameraProfileReport& report);
+    static bool EnableChunks(Pylon::CInstantCamera& camera, CameraProfileReport& report);
+    static void PrepareWindow(Pylon::CInstantCamera& camera, const StationCamera& cam,
+                              SlotWindow& window, CameraProfileReport& report);
+
+    void StartGrabbing(GrabStrategyKind strategy);
+    bool CalibrateSlot(size_t slot);
+    FrameStamp ReadStamp(size_t slot, const Pylon::CGrabResultPtr& grab) const;
+
+    StationConfig                    m_station;
+    Pylon::CInstantCameraArray       m_cameras;
+    std::vector<std::string>         m_serials;
+    std::vector<CameraProfileReport> m_reports;
+    std::vector<RateMeter>           m_rates;
+    std::vector<SlotWindow>          m_windows;
+    std::vector<GrabCounters>        m_counters;
+    std::vector<CCameraClock>        m_clocks;
+    std::vector<uint8_t>             m_chunks;       // 슬롯별 청크 모드 켜짐
+    uint64_t                         m_retrieveErrors = 0;
+    std::string                      m_lastError;
+    Mode                             m_mode = Mode::Preview;
+    GrabStrategyKind                 m_strategy = GrabStrategyKind::LatestImageOnly;   // 지금 그랩 중인 전략
+};
@@ -0,0 +1,82 @@
+﻿#include "ThreadPool.h"
+
+CThreadPool::CThreadPool(size_t threads)
+{
+    if (threads == 0)
+        threads = std::thread::hardware_concurrency();
+    if (threads == 0)
+        threads = 1;
+
+    for (size_t i = 1; i < threads; ++i)
+        m_workers.emplace_back(&CThreadPool::WorkerLoop, this);
+}
+
+CThreadPool::~CThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (std::thread& t : m_workers)
+        t.join();
+}
+
+void CThreadPool::RunJob()
+{
+    for (size_t i = m_next.fetch_add(1); i < m_count; i = m_next.fetch_add(1))
+        (*m_job)(i);
+}
+
+void CThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& fn)
+{
+    if (count == 0) return;
+
+    std::lock_guard<std::mutex> call(m_callMutex);
+
+    // 작업자가 없거나 일이 1개면 그냥 현재 스레드에서
+    if (m_workers.empty() || count == 1)
+    {
+        for (size_t i = 0; i < count; ++i)
+            fn(i);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_job = &fn;
+        m_count = count;
+        m_next.store(0);
+        m_pending = m_workers.size();
+        ++m_generation;
+    }
+    m_wake.notify_all();
+
+    RunJob();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_pending == 0; });
+    m_job = nullptr;
+}
+
+void CThreadPool::WorkerLoop()
+{
+    uint64_t seen = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop) return;
+            seen = m_generation;
+        }
+
+        RunJob();
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_pending == 0)
+                m_done.notify_one();
+        }
+    }
+}
@@ -0,0 +1,46 @@
+﻿#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ===== 고정 크기 작업자 풀 =====
+// ParallelFor(n, fn): fn(0..n-1) 를 작업자 + 호출 스레드가 나눠 실행하고 모두 끝날 때까지 대기.
+// 인덱스는 원자적 카운터로 동적 분배 (스트라이프/타일 크기가 달라도 균형).
+// fn 은 예외를 던지면 안 된다. ParallelFor 호출끼리는 직렬화된다.
+class CThreadPool
+{
+public:
+    // threads: 전체 병렬도 (호출 스레드 포함). 0 이면 hardware_concurrency.
+    explicit CThreadPool(size_t threads = 0);
+    ~CThreadPool();
+
+    CThreadPool(const CThreadPool&) = delete;
+    CThreadPool& operator=(const CThreadPool&) = delete;
+
+    size_t Size() const { return m_workers.size() + 1; }
+
+    void ParallelFor(size_t count, const std::function<void(size_t)>& fn);
+
+private:
+    void WorkerLoop();
+    void RunJob();
+
+    std::vector<std::thread> m_workers;
+
+    std::mutex              m_callMutex;   // ParallelFor 직렬화
+    std::mutex              m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t)>* m_job = nullptr;
+    size_t              m_count = 0;
+    std::atomic<size_t> m_next{ 0 };
+    size_t              m_pending = 0;     // 아직 이번 작업을 끝내지 않은 작업자 수
+    uint64_t            m_generation = 0;
+    bool                m_stop = false;
+};
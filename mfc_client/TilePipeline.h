@@ -0,0 +1,221 @@
+﻿#pragma once
+#include "ImageView.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CANCLIENT_SSE2 1
+#endif
+
+// ===== 타일 단위 융합 파이프라인 =====
+// 행 단위 단계들을 컴파일 타임에 묶고, 출력 행 묶음(타일) 단위로 스레드 풀에서 실행한다.
+// 단계마다 전체 프레임을 한 번씩 읽고 쓰는 대신 한 타일의 행이 캐시에 있는 동안 모든 단계를 거치므로
+// 센서 해상도 중간 영상(5MP BGR8 = 15MB)이 메모리를 오가지 않는다.
+//
+// 소스 (출력 행을 만든다. const 호출은 스레드 안전해야 함):
+//   int    Width() const, Height() const          출력 크기
+//   size_t RowFootprint() const                    출력 행 1개를 만들 때 건드리는 바이트 (타일 높이 결정용)
+//   const uint8_t* Row(int y, uint8_t* scratch) const
+//       출력 행 y (BGR8, Width()*3 바이트). scratch 에 만들어 돌려주거나,
+//       이미 메모리에 있는 행이면 그 포인터를 그대로 돌려준다 (복사 없음).
+// 단계 (출력 행 안에서 제자리 변환):
+//   void operator()(uint8_t* bgr, int width, int y) const
+//
+// 소스는 다른 소스를 감싸 합성한다: AreaDownscale<원본 변환 소스> = 변환 + 축소를 한 번에.
+namespace Tile
+{
+    constexpr size_t kTileBytes = 256 * 1024;   // 타일 1개가 건드리는 바이트 목표 (L2 안쪽)
+
+    // 비율 유지로 maxW x maxH 안에 들어가는 축소 크기 (확대 없음).
+    // 너비는 4의 배수 (24bpp DIB 행이 4바이트 정렬되도록 → StretchDIBits 에 그대로). 불가능하면 false.
+    inline bool FitSize(int srcW, int srcH, int maxW, int maxH, int& w, int& h)
+    {
+        if (srcW <= 0 || srcH <= 0 || maxW < 4 || maxH < 1)
+            return false;
+        const double s = std::min(1.0, std::min(static_cast<double>(maxW) / srcW,
+                                                static_cast<double>(maxH) / srcH));
+        w = std::max(4, static_cast<int>(srcW * s) & ~3);
+        h = std::max(1, static_cast<int>(std::lround(srcH * s)));
+        return true;
+    }
+
+    // sum[k] += row[k] (k < n), 면적 평균의 세로 누적
+    inline void AccumulateRow(uint32_t* sum, const uint8_t* row, size_t n)
+    {
+        size_t k = 0;
+#ifdef CANCLIENT_SSE2
+        const __m128i zero = _mm_setzero_si128();
+        for (; k + 16 <= n; k += 16) {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + k));
+            const __m128i lo = _mm_unpacklo_epi8(v, zero);
+            const __m128i hi = _mm_unpackhi_epi8(v, zero);
+            __m128i* s = reinterpret_cast<__m128i*>(sum + k);
+            _mm_storeu_si128(s + 0, _mm_add_epi32(_mm_loadu_si128(s + 0), _mm_unpacklo_epi16(lo, zero)));
+            _mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(lo, zero)));
+            _mm_storeu_si128(s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2), _mm_unpacklo_epi16(hi, zero)));
+            _mm_storeu_si128(s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3), _mm_unpackhi_epi16(hi, zero)));
+        }
+#endif
+        for (; k < n; ++k)
+            sum[k] += row[k];
+    }
+
+    // ===================== 소스: 이미 BGR8 인 영상 =====================
+    class ViewSource
+    {
+    public:
+        explicit ViewSource(const ImageView& view) : m_view(view) {}
+
+        int    Width() const { return m_view.width; }
+        int    Height() const { return m_view.height; }
+        size_t RowFootprint() const { return static_cast<size_t>(m_view.width) * 3; }
+
+        const uint8_t* Row(int y, uint8_t*) const { return m_view.Row(y); }
+
+    private:
+        ImageView m_view;
+    };
+
+    // ===================== 소스: 면적 평균 축소 =====================
+    // 출력 열 i = 입력 [xs[i], xs[i+1]) (정수 분할, 최소 1픽셀), 행도 같은 규칙.
+    // 입력 행은 Inner 에서 하나씩 받아 누적 → 입력 영상 전체를 만들지 않는다.
+    template <class Inner>
+    class AreaDownscale
+    {
+    public:
+        AreaDownscale(const Inner& inner, int outW, int outH)
+            : m_inner(inner), m_w(outW), m_h(outH)
+        {
+            const int srcW = m_inner.Width();
+            m_xs.resize(static_cast<size_t>(m_w) + 1);
+            for (int i = 0; i <= m_w; ++i)
+                m_xs[i] = std::min(srcW - 1, static_cast<int>(static_cast<int64_t>(i) * srcW / m_w));
+            m_xs[m_w] = srcW;
+        }
+
+        int    Width() const { return m_w; }
+        int    Height() const { return m_h; }
+        size_t RowFootprint() const
+        {
+            const size_t rowsPerOut = (static_cast<size_t>(m_inner.Height()) + m_h - 1) / m_h;
+            return rowsPerOut * m_inner.RowFootprint() + static_cast<size_t>(m_w) * 3;
+        }
+
+        const uint8_t* Row(int j, uint8_t* out) const
+        {
+            const int srcH = m_inner.Height();
+            const int y0 = std::min(srcH - 1, static_cast<int>(static_cast<int64_t>(j) * srcH / m_h));
+            const int y1 = std::max(y0 + 1, static_cast<int>(static_cast<int64_t>(j + 1) * srcH / m_h));
+
+            // 세로로 먼저 더하고 (행 전체 연속 덧셈, SIMD) 출력 행마다 가로 구간을 한 번 합산
+            thread_local std::vector<uint32_t> colSum;
+            thread_local std::vector<uint8_t>  line;
+            const size_t rowLen = static_cast<size_t>(m_inner.Width()) * 3;
+            colSum.assign(rowLen, 0u);
+            line.resize(rowLen);
+
+            uint32_t* sum = colSum.data();
+            for (int y = y0; y < y1; ++y)
+                AccumulateRow(sum, m_inner.Row(y, line.data()), rowLen);
+
+            for (int i = 0; i < m_w; ++i) {
+                const int x0 = m_xs[i];
+                const int x1 = std::max(x0 + 1, m_xs[i + 1]);
+                uint32_t b = 0, g = 0, r = 0;
+                for (const uint32_t* p = sum + x0 * 3, *end = sum + x1 * 3; p < end; p += 3) {
+                    b += p[0]; g += p[1]; r += p[2];
+                }
+                const uint32_t n = static_cast<uint32_t>((y1 - y0) * std::max(1, m_xs[i + 1] - x0));
+                out[i * 3 + 0] = static_cast<uint8_t>((b + n / 2) / n);
+                out[i * 3 + 1] = static_cast<uint8_t>((g + n / 2) / n);
+                out[i * 3 + 2] = static_cast<uint8_t>((r + n / 2) / n);
+            }
+            return out;
+        }
+
+    private:
+        Inner            m_inner;
+        int              m_w;
+        int              m_h;
+        std::vector<int> m_xs;
+    };
+
+    // ===================== 단계: 채널별 LUT (화이트 밸런스 / 감마 / 대비) =====================
+    struct ChannelLut
+    {
+        uint8_t b[256], g[256], r[256];
+
+        // 채널 이득 + 감마 (값 = 255 * (v/255 * gain)^(1/gamma), 포화)
+        static ChannelLut GainGamma(double gainB, double gainG, double gainR, double gamma = 1.0)
+        {
+            ChannelLut lut;
+            const double inv = gamma > 0.0 ? 1.0 / gamma : 1.0;
+            const double gains[3] = { gainB, gainG, gainR };
+            uint8_t* tables[3] = { lut.b, lut.g, lut.r };
+            for (int c = 0; c < 3; ++c)
+                for (int v = 0; v < 256; ++v) {
+                    const double x = std::min(1.0, v / 255.0 * gains[c]);
+                    tables[c][v] = static_cast<uint8_t>(std::lround(255.0 * std::pow(x, inv)));
+                }
+            return lut;
+        }
+
+        void operator()(uint8_t* p, int width, int) const
+        {
+            for (const uint8_t* end = p + static_cast<size_t>(width) * 3; p < end; p += 3) {
+                p[0] = b[p[0]];
+                p[1] = g[p[1]];
+                p[2] = r[p[2]];
+            }
+        }
+    };
+
+    // ===================== 실행 =====================
+    // dst 를 소스 크기로 잡고, 타일마다 소스 → 단계들을 행 단위로 적용.
+    // 타일 높이는 RowFootprint 기준 kTileBytes, 작업자마다 타일 2개 이상 (동적 분배로 균형).
+    // pool 이 nullptr 이면 호출 스레드에서 순서대로.
+    template <class Source, class... Stages>
+    void Run(const Source& src, ImageBuffer& dst, CThreadPool* pool, const Stages&... stages)
+    {
+        const int w = src.Width();
+        const int h = src.Height();
+        if (w <= 0 || h <= 0) {
+            dst.Allocate(0, 0);
+            return;
+        }
+        dst.Allocate(w, h);
+
+        const size_t threads = pool ? pool->Size() : 1;
+        const size_t footprint = std::max<size_t>(1, src.RowFootprint());
+        int rows = static_cast<int>(std::min<size_t>(std::max<size_t>(kTileBytes / footprint, 1), h));
+        if (threads > 1)
+            rows = std::min(rows, std::max(1, static_cast<int>(h / (threads * 2))));
+        const size_t tiles = (static_cast<size_t>(h) + rows - 1) / rows;
+        const size_t rowBytes = static_cast<size_t>(w) * 3;
+
+        auto tile = [&](size_t t) {
+            const int y0 = static_cast<int>(t) * rows;
+            const int y1 = std::min(h, y0 + rows);
+            for (int y = y0; y < y1; ++y) {
+                uint8_t* out = dst.Row(y);
+                const uint8_t* p = src.Row(y, out);
+                if (p != out)
+                    std::memcpy(out, p, rowBytes);
+                (stages(out, w, y), ...);
+            }
+        };
+
+        if (pool && tiles > 1)
+            pool->ParallelFor(tiles, tile);
+        else
+            for (size_t t = 0; t < tiles; ++t)
+                tile(t);
+    }
+}
@@ -25,6 +25,8 @@
 #define IDC_STATIC_RATE                 1013
 #define IDC_IMG_LEFT                    1014
 #define IDC_IMG_RIGHT                   1015
+#define IDC_CHK_AUTO                    1016
+#define IDC_EDIT_LATENCY                1017
 
 // Next default values for new objects
 // 
@@ -32,7 +34,7 @@
 #ifndef APSTUDIO_READONLY_SYMBOLS
 #define _APS_NEXT_RESOURCE_VALUE        132
 #define _APS_NEXT_COMMAND_VALUE         32771
-#define _APS_NEXT_CONTROL_VALUE         1016
+#define _APS_NEXT_CONTROL_VALUE         1018
 #define _APS_NEXT_SYMED_VALUE           101
 #endif
 #endif
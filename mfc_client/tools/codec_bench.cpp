@@ -0,0 +1,226 @@
+﻿// codec_bench.cpp — 전송 코덱 벤치마크 (MFC/Pylon 비의존, Linux/Windows 공용)
+//
+// 빌드 (Linux, OpenCV 있으면 JPEG 와 PNG 디코딩 포함):
+//   g++ -std=c++17 -O2 -I.. codec_bench.cpp ../FrameSource.cpp ../ImageEncoder.cpp ../PngEncoder.cpp ../Deflate.cpp
+//       ../ThreadPool.cpp ../LatencyStats.cpp -o codec_bench -lpthread $(pkg-config --cflags --libs opencv4)
+// 빌드 (OpenCV 없이):
+//   g++ -std=c++17 -O2 -I.. codec_bench.cpp ../FrameSource.cpp ../ImageEncoder.cpp ../PngEncoder.cpp ../Deflate.cpp
+//       ../ThreadPool.cpp ../LatencyStats.cpp -o codec_bench -lpthread
+//
+// 사용:
+//   codec_bench <이미지 폴더 또는 파일...> [--reps N] [--jpeg-quality Q] [--limit N]
+//   예) codec_bench ../../datasets/can_defect/images/val
+//
+// 입력: OpenCV 빌드면 png/jpg/bmp, 항상 ppm(P6)/qoi/bgr 지원.
+// 출력: 코덱별 평균 인코딩 시간, 크기, 디코딩 시간, 무손실 여부,
+//       그리고 링크 속도별 (인코딩 + 전송 + 디코딩) 예상 시간과 최적 코덱.
+
+#include "FrameSource.h"
+#include "ImageEncoder.h"
+#include "OpenCvSupport.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double Seconds(Clock::time_point a, Clock::time_point b)
+    {
+        return std::chrono::duration<double>(b - a).count();
+    }
+
+    struct CodecTotals
+    {
+        bool   available = false;
+        bool   lossless = true;
+        bool   decodable = true;   // 이 빌드에서 디코딩 가능 (OpenCV 없으면 PNG/JPEG 불가)
+        int    images = 0;
+        double encodeSec = 0.0;
+        double decodeSec = 0.0;
+        double bytes = 0.0;
+        double pixels = 0.0;
+    };
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<fs::path> inputs;
+    int reps = 3;
+    int jpegQuality = 95;
+    size_t limit = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (a == "--reps" && i + 1 < argc)              reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--jpeg-quality" && i + 1 < argc) jpegQuality = std::atoi(argv[++i]);
+        else if (a == "--limit" && i + 1 < argc)        limit = static_cast<size_t>(std::atoi(argv[++i]));
+        else                                            inputs.emplace_back(a);
+    }
+    if (inputs.empty())
+    {
+        std::fprintf(stderr, "usage: codec_bench <dir|file>... [--reps N] [--jpeg-quality Q] [--limit N]\n");
+        return 2;
+    }
+
+    // ===== 입력 파일 수집 =====
+    std::vector<fs::path> files;
+    for (const fs::path& in : inputs)
+    {
+        std::error_code ec;
+        if (fs::is_directory(in, ec))
+        {
+            for (const auto& e : fs::recursive_directory_iterator(in, ec))
+                if (e.is_regular_file() && IsImageFileName(e.path().string()))
+                    files.push_back(e.path());
+        }
+        else if (fs::is_regular_file(in, ec))
+        {
+            files.push_back(in);
+        }
+    }
+    std::sort(files.begin(), files.end());
+    if (limit > 0 && files.size() > limit)
+        files.resize(limit);
+    if (files.empty())
+    {
+        std::fprintf(stderr, "no images found\n");
+        return 1;
+    }
+
+    // ===== 코덱 준비 =====
+    constexpr size_t kCodecs = static_cast<size_t>(ImageCodec::Count);
+    std::unique_ptr<IImageEncoder> encoders[kCodecs];
+    CodecTotals totals[kCodecs];
+    for (size_t c = 0; c < kCodecs; ++c)
+    {
+        encoders[c] = CreateImageEncoder(static_cast<ImageCodec>(c), jpegQuality);
+        totals[c].available = encoders[c] != nullptr;
+    }
+
+    // ===== 측정 =====
+    ImageBuffer img, decoded;
+    std::vector<uint8_t> encoded;
+    size_t loaded = 0;
+
+    for (const fs::path& f : files)
+    {
+        if (!LoadImageFile(f.string(), img))
+        {
+            std::fprintf(stderr, "skip (decode failed): %s\n", f.string().c_str());
+            continue;
+        }
+        ++loaded;
+        const ImageView view = img.View();
+
+        for (size_t c = 0; c < kCodecs; ++c)
+        {
+            if (!encoders[c]) continue;
+            CodecTotals& t = totals[c];
+
+            // 반복 중 최솟값 (캐시/스케줄링 잡음 제거)
+            double bestEnc = 1e30, bestDec = 1e30;
+            for (int r = 0; r < reps; ++r)
+            {
+                const auto t0 = Clock::now();
+                encoders[c]->Encode(view, encoded);
+                const auto t1 = Clock::now();
+                const bool ok = DecodeImage(encoded.data(), encoded.size(), decoded);
+                const auto t2 = Clock::now();
+
+                bestEnc = std::min(bestEnc, Seconds(t0, t1));
+                bestDec = std::min(bestDec, Seconds(t1, t2));
+                if (!ok) t.decodable = false;
+            }
+
+            if (t.decodable && decoded.pixels != img.pixels)
+                t.lossless = false;
+
+            t.images++;
+            t.encodeSec += bestEnc;
+            t.decodeSec += bestDec;
+            t.bytes += static_cast<double>(encoded.size());
+            t.pixels += static_cast<double>(img.width) * img.height;
+        }
+    }
+    if (loaded == 0)
+    {
+        std::fprintf(stderr, "no decodable images\n");
+        return 1;
+    }
+
+    // ===== 결과 =====
+    std::printf("images: %zu, reps: %d, jpeg quality: %d%s\n\n", loaded, reps, jpegQuality,
+#ifdef CANCLIENT_HAS_OPENCV
+        ""
+#else
+        " (OpenCV 없음: jpeg 생략, png 디코딩 불가)"
+#endif
+    );
+    std::printf("%-6s %10s %12s %8s %10s %9s\n", "codec", "enc ms", "bytes", "ratio", "dec ms", "lossless");
+
+    for (size_t c = 0; c < kCodecs; ++c)
+    {
+        const CodecTotals& t = totals[c];
+        if (!t.available || t.images == 0) continue;
+        char dec[32] = "-";
+        if (t.decodable)
+            std::snprintf(dec, sizeof(dec), "%.2f", t.decodeSec * 1000.0 / t.images);
+        std::printf("%-6s %10.2f %12.0f %8.2f %10s %9s\n",
+            CodecName(static_cast<ImageCodec>(c)),
+            t.encodeSec * 1000.0 / t.images,
+            t.bytes / t.images,
+            t.pixels * 3.0 / t.bytes,
+            dec,
+            !t.decodable ? "?" : (t.lossless ? "yes" : "no"));
+    }
+
+    // 링크 속도별 (인코딩 + 전송 + 디코딩) — CCodecSelector 와 같은 비용 모델
+    const double linksMbps[] = { 10, 100, 1000, 10000 };
+    std::printf("\nper-image total ms (encode + transfer + decode)\n%-6s", "codec");
+    for (double m : linksMbps) std::printf(" %9.0fM", m);
+    std::printf("\n");
+
+    for (size_t c = 0; c < kCodecs; ++c)
+    {
+        const CodecTotals& t = totals[c];
+        if (!t.available || t.images == 0) continue;
+        std::printf("%-6s", CodecName(static_cast<ImageCodec>(c)));
+        for (double m : linksMbps)
+        {
+            const double transfer = (t.bytes / t.images) / (m * 1e6 / 8);
+            std::printf(" %10.2f", ((t.encodeSec + t.decodeSec) / t.images + transfer) * 1000.0);
+        }
+        std::printf("\n");
+    }
+
+    std::printf("%-6s", "best");
+    for (double m : linksMbps)
+    {
+        double best = 1e30;
+        const char* name = "-";
+        for (size_t c = 0; c < kCodecs; ++c)
+        {
+            const CodecTotals& t = totals[c];
+            if (!t.available || t.images == 0) continue;
+            const double cost = (t.encodeSec + t.decodeSec + t.bytes / (m * 1e6 / 8)) / t.images;
+            if (cost < best) { best = cost; name = CodecName(static_cast<ImageCodec>(c)); }
+        }
+        std::printf(" %10s", name);
+    }
+    std::printf("\n");
+    return 0;
+}
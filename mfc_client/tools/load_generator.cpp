@@ -0,0 +1,386 @@
+﻿// load_generator.cpp — 여러 라인이 한 검사 서버를 쓸 때의 부하 생성기
+//
+// 라인마다 스레드 하나가 자기 영상 세트/속도로 검사 코어(CInspectionPipeline)를 돌린다.
+// 다이얼로그와 같은 순서(TOP 전송 → 응답 → FRONT 전송 → 판정 응답)로 보내므로,
+// 서버가 도착 순서로 TOP/SIDE 를 짝지으면 라인이 늘 때 짝이 엇갈리는지 확인할 수 있다.
+// 요청 헤더 v3 에 라인별 제품번호("LINE<n>")와 단위 번호를 실으므로, 헤더로 짝짓는 서버
+// (stand_in_server --pairing header)에서는 엇갈림이 0 이어야 하고 --pairing order 와 비교할 수 있다.
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O2 -I.. -I../packages/nlohmann.json.3.12.0/build/native/include
+//       load_generator.cpp ../OutboundQueue.cpp ../InspectionCore.cpp ../InspectionClient.cpp ../FrameSource.cpp
+//       ../ClientConfig.cpp ../ImageEncoder.cpp ../CodecSelector.cpp ../PngEncoder.cpp
+//       ../Deflate.cpp ../ThreadPool.cpp ../Preprocess.cpp ../RequestHeader.cpp ../ReplyParser.cpp
+//       ../PresenceDetector.cpp ../LatencyStats.cpp ../LocalScreen.cpp ../SideEnhance.cpp
+//       ../Station.cpp ../CameraClock.cpp ../EndpointPool.cpp -o load_generator -lpthread
+//
+// 사용:
+//   load_generator --lines N [옵션]
+//     --server HOST:PORT   검사 서버 (기본: 설정 파일 또는 10.10.21.121:9000)
+//                          여러 번 주면 서버 풀 (상태 확인 + 최소 부하 분배, 끝에 서버별 분배 결과)
+//     --config PATH        클라이언트 설정 (코덱/전처리)
+//     --rate R             라인당 초당 검사 수 (기본 2, 0 = 최대 속도)
+//     --rates R1,R2,...    라인별 속도 (모자라면 --rate)
+//     --images PATH        영상 세트 (여러 번 주면 라인에 돌아가며 배정)
+//     --synthetic WxH[xN]  합성 영상 (라인마다 다른 시드)
+//     --duration SEC       실행 시간 (기본 10)
+//     --count N            라인당 최대 검사 수
+//     --no-stagger         모든 라인을 같은 시각에 시작 (기본: 주기를 라인 수로 나눠 엇갈림)
+//
+// 응답 분류 (라인별):
+//   ok        TOP 에 저장 응답, FRONT 에 판정 응답 (대체 서버면 지문까지 일치)
+//   mispaired TOP 에 판정이 오거나 FRONT 에 TOP 저장 응답이 옴, 또는 판정 지문이 내가 보낸 쌍이 아님
+//   error     {"result":"에러"} 판정
+//   failed    연결/전송 실패, 빈 응답, JSON 이 아닌 응답
+// 종료 코드: mispaired/failed 가 있으면 1.
+
+#include "FrameSource.h"
+#include "InspectionCore.h"
+#include "SocketCompat.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+namespace
+{
+    enum class ReplyKind { TopAck, Verdict, Empty, Garbage };
+
+    struct Reply
+    {
+        ReplyKind   kind = ReplyKind::Empty;
+        std::string result;
+        bool        hasFp = false;
+        uint32_t    topFp = 0;
+        uint32_t    sideFp = 0;
+    };
+
+    Reply Classify(const std::string& text)
+    {
+        Reply r;
+        if (text.empty()) return r;
+
+        // 바이너리 응답 (server.reply_format = binary): 지문 없음
+        const uint8_t* raw = reinterpret_cast<const uint8_t*>(text.data());
+        if (BinaryReply::ExpectedSize(raw, text.size())) {
+            InspectionReply reply;
+            if (BinaryReply::IsTopAck(raw, text.size())) {
+                r.kind = ReplyKind::TopAck;
+            }
+            else if (BinaryReply::Decode(raw, text.size(), reply)) {
+                r.kind = ReplyKind::Verdict;
+                r.result = reply.result.Str();
+            }
+            else {
+                r.kind = ReplyKind::Garbage;
+            }
+            return r;
+        }
+
+        try {
+            const json j = json::parse(text);
+            if (j.contains("result")) {
+                r.kind = ReplyKind::Verdict;
+                r.result = j["result"].get<std::string>();
+                if (j.contains("top_fp") && j.contains("side_fp")) {
+                    r.hasFp = true;
+                    r.topFp = static_cast<uint32_t>(std::stoul(j["top_fp"].get<std::string>(), nullptr, 16));
+                    r.sideFp = static_cast<uint32_t>(std::stoul(j["side_fp"].get<std::string>(), nullptr, 16));
+                }
+            }
+            else if (j.value("ok", false)) {
+                r.kind = ReplyKind::TopAck;
+            }
+            else {
+                r.kind = ReplyKind::Garbage;
+            }
+        }
+        catch (const std::exception&) {
+            r.kind = ReplyKind::Garbage;
+        }
+        return r;
+    }
+
+    struct LineResult
+    {
+        double   rate = 0.0;
+        std::string images;
+        uint64_t inspections = 0, ok = 0, mispaired = 0, errors = 0, failed = 0;
+        uint64_t bytes = 0;
+        CLatencyHistogram total;     // 검사 1회 (TOP+FRONT)
+    };
+
+    struct LineSetup
+    {
+        int         index = 0;
+        double      rate = 0.0;
+        double      startDelay = 0.0;
+        std::string images;          // 비어 있으면 합성
+        int synthW = 0, synthH = 0, synthN = 8;
+        size_t      limit = 0;
+    };
+
+    std::atomic<bool> g_stop{ false };
+    CEndpointPool*    g_pool = nullptr;   // 서버가 여러 대면 모든 라인이 함께 씀
+
+    void RunLine(const LineSetup& setup, const ClientConfig& cfg, CLatencyStats& stages, LineResult& res)
+    {
+        FileSourceOptions opt;
+        opt.rate = setup.rate;
+        opt.loops = 0;
+        opt.limit = setup.limit;
+
+        CFileFrameSource source;
+        if (setup.images.empty()) {
+            source.OpenSynthetic(setup.synthW, setup.synthH, static_cast<size_t>(setup.synthN), opt,
+                1234u + static_cast<uint32_t>(setup.index) * 7919u);
+        }
+        else {
+            std::string err;
+            if (!source.Open({ setup.images }, opt, &err)) {
+                std::fprintf(stderr, "line %d: %s\n", setup.index, err.c_str());
+                return;
+            }
+        }
+
+        CInspectionPipeline pipeline(stages);
+        pipeline.Configure(cfg);
+        pipeline.SetCancel(&g_stop);     // 종료 시각에 멈춘 서버를 기다리는 요청도 바로 끝냄
+        pipeline.SetEndpointPool(g_pool);
+
+        if (setup.startDelay > 0.0)
+            std::this_thread::sleep_for(std::chrono::duration<double>(setup.startDelay));
+
+        CapturePair pair;
+        uint64_t scheduled = 0;
+        uint64_t sequence = 0;
+        const std::string productId = "LINE" + std::to_string(setup.index);   // 헤더 짝 키 (라인별로 다르게)
+        while (!g_stop && source.Next(pair, scheduled))
+        {
+            CStageTimer stageTotal(stages, Stage::Total);
+            const uint64_t t0 = NowNs();
+
+            ViewRequest req;
+            ViewOutcome top, front;
+            req.sequence = ++sequence;
+            req.productId = productId;
+            req.frame = pair.top->View();
+            req.roi = cfg.preprocess.roiTop;
+            const bool topSent = pipeline.ProcessView(req, top);
+
+            req.frame = pair.front->View();
+            req.roi = cfg.preprocess.roiFront;
+            req.role = CameraRole::Front;
+            const bool frontSent = topSent && pipeline.ProcessView(req, front);
+
+            res.total.Record(NowNs() - t0);
+            ++res.inspections;
+            res.bytes += top.encodedBytes + front.encodedBytes;
+
+            if (!frontSent) { ++res.failed; continue; }
+
+            const Reply a = Classify(top.response);
+            const Reply b = Classify(front.response);
+
+            if (a.kind == ReplyKind::Verdict || b.kind == ReplyKind::TopAck) {
+                ++res.mispaired;                 // 서버가 다른 라인 요청과 짝지음
+            }
+            else if (a.kind != ReplyKind::TopAck || b.kind != ReplyKind::Verdict) {
+                ++res.failed;                    // 빈 응답 / JSON 아님 / 끊김
+            }
+            else if (b.hasFp && (b.topFp != top.fingerprint || b.sideFp != front.fingerprint)) {
+                ++res.mispaired;                 // 판정은 왔지만 다른 쌍에 대한 것
+            }
+            else if (b.result == "에러") {
+                ++res.errors;
+            }
+            else {
+                ++res.ok;
+            }
+        }
+    }
+
+    void PrintRow(const char* name, double rateTarget, uint64_t n, double elapsed,
+        uint64_t ok, uint64_t mis, uint64_t err, uint64_t fail, const HistogramSnapshot& s)
+    {
+        char target[16] = "max";
+        if (rateTarget > 0) std::snprintf(target, sizeof(target), "%.1f", rateTarget);
+        std::printf("%-6s %7s %8.2f %7llu %7llu %7llu %7llu %7llu %9.1f %9.1f %9.1f %9.1f\n",
+            name, target, elapsed > 0 ? n / elapsed : 0.0,
+            (unsigned long long)n, (unsigned long long)ok, (unsigned long long)mis,
+            (unsigned long long)err, (unsigned long long)fail,
+            s.PercentileNs(0.5) / 1e6, s.PercentileNs(0.99) / 1e6,
+            s.PercentileNs(0.999) / 1e6, s.maxNs / 1e6);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int lines = 0;
+    double rate = 2.0, duration = 10.0;
+    size_t limit = 0;
+    bool stagger = true;
+    std::vector<double> rates;
+    std::vector<std::string> imageSets;
+    std::string configPath;
+    std::vector<std::string> serverArgs;
+    int synthW = 0, synthH = 0, synthN = 8;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--lines" && hasValue)          lines = std::atoi(argv[++i]);
+        else if (a == "--rate" && hasValue)      rate = std::atof(argv[++i]);
+        else if (a == "--duration" && hasValue)  duration = std::atof(argv[++i]);
+        else if (a == "--count" && hasValue)     limit = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--images" && hasValue)    imageSets.push_back(argv[++i]);
+        else if (a == "--config" && hasValue)    configPath = argv[++i];
+        else if (a == "--server" && hasValue)    serverArgs.push_back(argv[++i]);
+        else if (a == "--no-stagger")            stagger = false;
+        else if (a == "--rates" && hasValue)
+        {
+            char* s = argv[++i];
+            while (*s) {
+                rates.push_back(std::strtod(s, &s));
+                if (*s == ',') ++s;
+                else if (*s) break;
+            }
+        }
+        else if (a == "--synthetic" && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%dx%d", &synthW, &synthH, &synthN) < 2) synthW = 0;
+        }
+        else {
+            std::fprintf(stderr, "bad option: %s (see header comment for usage)\n", a.c_str());
+            return 2;
+        }
+    }
+    if (lines <= 0 || (imageSets.empty() && synthW <= 0)) {
+        std::fprintf(stderr, "usage: load_generator --lines N (--images PATH | --synthetic WxH) [options]\n");
+        return 2;
+    }
+
+    // ===== 설정 =====
+    ClientConfig cfg;
+    if (!configPath.empty()) {
+        std::string err;
+        if (!LoadClientConfig(configPath, cfg, &err)) {
+            std::fprintf(stderr, "config: %s\n", err.c_str());
+            return 2;
+        }
+    }
+    for (size_t i = 0; i < serverArgs.size(); ++i)
+    {
+        const std::string& arg = serverArgs[i];
+        const size_t colon = arg.rfind(':');
+        if (colon == std::string::npos) { std::fprintf(stderr, "bad --server\n"); return 2; }
+        ServerEndpoint e;
+        e.host = arg.substr(0, colon);
+        e.port = std::atoi(arg.c_str() + colon + 1);
+        if (i == 0) {
+            cfg.server.host = e.host;
+            cfg.server.port = e.port;
+            cfg.pool.endpoints.clear();
+        }
+        if (serverArgs.size() > 1) cfg.pool.endpoints.push_back(e);
+    }
+    cfg.encoder.archive = cfg.encoder.archivePng = false;
+    if (cfg.encoder.pngThreads == 0)
+        cfg.encoder.pngThreads = 1;     // 라인마다 코어 수만큼 스레드를 만들지 않게
+
+    Net::Startup();
+
+    CEndpointPool pool;
+    if (!cfg.pool.endpoints.empty()) {
+        pool.Configure(cfg.server, cfg.pool);
+        pool.StartProbes();
+        g_pool = &pool;
+    }
+
+    // ===== 라인 구성 =====
+    std::vector<LineSetup> setups(static_cast<size_t>(lines));
+    for (int i = 0; i < lines; ++i)
+    {
+        LineSetup& s = setups[static_cast<size_t>(i)];
+        s.index = i;
+        s.rate = i < static_cast<int>(rates.size()) ? rates[static_cast<size_t>(i)] : rate;
+        s.startDelay = (stagger && s.rate > 0) ? (1.0 / s.rate) * i / lines : 0.0;
+        if (!imageSets.empty()) s.images = imageSets[static_cast<size_t>(i) % imageSets.size()];
+        s.synthW = synthW;
+        s.synthH = synthH;
+        s.synthN = synthN;
+        s.limit = limit;
+    }
+
+    if (g_pool)
+        std::printf("server pool of %zu, %d lines, %.0f s%s\n", pool.Size(), lines, duration, stagger ? ", staggered" : "");
+    else
+        std::printf("server %s:%d, %d lines, %.0f s%s\n", cfg.server.host.c_str(), cfg.server.port,
+            lines, duration, stagger ? ", staggered" : "");
+
+    CLatencyStats stages;                                    // 전 라인 합산 단계별 지연
+    std::vector<std::unique_ptr<LineResult>> results;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < lines; ++i)
+    {
+        results.push_back(std::make_unique<LineResult>());
+        results.back()->rate = setups[static_cast<size_t>(i)].rate;
+        threads.emplace_back(RunLine, std::cref(setups[static_cast<size_t>(i)]), std::cref(cfg),
+            std::ref(stages), std::ref(*results.back()));
+    }
+
+    const uint64_t start = NowNs();
+    while ((NowNs() - start) / 1e9 < duration)
+    {
+        bool anyRunning = false;
+        for (const auto& r : results) anyRunning |= (limit == 0 || r->inspections < limit);
+        if (!anyRunning) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    g_stop = true;
+    for (std::thread& t : threads) t.join();
+    const double elapsed = (NowNs() - start) / 1e9;
+    pool.StopProbes();
+    Net::Cleanup();
+
+    // ===== 보고 =====
+    std::printf("\n%-6s %7s %8s %7s %7s %7s %7s %7s %9s %9s %9s %9s\n", "line", "target", "insp/s",
+        "n", "ok", "mispair", "error", "failed", "p50(ms)", "p99(ms)", "p999(ms)", "max(ms)");
+
+    HistogramSnapshot all, snap;
+    uint64_t n = 0, ok = 0, mis = 0, err = 0, fail = 0, bytes = 0;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const LineResult& r = *results[i];
+        r.total.Snapshot(snap);
+        char name[24];
+        std::snprintf(name, sizeof(name), "%zu", i);
+        PrintRow(name, r.rate, r.inspections, elapsed, r.ok, r.mispaired, r.errors, r.failed, snap);
+
+        for (size_t b = 0; b < snap.counts.size(); ++b) all.counts[b] += snap.counts[b];
+        all.total += snap.total;
+        all.sumNs += snap.sumNs;
+        all.maxNs = std::max(all.maxNs, snap.maxNs);
+        n += r.inspections; ok += r.ok; mis += r.mispaired; err += r.errors; fail += r.failed; bytes += r.bytes;
+    }
+    double totalRate = 0.0;
+    for (const LineSetup& s : setups) totalRate += s.rate;
+    PrintRow("all", totalRate, n, elapsed, ok, mis, err, fail, all);
+
+    std::printf("\nsent %.1f MB (%.1f MB/s) in %.1f s\n\n%s", bytes / 1e6, elapsed > 0 ? bytes / 1e6 / elapsed : 0.0,
+        elapsed, stages.Report().c_str());
+    if (g_pool)
+        std::printf("\n%s", pool.Report().c_str());
+
+    return (mis || fail) ? 1 : 0;
+}
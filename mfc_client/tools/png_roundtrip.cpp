@@ -0,0 +1,242 @@
+﻿// png_roundtrip.cpp — 스트라이프 PNG 인코더 검증/벤치마크 (Linux)
+//
+// 빌드:
+//   g++ -std=c++17 -O2 -I.. png_roundtrip.cpp ../PngEncoder.cpp ../Deflate.cpp ../ThreadPool.cpp
+//       ../ImageEncoder.cpp ../FrameSource.cpp ../LatencyStats.cpp -o png_roundtrip -lz -lpthread
+//
+// 사용:
+//   png_roundtrip [이미지 파일...] [--threads 1,2,4,8] [--reps N]
+//   파일을 안 주면 카메라 해상도(2448x2048) 합성 영상으로 검사.
+//
+// 검사 항목 (하나라도 실패하면 종료 코드 1):
+//   - 모든 청크 CRC, IHDR 값
+//   - zlib(inflate) 로 IDAT 해제 → Adler-32 검증 포함
+//   - 필터 해제 후 원본 BGR 과 픽셀 단위 일치 (bit-exact)
+//   - 스레드 수와 관계없이 같은 픽셀
+// 출력: 스레드 수별 인코딩 시간, 1스레드 대비 속도 향상, 크기
+
+#include "FrameSource.h"
+#include "ImageEncoder.h"
+#include "PngEncoder.h"
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    uint32_t GetU32(const uint8_t* p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+    }
+
+    // PNG → BGR (8비트 truecolor, 비인터레이스만). 실패 사유를 err 에.
+    bool DecodePng(const std::vector<uint8_t>& png, ImageBuffer& out, std::string& err)
+    {
+        static const uint8_t sig[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+        if (png.size() < 8 || std::memcmp(png.data(), sig, 8) != 0) { err = "signature"; return false; }
+
+        std::vector<uint8_t> idat;
+        uint32_t w = 0, h = 0;
+        bool sawEnd = false;
+        size_t p = 8;
+        while (p + 12 <= png.size())
+        {
+            const uint32_t len = GetU32(&png[p]);
+            if (p + 12 + len > png.size()) { err = "chunk overrun"; return false; }
+            const uint8_t* type = &png[p + 4];
+            const uint8_t* body = &png[p + 8];
+
+            const uint32_t crc = static_cast<uint32_t>(crc32(crc32(0, nullptr, 0), type, len + 4));
+            if (crc != GetU32(body + len)) { err = "crc " + std::string(reinterpret_cast<const char*>(type), 4); return false; }
+
+            if (std::memcmp(type, "IHDR", 4) == 0)
+            {
+                w = GetU32(body);
+                h = GetU32(body + 4);
+                if (body[8] != 8 || body[9] != 2 || body[12] != 0) { err = "IHDR format"; return false; }
+            }
+            else if (std::memcmp(type, "IDAT", 4) == 0)
+            {
+                idat.insert(idat.end(), body, body + len);
+            }
+            else if (std::memcmp(type, "IEND", 4) == 0)
+            {
+                sawEnd = true;
+                break;
+            }
+            p += 12 + len;
+        }
+        if (!sawEnd || w == 0 || h == 0) { err = "missing IHDR/IEND"; return false; }
+
+        const size_t rowBytes = static_cast<size_t>(w) * 3;
+        std::vector<uint8_t> raw((rowBytes + 1) * h);
+        uLongf rawLen = static_cast<uLongf>(raw.size());
+        if (uncompress(raw.data(), &rawLen, idat.data(), static_cast<uLong>(idat.size())) != Z_OK || rawLen != raw.size())
+        {
+            err = "inflate";
+            return false;
+        }
+
+        // 필터 해제 (RGB)
+        std::vector<uint8_t> prev(rowBytes, 0), cur(rowBytes);
+        out.Allocate(static_cast<int>(w), static_cast<int>(h));
+        for (uint32_t y = 0; y < h; ++y)
+        {
+            const uint8_t* line = &raw[(rowBytes + 1) * y];
+            const uint8_t type = line[0];
+            const uint8_t* f = line + 1;
+            for (size_t i = 0; i < rowBytes; ++i)
+            {
+                const int a = i >= 3 ? cur[i - 3] : 0;
+                const int b = prev[i];
+                const int c = i >= 3 ? prev[i - 3] : 0;
+                int pred = 0;
+                switch (type)
+                {
+                case 0: pred = 0; break;
+                case 1: pred = a; break;
+                case 2: pred = b; break;
+                case 3: pred = (a + b) >> 1; break;
+                case 4:
+                {
+                    const int pp = a + b - c;
+                    const int pa = std::abs(pp - a), pb = std::abs(pp - b), pc = std::abs(pp - c);
+                    pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+                    break;
+                }
+                default: err = "filter type"; return false;
+                }
+                cur[i] = static_cast<uint8_t>(f[i] + pred);
+            }
+
+            uint8_t* dst = out.Row(static_cast<int>(y));
+            for (uint32_t x = 0; x < w; ++x)
+            {
+                dst[x * 3] = cur[x * 3 + 2];
+                dst[x * 3 + 1] = cur[x * 3 + 1];
+                dst[x * 3 + 2] = cur[x * 3];
+            }
+            prev.swap(cur);
+        }
+        return true;
+    }
+
+    // 캔 비슷한 합성 영상: 밝은 원판 + 그라디언트 + 센서 노이즈
+    void MakeSynthetic(ImageBuffer& img, int w, int h)
+    {
+        img.Allocate(w, h);
+        std::mt19937 rng(1234);
+        std::uniform_int_distribution<int> noise(-4, 4);
+        for (int y = 0; y < h; ++y)
+        {
+            uint8_t* row = img.Row(y);
+            for (int x = 0; x < w; ++x)
+            {
+                const double dx = x - w * 0.5, dy = y - h * 0.5;
+                const bool can = dx * dx + dy * dy < (h * 0.35) * (h * 0.35);
+                const int base = can ? 170 + (x * 40) / w : 40 + (y * 20) / h;
+                for (int c = 0; c < 3; ++c)
+                    row[x * 3 + c] = static_cast<uint8_t>(std::clamp(base + c * 8 + noise(rng), 0, 255));
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> files;
+    std::vector<size_t> threadCounts = { 1, 2, 4, 8 };
+    int reps = 3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        if (a == "--threads" && i + 1 < argc)
+        {
+            threadCounts.clear();
+            char* s = argv[++i];
+            while (*s)
+            {
+                threadCounts.push_back(static_cast<size_t>(std::strtoul(s, &s, 10)));
+                if (*s == ',') ++s;
+                else if (*s) break;
+            }
+        }
+        else if (a == "--reps" && i + 1 < argc)
+        {
+            reps = std::max(1, std::atoi(argv[++i]));
+        }
+        else
+        {
+            files.push_back(a);
+        }
+    }
+
+    std::vector<std::pair<std::string, ImageBuffer>> images;
+    if (files.empty())
+    {
+        images.emplace_back("synthetic 2448x2048", ImageBuffer());
+        MakeSynthetic(images.back().second, 2448, 2048);
+    }
+    for (const std::string& f : files)
+    {
+        ImageBuffer img;
+        if (!LoadImageFile(f, img))
+        {
+            std::fprintf(stderr, "load failed: %s\n", f.c_str());
+            return 1;
+        }
+        images.emplace_back(f, std::move(img));
+    }
+
+    std::printf("hardware threads: %u\n", std::thread::hardware_concurrency());
+    bool allOk = true;
+
+    for (const auto& entry : images)
+    {
+        const ImageBuffer& img = entry.second;
+        std::printf("\n%s (%dx%d)\n%8s %10s %9s %12s %8s\n", entry.first.c_str(), img.width, img.height,
+            "threads", "enc ms", "speedup", "bytes", "exact");
+
+        double baseMs = 0.0;
+        for (size_t threads : threadCounts)
+        {
+            CPngStripeEncoder encoder(threads);
+            std::vector<uint8_t> png;
+
+            double bestMs = 1e30;
+            for (int r = 0; r < reps; ++r)
+            {
+                const auto t0 = std::chrono::steady_clock::now();
+                encoder.Encode(img.View(), png);
+                const auto t1 = std::chrono::steady_clock::now();
+                bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(t1 - t0).count());
+            }
+            if (baseMs == 0.0) baseMs = bestMs;
+
+            ImageBuffer decoded;
+            std::string err;
+            const bool ok = DecodePng(png, decoded, err) &&
+                decoded.width == img.width && decoded.height == img.height &&
+                decoded.pixels == img.pixels;
+            if (!ok && err.empty()) err = "pixel mismatch";
+            allOk = allOk && ok;
+
+            std::printf("%8zu %10.1f %8.2fx %12zu %8s %s\n", encoder.Threads(), bestMs, baseMs / bestMs,
+                png.size(), ok ? "yes" : "NO", err.c_str());
+        }
+    }
+
+    std::printf("\n%s\n", allOk ? "PASS" : "FAIL");
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,269 @@
+﻿// replay_harness.cpp — 헤드리스 검사 재생 도구 (Linux / Windows 콘솔)
+//
+// 카메라 대신 저장된 영상(datasets/can_defect, C:\CanClient\captures 등)을 정해진 속도로
+// 다이얼로그와 같은 검사 코어(CInspectionPipeline)에 흘려 보내고 처리량/지연을 보고한다.
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O2 -I.. -I../packages/nlohmann.json.3.12.0/build/native/include
+//       replay_harness.cpp ../OutboundQueue.cpp ../InspectionCore.cpp ../InspectionClient.cpp ../FrameSource.cpp
+//       ../ClientConfig.cpp ../ImageEncoder.cpp ../CodecSelector.cpp ../PngEncoder.cpp
+//       ../Deflate.cpp ../ThreadPool.cpp ../Preprocess.cpp ../RequestHeader.cpp ../ReplyParser.cpp
+//       ../PresenceDetector.cpp ../LatencyStats.cpp ../LocalScreen.cpp ../SideEnhance.cpp
+//       ../Station.cpp ../CameraClock.cpp ../EndpointPool.cpp -o replay_harness -lpthread
+//   (OpenCV 가 있으면 PNG/JPEG 데이터셋도 읽힘: `pkg-config --cflags --libs opencv4` 추가)
+//
+// 사용:
+//   replay_harness [이미지 파일/디렉터리...] [옵션]
+//     --config PATH       클라이언트 설정 (config.json, 기본값 사용 시 생략)
+//     --server HOST:PORT  검사 서버 (설정 파일보다 우선)
+//     --rate N            초당 검사 수 (기본 0 = 최대 속도)
+//     --loops N           목록 반복 횟수 (기본 1, --count 만 주면 무한, 0 = 무한)
+//     --count N           최대 검사 수
+//     --synthetic WxH[xN] 파일 대신 합성 영상 N쌍 (기본 N=8)
+//     --dry-run           전송하지 않고 전처리/인코딩만 측정
+//     --archive DIR       보낸 바이트를 DIR 에 저장 (encoder.archive 설정 따름)
+//     --report PATH       최종 보고서를 파일로도 저장
+//     --verbose           파이프라인 로그 출력
+//
+// 보고:
+//   - 처리량 (검사/초, 전송 MB/s), 응답 판정 집계 (정상/불량/에러/파싱 실패/전송 실패)
+//   - 단계별 지연 p50/p99/p999/max (다이얼로그 지연 표와 같은 형식)
+//   - 예정 시각 기준 지연 (rate 를 못 따라갈 때 대기열에 쌓인 시간까지 포함)
+
+#include "FrameSource.h"
+#include "InspectionCore.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+#endif
+
+namespace
+{
+    void Usage()
+    {
+        std::fprintf(stderr,
+            "usage: replay_harness [files/dirs...] [--config PATH] [--server HOST:PORT]\n"
+            "                      [--rate N] [--loops N] [--count N] [--synthetic WxH[xN]]\n"
+            "                      [--dry-run] [--archive DIR] [--report PATH] [--verbose]\n");
+    }
+
+    bool ParseHostPort(const std::string& s, ServerEndpoint& ep)
+    {
+        const size_t colon = s.rfind(':');
+        if (colon == std::string::npos || colon == 0) return false;
+        ep.host = s.substr(0, colon);
+        ep.port = std::atoi(s.c_str() + colon + 1);
+        return ep.port > 0 && ep.port < 65536;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> inputs;
+    std::string configPath, serverArg, archiveDir, reportPath;
+    FileSourceOptions opt;
+    int synthW = 0, synthH = 0, synthN = 8;
+    bool dryRun = false, verbose = false, loopsGiven = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--config" && hasValue)          configPath = argv[++i];
+        else if (a == "--server" && hasValue)     serverArg = argv[++i];
+        else if (a == "--rate" && hasValue)       opt.rate = std::atof(argv[++i]);
+        else if (a == "--loops" && hasValue)      opt.loops = std::atoi(argv[++i]), loopsGiven = true;
+        else if (a == "--count" && hasValue)      opt.limit = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--archive" && hasValue)    archiveDir = argv[++i];
+        else if (a == "--report" && hasValue)     reportPath = argv[++i];
+        else if (a == "--dry-run")                dryRun = true;
+        else if (a == "--verbose")                verbose = true;
+        else if (a == "--synthetic" && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%dx%d", &synthW, &synthH, &synthN) < 2 || synthW <= 0 || synthH <= 0) {
+                Usage();
+                return 2;
+            }
+        }
+        else if (a.rfind("--", 0) == 0) { Usage(); return 2; }
+        else inputs.push_back(a);
+    }
+    if (inputs.empty() && synthW == 0) { Usage(); return 2; }
+    if (opt.limit && !loopsGiven)
+        opt.loops = 0;   // --count 만 주면 목록을 돌려 가며 채움
+
+    // ===== 설정 =====
+    ClientConfig cfg;
+    if (!configPath.empty())
+    {
+        std::string err;
+        if (!LoadClientConfig(configPath, cfg, &err)) {
+            std::fprintf(stderr, "config: %s\n", err.c_str());
+            return 2;
+        }
+    }
+    if (!serverArg.empty() && !ParseHostPort(serverArg, cfg.server)) {
+        std::fprintf(stderr, "bad --server: %s\n", serverArg.c_str());
+        return 2;
+    }
+    if (archiveDir.empty())
+        cfg.encoder.archive = cfg.encoder.archivePng = false;
+
+    // ===== 소스 =====
+    CFileFrameSource source;
+    if (synthW > 0) {
+        source.OpenSynthetic(synthW, synthH, static_cast<size_t>(synthN), opt);
+    }
+    else {
+        std::string err;
+        if (!source.Open(inputs, opt, &err)) {
+            std::fprintf(stderr, "source: %s\n", err.c_str());
+            return 2;
+        }
+    }
+    std::printf("images: %zu, pairs: %zu, skipped: %zu, unpaired: %zu\n",
+        source.ImageCount(), source.PairCount(), source.Skipped(), source.Unpaired());
+    std::printf("server: %s\n", dryRun ? "(dry run)" : (cfg.server.host + ":" + std::to_string(cfg.server.port)).c_str());
+
+#ifdef _WIN32
+    WSADATA wsa;
+    WSAStartup(MAKEWORD(2, 2), &wsa);
+#endif
+
+    // ===== 파이프라인 =====
+    CLatencyStats stats;
+    CInspectionPipeline pipeline(stats);
+    if (verbose)
+        pipeline.SetLogger([](const std::string& msg) { std::fputs(msg.c_str(), stderr); });
+    pipeline.Configure(cfg);
+    pipeline.SetDryRun(dryRun);
+
+    CLatencyHistogram fromSchedule;     // 예정 시각 → 결과 반영 (대기열 포함)
+    std::map<std::string, size_t> verdicts;
+    size_t inspections = 0, sendFailures = 0, parseFailures = 0;
+    size_t boxes = 0;   // 센서 좌표로 되돌린 검출 박스 (다이얼로그 오버레이와 같은 경로)
+    size_t localPasses = 0;   // 로컬 선별로 서버를 생략한 검사 (screen 설정)
+    uint64_t bytesSent = 0;
+
+    CapturePair pair;
+    uint64_t scheduled = 0;
+    const uint64_t runStart = NowNs();
+
+    while (source.Next(pair, scheduled))
+    {
+        CStageTimer total(stats, Stage::Total);
+        const std::string base = archiveDir.empty() ? std::string()
+            : archiveDir + "/replay_" + std::to_string(inspections);
+
+        // 카메라 경로와 같은 순서: (로컬 선별) → TOP 전송 → 응답 → FRONT 전송 → 응답(판정)
+        ViewOutcome topOut, frontOut;
+        ViewRequest reqTop, reqFront;
+        {
+            CStageTimer grab(stats, Stage::Grab);   // 파일 소스: 메모리 프레임 참조만
+            reqTop.frame = pair.top->View();
+            reqFront.frame = pair.front->View();
+        }
+        reqTop.sequence = reqFront.sequence = inspections + 1;
+        reqTop.productId = reqFront.productId = "REPLAY";
+        reqTop.roi = cfg.preprocess.roiTop;
+        reqTop.archiveBase = base.empty() ? base : base + "_top";
+        reqFront.roi = cfg.preprocess.roiFront;
+        reqFront.role = CameraRole::Front;
+        reqFront.archiveBase = base.empty() ? base : base + "_front";
+
+        ScreenVerdict screen;
+        if (pipeline.ScreenPair(reqTop, reqFront, screen)) {
+            ++localPasses;
+            total.Stop();
+            fromSchedule.Record(NowNs() - scheduled);
+            ++inspections;
+            continue;
+        }
+
+        bool ok = pipeline.ProcessView(reqTop, topOut);
+        bytesSent += topOut.sent ? topOut.encodedBytes : 0;
+        ok = pipeline.ProcessView(reqFront, frontOut) && ok;
+        bytesSent += frontOut.sent ? frontOut.encodedBytes : 0;
+
+        if (!ok) {
+            ++sendFailures;
+        }
+        else if (!dryRun) {
+            InspectionReply reply;
+            if (pipeline.ParseReply(frontOut.response, reply)) {
+                ++verdicts[reply.result.Str()];
+                ViewDetections top, front;
+                MapDetectionsToSensor(reply.top, topOut.geometry, top);
+                MapDetectionsToSensor(reply.side, frontOut.geometry, front);
+                for (const ViewDetections* list : { &top, &front })
+                    for (const SensorDetection& d : *list)
+                        boxes += d.HasBox() ? 1 : 0;
+            }
+            else
+                ++parseFailures;
+        }
+
+        total.Stop();
+        fromSchedule.Record(NowNs() - scheduled);
+        ++inspections;
+    }
+    const double elapsed = (NowNs() - runStart) / 1e9;
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+
+    // ===== 보고 =====
+    std::string report;
+    char line[256], target[32] = "max";
+    if (opt.rate > 0)
+        std::snprintf(target, sizeof(target), "%.1f", opt.rate);
+    std::snprintf(line, sizeof(line),
+        "\ninspections: %zu in %.2f s → %.1f /s (target %s)\nsent: %.1f MB → %.1f MB/s, link estimate %.1f Mbps\n",
+        inspections, elapsed, elapsed > 0 ? inspections / elapsed : 0.0,
+        target,
+        bytesSent / 1e6, elapsed > 0 ? bytesSent / 1e6 / elapsed : 0.0,
+        pipeline.LinkBandwidth() * 8 / 1e6);
+    report += line;
+
+    if (pipeline.ScreenEnabled())
+    {
+        std::snprintf(line, sizeof(line), "local screen: %zu / %zu passed locally (%.1f%%), rest sent to server\n",
+            localPasses, inspections, inspections ? 100.0 * localPasses / inspections : 0.0);
+        report += line;
+    }
+
+    if (!dryRun)
+    {
+        report += "verdicts:";
+        for (const auto& v : verdicts)
+            report += " " + v.first + "=" + std::to_string(v.second);
+        std::snprintf(line, sizeof(line), " | boxes=%zu | parse failures=%zu, send failures=%zu\n",
+            boxes, parseFailures, sendFailures);
+        report += line;
+    }
+
+    report += "\n" + stats.Report();
+
+    HistogramSnapshot snap;
+    fromSchedule.Snapshot(snap);
+    std::snprintf(line, sizeof(line), "%-8s %7llu %9.2f %9.2f %9.2f %9.2f   (예정 시각 기준)\n", "sched",
+        static_cast<unsigned long long>(snap.total), snap.PercentileNs(0.5) / 1e6,
+        snap.PercentileNs(0.99) / 1e6, snap.PercentileNs(0.999) / 1e6, snap.maxNs / 1e6);
+    report += line;
+
+    std::fputs(report.c_str(), stdout);
+    if (!reportPath.empty())
+        std::ofstream(reportPath) << report;
+
+    return (sendFailures || parseFailures) ? 1 : 0;
+}
@@ -0,0 +1,562 @@
+﻿// reply_parser_bench.cpp — 응답 전용 파서 동등성 퍼징 + 벤치마크 (Linux / Windows 콘솔)
+//
+// ReplyParser(ParseInspectionReply) 결과를 기존 nlohmann::json 경로와 비교한다.
+//   1) 퍼징: 스키마에 맞는 응답을 무작위 생성 + 바이트 변형/절단/무작위 바이트.
+//      성공 여부, 실패 종류, result/reason/timestamp, det_top/det_side 가 모두 같아야 한다.
+//   2) 벤치마크: 대표 응답(TOP 저장 응답, C# 판정 응답, 검출 목록이 붙은 AI 응답)별
+//      파싱 1회 시간과 파싱당 힙 할당 횟수.
+//   3) 바이너리 응답('CNRP'): 직렬화 → 디코딩 왕복 확인, 변형/절단 입력 경계 검사,
+//      같은 내용의 JSON 파싱과 디코딩 시간 비교.
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O2 -I.. -I../packages/nlohmann.json.3.12.0/build/native/include
+//       reply_parser_bench.cpp ../ReplyParser.cpp -o reply_parser_bench
+//
+// 사용:
+//   reply_parser_bench [--fuzz N] [--seed S] [--iters N] [--verbose]
+//     --fuzz N    퍼징 입력 수 (기본 200000, 0 = 생략)
+//     --seed S    난수 시드 (기본 1)
+//     --iters N   벤치마크 반복 (기본 200000, 0 = 생략)
+// 종료 코드: 불일치가 있으면 1 (첫 불일치 입력을 출력).
+
+#include "ReplyParser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// ===== 힙 할당 계수 =====
+// (GCC 는 인라인된 malloc/free 짝을 new/delete 불일치로 오인해 경고한다)
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+static std::atomic<uint64_t> g_allocs{ 0 };
+
+void* operator new(size_t size)
+{
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace
+{
+    // ===== 기준 경로 (nlohmann DOM) =====
+    struct RefDetection { std::string label; float score; uint16_t x, y, w, h; };
+    struct RefList
+    {
+        bool present = false;
+        size_t dropped = 0;
+        std::vector<RefDetection> items;
+    };
+    struct RefReply
+    {
+        std::string result, reason, timestamp;
+        RefList top, side;
+    };
+
+    void RefDetections(const json& j, const char* key, RefList& list)
+    {
+        if (!j.contains(key) || !j[key].is_array()) return;
+        list.present = true;
+        for (const json& e : j[key]) {
+            if (!e.is_array() || e.size() < 2 || !e[0].is_string() || !e[1].is_number()) continue;
+            if (list.items.size() < DetectionList::kCapacity) {
+                RefDetection d{ e[0].get<std::string>(), static_cast<float>(e[1].get<double>()), 0, 0, 0, 0 };
+                if (e.size() >= 6 && e[2].is_number() && e[3].is_number() && e[4].is_number() && e[5].is_number()) {
+                    auto coord = [](double v) -> uint16_t {
+                        return v > 0.0 ? static_cast<uint16_t>(std::min(v, 65535.0)) : 0;
+                    };
+                    d.x = coord(e[2].get<double>()); d.y = coord(e[3].get<double>());
+                    d.w = coord(e[4].get<double>()); d.h = coord(e[5].get<double>());
+                }
+                list.items.push_back(d);
+            }
+            else
+                ++list.dropped;
+        }
+    }
+
+    ReplyError RefParse(const std::string& text, RefReply& out)
+    {
+        if (text.empty()) return ReplyError::Empty;
+        json j;
+        try { j = json::parse(text); }
+        catch (const json::parse_error&) { return ReplyError::Syntax; }
+        catch (const json::out_of_range&) { return ReplyError::Syntax; }   // 숫자 넘침 (1e400)
+        if (!j.is_object()) return ReplyError::NotObject;
+        if (!j.contains("result")) return ReplyError::MissingResult;
+        try {
+            out.result = j["result"].get<std::string>();
+            if (j.contains("reason")) out.reason = j["reason"].get<std::string>();
+            if (j.contains("timestamp")) out.timestamp = j["timestamp"].get<std::string>();
+        }
+        catch (const json::type_error&) { return ReplyError::TypeMismatch; }
+        RefDetections(j, "det_top", out.top);
+        RefDetections(j, "det_side", out.side);
+        return ReplyError::None;
+    }
+
+    // 잘린 고정 문자열은 기준 문자열의 앞부분이어야 함
+    template <size_t N>
+    bool SameText(const FixedText<N>& a, const std::string& b)
+    {
+        if (!a.truncated) return a.View() == b;
+        return b.size() > a.size && b.compare(0, a.size, a.data, a.size) == 0;
+    }
+
+    bool SameList(const DetectionList& a, const RefList& b)
+    {
+        if (a.present != b.present || a.count != b.items.size() || a.dropped != b.dropped) return false;
+        for (size_t i = 0; i < a.count; ++i) {
+            if (!SameText(a.items[i].label, b.items[i].label)) return false;
+            const float x = a.items[i].score, y = b.items[i].score;
+            if (!(x == y || (x != x && y != y))) return false;   // NaN 은 없지만 방어
+            const Detection& d = a.items[i];
+            const RefDetection& r = b.items[i];
+            if (d.x != r.x || d.y != r.y || d.w != r.w || d.h != r.h) return false;
+        }
+        return true;
+    }
+
+    // ===== 입력 생성 =====
+    class Generator
+    {
+    public:
+        explicit Generator(uint32_t seed) : m_rng(seed) {}
+
+        std::string Next()
+        {
+            std::string s = Reply();
+            switch (Pick(8))
+            {
+            case 0: case 1: case 2: return s;           // 정상 응답
+            case 3: Mutate(s, 1); return s;             // 1바이트 변형
+            case 4: Mutate(s, 1 + Pick(6)); return s;   // 여러 바이트 변형
+            case 5: s.resize(Pick(s.size() + 1)); return s;   // 절단
+            case 6: return RandomBytes();
+            default: return Value(0);                   // 최상위가 임의 값
+            }
+        }
+
+    private:
+        size_t Pick(size_t n) { return n ? std::uniform_int_distribution<size_t>(0, n - 1)(m_rng) : 0; }
+        bool   Chance(int percent) { return static_cast<int>(Pick(100)) < percent; }
+
+        void Ws(std::string& s)
+        {
+            static const char kWs[] = { ' ', '\t', '\n', '\r' };
+            if (Chance(20)) s += kWs[Pick(4)];
+        }
+
+        std::string Text()
+        {
+            static const char* kPieces[] = {
+                "정상", "불량", "에러", "TOP: ", "SIDE: ", "비정상(top_dent)", " · ", "side_foreign",
+                "bad image", "2026-10-19 09:15:02", "\\n", "\\t", "\\\"", "\\\\", "\\/", "\\u00e9",
+                "\\uD83D\\uDE00", "\\u0000", "\\u12", "\\x", "\xF0\x9F\x98\x80", "\xC3\xA9", "a", "0",
+                "\xED\xA0\x80", "\xC0\xAF", "\xE2\x82", "\\uDC00", "\\uD800x", "\x01",
+            };
+            std::string s = "\"";
+            const size_t n = Pick(7);
+            for (size_t i = 0; i < n; ++i) {
+                // 유효한 조각 위주, 가끔 잘못된 조각
+                size_t k = Pick(sizeof(kPieces) / sizeof(kPieces[0]));
+                if (k >= 18 && Chance(85)) k = Pick(18);
+                s += kPieces[k];
+            }
+            if (Chance(3)) s += std::string(Pick(400), 'x');   // 용량 초과 (잘림 경로)
+            return s + "\"";
+        }
+
+        std::string Number()
+        {
+            static const char* kNums[] = {
+                "0", "-0", "0.5", "0.91", "1", "12", "-3.25", "1e3", "2.5E-2", "1e+2", "0.123456789",
+                "1e400", "-1e-400", "01", "1.", ".5", "-", "1e", "+1", "18446744073709551617",
+            };
+            size_t k = Pick(sizeof(kNums) / sizeof(kNums[0]));
+            if (k >= 13 && Chance(85)) k = Pick(13);
+            return kNums[k];
+        }
+
+        std::string Value(int depth)
+        {
+            switch (depth > 4 ? Pick(5) : Pick(7))
+            {
+            case 0: return Text();
+            case 1: return Number();
+            case 2: return "true";
+            case 3: return "false";
+            case 4: return "null";
+            case 5: {
+                std::string s = "[";
+                const size_t n = Pick(4);
+                for (size_t i = 0; i < n; ++i) { if (i) s += ','; Ws(s); s += Value(depth + 1); }
+                return s + "]";
+            }
+            default: {
+                std::string s = "{";
+                const size_t n = Pick(4);
+                for (size_t i = 0; i < n; ++i) {
+                    if (i) s += ',';
+                    s += Text(); Ws(s); s += ':'; s += Value(depth + 1);
+                }
+                return s + "}";
+            }
+            }
+        }
+
+        std::string Detections()
+        {
+            std::string s = "[";
+            const size_t n = Chance(10) ? 10 + Pick(15) : Pick(5);
+            for (size_t i = 0; i < n; ++i) {
+                if (i) s += ',';
+                Ws(s);
+                if (Chance(90)) {
+                    s += '[';
+                    s += Chance(95) ? Text() : Value(2);
+                    s += ',';
+                    s += Chance(95) ? Number() : Value(2);
+                    if (Chance(50)) {   // 박스 (가끔 원소 부족/비숫자/범위 밖)
+                        const size_t k = Chance(80) ? 4 : Pick(6);
+                        for (size_t b = 0; b < k; ++b) { s += ','; s += Chance(95) ? Number() : Value(2); }
+                    }
+                    if (Chance(20)) { s += ','; s += Value(2); }
+                    s += ']';
+                }
+                else {
+                    s += Value(2);
+                }
+            }
+            return s + "]";
+        }
+
+        std::string Reply()
+        {
+            static const char* kKeys[] = {
+                "\"result\"", "\"reason\"", "\"timestamp\"", "\"det_top\"", "\"det_side\"",
+                "\"ok\"", "\"msg\"", "\"top_fp\"", "\"res\\u0075lt\"", "\"top_result\"",
+            };
+            std::string s;
+            if (Chance(2)) s += "\xEF\xBB\xBF";
+            Ws(s);
+            s += '{';
+            const size_t n = Pick(7);
+            for (size_t i = 0; i < n; ++i) {
+                if (i) s += ',';
+                Ws(s);
+                const size_t k = Pick(sizeof(kKeys) / sizeof(kKeys[0]));
+                s += kKeys[k];
+                Ws(s);
+                s += ':';
+                Ws(s);
+                if (k <= 2 || k == 8) s += Chance(90) ? Text() : Value(1);
+                else if (k <= 4) s += Chance(90) ? Detections() : Value(1);
+                else s += Value(1);
+                Ws(s);
+            }
+            s += '}';
+            Ws(s);
+            return s;
+        }
+
+        void Mutate(std::string& s, size_t count)
+        {
+            static const char kBytes[] = "{}[]\",:\\ 0-.eE";
+            for (size_t i = 0; i < count && !s.empty(); ++i) {
+                const size_t at = Pick(s.size());
+                switch (Pick(3))
+                {
+                case 0: s[at] = Chance(50) ? kBytes[Pick(sizeof(kBytes) - 1)] : static_cast<char>(Pick(256)); break;
+                case 1: s.erase(at, 1); break;
+                default: s.insert(at, 1, kBytes[Pick(sizeof(kBytes) - 1)]); break;
+                }
+            }
+        }
+
+        std::string RandomBytes()
+        {
+            std::string s(Pick(32), '\0');
+            for (char& c : s) c = static_cast<char>(Pick(256));
+            return s;
+        }
+
+        std::mt19937 m_rng;
+    };
+
+    void PrintInput(const std::string& s)
+    {
+        std::printf("  input (%zu bytes): \"", s.size());
+        for (unsigned char c : s) {
+            if (c >= 0x20 && c < 0x7F && c != '\\') std::putchar(c);
+            else std::printf("\\x%02X", c);
+        }
+        std::printf("\"\n");
+    }
+
+    // 한 입력 비교. 같으면 true.
+    bool CheckOne(const std::string& text, InspectionReply& fast, bool verbose)
+    {
+        ReplyError fastErr;
+        const bool fastOk = ParseInspectionReply(text.data(), text.size(), fast, &fastErr);
+        RefReply ref;
+        const ReplyError refErr = RefParse(text, ref);
+
+        bool same = fastErr == refErr;
+        if (same && fastOk) {
+            same = SameText(fast.result, ref.result) && SameText(fast.reason, ref.reason)
+                && SameText(fast.timestamp, ref.timestamp)
+                && SameList(fast.top, ref.top) && SameList(fast.side, ref.side);
+        }
+        if (!same || verbose) {
+            std::printf("%s fast=%s ref=%s\n", same ? "same" : "MISMATCH",
+                ReplyErrorName(fastErr), ReplyErrorName(refErr));
+            PrintInput(text);
+            if (fastOk && refErr == ReplyError::None && !same) {
+                std::printf("  fast: result=%s reason=%s det_top=%u det_side=%u\n",
+                    fast.result.c_str(), fast.reason.c_str(), fast.top.count, fast.side.count);
+                std::printf("  ref : result=%s reason=%s det_top=%zu det_side=%zu\n",
+                    ref.result.c_str(), ref.reason.c_str(), ref.top.items.size(), ref.side.items.size());
+            }
+        }
+        return same;
+    }
+
+    double Seconds(std::chrono::steady_clock::duration d)
+    {
+        return std::chrono::duration<double>(d).count();
+    }
+
+    // ===== 벤치마크 =====
+    void Bench(const char* name, const std::string& text, size_t iters)
+    {
+        using Clock = std::chrono::steady_clock;
+        InspectionReply fast;
+        size_t sink = 0;
+
+        const uint64_t a0 = g_allocs.load();
+        const auto f0 = Clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            ParseInspectionReply(text.data(), text.size(), fast);
+            sink += fast.result.size + fast.top.count;
+        }
+        const double fastSec = Seconds(Clock::now() - f0);
+        const uint64_t fastAllocs = g_allocs.load() - a0;
+
+        const uint64_t b0 = g_allocs.load();
+        const auto r0 = Clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            RefReply ref;
+            RefParse(text, ref);
+            sink += ref.result.size() + ref.top.items.size();
+        }
+        const double refSec = Seconds(Clock::now() - r0);
+        const uint64_t refAllocs = g_allocs.load() - b0;
+
+        std::printf("%-8s %6zu %10.1f %10.1f %8.1fx %9.2f %9.2f\n", name, text.size(),
+            fastSec / iters * 1e9, refSec / iters * 1e9, refSec / (fastSec > 0 ? fastSec : 1e-12),
+            static_cast<double>(fastAllocs) / iters, static_cast<double>(refAllocs) / iters);
+        if (sink == 42) std::printf(" ");   // 최적화로 루프가 사라지지 않게
+    }
+
+    // ===== 바이너리 응답 =====
+    void RandomList(std::mt19937& rng, DetectionList& list)
+    {
+        list.Clear();
+        list.present = true;
+        const size_t n = rng() % (DetectionList::kCapacity + 1);
+        for (size_t i = 0; i < n; ++i) {
+            Detection& d = list.items[list.count++];
+            d.labelId = static_cast<uint8_t>(rng() % 8 == 0 ? DefectLabels::kUnknown : rng() % DefectLabels::kCount);
+            d.score = static_cast<float>(rng() % 10001) / 10000.0f;
+            d.x = static_cast<uint16_t>(rng()); d.y = static_cast<uint16_t>(rng());
+            d.w = static_cast<uint16_t>(rng()); d.h = static_cast<uint16_t>(rng());
+        }
+    }
+
+    bool SameDetections(const DetectionList& a, const DetectionList& b)
+    {
+        if (a.count != b.count) return false;
+        for (size_t i = 0; i < a.count; ++i) {
+            const Detection& x = a.items[i];
+            const Detection& y = b.items[i];
+            if (x.labelId != y.labelId || x.x != y.x || x.y != y.y || x.w != y.w || x.h != y.h) return false;
+            if (std::fabs(x.score - y.score) > 0.5e-4f) return false;
+            if (y.label != DefectLabels::Name(x.labelId)) return false;
+        }
+        return true;
+    }
+
+    bool FuzzBinary(uint32_t seed, size_t count)
+    {
+        std::mt19937 rng(seed);
+        uint8_t raw[BinaryReply::kMaxSize];
+        InspectionReply out;
+        size_t mutated = 0, mutatedAccepted = 0;
+
+        for (size_t n = 0; n < count; ++n)
+        {
+            BinaryReply::Fields f;
+            f.result = static_cast<BinaryReply::Verdict>(rng() % 3);
+            f.topResult = static_cast<BinaryReply::ViewVerdict>(rng() % 4);
+            f.sideResult = static_cast<BinaryReply::ViewVerdict>(rng() % 4);
+            f.reason = static_cast<BinaryReply::ReasonCode>(rng() % 5);
+            f.serverUs = rng();
+            f.aiUs = rng();
+            f.timestampMs = 1700000000000ull + rng();
+            DetectionList top, side;
+            RandomList(rng, top);
+            RandomList(rng, side);
+
+            const size_t size = BinaryReply::Serialize(f, top, side, raw);
+            if (!ParseInspectionReply(reinterpret_cast<const char*>(raw), size, out)
+                || !out.binary || out.serverUs != f.serverUs || out.aiUs != f.aiUs
+                || !SameDetections(top, out.top) || !SameDetections(side, out.side)
+                || out.timestamp.size != 19) {
+                std::printf("binary: round trip mismatch at %zu (seed %u)\n", n, seed);
+                return false;
+            }
+
+            // 변형/절단: 실패하거나, 성공하면 개수가 크기 필드와 맞아야 함 (ASan 빌드로 범위 밖 읽기 확인)
+            for (int k = 0; k < 4; ++k) {
+                std::vector<uint8_t> bad(raw, raw + size);
+                if (rng() % 2) bad.resize(rng() % (size + 1));
+                const size_t flips = 1 + rng() % 3;
+                for (size_t i = 0; i < flips && !bad.empty(); ++i)
+                    bad[rng() % bad.size()] = static_cast<uint8_t>(rng());
+                ++mutated;
+                if (ParseInspectionReply(reinterpret_cast<const char*>(bad.data()), bad.size(), out)) {
+                    ++mutatedAccepted;
+                    const size_t expect = BinaryReply::kHeaderSize + (out.top.count + out.top.dropped +
+                        out.side.count + out.side.dropped) * BinaryReply::kDetectionSize;
+                    if (out.binary && expect > bad.size()) {
+                        std::printf("binary: accepted %zu bytes but needs %zu\n", bad.size(), expect);
+                        return false;
+                    }
+                }
+            }
+        }
+        std::printf("binary: %zu round trips ok, %zu mutated inputs (%zu still valid)\n",
+            count, mutated, mutatedAccepted);
+        return true;
+    }
+
+    void BenchBinary(const std::string& jsonText, size_t iters)
+    {
+        using Clock = std::chrono::steady_clock;
+        InspectionReply reply;
+        ParseInspectionReply(jsonText.data(), jsonText.size(), reply);
+
+        BinaryReply::Fields f;
+        f.result = BinaryReply::Verdict::Defect;
+        f.topResult = BinaryReply::ViewVerdict::Abnormal;
+        f.sideResult = BinaryReply::ViewVerdict::Normal;
+        f.timestampMs = 1760832902000ull;
+        uint8_t raw[BinaryReply::kMaxSize];
+        const size_t size = BinaryReply::Serialize(f, reply.top, reply.side, raw);
+
+        size_t sink = 0;
+        const uint64_t a0 = g_allocs.load();
+        const auto t0 = Clock::now();
+        for (size_t i = 0; i < iters; ++i) {
+            ParseInspectionReply(reinterpret_cast<const char*>(raw), size, reply);
+            sink += reply.top.count;
+        }
+        const double sec = Seconds(Clock::now() - t0);
+        const uint64_t allocs = g_allocs.load() - a0;
+        std::printf("%-8s %6zu %10.1f %10s %9s %9.2f %9s   (det %u/%u, reason/timestamp 조립 포함)\n",
+            "binary", size, sec / iters * 1e9, "-", "-", static_cast<double>(allocs) / iters, "-",
+            reply.top.count, reply.side.count);
+        if (sink == 42) std::printf(" ");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t fuzz = 200000;
+    size_t iters = 200000;
+    uint32_t seed = 1;
+    bool verbose = false;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { std::fprintf(stderr, "%s: 값 필요\n", a.c_str()); std::exit(2); }
+            return argv[++i];
+        };
+        if (a == "--fuzz") fuzz = std::strtoull(next(), nullptr, 10);
+        else if (a == "--iters") iters = std::strtoull(next(), nullptr, 10);
+        else if (a == "--seed") seed = static_cast<uint32_t>(std::strtoul(next(), nullptr, 10));
+        else if (a == "--verbose") verbose = true;
+        else { std::fprintf(stderr, "알 수 없는 옵션: %s\n", a.c_str()); return 2; }
+    }
+
+    // ===== 퍼징 =====
+    if (fuzz > 0)
+    {
+        Generator gen(seed);
+        InspectionReply fast;
+        size_t accepted = 0, truncated = 0;
+        size_t byError[8] = {};
+        for (size_t n = 0; n < fuzz; ++n) {
+            const std::string text = gen.Next();
+            if (!CheckOne(text, fast, verbose)) {
+                std::printf("fuzz: mismatch after %zu inputs (seed %u)\n", n, seed);
+                return 1;
+            }
+            ReplyError e;
+            if (ParseInspectionReply(text.data(), text.size(), fast, &e)) {
+                ++accepted;
+                if (fast.reason.truncated || fast.result.truncated || fast.timestamp.truncated) ++truncated;
+            }
+            ++byError[static_cast<size_t>(e)];
+        }
+        std::printf("fuzz: %zu inputs, all equivalent (accepted %zu, truncated %zu; syntax %zu, "
+            "not-object %zu, missing %zu, type %zu)\n", fuzz, accepted, truncated,
+            byError[static_cast<size_t>(ReplyError::Syntax)] + byError[static_cast<size_t>(ReplyError::Empty)],
+            byError[static_cast<size_t>(ReplyError::NotObject)],
+            byError[static_cast<size_t>(ReplyError::MissingResult)],
+            byError[static_cast<size_t>(ReplyError::TypeMismatch)]);
+
+        if (!FuzzBinary(seed, fuzz / 10 + 1))
+            return 1;
+    }
+
+    // ===== 벤치마크 =====
+    if (iters > 0)
+    {
+        const std::string ack = "{\"ok\":true,\"msg\":\"TOP saved\"}";
+        const std::string verdict =
+            "{\"result\":\"불량\",\"reason\":\"TOP: 비정상(top_dent) · SIDE: 정상\","
+            "\"timestamp\":\"2026-10-19 09:15:02\"}";
+        const std::string ai =
+            "{\"result\": \"비정상\", \"top_result\": \"비정상\", \"side_result\": \"정상\", "
+            "\"det_top\": [[\"top_dent\", 0.9134, 212, 180, 96, 64], [\"top_normal\", 0.4211, 140, 132, 360, 356], "
+            "[\"top_no_tap\", 0.1875, 236, 220, 168, 170]], "
+            "\"det_side\": [[\"side_normal\", 0.8822, 96, 40, 448, 560], [\"side_dent\", 0.2051, 300, 310, 72, 90], "
+            "[\"side_foreign\", 0.1377, 180, 402, 40, 22], [\"side_normal\", 0.1002, 110, 60, 420, 530]]}";
+
+        std::printf("\nreply    bytes  fast(ns)  json(ns)  speedup  allocs/f  allocs/j\n");
+        Bench("ack", ack, iters);
+        Bench("verdict", verdict, iters);
+        Bench("ai", ai, iters);
+        BenchBinary(ai, iters);
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+﻿// screen_bench.cpp — 로컬 1차 선별 모델('CNSM') 정확도/처리량 측정 (MFC/Pylon 비의존, Linux/Windows 공용)
+//
+// 빌드 (Linux, OpenCV 있으면 jpg/png 데이터셋 직접 읽음):
+//   g++ -std=c++17 -O3 -march=native -I.. screen_bench.cpp ../LocalScreen.cpp ../Preprocess.cpp
+//       ../FrameSource.cpp ../ImageEncoder.cpp ../PngEncoder.cpp ../Deflate.cpp ../ThreadPool.cpp
+//       ../LatencyStats.cpp -o screen_bench -lpthread $(pkg-config --cflags --libs opencv4)
+//   (OpenCV 없이: 마지막 pkg-config 제외, ppm/qoi/bgr 만 읽힘)
+//
+// 사용:
+//   screen_bench <데이터셋 루트 | 이미지 폴더> [옵션]
+//     --model PATH         두 뷰 공용 모델
+//     --model-top PATH     TOP 뷰 모델 (라벨 클래스 0/1/4 또는 이름에 top)
+//     --model-side PATH    SIDE 뷰 모델 (라벨 클래스 2/3/5 또는 이름에 side/front)
+//     --random-model       학습된 모델 없이 무작위 가중치 (처리량/자체 검사용)
+//     --synthetic N        파일 대신 합성 영상 N장 (2448x2048)
+//     --split NAME         데이터셋 루트일 때 images/NAME + labels/NAME (기본 val)
+//     --threads N          다중 스레드 처리량 측정 병렬도 (기본 코어 수)
+//     --reps N             처리량 반복 횟수 (기본 3)
+//     --export PATH        TOP 모델을 'CNSM' 파일로 저장 (무작위 모델로 stand_in_server 연동 시험용)
+//   예) screen_bench ../../datasets/can_defect --model-top screen_top.cnsm --model-side screen_side.cnsm
+//
+// 라벨: YOLO txt (클래스 ID < 4 가 하나라도 있으면 불량, 파일이 없거나 비면 정상).
+// 출력:
+//   - 자체 검사: 최적화 경로(RunPrepared)와 단순 참조 경로(RunReference)가 비트 단위로 같은지
+//   - 임계값별 로컬 통과율 / 불량 누락률 / 정상 통과율 (pass_below 선택용, 누락률 0 이 목표)
+//   - 단일/다중 스레드 처리량 (원본 프레임 → 레터박스 → 추론, 다이얼로그 Screen 단계와 같은 경로)
+
+#include "FrameSource.h"
+#include "ImageEncoder.h"
+#include "LatencyStats.h"
+#include "LocalScreen.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    enum View { kTop = 0, kSide = 1 };
+
+    struct Sample
+    {
+        ImageBuffer image;
+        int  view = kTop;
+        bool defect = false;
+        float prob = -1.0f;
+    };
+
+    // YOLO 라벨 → (뷰, 불량). 라벨에 뷰 클래스가 없으면 파일 이름으로.
+    void ReadLabel(const fs::path& image, const fs::path& labelDir, Sample& s)
+    {
+        std::string name = image.stem().string();
+        std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        s.view = (name.find("side") != std::string::npos || name.find("front") != std::string::npos) ? kSide : kTop;
+
+        std::ifstream in(labelDir / (image.stem().string() + ".txt"));
+        int cls;
+        float rest[4];
+        while (in >> cls >> rest[0] >> rest[1] >> rest[2] >> rest[3])
+        {
+            s.defect = s.defect || cls < 4;
+            if (cls == 0 || cls == 1 || cls == 4) s.view = kTop;
+            if (cls == 2 || cls == 3 || cls == 5) s.view = kSide;
+        }
+    }
+
+    // 회색 배경 + 밝은 원(캔) + 불량이면 어두운 얼룩
+    void MakeSynthetic(size_t n, std::vector<Sample>& out)
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> jitter(-120, 120), noise(-6, 6);
+        const int w = 2448, h = 2048;
+        for (size_t i = 0; i < n; ++i)
+        {
+            Sample s;
+            s.view = static_cast<int>(i % 2);
+            s.defect = (i % 5) == 0;
+            s.image.Allocate(w, h);
+            const int cx = w / 2 + jitter(rng), cy = h / 2 + jitter(rng), r = 700;
+            const int bx = cx + jitter(rng), by = cy + jitter(rng);
+            for (int y = 0; y < h; ++y)
+            {
+                uint8_t* row = s.image.Row(y);
+                for (int x = 0; x < w; ++x)
+                {
+                    const int dx = x - cx, dy = y - cy;
+                    int v = (dx * dx + dy * dy < r * r) ? 190 : 60;
+                    if (s.defect && (x - bx) * (x - bx) + (y - by) * (y - by) < 90 * 90)
+                        v = 40;
+                    v += noise(rng);
+                    row[x * 3] = row[x * 3 + 1] = row[x * 3 + 2] = static_cast<uint8_t>(v);
+                }
+            }
+            out.push_back(std::move(s));
+        }
+    }
+
+    void Usage()
+    {
+        std::fprintf(stderr,
+            "usage: screen_bench <dataset|dir> [--model PATH] [--model-top PATH] [--model-side PATH]\n"
+            "                    [--random-model] [--synthetic N] [--split NAME] [--threads N] [--reps N]\n"
+            "                    [--export PATH]\n");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string input, split = "val", modelPath[2], exportPath;
+    bool randomModel = false;
+    size_t synthetic = 0, threads = 0;
+    int reps = 3;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--model" && hasValue)            modelPath[kTop] = modelPath[kSide] = argv[++i];
+        else if (a == "--model-top" && hasValue)   modelPath[kTop] = argv[++i];
+        else if (a == "--model-side" && hasValue)  modelPath[kSide] = argv[++i];
+        else if (a == "--random-model")            randomModel = true;
+        else if (a == "--synthetic" && hasValue)   synthetic = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--split" && hasValue)       split = argv[++i];
+        else if (a == "--threads" && hasValue)     threads = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--reps" && hasValue)        reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--export" && hasValue)      exportPath = argv[++i];
+        else if (a.rfind("--", 0) == 0) { Usage(); return 2; }
+        else input = a;
+    }
+    if (input.empty() && synthetic == 0 && exportPath.empty()) { Usage(); return 2; }
+
+    // ===== 모델 =====
+    CScreenModel models[2];
+    for (int v = 0; v < 2; ++v)
+    {
+        std::string err;
+        if (randomModel)
+            models[v].MakeRandom(160, { 8, 16, 32, 32 }, 1234u + v);
+        else if (modelPath[v].empty() || !models[v].Load(modelPath[v], &err)) {
+            std::fprintf(stderr, "%s model: %s\n", v == kTop ? "top" : "side",
+                modelPath[v].empty() ? "not given (--model-top/--model-side or --random-model)" : err.c_str());
+            return 2;
+        }
+        std::printf("%s model: %s\n", v == kTop ? "top " : "side", models[v].Describe().c_str());
+    }
+
+    if (!exportPath.empty())
+    {
+        const std::vector<uint8_t> bytes = models[kTop].Serialize();
+        CScreenModel check;
+        std::string err;
+        if (!check.LoadFromMemory(bytes.data(), bytes.size(), &err) || check.Serialize() != bytes) {
+            std::fprintf(stderr, "export: round trip failed (%s)\n", err.c_str());
+            return 1;
+        }
+        std::ofstream(exportPath, std::ios::binary).write(reinterpret_cast<const char*>(bytes.data()),
+            static_cast<std::streamsize>(bytes.size()));
+        std::printf("exported %zu bytes → %s\n", bytes.size(), exportPath.c_str());
+        if (input.empty() && synthetic == 0)
+            return 0;
+    }
+
+    // ===== 입력 =====
+    std::vector<Sample> samples;
+    if (synthetic > 0) {
+        MakeSynthetic(synthetic, samples);
+    }
+    else {
+        fs::path imageDir = input, labelDir = input;
+        if (fs::is_directory(fs::path(input) / "images" / split)) {
+            imageDir = fs::path(input) / "images" / split;
+            labelDir = fs::path(input) / "labels" / split;
+        }
+        std::vector<fs::path> files;
+        std::error_code ec;
+        for (const auto& e : fs::directory_iterator(imageDir, ec))
+            if (e.is_regular_file() && IsImageFileName(e.path().string()))
+                files.push_back(e.path());
+        std::sort(files.begin(), files.end());
+
+        size_t skipped = 0;
+        for (const fs::path& f : files)
+        {
+            Sample s;
+            if (!LoadImageFile(f.string(), s.image)) { ++skipped; continue; }
+            ReadLabel(f, labelDir, s);
+            samples.push_back(std::move(s));
+        }
+        std::printf("images: %zu (skipped %zu) from %s\n", samples.size(), skipped, imageDir.string().c_str());
+    }
+    if (samples.empty()) {
+        std::fprintf(stderr, "no images\n");
+        return 2;
+    }
+
+    // ===== 자체 검사: 최적화 경로 == 참조 경로 =====
+    CScreenModel::Scratch scratch;
+    size_t mismatches = 0, checked = 0;
+    for (size_t i = 0; i < samples.size() && checked < 16; ++i, ++checked)
+    {
+        const CScreenModel& m = models[samples[i].view];
+        const ImageView frame = samples[i].image.View();
+        LetterboxResize(frame, ComputeLetterbox(frame.width, frame.height, RoiRect(), m.InputSize()), scratch.input);
+        const ImageBuffer prepared = scratch.input;
+        if (m.RunPrepared(prepared.View(), scratch) != m.RunReference(prepared.View()))
+            ++mismatches;
+    }
+    std::printf("self-test: %zu/%zu identical to reference\n", checked - mismatches, checked);
+
+    // ===== 정확도 =====
+    size_t defects = 0, normals = 0;
+    for (Sample& s : samples)
+    {
+        s.prob = models[s.view].Run(s.image.View(), RoiRect(), scratch);
+        (s.defect ? defects : normals)++;
+    }
+    std::printf("\nlabels: defect %zu, normal %zu\n", defects, normals);
+    std::printf("pass_below  local-pass   defect-miss   normal-pass\n");
+    for (float thr : { 0.01f, 0.02f, 0.05f, 0.10f, 0.20f, 0.30f, 0.50f })
+    {
+        size_t pass = 0, miss = 0, normalPass = 0;
+        for (const Sample& s : samples)
+        {
+            if (s.prob >= thr) continue;
+            ++pass;
+            (s.defect ? miss : normalPass)++;
+        }
+        std::printf("%10.2f  %9.1f%%  %4zu (%5.2f%%)  %9.1f%%\n", thr,
+            100.0 * pass / samples.size(), miss, defects ? 100.0 * miss / defects : 0.0,
+            normals ? 100.0 * normalPass / normals : 0.0);
+    }
+
+    // ===== 처리량 =====
+    const double macs = static_cast<double>(models[kTop].MacCount());
+    uint64_t t0 = NowNs();
+    for (int r = 0; r < reps; ++r)
+        for (const Sample& s : samples)
+            models[s.view].Run(s.image.View(), RoiRect(), scratch);
+    double sec = (NowNs() - t0) / 1e9;
+    const double runs = static_cast<double>(reps) * samples.size();
+    std::printf("\nsingle thread: %.3f ms/view → %.0f views/s (%.2f GMAC/s)\n",
+        sec * 1e3 / runs, runs / sec, runs * macs / sec / 1e9);
+
+    CThreadPool pool(threads);
+    std::atomic<size_t> done{ 0 };
+    t0 = NowNs();
+    for (int r = 0; r < reps; ++r)
+        pool.ParallelFor(samples.size(), [&](size_t i) {
+            thread_local CScreenModel::Scratch local;
+            models[samples[i].view].Run(samples[i].image.View(), RoiRect(), local);
+            done.fetch_add(1, std::memory_order_relaxed);
+        });
+    sec = (NowNs() - t0) / 1e9;
+    std::printf("%zu threads:    %.3f ms/view → %.0f views/s\n", pool.Size(), sec * 1e3 / runs, done.load() / sec);
+
+    return mismatches ? 1 : 0;
+}
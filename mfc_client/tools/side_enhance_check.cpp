@@ -0,0 +1,249 @@
+﻿// side_enhance_check.cpp — 측면 전처리(CSideEnhancer) 검증 + 벤치마크 (MFC/Pylon 비의존, Linux/Windows 공용)
+//
+// 빌드 (Linux, OpenCV 기준 비교 포함):
+//   g++ -std=c++17 -O3 -march=native -I.. side_enhance_check.cpp ../SideEnhance.cpp ../ThreadPool.cpp
+//       ../FrameSource.cpp ../ImageEncoder.cpp ../PngEncoder.cpp ../Deflate.cpp ../LatencyStats.cpp
+//       -o side_enhance_check -lpthread $(pkg-config --cflags --libs opencv4)
+//   (OpenCV 없이: 마지막 pkg-config 제외 → 참조 구현과의 비교만)
+//
+// 사용:
+//   side_enhance_check [이미지 파일/폴더...] [--synthetic WxH] [--threads N] [--reps N] [--limit N]
+//   예) side_enhance_check ../../datasets/can_defect/images/val --limit 20
+//
+// 검사:
+//   1) 융합 경로 == 단계별 참조 구현 (비트 단위, 모든 스레드 수)
+//   2) OpenCV 빌드면 ai_server.py 와 같은 cv2 연쇄와 비교
+//      - 엣지 맵 불일치 비율 (IPP Canny 등 구현 차이) ≤ 0.1%
+//      - 엣지가 같은 픽셀의 출력 차이 ≤ 1 (addWeighted 반올림 경로 차이)
+// 시간: 참조 / 융합 1스레드 / 융합 N스레드 / OpenCV 연쇄 (장당 ms)
+
+#include "FrameSource.h"
+#include "ImageEncoder.h"
+#include "LatencyStats.h"
+#include "OpenCvSupport.h"
+#include "SideEnhance.h"
+
+#ifdef CANCLIENT_HAS_OPENCV
+#include <opencv2/imgproc.hpp>
+#endif
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // 측면 캔 비슷한 합성 영상: 세로 줄무늬 몸통 + 찌그러진 자국 + 잡음
+    void MakeSynthetic(int w, int h, uint32_t seed, ImageBuffer& out)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-8, 8);
+        out.Allocate(w, h);
+        const int left = w / 5, right = w - w / 5;
+        const int dentX = left + static_cast<int>(rng() % std::max(1, right - left)), dentY = static_cast<int>(rng() % std::max(1, h));
+        for (int y = 0; y < h; ++y)
+        {
+            uint8_t* row = out.Row(y);
+            for (int x = 0; x < w; ++x)
+            {
+                int v = 40;
+                if (x >= left && x < right) {
+                    v = 150 + ((x - left) % 64 < 32 ? 30 : -20);
+                    const int dx = x - dentX, dy = y - dentY;
+                    if (dx * dx + dy * dy < (w / 20) * (w / 20)) v -= 60;
+                }
+                row[x * 3 + 0] = static_cast<uint8_t>(std::clamp(v + noise(rng), 0, 255));
+                row[x * 3 + 1] = static_cast<uint8_t>(std::clamp(v + 10 + noise(rng), 0, 255));
+                row[x * 3 + 2] = static_cast<uint8_t>(std::clamp(v - 10 + noise(rng), 0, 255));
+            }
+        }
+    }
+
+#ifdef CANCLIENT_HAS_OPENCV
+    // ai_server.py infer_image(side) 와 같은 연쇄. edges 는 비교용으로 따로 돌려줌.
+    void OpenCvChain(const ImageBuffer& in, cv::Mat& out, cv::Mat& edges)
+    {
+        cv::Mat src(in.height, in.width, CV_8UC3, const_cast<uint8_t*>(in.pixels.data()));
+        cv::Mat img, gray, edges3;
+        cv::convertScaleAbs(src, img, 1.4, 15);
+        cv::cvtColor(img, gray, cv::COLOR_BGR2GRAY);
+        cv::Canny(gray, edges, 60, 180);
+        cv::cvtColor(edges, edges3, cv::COLOR_GRAY2BGR);
+        cv::addWeighted(img, 0.85, edges3, 0.15, 0, img);
+        cv::GaussianBlur(img, out, cv::Size(3, 3), 0);
+    }
+#endif
+
+    double MsPer(uint64_t ns, size_t n) { return n ? ns / 1e6 / n : 0.0; }
+}
+
+int main(int argc, char** argv)
+{
+    std::vector<std::string> inputs;
+    int synthW = 0, synthH = 0, reps = 3;
+    size_t threads = 0, limit = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--synthetic" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &synthW, &synthH) != 2 || synthW <= 0 || synthH <= 0) {
+                std::fprintf(stderr, "bad --synthetic\n");
+                return 2;
+            }
+        }
+        else if (a == "--threads" && hasValue) threads = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--reps" && hasValue)    reps = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--limit" && hasValue)   limit = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a.rfind("--", 0) == 0) {
+            std::fprintf(stderr, "usage: side_enhance_check [files/dirs...] [--synthetic WxH] [--threads N] [--reps N] [--limit N]\n");
+            return 2;
+        }
+        else inputs.push_back(a);
+    }
+
+    // ===== 입력 =====
+    std::vector<ImageBuffer> images;
+    if (synthW > 0 || inputs.empty())
+    {
+        const int w = synthW > 0 ? synthW : 640, h = synthH > 0 ? synthH : 640;
+        for (uint32_t s = 0; s < 4; ++s) {
+            images.emplace_back();
+            MakeSynthetic(w, h, s, images.back());
+        }
+        // 홀수/작은 크기 (SIMD 꼬리, 테두리)
+        for (auto wh : { std::pair<int, int>{ 1, 1 }, { 2, 3 }, { 17, 9 }, { 33, 31 } }) {
+            images.emplace_back();
+            MakeSynthetic(wh.first, wh.second, 99, images.back());
+        }
+    }
+    for (const std::string& in : inputs)
+    {
+        std::vector<fs::path> files;
+        std::error_code ec;
+        if (fs::is_directory(in, ec)) {
+            for (const auto& e : fs::directory_iterator(in, ec))
+                if (e.is_regular_file() && IsImageFileName(e.path().string())) files.push_back(e.path());
+            std::sort(files.begin(), files.end());
+        }
+        else files.push_back(in);
+
+        for (const fs::path& f : files)
+        {
+            if (limit && images.size() >= limit) break;
+            ImageBuffer img;
+            if (LoadImageFile(f.string(), img)) images.push_back(std::move(img));
+            else std::fprintf(stderr, "skip: %s\n", f.string().c_str());
+        }
+    }
+    if (images.empty()) {
+        std::fprintf(stderr, "no images\n");
+        return 2;
+    }
+
+    // ===== 1) 참조 구현과 비트 단위 비교 =====
+    CSideEnhancer single(1), multi(threads);
+    ImageBuffer ref, fused;
+    size_t mismatched = 0;
+    uint64_t refNs = 0;
+    for (const ImageBuffer& img : images)
+    {
+        uint64_t t0 = NowNs();
+        SideEnhanceReference(img.View(), ref);
+        refNs += NowNs() - t0;
+
+        for (CSideEnhancer* e : { &single, &multi })
+        {
+            e->Apply(img.View(), fused);
+            if (fused.pixels != ref.pixels) {
+                ++mismatched;
+                std::fprintf(stderr, "mismatch %dx%d (threads %zu)\n", img.width, img.height, e->Threads());
+            }
+        }
+    }
+    std::printf("images: %zu, fused vs reference: %s\n", images.size(), mismatched ? "MISMATCH" : "identical");
+
+    // ===== 2) OpenCV 연쇄와 비교 =====
+    bool opencvOk = true;
+    uint64_t cvNs = 0;
+#ifdef CANCLIENT_HAS_OPENCV
+    size_t pixels = 0, edgeDiff = 0, valueDiff = 0;
+    int maxDiff = 0;
+    for (const ImageBuffer& img : images)
+    {
+        cv::Mat out, edges;
+        uint64_t t0 = NowNs();
+        OpenCvChain(img, out, edges);
+        cvNs += NowNs() - t0;
+
+        single.Apply(img.View(), fused);
+        const std::vector<uint8_t>& ours = single.EdgeMap();
+        const int w = img.width, h = img.height;
+        auto edgeAt = [&](int x, int y) { return ours[static_cast<size_t>(y) * w + x] == 255; };
+        auto cvEdgeAt = [&](int x, int y) { return edges.at<uint8_t>(y, x) != 0; };
+
+        for (int y = 0; y < h; ++y)
+            for (int x = 0; x < w; ++x)
+            {
+                ++pixels;
+                edgeDiff += edgeAt(x, y) != cvEdgeAt(x, y) ? 1 : 0;
+
+                // 블러 3x3 이웃의 엣지가 모두 같을 때만 출력 값 비교 (엣지 차이의 번짐 제외)
+                bool same = true;
+                for (int j = -1; j <= 1 && same; ++j)
+                    for (int i = -1; i <= 1 && same; ++i) {
+                        const int nx = std::clamp(x + i, 0, w - 1), ny = std::clamp(y + j, 0, h - 1);
+                        same = edgeAt(nx, ny) == cvEdgeAt(nx, ny);
+                    }
+                if (!same) continue;
+                for (int c = 0; c < 3; ++c)
+                {
+                    const int d = std::abs(static_cast<int>(out.at<cv::Vec3b>(y, x)[c]) - fused.Row(y)[x * 3 + c]);
+                    maxDiff = std::max(maxDiff, d);
+                    valueDiff += d > 1 ? 1 : 0;
+                }
+            }
+    }
+    const double edgeRatio = pixels ? static_cast<double>(edgeDiff) / pixels : 0.0;
+    opencvOk = edgeRatio <= 0.001 && valueDiff == 0;
+    std::printf("vs OpenCV: edge map differs at %.4f%% of pixels (limit 0.1%%), "
+        "max |diff| elsewhere %d (limit 1) → %s\n", edgeRatio * 100.0, maxDiff, opencvOk ? "OK" : "FAIL");
+#else
+    std::printf("vs OpenCV: skipped (built without OpenCV)\n");
+#endif
+
+    // ===== 3) 시간 =====
+    auto timeIt = [&](CSideEnhancer& e) {
+        ImageBuffer out;
+        const uint64_t t0 = NowNs();
+        for (int r = 0; r < reps; ++r)
+            for (const ImageBuffer& img : images)
+                e.Apply(img.View(), out);
+        return NowNs() - t0;
+    };
+    const size_t runs = images.size() * static_cast<size_t>(reps);
+    uint64_t mpix = 0;
+    for (const ImageBuffer& img : images) mpix += static_cast<uint64_t>(img.width) * img.height;
+    const uint64_t singleNs = timeIt(single);
+    const uint64_t multiNs = timeIt(multi);
+
+    std::printf("\n%-22s %10s %10s\n", "path", "ms/image", "Mpix/s");
+    std::printf("%-22s %10.2f %10.1f\n", "reference", MsPer(refNs, images.size()), refNs ? mpix / (refNs / 1e3) : 0.0);
+    std::printf("%-22s %10.2f %10.1f\n", "fused (1 thread)", MsPer(singleNs, runs), mpix * reps / (singleNs / 1e3));
+    char label[32];
+    std::snprintf(label, sizeof(label), "fused (%zu threads)", multi.Threads());
+    std::printf("%-22s %10.2f %10.1f\n", label, MsPer(multiNs, runs), mpix * reps / (multiNs / 1e3));
+    if (cvNs)
+        std::printf("%-22s %10.2f %10.1f\n", "opencv chain", MsPer(cvNs, images.size()), mpix / (cvNs / 1e3));
+
+    return (mismatched || !opencvOk) ? 1 : 0;
+}
@@ -0,0 +1,227 @@
+﻿// spool_harness.cpp — 오프라인 전송 대기열(COutboundQueue) 점검 도구
+//
+// 서버가 꺼진 동안 검사 코어가 요청을 대기열 파일에 쌓고(fill), 다른 프로세스가 같은 파일을 열어
+// 서버가 돌아온 뒤 비우는(drain) 과정을 재현한다. 두 단계를 따로 실행하므로 재시작 뒤 이어 보내기까지 확인된다.
+// 대체 서버(stand_in_server --pairing header)에 보내면 TOP 은 저장 응답, SIDE 는 판정이 와야 한다.
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O2 -I.. -I../packages/nlohmann.json.3.12.0/build/native/include
+//       spool_harness.cpp ../OutboundQueue.cpp ../InspectionCore.cpp ../InspectionClient.cpp
+//       ../FrameSource.cpp ../ClientConfig.cpp ../ImageEncoder.cpp ../CodecSelector.cpp
+//       ../PngEncoder.cpp ../Deflate.cpp ../ThreadPool.cpp ../Preprocess.cpp ../RequestHeader.cpp
+//       ../ReplyParser.cpp ../PresenceDetector.cpp ../LatencyStats.cpp ../LocalScreen.cpp
+//       ../SideEnhance.cpp ../Station.cpp ../CameraClock.cpp ../EndpointPool.cpp -o spool_harness -lpthread
+//
+// 사용:
+//   spool_harness fill  --spool PATH --count N --synthetic WxH [--server HOST:PORT] [--capacity-mb M]
+//       검사 단위 N 개(TOP+FRONT)를 보냄. 서버가 없으면 전부 대기열로 (기본 서버 127.0.0.1:1 = 항상 거절)
+//   spool_harness drain --spool PATH --server HOST:PORT [--concurrency C] [--retry-ms MS] [--timeout SEC]
+//       대기열이 빌 때까지 배출하고 응답을 분류. 시간 안에 못 비우거나 짝이 틀리면 종료 코드 1.
+//       --server 를 여러 번 주면 서버 풀로 배출 (단위별 분배, 끝에 서버별 결과)
+//   spool_harness stat  --spool PATH
+//
+// 예:
+//   ./spool_harness fill --spool /tmp/spool.bin --count 200 --synthetic 640x480
+//   ./stand_in_server --port 9100 --latency fixed:20 --quiet &
+//   ./spool_harness drain --spool /tmp/spool.bin --server 127.0.0.1:9100 --concurrency 4
+
+#include "FrameSource.h"
+#include "InspectionCore.h"
+#include "OutboundQueue.h"
+#include "SocketCompat.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+namespace
+{
+    struct Options
+    {
+        std::string command, spoolPath, serverArg = "127.0.0.1:1";
+        std::vector<std::string> poolArgs;      // --server 를 두 번 이상 주면 전부
+        size_t count = 0;
+        int    synthW = 0, synthH = 0;
+        int    capacityMb = 256;
+        int    concurrency = 4;
+        int    retryMs = 200;
+        double timeout = 60.0;
+    };
+
+    bool ParseServer(const std::string& arg, ServerEndpoint& server)
+    {
+        const size_t colon = arg.rfind(':');
+        if (colon == std::string::npos) return false;
+        server.host = arg.substr(0, colon);
+        server.port = std::atoi(arg.c_str() + colon + 1);
+        return true;
+    }
+
+    int Fill(const Options& o, COutboundQueue& spool)
+    {
+        ClientConfig cfg;
+        ParseServer(o.serverArg, cfg.server);
+        cfg.encoder.archive = cfg.encoder.archivePng = false;
+        cfg.encoder.pngThreads = 1;
+
+        FileSourceOptions opt;
+        opt.rate = 0.0;
+        opt.loops = 0;
+        opt.limit = o.count;
+        CFileFrameSource source;
+        source.OpenSynthetic(o.synthW, o.synthH, 8, opt, 1234u);
+
+        CLatencyStats stages;
+        CInspectionPipeline pipeline(stages);
+        pipeline.Configure(cfg);
+        pipeline.SetSpool(&spool);
+
+        CapturePair pair;
+        uint64_t scheduled = 0, sequence = 0, queued = 0, sent = 0, failed = 0;
+        const uint64_t start = NowNs();
+        while (source.Next(pair, scheduled))
+        {
+            ViewRequest req;
+            ViewOutcome top, front;
+            req.sequence = ++sequence;
+            req.productId = "SPOOL";
+            req.frame = pair.top->View();
+            const bool topOk = pipeline.ProcessView(req, top);
+
+            req.frame = pair.front->View();
+            req.role = CameraRole::Front;
+            const bool frontOk = topOk && pipeline.ProcessView(req, front);
+
+            if (!frontOk)                        ++failed;
+            else if (top.queued || front.queued) ++queued;
+            else                                 ++sent;
+        }
+        const double elapsed = (NowNs() - start) / 1e9;
+        std::printf("fill: %llu units in %.2f s — queued %llu, sent directly %llu, failed %llu\n",
+            (unsigned long long)sequence, elapsed, (unsigned long long)queued,
+            (unsigned long long)sent, (unsigned long long)failed);
+        std::printf("%s", FormatSpoolStatus(spool.GetStatus(), SteadyToUnixMs(NowNs())).c_str());
+        return failed ? 1 : 0;
+    }
+
+    int Drain(const Options& o, COutboundQueue& spool)
+    {
+        ServerEndpoint server;
+        if (!ParseServer(o.serverArg, server)) { std::fprintf(stderr, "bad --server\n"); return 2; }
+
+        CEndpointPool pool;
+        if (o.poolArgs.size() > 1) {
+            EndpointPoolConfig pc;
+            for (const std::string& arg : o.poolArgs) {
+                ServerEndpoint e;
+                if (!ParseServer(arg, e)) { std::fprintf(stderr, "bad --server\n"); return 2; }
+                pc.endpoints.push_back(e);
+            }
+            pool.Configure(server, pc);
+            pool.StartProbes();
+            spool.SetEndpointPool(&pool);
+        }
+
+        const size_t initial = spool.Depth();
+        std::mutex lock;
+        uint64_t topAcks = 0, verdicts = 0, errors = 0, mispaired = 0, garbage = 0;
+
+        const uint64_t start = NowNs();
+        spool.StartDrain(server, o.concurrency, o.retryMs,
+            [&](const RequestHeader::Fields& meta, const std::string& response) {
+                std::lock_guard<std::mutex> g(lock);
+                if (response.empty())
+                    return;              // 버린 레코드 (TOP 받은 서버 모름) → abandoned
+                try {
+                    const json j = json::parse(response);
+                    const bool isVerdict = j.contains("result");
+                    const bool isAck = !isVerdict && j.value("ok", false);
+                    const bool isSide = meta.hasRole && meta.role == CameraRole::Front;
+                    if (isVerdict && j["result"].get<std::string>() == "에러") ++errors;
+                    else if (isSide ? isVerdict : isAck)                     (isSide ? verdicts : topAcks)++;
+                    else if (isVerdict || isAck)                             ++mispaired;
+                    else                                                     ++garbage;
+                }
+                catch (const std::exception&) {
+                    ++garbage;
+                }
+            });
+
+        while (spool.Depth() > 0 && (NowNs() - start) / 1e9 < o.timeout)
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        const double elapsed = (NowNs() - start) / 1e9;
+        spool.StopDrain();
+        spool.SetEndpointPool(nullptr);
+        pool.StopProbes();
+
+        const COutboundQueue::Status s = spool.GetStatus();
+        std::printf("drain: %zu → %zu records in %.2f s (%.0f req/s, %d connections)\n",
+            initial, s.records, elapsed, elapsed > 0 ? s.delivered / elapsed : 0.0, o.concurrency);
+        std::printf("       TOP ack %llu, verdict %llu, error %llu, mispaired %llu, bad reply %llu, retries %llu, abandoned %llu\n",
+            (unsigned long long)topAcks, (unsigned long long)verdicts, (unsigned long long)errors,
+            (unsigned long long)mispaired, (unsigned long long)garbage, (unsigned long long)s.retries,
+            (unsigned long long)s.abandoned);
+        if (o.poolArgs.size() > 1)
+            std::printf("%s", pool.Report().c_str());
+        return (s.records || errors || mispaired || garbage || s.abandoned) ? 1 : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Options o;
+    if (argc >= 2) o.command = argv[1];
+    for (int i = 2; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--spool" && hasValue)             o.spoolPath = argv[++i];
+        else if (a == "--server" && hasValue)
+        {
+            o.serverArg = argv[++i];
+            o.poolArgs.push_back(o.serverArg);
+        }
+        else if (a == "--count" && hasValue)        o.count = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--capacity-mb" && hasValue)  o.capacityMb = std::atoi(argv[++i]);
+        else if (a == "--concurrency" && hasValue)  o.concurrency = std::atoi(argv[++i]);
+        else if (a == "--retry-ms" && hasValue)     o.retryMs = std::atoi(argv[++i]);
+        else if (a == "--timeout" && hasValue)      o.timeout = std::atof(argv[++i]);
+        else if (a == "--synthetic" && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &o.synthW, &o.synthH) != 2) o.synthW = 0;
+        }
+        else {
+            std::fprintf(stderr, "bad option: %s (see header comment for usage)\n", a.c_str());
+            return 2;
+        }
+    }
+    const bool fill = o.command == "fill", drain = o.command == "drain", stat = o.command == "stat";
+    if (o.spoolPath.empty() || !(fill || drain || stat) || (fill && (o.count == 0 || o.synthW <= 0))) {
+        std::fprintf(stderr, "usage: spool_harness fill|drain|stat --spool PATH [options]\n");
+        return 2;
+    }
+
+    COutboundQueue spool;
+    std::string err;
+    if (!spool.Open(o.spoolPath, static_cast<uint64_t>(o.capacityMb) << 20, &err)) {
+        std::fprintf(stderr, "spool: %s\n", err.c_str());
+        return 2;
+    }
+
+    Net::Startup();
+    int rc = 0;
+    if (fill)       rc = Fill(o, spool);
+    else if (drain) rc = Drain(o, spool);
+    else            std::printf("%s", FormatSpoolStatus(spool.GetStatus(), SteadyToUnixMs(NowNs())).c_str());
+    spool.Close();
+    Net::Cleanup();
+    return rc;
+}
@@ -0,0 +1,542 @@
+﻿// stand_in_server.cpp — 검사 서버 대체용 루프백 서버 (부하/장애 시험)
+//
+// C# TcpInspectionServer 와 같은 프로토콜을 말한다:
+//   요청: [선택 'CNHD' 헤더][4바이트 길이(BE)][이미지]
+//   응답: TOP  → {"ok":true,"msg":"TOP saved"}
+//         SIDE → {"result":"정상|불량|에러","reason":"...","timestamp":"yyyy-MM-dd HH:mm:ss"}
+//         헤더가 바이너리 응답을 요청하면 (replyFormat = 1) 같은 내용을 'CNRP' 로 (ReplyParser.h)
+//   상태 확인: 'CNHC' 4바이트 → {"ok":true,"ai":true,"active":N,"pending":M} 후 닫음 (EndpointPool.h)
+// 실제 서버처럼 v3 헤더의 역할 + (제품번호, 단위 번호)로, 헤더가 없거나 v2 이하면 도착 순서로
+// TOP/SIDE 를 짝짓고 (--pairing header), 응답에 짝지은 두 본문의
+// 지문(top_fp / side_fp, PayloadFingerprint)을 덧붙여 부하 생성기가 엇갈린 짝을 찾을 수 있게 한다.
+// AI 추론 대신 설정한 분포로 지연을 넣고, 오류/끊김을 확률적으로 주입한다.
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O2 -I.. stand_in_server.cpp ../LatencyStats.cpp ../ReplyParser.cpp ../RequestHeader.cpp
+//       -o stand_in_server -lpthread
+//
+// 사용:
+//   stand_in_server [옵션]
+//     --bind ADDR          (기본 127.0.0.1)
+//     --port N             (기본 19000)
+//     --threads N          동시 처리 연결 수 (기본 64)
+//     --pairing header|order|none
+//                          header = 실제 서버처럼 v3 헤더 역할/단위 번호 (없으면 도착 순서, 기본)
+//                          order  = 헤더를 무시하고 도착 순서로 TOP→SIDE (v2 이전 서버), none = 요청마다 판정
+//     --latency DIST       판정 응답 지연 (기본 lognormal:40,0.35)
+//     --ack-latency DIST   TOP 저장 응답 지연 (기본 fixed:0)
+//         DIST = fixed:MS | uniform:LO,HI | normal:MEAN,SD | exp:MEAN | lognormal:MEDIAN,SIGMA
+//     --defect-rate P      불량 판정 비율 (기본 0.1)
+//     --error-rate P       {"result":"에러"} 응답
+//     --garbage-rate P     JSON 이 아닌 응답
+//     --drop-rate P        본문을 받은 뒤 응답 없이 끊기
+//     --reset-rate P       길이만 받고 본문 도중에 끊기
+//     --stall-rate P       --stall-ms 만큼 멈췄다가 응답 (타임아웃 시험)
+//     --stall-ms N         (기본 30000)
+//     --keep-alive         응답 후 같은 연결에서 다음 요청을 계속 받음
+//     --ai-down            상태 확인에 "ai":false 로 답함 (Python AI 서버 장애 흉내)
+//     --duration SEC       지정 시간 후 요약을 찍고 종료 (기본 0 = 계속)
+//     --seed N             난수 시드
+//     --quiet              초당 진행 줄 생략
+
+#include "EndpointPool.h"
+#include "InspectionClient.h"
+#include "LatencyStats.h"
+#include "ReplyParser.h"
+#include "SocketCompat.h"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Net;
+
+namespace
+{
+    // ===== 지연 분포 =====
+    struct LatencyDist
+    {
+        enum Kind { Fixed, Uniform, Normal, Exp, LogNormal } kind = Fixed;
+        double a = 0.0;
+        double b = 0.0;
+
+        bool Parse(const std::string& s)
+        {
+            const size_t colon = s.find(':');
+            if (colon == std::string::npos) return false;
+            const std::string name = s.substr(0, colon);
+            const int n = std::sscanf(s.c_str() + colon + 1, "%lf,%lf", &a, &b);
+            if (name == "fixed" && n >= 1)          kind = Fixed;
+            else if (name == "uniform" && n == 2)   kind = Uniform;
+            else if (name == "normal" && n == 2)    kind = Normal;
+            else if (name == "exp" && n >= 1)       kind = Exp;
+            else if (name == "lognormal" && n == 2) kind = LogNormal;
+            else return false;
+            return a >= 0.0;
+        }
+
+        double SampleMs(std::mt19937_64& rng) const
+        {
+            switch (kind)
+            {
+            case Uniform:   return std::uniform_real_distribution<double>(a, b)(rng);
+            case Normal:    return std::max(0.0, std::normal_distribution<double>(a, b)(rng));
+            case Exp:       return a > 0 ? std::exponential_distribution<double>(1.0 / a)(rng) : 0.0;
+            case LogNormal: return a > 0 ? std::lognormal_distribution<double>(std::log(a), b)(rng) : 0.0;
+            default:        return a;
+            }
+        }
+    };
+
+    struct Options
+    {
+        std::string bind = "127.0.0.1";
+        int         port = 19000;
+        int         threads = 64;
+        enum class Pairing { Header, Order, None } pairing = Pairing::Header;
+        LatencyDist latency{ LatencyDist::LogNormal, 40.0, 0.35 };
+        LatencyDist ackLatency;
+        double defectRate = 0.1;
+        double errorRate = 0.0;
+        double garbageRate = 0.0;
+        double dropRate = 0.0;
+        double resetRate = 0.0;
+        double stallRate = 0.0;
+        int    stallMs = 30000;
+        bool   keepAlive = false;
+        bool   aiDown = false;
+        double duration = 0.0;
+        uint64_t seed = 1;
+        bool   quiet = false;
+    };
+
+    // ===== 카운터 =====
+    struct Counters
+    {
+        std::atomic<uint64_t> connections{ 0 }, active{ 0 }, probes{ 0 };
+        std::atomic<uint64_t> requests{ 0 }, headers{ 0 }, binary{ 0 }, bytes{ 0 };
+        std::atomic<uint64_t> tops{ 0 }, verdicts{ 0 }, defects{ 0 }, byHeader{ 0 }, orphans{ 0 };
+        std::atomic<uint64_t> errors{ 0 }, garbage{ 0 }, drops{ 0 }, resets{ 0 }, stalls{ 0 }, bad{ 0 };
+    };
+
+    Options  g_opt;
+    Counters g_count;
+    CLatencyHistogram g_service;    // 본문 수신 완료 → 응답 송신 완료
+
+    // ===== 짝짓기 (TcpInspectionServer 의 _pendingTop / _pendingByKey 와 같은 전역 상태) =====
+    std::mutex g_pairMutex;
+    bool       g_hasPendingTop = false;     // 도착 순서 (헤더 없음 / v2 이하)
+    uint32_t   g_pendingTopFp = 0;
+    std::map<std::string, uint32_t> g_pendingByKey;   // "제품번호#단위 번호" → TOP 지문
+    constexpr size_t kMaxPendingKeys = 4096;          // SIDE 가 끝내 안 온 TOP 이 쌓이지 않게
+
+
+    std::string Timestamp()
+    {
+        const std::time_t now = std::time(nullptr);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &now);
+#else
+        localtime_r(&now, &tm);
+#endif
+        char buf[32];
+        std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+        return buf;
+    }
+
+    void SleepMs(double ms)
+    {
+        if (ms > 0.0)
+            std::this_thread::sleep_for(std::chrono::microseconds(static_cast<int64_t>(ms * 1000.0)));
+    }
+
+    bool Roll(std::mt19937_64& rng, double p)
+    {
+        return p > 0.0 && std::uniform_real_distribution<double>(0.0, 1.0)(rng) < p;
+    }
+
+    // ===== 판정 (AI 추론 대신 확률로) =====
+    // 불량이면 불량 라벨 하나가 해당 뷰에, 나머지 뷰는 정상 라벨 검출 하나.
+    struct DrawnVerdict
+    {
+        BinaryReply::Fields fields;
+        DetectionList top, side;
+    };
+
+    void AddDetection(std::mt19937_64& rng, DetectionList& list, uint8_t labelId)
+    {
+        Detection& d = list.items[list.count++];
+        list.present = true;
+        d.labelId = labelId;
+        d.label.Clear();
+        d.label.Append(DefectLabels::Name(labelId), std::strlen(DefectLabels::Name(labelId)));
+        d.score = std::uniform_real_distribution<float>(0.5f, 0.99f)(rng);
+        d.w = static_cast<uint16_t>(40 + rng() % 200);
+        d.h = static_cast<uint16_t>(40 + rng() % 200);
+        d.x = static_cast<uint16_t>(rng() % (640 - d.w));
+        d.y = static_cast<uint16_t>(rng() % (640 - d.h));
+    }
+
+    void DrawVerdict(std::mt19937_64& rng, DrawnVerdict& v)
+    {
+        using namespace BinaryReply;
+        v.top.Clear();
+        v.side.Clear();
+        v.fields = Fields();
+        v.fields.timestampMs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count());
+
+        if (Roll(rng, g_opt.errorRate)) {
+            ++g_count.errors;
+            v.fields.result = Verdict::Error;
+            v.fields.reason = ReasonCode::NoAiReply;
+            return;
+        }
+        const bool defect = Roll(rng, g_opt.defectRate);
+        const uint8_t label = static_cast<uint8_t>(rng() % 4);   // 0..3 = 불량 라벨
+        const bool topDefect = defect && label <= 1;
+        const bool sideDefect = defect && label >= 2;
+        if (defect) ++g_count.defects;
+
+        v.fields.result = defect ? Verdict::Defect : Verdict::Normal;
+        v.fields.topResult = topDefect ? ViewVerdict::Abnormal : ViewVerdict::Normal;
+        v.fields.sideResult = sideDefect ? ViewVerdict::Abnormal : ViewVerdict::Normal;
+        AddDetection(rng, v.top, topDefect ? label : 4);
+        AddDetection(rng, v.side, sideDefect ? label : 5);
+    }
+
+    // [label, score, x, y, w, h] 배열 (C# 서버가 AI 응답에서 그대로 넘기는 모양)
+    void AppendDetections(std::string& s, const char* key, const DetectionList& list)
+    {
+        s += ",\"";
+        s += key;
+        s += "\":[";
+        char item[96];
+        for (size_t i = 0; i < list.count; ++i) {
+            const Detection& d = list.items[i];
+            std::snprintf(item, sizeof(item), "%s[\"%s\",%.4f,%u,%u,%u,%u]", i ? "," : "",
+                DefectLabels::Name(d.labelId), d.score, d.x, d.y, d.w, d.h);
+            s += item;
+        }
+        s += ']';
+    }
+
+    std::string VerdictJson(const DrawnVerdict& v, uint32_t topFp, uint32_t sideFp)
+    {
+        // 서버 응답 문자열은 바이너리 응답을 풀었을 때와 같게 조립
+        uint8_t raw[BinaryReply::kMaxSize];
+        const size_t n = BinaryReply::Serialize(v.fields, v.top, v.side, raw);
+        InspectionReply reply;
+        BinaryReply::Decode(raw, n, reply);
+
+        char fp[64];
+        std::snprintf(fp, sizeof(fp), ",\"top_fp\":\"%08x\",\"side_fp\":\"%08x\"", topFp, sideFp);
+        std::string json = "{\"result\":\"" + reply.result.Str() + "\",\"reason\":\"" + reply.reason.Str() +
+            "\",\"timestamp\":\"" + Timestamp() + "\"" + fp;
+        AppendDetections(json, "det_top", v.top);
+        AppendDetections(json, "det_side", v.side);
+        return json + "}";
+    }
+
+    std::string ToBinary(const BinaryReply::Fields& f, const DetectionList& top, const DetectionList& side)
+    {
+        uint8_t raw[BinaryReply::kMaxSize];
+        const size_t n = BinaryReply::Serialize(f, top, side, raw);
+        return std::string(reinterpret_cast<const char*>(raw), n);
+    }
+
+    // ===== 연결 1개 처리 =====
+    void HandleConnection(SocketHandle s, std::mt19937_64& rng, std::vector<uint8_t>& body)
+    {
+        do
+        {
+            // (1) 길이 또는 'CNHD' 헤더
+            uint8_t lenBuf[4];
+            if (!RecvExact(s, lenBuf, 4)) return;
+
+            // 상태 확인 (TcpInspectionServer 와 같은 회신, active 는 이 연결 제외)
+            if (((uint32_t(lenBuf[0]) << 24) | (uint32_t(lenBuf[1]) << 16) | (uint32_t(lenBuf[2]) << 8) | lenBuf[3]) == kHealthCheckMagic)
+            {
+                ++g_count.probes;
+                size_t pending = 0;
+                {
+                    std::lock_guard<std::mutex> lock(g_pairMutex);
+                    pending = g_pendingByKey.size() + (g_hasPendingTop ? 1 : 0);
+                }
+                char reply[128];
+                const int n = std::snprintf(reply, sizeof(reply), "{\"ok\":true,\"ai\":%s,\"active\":%llu,\"pending\":%zu}",
+                    g_opt.aiDown ? "false" : "true", (unsigned long long)(g_count.active - 1), pending);
+                SendAll(s, reinterpret_cast<const uint8_t*>(reply), static_cast<size_t>(n));
+                return;
+            }
+
+            bool binary = false;
+            RequestHeader::Fields fields;
+            if (lenBuf[0] == 'C' && lenBuf[1] == 'N' && lenBuf[2] == 'H' && lenBuf[3] == 'D')
+            {
+                uint8_t header[256];   // magic, version, flags, headerSize(u16), ...
+                std::memcpy(header, lenBuf, 4);
+                if (!RecvExact(s, header + 4, 4)) return;
+                const size_t headerSize = (static_cast<size_t>(header[6]) << 8) | header[7];
+                if (headerSize < 8 || headerSize > sizeof(header)) { ++g_count.bad; return; }
+                if (!RecvExact(s, header + 8, headerSize - 8) || !RecvExact(s, lenBuf, 4)) return;
+                ++g_count.headers;
+
+                if (!RequestHeader::Parse(header, headerSize, fields))
+                    fields = RequestHeader::Fields();
+                binary = fields.replyFormat == ReplyFormat::Binary;
+                if (binary) ++g_count.binary;
+            }
+
+            const uint32_t size = (uint32_t(lenBuf[0]) << 24) | (uint32_t(lenBuf[1]) << 16) |
+                                  (uint32_t(lenBuf[2]) << 8) | lenBuf[3];
+            if (size == 0 || size > 100000000) { ++g_count.bad; return; }   // 이상치 방어 (서버와 동일)
+
+            // (2) 본문 도중 끊기
+            if (Roll(rng, g_opt.resetRate)) { ++g_count.resets; return; }
+
+            body.resize(size);
+            if (!RecvExact(s, body.data(), size)) return;
+            const uint64_t received = NowNs();
+            ++g_count.requests;
+            g_count.bytes += size;
+
+            // (3) 역할 (v3 헤더, 없으면 도착 순서)
+            const uint32_t fp = PayloadFingerprint(body.data(), size);
+            bool isTop = false;
+            uint32_t topFp = fp;
+            if (g_opt.pairing == Options::Pairing::Header && fields.hasRole)
+            {
+                ++g_count.byHeader;
+                const std::string key = std::string(fields.productId.data()) + "#" + std::to_string(fields.sequence);
+                std::lock_guard<std::mutex> lock(g_pairMutex);
+                isTop = fields.role == CameraRole::Top;
+                if (isTop) {
+                    if (g_pendingByKey.size() >= kMaxPendingKeys)
+                        g_pendingByKey.clear();
+                    g_pendingByKey[key] = fp;
+                }
+                else {
+                    auto it = g_pendingByKey.find(key);
+                    if (it != g_pendingByKey.end()) {
+                        topFp = it->second;
+                        g_pendingByKey.erase(it);
+                    }
+                    else {
+                        ++g_count.orphans;   // 짝 TOP 없음 → 지문 0 (클라이언트가 짝 불일치로 셈)
+                        topFp = 0;
+                    }
+                }
+            }
+            else if (g_opt.pairing != Options::Pairing::None)
+            {
+                std::lock_guard<std::mutex> lock(g_pairMutex);
+                isTop = !g_hasPendingTop;
+                if (isTop) g_pendingTopFp = fp;
+                else       topFp = g_pendingTopFp;
+                g_hasPendingTop = isTop;
+            }
+
+            // (4) 응답 없이 끊기 / 멈춤
+            if (Roll(rng, g_opt.dropRate)) { ++g_count.drops; return; }
+            if (Roll(rng, g_opt.stallRate)) { ++g_count.stalls; SleepMs(g_opt.stallMs); }
+
+            // (5) 응답
+            std::string reply;
+            if (isTop) {
+                ++g_count.tops;
+                SleepMs(g_opt.ackLatency.SampleMs(rng));
+                if (binary) {
+                    BinaryReply::Fields ack;
+                    ack.kind = BinaryReply::Kind::TopAck;
+                    reply = ToBinary(ack, DetectionList(), DetectionList());
+                }
+                else {
+                    reply = "{\"ok\":true,\"msg\":\"TOP saved\"}";
+                }
+            }
+            else {
+                ++g_count.verdicts;
+                const uint64_t aiStart = NowNs();
+                SleepMs(g_opt.latency.SampleMs(rng));
+                if (Roll(rng, g_opt.garbageRate)) {
+                    ++g_count.garbage;
+                    reply = "<html>502 Bad Gateway</html>";
+                }
+                else {
+                    DrawnVerdict v;
+                    DrawVerdict(rng, v);
+                    if (binary) {
+                        const uint64_t now = NowNs();
+                        v.fields.aiUs = static_cast<uint32_t>((now - aiStart) / 1000);
+                        v.fields.serverUs = static_cast<uint32_t>((now - received) / 1000);
+                        reply = ToBinary(v.fields, v.top, v.side);
+                    }
+                    else {
+                        reply = VerdictJson(v, topFp, fp);
+                    }
+                }
+            }
+
+            if (!SendAll(s, reinterpret_cast<const uint8_t*>(reply.data()), reply.size())) return;
+            g_service.Record(NowNs() - received);
+        } while (g_opt.keepAlive);
+    }
+
+    void Worker(SocketHandle listener, int index)
+    {
+        std::mt19937_64 rng(g_opt.seed * 1000003u + static_cast<uint64_t>(index));
+        std::vector<uint8_t> body;
+
+        for (;;)
+        {
+            SocketHandle s = accept(listener, nullptr, nullptr);
+            if (s == kInvalidSocket) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                continue;
+            }
+            SocketGuard guard(s);
+            const int one = 1;
+            setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+
+            ++g_count.connections;
+            ++g_count.active;
+            HandleConnection(s, rng, body);
+            --g_count.active;
+        }
+    }
+
+    void PrintSummary(double elapsed)
+    {
+        HistogramSnapshot snap;
+        g_service.Snapshot(snap);
+        std::printf("\n===== 요약 (%.1f s) =====\n", elapsed);
+        std::printf("connections %llu, requests %llu (%.1f /s), headers %llu (binary reply %llu), %.1f MB, health probes %llu\n",
+            (unsigned long long)g_count.connections, (unsigned long long)g_count.requests,
+            elapsed > 0 ? g_count.requests / elapsed : 0.0,
+            (unsigned long long)g_count.headers, (unsigned long long)g_count.binary, g_count.bytes / 1e6,
+            (unsigned long long)g_count.probes);
+        std::printf("top %llu, verdict %llu (defect %llu) | paired by header %llu, orphan side %llu\n",
+            (unsigned long long)g_count.tops, (unsigned long long)g_count.verdicts,
+            (unsigned long long)g_count.defects, (unsigned long long)g_count.byHeader,
+            (unsigned long long)g_count.orphans);
+        std::printf("injected: error %llu, garbage %llu, drop %llu, reset %llu, stall %llu | bad request %llu\n",
+            (unsigned long long)g_count.errors, (unsigned long long)g_count.garbage,
+            (unsigned long long)g_count.drops, (unsigned long long)g_count.resets,
+            (unsigned long long)g_count.stalls, (unsigned long long)g_count.bad);
+        std::printf("service ms: p50 %.2f  p99 %.2f  p999 %.2f  max %.2f\n",
+            snap.PercentileNs(0.5) / 1e6, snap.PercentileNs(0.99) / 1e6,
+            snap.PercentileNs(0.999) / 1e6, snap.maxNs / 1e6);
+        std::fflush(stdout);
+    }
+
+    bool ParseRate(const char* s, double& out)
+    {
+        out = std::atof(s);
+        return out >= 0.0 && out <= 1.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        bool ok = true;
+        if (a == "--bind" && hasValue)              g_opt.bind = argv[++i];
+        else if (a == "--port" && hasValue)         g_opt.port = std::atoi(argv[++i]);
+        else if (a == "--threads" && hasValue)      g_opt.threads = std::max(1, std::atoi(argv[++i]));
+        else if (a == "--pairing" && hasValue) {
+            const std::string m = argv[++i];
+            ok = m == "header" || m == "order" || m == "none";
+            g_opt.pairing = m == "order" ? Options::Pairing::Order : m == "none" ? Options::Pairing::None : Options::Pairing::Header;
+        }
+        else if (a == "--latency" && hasValue)      ok = g_opt.latency.Parse(argv[++i]);
+        else if (a == "--ack-latency" && hasValue)  ok = g_opt.ackLatency.Parse(argv[++i]);
+        else if (a == "--defect-rate" && hasValue)  ok = ParseRate(argv[++i], g_opt.defectRate);
+        else if (a == "--error-rate" && hasValue)   ok = ParseRate(argv[++i], g_opt.errorRate);
+        else if (a == "--garbage-rate" && hasValue) ok = ParseRate(argv[++i], g_opt.garbageRate);
+        else if (a == "--drop-rate" && hasValue)    ok = ParseRate(argv[++i], g_opt.dropRate);
+        else if (a == "--reset-rate" && hasValue)   ok = ParseRate(argv[++i], g_opt.resetRate);
+        else if (a == "--stall-rate" && hasValue)   ok = ParseRate(argv[++i], g_opt.stallRate);
+        else if (a == "--stall-ms" && hasValue)     g_opt.stallMs = std::atoi(argv[++i]);
+        else if (a == "--duration" && hasValue)     g_opt.duration = std::atof(argv[++i]);
+        else if (a == "--seed" && hasValue)         g_opt.seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (a == "--keep-alive")               g_opt.keepAlive = true;
+        else if (a == "--ai-down")                  g_opt.aiDown = true;
+        else if (a == "--quiet")                    g_opt.quiet = true;
+        else ok = false;
+
+        if (!ok) {
+            std::fprintf(stderr, "bad option: %s (see header comment for usage)\n", a.c_str());
+            return 2;
+        }
+    }
+
+    if (!Startup()) {
+        std::fprintf(stderr, "socket startup failed\n");
+        return 1;
+    }
+
+    // ===== 리슨 =====
+    sockaddr_in addr;
+    if (!Resolve(g_opt.bind.c_str(), g_opt.port, addr)) {
+        std::fprintf(stderr, "cannot resolve %s\n", g_opt.bind.c_str());
+        return 1;
+    }
+    SocketHandle listener = socket(AF_INET, SOCK_STREAM, 0);
+    const int one = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+    if (listener == kInvalidSocket ||
+        bind(listener, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listener, 1024) != 0) {
+        std::fprintf(stderr, "listen %s:%d failed (%d)\n", g_opt.bind.c_str(), g_opt.port, LastError());
+        return 1;
+    }
+    std::printf("stand-in server %s:%d, %d threads, pairing %s, keep-alive %s\n",
+        g_opt.bind.c_str(), g_opt.port, g_opt.threads,
+        g_opt.pairing == Options::Pairing::Header ? "header" : g_opt.pairing == Options::Pairing::Order ? "order" : "none",
+        g_opt.keepAlive ? "on" : "off");
+    std::fflush(stdout);
+
+    // 워커마다 같은 리슨 소켓에서 accept (프로세스 종료 시 함께 끝남)
+    for (int i = 0; i < g_opt.threads; ++i)
+        std::thread(Worker, listener, i).detach();
+
+    // ===== 초당 진행 =====
+    const uint64_t start = NowNs();
+    uint64_t lastRequests = 0;
+    for (;;)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+        const double elapsed = (NowNs() - start) / 1e9;
+        if (!g_opt.quiet)
+        {
+            const uint64_t req = g_count.requests;
+            std::printf("[%6.1fs] %6llu req/s  active %3llu  top %llu  verdict %llu  err %llu  drop %llu  reset %llu\n",
+                elapsed, (unsigned long long)(req - lastRequests), (unsigned long long)g_count.active,
+                (unsigned long long)g_count.tops, (unsigned long long)g_count.verdicts,
+                (unsigned long long)(g_count.errors + g_count.garbage), (unsigned long long)g_count.drops,
+                (unsigned long long)g_count.resets);
+            std::fflush(stdout);
+            lastRequests = req;
+        }
+        if (g_opt.duration > 0.0 && elapsed >= g_opt.duration)
+        {
+            PrintSummary(elapsed);
+            return 0;
+        }
+    }
+}
@@ -0,0 +1,250 @@
+﻿// tile_bench.cpp — 타일 융합 파이프라인 검증 + 메모리 대역폭 벤치마크 (MFC/Pylon 비의존, Linux/Windows 공용)
+//
+// 빌드 (Linux):
+//   g++ -std=c++17 -O3 -march=native -I.. tile_bench.cpp ../FrameConvert.cpp ../OverlayCompositor.cpp
+//       ../ReplyParser.cpp ../ThreadPool.cpp ../LatencyStats.cpp -o tile_bench -lpthread
+//
+// 사용:
+//   tile_bench [--size WxH] [--format NAME] [--preview WxH] [--threads N] [--reps N]
+//   NAME = Mono8 | BayerRG8 | BayerGR8 | BayerGB8 | BayerBG8 | RGB8 | BGR8 (기본 BayerRG8)
+//
+// 검사 (모든 형식):
+//   1) 단색 영상 → 변환 결과가 그 색 그대로 (디모자이크 가중치/경계 처리)
+//   2) 융합 == 단계별 (변환 → 축소, 변환 → LUT), 1스레드 == N스레드 (비트 단위)
+// 시간 (--format 형식): 단계별 실행 vs 융합 실행, 장당 ms + 메모리 이동량 모델
+//   단계별 = 원본 읽기 + 센서 해상도 BGR8 쓰기 + 다시 읽기 + 출력 쓰기
+//   융합   = 원본 읽기 + 출력 쓰기 (베이어 이웃 행은 같은 타일 안이라 캐시에서)
+
+#include "FrameConvert.h"
+#include "LatencyStats.h"
+#include "OverlayCompositor.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace
+{
+    const RawFormat kFormats[] = {
+        RawFormat::Mono8, RawFormat::BayerRG8, RawFormat::BayerGR8, RawFormat::BayerGB8,
+        RawFormat::BayerBG8, RawFormat::RGB8, RawFormat::BGR8,
+    };
+
+    bool ParseFormat(const std::string& name, RawFormat& out)
+    {
+        for (RawFormat f : kFormats)
+            if (name == RawFormatName(f)) { out = f; return true; }
+        return false;
+    }
+
+    // 캔 비슷한 합성 컬러 영상 (가로 그라데이션 + 줄무늬 + 잡음)
+    void MakeSynthetic(int w, int h, uint32_t seed, ImageBuffer& out)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> noise(-6, 6);
+        out.Allocate(w, h);
+        for (int y = 0; y < h; ++y) {
+            uint8_t* row = out.Row(y);
+            for (int x = 0; x < w; ++x) {
+                const int v = 60 + 120 * x / std::max(1, w) + ((y / 16) % 2 ? 25 : 0);
+                row[x * 3 + 0] = static_cast<uint8_t>(std::clamp(v - 20 + noise(rng), 0, 255));
+                row[x * 3 + 1] = static_cast<uint8_t>(std::clamp(v + noise(rng), 0, 255));
+                row[x * 3 + 2] = static_cast<uint8_t>(std::clamp(v + 30 + noise(rng), 0, 255));
+            }
+        }
+    }
+
+    // BGR8 → 카메라 원본 형식 (베이어는 해당 위치의 채널만 남김)
+    RawFrame Mosaic(const ImageBuffer& bgr, RawFormat f, std::vector<uint8_t>& storage)
+    {
+        const int bpp = RawBytesPerPixel(f);
+        const int stride = bgr.width * bpp;
+        storage.assign(static_cast<size_t>(stride) * bgr.height, 0);
+        const int rx = (f == RawFormat::BayerGR8 || f == RawFormat::BayerBG8) ? 1 : 0;
+        const int ry = (f == RawFormat::BayerGB8 || f == RawFormat::BayerBG8) ? 1 : 0;
+
+        for (int y = 0; y < bgr.height; ++y) {
+            const uint8_t* s = bgr.View().Row(y);
+            uint8_t* d = storage.data() + static_cast<size_t>(y) * stride;
+            for (int x = 0; x < bgr.width; ++x) {
+                const uint8_t* p = s + x * 3;
+                switch (f) {
+                case RawFormat::BGR8:  d[x * 3] = p[0]; d[x * 3 + 1] = p[1]; d[x * 3 + 2] = p[2]; break;
+                case RawFormat::RGB8:  d[x * 3] = p[2]; d[x * 3 + 1] = p[1]; d[x * 3 + 2] = p[0]; break;
+                case RawFormat::Mono8: d[x] = static_cast<uint8_t>((p[0] * 29 + p[1] * 150 + p[2] * 77) >> 8); break;
+                default: {
+                    const bool rRow = (y & 1) == ry;
+                    const bool pSite = (x & 1) == (rRow ? rx : 1 - rx);
+                    d[x] = pSite ? (rRow ? p[2] : p[0]) : p[1];
+                }
+                }
+            }
+        }
+
+        RawFrame raw;
+        raw.data = storage.data();
+        raw.width = bgr.width;
+        raw.height = bgr.height;
+        raw.stride = stride;
+        raw.format = f;
+        return raw;
+    }
+
+    // 단계별 LUT 패스 (전체 영상을 한 번 더 읽고 씀)
+    void ApplyLut(const Tile::ChannelLut& lut, ImageBuffer& img)
+    {
+        for (int y = 0; y < img.height; ++y)
+            lut(img.Row(y), img.width, y);
+    }
+
+    template <class Fn>
+    double MsPer(int reps, Fn&& fn)
+    {
+        fn();   // 버퍼 할당/캐시 준비
+        const uint64_t t0 = NowNs();
+        for (int r = 0; r < reps; ++r)
+            fn();
+        return (NowNs() - t0) / 1e6 / reps;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    int w = 2448, h = 2048, pw = 640, ph = 480, reps = 10;
+    size_t threads = 0;
+    RawFormat format = RawFormat::BayerRG8;
+
+    for (int i = 1; i < argc; ++i) {
+        const std::string a = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (a == "--size" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &w, &h) != 2 || w < 2 || h < 2) {
+                std::fprintf(stderr, "bad --size\n");
+                return 2;
+            }
+        }
+        else if (a == "--preview" && hasValue) {
+            if (std::sscanf(argv[++i], "%dx%d", &pw, &ph) != 2 || pw < 4 || ph < 1) {
+                std::fprintf(stderr, "bad --preview\n");
+                return 2;
+            }
+        }
+        else if (a == "--format" && hasValue) {
+            if (!ParseFormat(argv[++i], format)) {
+                std::fprintf(stderr, "unknown format: %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (a == "--threads" && hasValue) threads = static_cast<size_t>(std::atol(argv[++i]));
+        else if (a == "--reps" && hasValue)    reps = std::max(1, std::atoi(argv[++i]));
+        else {
+            std::fprintf(stderr, "usage: tile_bench [--size WxH] [--format NAME] [--preview WxH] [--threads N] [--reps N]\n");
+            return 2;
+        }
+    }
+
+    CThreadPool pool(threads);
+    const Tile::ChannelLut lut = Tile::ChannelLut::GainGamma(1.10, 1.0, 1.25, 2.2);
+    size_t failures = 0;
+
+    // ===== 1) 단색 =====
+    for (RawFormat f : kFormats) {
+        ImageBuffer flat, out;
+        flat.Allocate(37, 21);
+        for (size_t i = 0; i < flat.pixels.size(); i += 3) {
+            flat.pixels[i] = 40; flat.pixels[i + 1] = 150; flat.pixels[i + 2] = 220;
+        }
+        std::vector<uint8_t> storage;
+        const RawFrame raw = Mosaic(flat, f, storage);
+        ImageBuffer expect;
+        if (f == RawFormat::Mono8) {
+            const uint8_t v = storage[0];
+            expect.Allocate(flat.width, flat.height);
+            std::fill(expect.pixels.begin(), expect.pixels.end(), v);
+        }
+        else expect = flat;
+
+        if (!ConvertToBgr(raw, out, &pool) || out.pixels != expect.pixels) {
+            ++failures;
+            std::fprintf(stderr, "flat colour mismatch: %s\n", RawFormatName(f));
+        }
+    }
+
+    // ===== 2) 융합 == 단계별, 1스레드 == N스레드 (홀수 크기 포함) =====
+    for (RawFormat f : kFormats) {
+        for (auto wh : { std::pair<int, int>{ 2, 2 }, { 33, 17 }, { 641, 479 }, { 1280, 960 } }) {
+            ImageBuffer bgr;
+            MakeSynthetic(wh.first, wh.second, 7, bgr);
+            std::vector<uint8_t> storage;
+            const RawFrame raw = Mosaic(bgr, f, storage);
+
+            ImageBuffer full, staged, fused, fusedSingle;
+            ConvertToBgr(raw, full, nullptr);
+            DownscaleToFit(full.View(), 320, 240, staged);
+            ConvertPreview(raw, 320, 240, fused, &pool);
+            ConvertPreview(raw, 320, 240, fusedSingle, nullptr);
+            bool ok = fused.width == staged.width && fused.height == staged.height &&
+                      fused.pixels == staged.pixels && fusedSingle.pixels == fused.pixels;
+
+            ImageBuffer lutFused;
+            ConvertToBgr(raw, lutFused, &pool, &lut);
+            ApplyLut(lut, full);
+            ok = ok && lutFused.pixels == full.pixels;
+
+            if (!ok) {
+                ++failures;
+                std::fprintf(stderr, "fused/staged mismatch: %s %dx%d\n", RawFormatName(f), wh.first, wh.second);
+            }
+        }
+    }
+    std::printf("formats: %zu, flat colour + fused vs staged: %s\n",
+        sizeof(kFormats) / sizeof(kFormats[0]), failures ? "MISMATCH" : "identical");
+
+    // ===== 3) 시간 / 메모리 이동량 =====
+    ImageBuffer bgr;
+    MakeSynthetic(w, h, 1, bgr);
+    std::vector<uint8_t> storage;
+    const RawFrame raw = Mosaic(bgr, format, storage);
+
+    ImageBuffer full, small;
+    int sw = 0, sh = 0;
+    Tile::FitSize(w, h, pw, ph, sw, sh);
+
+    const double rawMB = static_cast<double>(w) * h * RawBytesPerPixel(format) / 1e6;
+    const double bgrMB = static_cast<double>(w) * h * 3 / 1e6;
+    const double smallMB = static_cast<double>(sw) * sh * 3 / 1e6;
+
+    struct Row { const char* name; double ms; double mb; };
+    std::vector<Row> table;
+
+    table.push_back({ "convert (1 thread)", MsPer(reps, [&] { ConvertToBgr(raw, full, nullptr); }), rawMB + bgrMB });
+    table.push_back({ "convert (N threads)", MsPer(reps, [&] { ConvertToBgr(raw, full, &pool); }), rawMB + bgrMB });
+    table.push_back({ "preview staged", MsPer(reps, [&] {
+        ConvertToBgr(raw, full, &pool);
+        DownscaleToFit(full.View(), pw, ph, small);
+    }), rawMB + 2 * bgrMB + smallMB });
+    table.push_back({ "preview fused", MsPer(reps, [&] { ConvertPreview(raw, pw, ph, small, &pool); }), rawMB + smallMB });
+    table.push_back({ "convert+lut staged", MsPer(reps, [&] {
+        ConvertToBgr(raw, full, &pool);
+        ApplyLut(lut, full);
+    }), rawMB + 3 * bgrMB });
+    table.push_back({ "convert+lut fused", MsPer(reps, [&] { ConvertToBgr(raw, full, &pool, &lut); }), rawMB + bgrMB });
+
+    std::printf("\n%s %dx%d → preview %dx%d, %zu threads, %d reps\n",
+        RawFormatName(format), w, h, sw, sh, pool.Size(), reps);
+    std::printf("%-22s %9s %11s %9s\n", "path", "ms/frame", "moved(MB)", "GB/s");
+    for (const Row& r : table)
+        std::printf("%-22s %9.2f %11.1f %9.2f\n", r.name, r.ms, r.mb, r.ms > 0 ? r.mb / r.ms : 0.0);
+
+    auto saved = [](const Row& staged, const Row& fused) {
+        return staged.mb > 0 ? 100.0 * (1.0 - fused.mb / staged.mb) : 0.0;
+    };
+    std::printf("\nmemory traffic saved by fusion: preview %.0f%%, convert+lut %.0f%%\n",
+        saved(table[2], table[3]), saved(table[4], table[5]));
+
+    return failures ? 1 : 0;
+}
@@ -57,8 +57,26 @@ DEFECT_LABELS_SIDE = {"측면찌그러짐", "스크래치"}
 # ======================================
 # 추론 함수
 # ======================================
-def infer_image(img_bgr, camera_type=None):
-    """단일 이미지 추론 → 내부 공통 포맷 리턴"""
+def enhance_side(img_bgr):
+    """측면 전처리: 대비/엣지 강화 + 약한 블러 (클라이언트 SideEnhance.cpp 와 같은 연산)"""
+    # 명암 대비 및 밝기 조정
+    img_bgr = cv2.convertScaleAbs(img_bgr, alpha=1.4, beta=15)
+
+    # 윤곽선(엣지) 검출
+    gray = cv2.cvtColor(img_bgr, cv2.COLOR_BGR2GRAY)
+    edges = cv2.Canny(gray, 60, 180)  # 엣지 검출
+    edges_colored = cv2.cvtColor(edges, cv2.COLOR_GRAY2BGR)
+
+    # 원본 이미지에 엣지 일부 섞기 (찌그러진 부분 대비 향상)
+    img_bgr = cv2.addWeighted(img_bgr, 0.85, edges_colored, 0.15, 0)
+
+    # 약한 노이즈 제거
+    return cv2.GaussianBlur(img_bgr, (3, 3), 0)
+
+
+def infer_image(img_bgr, camera_type=None, side_ready=False):
+    """단일 이미지 추론 → 내부 공통 포맷 리턴
+    side_ready: 클라이언트가 측면 전처리를 이미 적용함 (모드 0x04) → 다시 하지 않음"""
     t0 = time.time()
 
     if img_bgr is None or img_bgr.size == 0:
@@ -78,19 +96,8 @@ def infer_image(img_bgr, camera_type=None):
     # # ⚙️ 전처리: 측면만 대비/엣지 강화
     # # ===============================
     if camera_type == "side":
-        # 명암 대비 및 밝기 조정
-        img_bgr = cv2.convertScaleAbs(img_bgr, alpha=1.4, beta=15)
-
-        # 윤곽선(엣지) 검출
-        gray = cv2.cvtColor(img_bgr, cv2.COLOR_BGR2GRAY)
-        edges = cv2.Canny(gray, 60, 180)  # 엣지 검출
-        edges_colored = cv2.cvtColor(edges, cv2.COLOR_GRAY2BGR)
-
-        # 원본 이미지에 엣지 일부 섞기 (찌그러진 부분 대비 향상)
-        img_bgr = cv2.addWeighted(img_bgr, 0.85, edges_colored, 0.15, 0)
-
-        # 약한 노이즈 제거
-        img_bgr = cv2.GaussianBlur(img_bgr, (3, 3), 0)
+        if not side_ready:
+            img_bgr = enhance_side(img_bgr)
 
         img_rgb = cv2.cvtColor(img_bgr, cv2.COLOR_BGR2RGB)
 
@@ -185,6 +192,12 @@ def infer_image(img_bgr, camera_type=None):
 
 
 
+def det_list(res):
+    """클라이언트 회신용 검출 목록: [label, score, x, y, w, h] (박스는 전송 이미지 좌표)
+    앞 두 원소는 기존 [label, score] 와 같아서 옛 클라이언트도 그대로 읽는다."""
+    return [[b["label"], b["score"], b["x"], b["y"], b["w"], b["h"]] for b in res["bboxes"]]
+
+
 # ======================================
 # TCP 유틸리티 함수
 # ======================================
@@ -223,8 +236,9 @@ def handle_client(conn: socket.socket, addr):
 
         # ----------------------------
         # 0x02 : Dual 분석 (TOP + SIDE)
+        # 0x04 : Dual, SIDE 는 클라이언트에서 전처리 완료
         # ----------------------------
-        if mode == 0x02:
+        if mode in (0x02, 0x04):
             print("[AI] Dual request...")
 
             # TOP 이미지 수신
@@ -253,14 +267,14 @@ def handle_client(conn: socket.socket, addr):
 
             # AI 추론 수행
             res_top = infer_image(img_top, "top")
-            res_side = infer_image(img_side, "side")
+            res_side = infer_image(img_side, "side", side_ready=(mode == 0x04))
 
             final = {
                 "result": "정상" if (res_top["result"] == "normal" and res_side["result"] == "normal") else "비정상",
                 "top_result": "정상" if res_top["result"] == "normal" else "비정상",
                 "side_result": "정상" if res_side["result"] == "normal" else "비정상",
-                "det_top": [[c["name"], c["score"]] for c in res_top["classes"]],
-                "det_side": [[c["name"], c["score"]] for c in res_side["classes"]],
+                "det_top": det_list(res_top),
+                "det_side": det_list(res_side),
             }
 
             payload = json.dumps(final, ensure_ascii=False).encode("utf-8")
@@ -301,7 +315,7 @@ def handle_client(conn: socket.socket, addr):
             final = {
                 "result": "정상" if res["result"] == "normal" else "비정상",
                 ("det_top" if cam_label == "top" else "det_side"):
-                    [[c["name"], c["score"]] for c in res["classes"]]
+                    det_list(res)
             }
 
             payload = json.dumps(final, ensure_ascii=False).encode("utf-8")
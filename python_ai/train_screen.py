@@ -0,0 +1,296 @@
+# train_screen.py
+# 목적: 클라이언트(CanClient) 로컬 1차 선별용 초소형 CNN 학습 → int8 양자화 → 'CNSM' 파일 출력
+#       (C++ 엔진: mfc_client/LocalScreen.h/.cpp, 정확도/처리량 측정: mfc_client/tools/screen_bench.cpp)
+#
+# 사용:
+#   python train_screen.py --data ../datasets/can_defect --view top  --out screen_top.cnsm
+#   python train_screen.py --data ../datasets/can_defect --view side --out screen_side.cnsm
+#
+# 데이터: YOLO 포맷 (images/train, labels/train, images/val, labels/val)
+#   - 이미지 라벨에 불량 클래스(ID 0~3)가 하나라도 있으면 불량, 아니면 정상
+#   - 뷰: 라벨 클래스 0/1/4 = top, 2/3/5 = side (라벨이 없으면 파일 이름의 top/side/front)
+#
+# 입력 전처리는 클라이언트와 똑같이 맞춤:
+#   BGR 그대로, 레터박스(ultralytics 규칙, 패딩 114, cv2.INTER_LINEAR), 1/255 정규화는 첫 층 multiplier 에 포함
+
+import os
+import glob
+import math
+import struct
+import argparse
+import random
+
+import cv2
+import numpy as np
+import torch
+import torch.nn as nn
+import torch.nn.functional as F
+
+# ===== ① 기본 설정 =====
+INPUT_SIZE = 160
+CHANNELS   = [8, 16, 32, 32]      # 층별 출력 채널 (3x3, stride 2, pad 1)
+EPOCHS     = 60
+BATCH      = 32
+LR         = 2e-3
+DEFECT_W   = 4.0                  # 불량 놓침이 더 비싸므로 불량 클래스 손실 가중
+CALIB_PCT  = 99.99                # 활성값 스케일 보정 백분위
+DEVICE     = "cuda" if torch.cuda.is_available() else "cpu"
+
+TOP_CLASSES  = {0, 1, 4}
+SIDE_CLASSES = {2, 3, 5}
+IMAGE_EXTS   = (".jpg", ".jpeg", ".png", ".bmp")
+
+
+# ===== ② 전처리 (mfc_client/Preprocess.cpp ComputeLetterbox / LetterboxResize 와 동일) =====
+def round_half_away(x):
+    return int(math.floor(x + 0.5)) if x >= 0 else -int(math.floor(-x + 0.5))
+
+
+def letterbox(img, size=INPUT_SIZE):
+    h, w = img.shape[:2]
+    r = min(size / w, size / h)
+    sw = min(max(round_half_away(w * r), 1), size)
+    sh = min(max(round_half_away(h * r), 1), size)
+    px = max(0, round_half_away((size - sw) / 2.0 - 0.1))
+    py = max(0, round_half_away((size - sh) / 2.0 - 0.1))
+    out = np.full((size, size, 3), 114, np.uint8)
+    out[py:py + sh, px:px + sw] = cv2.resize(img, (sw, sh), interpolation=cv2.INTER_LINEAR)
+    return out
+
+
+# ===== ③ 데이터셋 =====
+def read_label(img_path, label_dir):
+    stem = os.path.splitext(os.path.basename(img_path))[0]
+    name = stem.lower()
+    view = "side" if ("side" in name or "front" in name) else "top"
+    defect = False
+    label_path = os.path.join(label_dir, stem + ".txt")
+    if os.path.exists(label_path):
+        with open(label_path, encoding="utf-8") as f:
+            for line in f:
+                parts = line.split()
+                if not parts:
+                    continue
+                cls = int(float(parts[0]))
+                defect = defect or cls < 4
+                if cls in TOP_CLASSES:
+                    view = "top"
+                elif cls in SIDE_CLASSES:
+                    view = "side"
+    return view, defect
+
+
+def load_split(root, split, view):
+    img_dir = os.path.join(root, "images", split)
+    label_dir = os.path.join(root, "labels", split)
+    xs, ys = [], []
+    for path in sorted(glob.glob(os.path.join(img_dir, "*"))):
+        if not path.lower().endswith(IMAGE_EXTS):
+            continue
+        v, defect = read_label(path, label_dir)
+        if view != "both" and v != view:
+            continue
+        img = cv2.imread(path, cv2.IMREAD_COLOR)
+        if img is None:
+            continue
+        xs.append(letterbox(img))
+        ys.append(1 if defect else 0)
+    print(f"[DATA] {split}/{view}: {len(xs)}장 (불량 {sum(ys)}, 정상 {len(ys) - sum(ys)})")
+    return np.stack(xs) if xs else np.zeros((0, INPUT_SIZE, INPUT_SIZE, 3), np.uint8), np.array(ys, np.int64)
+
+
+def augment(batch):
+    # 좌우/상하 반전 + 밝기/대비 흔들기 (uint8 NHWC)
+    out = batch.astype(np.float32)
+    for i in range(len(out)):
+        if random.random() < 0.5:
+            out[i] = out[i][:, ::-1]
+        if random.random() < 0.5:
+            out[i] = out[i][::-1]
+        out[i] = out[i] * random.uniform(0.85, 1.15) + random.uniform(-15, 15)
+    return np.clip(out, 0, 255)
+
+
+def to_tensor(batch):
+    # NHWC(0~255) → NCHW(0~1), 채널 순서는 BGR 그대로
+    return torch.from_numpy(np.ascontiguousarray(batch, np.float32)).permute(0, 3, 1, 2).div(255.0)
+
+
+# ===== ④ 모델 =====
+class ScreenNet(nn.Module):
+    def __init__(self, channels=CHANNELS):
+        super().__init__()
+        layers, in_c = [], 3
+        for c in channels:
+            layers.append(nn.Conv2d(in_c, c, 3, stride=2, padding=1))
+            in_c = c
+        self.convs = nn.ModuleList(layers)
+        self.fc = nn.Linear(in_c, 2)   # [정상, 불량]
+
+    def features(self, x):
+        acts = []
+        for conv in self.convs:
+            x = F.relu(conv(x))
+            acts.append(x)
+        return x, acts
+
+    def forward(self, x):
+        x, _ = self.features(x)
+        return self.fc(x.mean(dim=(2, 3)))
+
+
+def train(model, x_train, y_train, x_val, y_val, epochs):
+    opt = torch.optim.AdamW(model.parameters(), lr=LR, weight_decay=1e-4)
+    sched = torch.optim.lr_scheduler.CosineAnnealingLR(opt, epochs)
+    weight = torch.tensor([1.0, DEFECT_W], device=DEVICE)
+    for epoch in range(1, epochs + 1):
+        model.train()
+        order = np.random.permutation(len(x_train))
+        total = 0.0
+        for i in range(0, len(order), BATCH):
+            idx = order[i:i + BATCH]
+            xb = to_tensor(augment(x_train[idx])).to(DEVICE)
+            yb = torch.from_numpy(y_train[idx]).to(DEVICE)
+            loss = F.cross_entropy(model(xb), yb, weight=weight)
+            opt.zero_grad()
+            loss.backward()
+            opt.step()
+            total += loss.item() * len(idx)
+        sched.step()
+        if epoch % 10 == 0 or epoch == epochs:
+            p = predict(model, x_val)
+            print(f"[TRAIN] epoch {epoch:3d} loss {total / max(1, len(x_train)):.4f}  val {summary(p, y_val, 0.05)}")
+
+
+@torch.no_grad()
+def predict(model, x):
+    model.eval()
+    out = []
+    for i in range(0, len(x), 64):
+        out.append(F.softmax(model(to_tensor(x[i:i + 64]).to(DEVICE)), dim=1)[:, 1].cpu().numpy())
+    return np.concatenate(out) if out else np.zeros(0)
+
+
+def summary(prob, y, thr):
+    if len(y) == 0:
+        return "-"
+    passed = prob < thr
+    defects = max(1, int((y == 1).sum()))
+    normals = max(1, int((y == 0).sum()))
+    return (f"pass<{thr:.2f}: 로컬 {passed.mean() * 100:.1f}%, "
+            f"불량 누락 {int((passed & (y == 1)).sum())}/{defects}, "
+            f"정상 통과 {(passed & (y == 0)).sum() / normals * 100:.1f}%")
+
+
+# ===== ⑤ int8 양자화 (LocalScreen.cpp 정수 연산과 동일한 규칙) =====
+@torch.no_grad()
+def calibrate(model, x_calib):
+    # 층별 ReLU 출력 상한 → uint8 스케일
+    model.eval()
+    maxima = [[] for _ in model.convs]
+    for i in range(0, len(x_calib), 64):
+        _, acts = model.features(to_tensor(x_calib[i:i + 64]).to(DEVICE))
+        for k, a in enumerate(acts):
+            maxima[k].append(a.flatten().cpu().numpy())
+    scales = []
+    for values in maxima:
+        v = np.concatenate(values)
+        top = float(np.percentile(v, CALIB_PCT)) if len(v) else 1.0
+        scales.append(max(top, 1e-6) / 255.0)
+    return scales
+
+
+def quantize(model, act_scales):
+    layers = []
+    s_in = 1.0 / 255.0   # 첫 층 입력 = 픽셀 값 그대로
+    for conv, s_out in zip(model.convs, act_scales):
+        w = conv.weight.detach().cpu().numpy().astype(np.float64)   # [out][in][k][k]
+        b = conv.bias.detach().cpu().numpy().astype(np.float64)
+        w_scale = np.maximum(np.abs(w).reshape(w.shape[0], -1).max(axis=1), 1e-12) / 127.0
+        wq = np.clip(np.round(w / w_scale[:, None, None, None]), -127, 127).astype(np.int8)
+        bq = np.round(b / (s_in * w_scale)).astype(np.int64)
+        bq = np.clip(bq, -2**31, 2**31 - 1).astype(np.int32)
+        mult = (s_in * w_scale / s_out).astype(np.float32)
+        layers.append(("conv", conv, wq.transpose(0, 2, 3, 1), bq, mult))   # → [out][k][k][in]
+        s_in = s_out
+    fc_w = model.fc.weight.detach().cpu().numpy().astype(np.float32)
+    fc_b = model.fc.bias.detach().cpu().numpy().astype(np.float32)
+    return layers, (s_in, fc_w, fc_b)
+
+
+def simulate_int8(layers, head, x):
+    # C++ RunPrepared 와 같은 정수 연산 (검증용, 느리지만 단순)
+    probs = []
+    for img in x:
+        a = img.astype(np.int64)   # HWC
+        for _, conv, wq, bq, mult in layers:
+            k, s, p = conv.kernel_size[0], conv.stride[0], conv.padding[0]
+            h, w, c = a.shape
+            oh, ow = (h + 2 * p - k) // s + 1, (w + 2 * p - k) // s + 1
+            padded = np.zeros((h + 2 * p, w + 2 * p, c), np.int64)
+            padded[p:p + h, p:p + w] = a
+            acc = np.zeros((oh, ow, wq.shape[0]), np.int64) + bq.astype(np.int64)
+            for ky in range(k):
+                for kx in range(k):
+                    patch = padded[ky:ky + s * oh:s, kx:kx + s * ow:s]        # [oh][ow][in]
+                    acc += patch @ wq[:, ky, kx, :].astype(np.int64).T
+            a = np.clip(np.rint(acc.astype(np.float32) * mult), 0, 255).astype(np.int64)
+        s_last, fc_w, fc_b = head
+        pooled = a.reshape(-1, a.shape[-1]).sum(axis=0).astype(np.float32) / (a.shape[0] * a.shape[1]) * s_last
+        z = fc_w @ pooled + fc_b
+        probs.append(1.0 / (1.0 + math.exp(float(z[0] - z[1]))))
+    return np.array(probs)
+
+
+def export_cnsm(path, layers, head):
+    s_last, fc_w, fc_b = head
+    with open(path, "wb") as f:
+        f.write(b"CNSM")
+        f.write(struct.pack("<HHB3x", 1, INPUT_SIZE, len(layers) + 1))
+        for _, conv, wq, bq, mult in layers:
+            out_c, k, _, in_c = wq.shape
+            f.write(struct.pack("<BBBBBHH", 1, k, conv.stride[0], conv.padding[0], 0, in_c, out_c))
+            f.write(np.ascontiguousarray(wq, np.int8).tobytes())
+            f.write(bq.astype("<i4").tobytes())
+            f.write(mult.astype("<f4").tobytes())
+        f.write(struct.pack("<BHHf", 2, fc_w.shape[1], fc_w.shape[0], s_last))
+        f.write(fc_w.astype("<f4").tobytes())
+        f.write(fc_b.astype("<f4").tobytes())
+    print(f"[EXPORT] {path} ({os.path.getsize(path)} bytes)")
+
+
+# ===== ⑥ 실행 =====
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--data", default=os.path.join("..", "datasets", "can_defect"))
+    ap.add_argument("--view", choices=["top", "side", "both"], default="top")
+    ap.add_argument("--out", default=None)
+    ap.add_argument("--epochs", type=int, default=EPOCHS)
+    ap.add_argument("--seed", type=int, default=42)
+    args = ap.parse_args()
+
+    random.seed(args.seed)
+    np.random.seed(args.seed)
+    torch.manual_seed(args.seed)
+
+    x_train, y_train = load_split(args.data, "train", args.view)
+    x_val, y_val = load_split(args.data, "val", args.view)
+    if len(x_train) == 0:
+        raise SystemExit("[ERROR] 학습 이미지가 없습니다")
+
+    model = ScreenNet().to(DEVICE)
+    train(model, x_train, y_train, x_val, y_val, args.epochs)
+
+    layers, head = quantize(model, calibrate(model, x_train))
+    if len(x_val):
+        p_float = predict(model, x_val)
+        p_int8 = simulate_int8(layers, head, x_val)
+        print(f"[QUANT] float vs int8 최대 차이 {np.abs(p_float - p_int8).max():.4f}")
+        for thr in (0.01, 0.02, 0.05, 0.1, 0.2):
+            print(f"[QUANT] {summary(p_int8, y_val, thr)}")
+
+    export_cnsm(args.out or f"screen_{args.view}.cnsm", layers, head)
+
+
+if __name__ == "__main__":
+    main()